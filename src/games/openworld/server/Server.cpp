@@ -53,6 +53,8 @@ app::AppState Server::onConstruct() {
 	core::Var::get(cfg::ServerMaxClients, "1024");
 	core::Var::get(cfg::ServerHttpPort, HTTP_SERVER_PORT, core::CV_REPLICATE);
 	core::Var::get(cfg::ServerSeed, "1", core::CV_REPLICATE);
+	core::Var::get(cfg::ServerCompressChunks, "true");
+	core::Var::get(cfg::ServerChunkWriteBackInterval, "5000");
 	core::Var::get(cfg::VoxelMeshSize, "16", core::CV_READONLY);
 	core::Var::get(cfg::DatabaseMinConnections, "2");
 	core::Var::get(cfg::DatabaseMaxConnections, "100");
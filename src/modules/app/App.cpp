@@ -5,6 +5,7 @@
 #include "App.h"
 #include "app/AppCommand.h"
 #include "core/Var.h"
+#include "core/ColorReduction.h"
 #include "core/concurrent/ThreadPool.h"
 #include "command/Command.h"
 #include "command/CommandHandler.h"
@@ -244,6 +245,12 @@ AppState App::onConstruct() {
 		logVar->setVal(logLevelVal);
 	}
 	core::Var::get(cfg::CoreSysLog, _syslog ? "true" : "false", "Log to the system log", core::Var::boolValidator);
+	core::Var::get(cfg::CoreColorReduction,
+				   core::toColorReductionTypeString(core::ColorReductionType::Octree),
+				   "Controls the algorithm that is used to perform the color reduction (Octree, MedianCut or KMeans)",
+				   [](const core::String &val) {
+					   return core::toColorReductionType(val.c_str()) != core::ColorReductionType::Max;
+				   });
 
 	Log::init();
 
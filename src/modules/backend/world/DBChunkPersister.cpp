@@ -68,8 +68,7 @@ bool DBChunkPersister::load(const voxel::PagedVolume::ChunkPtr& chunk, unsigned
 	return true;
 }
 
-// TODO: this must be done async
-bool DBChunkPersister::save(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) {
+bool DBChunkPersister::save(const voxel::PagedVolume::Chunk* chunk, unsigned int seed) {
 	core_trace_scoped(DBChunkPersisterSave);
 	io::BufferedReadWriteStream out(10);
 	if (!saveCompressed(chunk, out)) {
@@ -29,9 +29,14 @@ public:
 	 */
 	bool truncate(unsigned int seed);
 
+	using voxelworld::ChunkPersister::save;
+
 	bool load(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) override;
-	bool save(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) override;
+	bool save(const voxel::PagedVolume::Chunk* chunk, unsigned int seed) override;
 	void erase(const voxel::Region& region, unsigned int seed) override;
+	bool isPersistent() const override {
+		return true;
+	}
 };
 
 typedef std::shared_ptr<DBChunkPersister> DBChunkPersisterPtr;
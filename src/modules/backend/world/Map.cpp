@@ -85,6 +85,14 @@ void Map::update(long dt) {
 	_zone->update(dt);
 	_attackMgr.update(dt);
 
+	const uint32_t flushedChunks = _pager->flushedChunks();
+	if (flushedChunks != _reportedFlushedChunks) {
+		_reportedFlushedChunks = flushedChunks;
+		metric::TagMap tags;
+		tags.put("map", _mapIdStr);
+		_eventBus->enqueue(std::make_shared<metric::MetricEvent>(metric::timing("chunk.flush", _pager->lastFlushMillis(), tags)));
+	}
+
 	for (auto i = _users.begin(); i != _users.end();) {
 		UserPtr user = i->second;
 		if (updateEntity(user, dt)) {
@@ -123,7 +131,8 @@ bool Map::init() {
 
 	_pager = core::make_shared<voxelworld::WorldPager>(_volumeCache, _chunkPersister);
 	_voxelWorldMgr = new voxelworld::WorldMgr(_pager);
-	if (!_voxelWorldMgr->init()) {
+	const core::VarPtr& compressChunks = core::Var::get(cfg::ServerCompressChunks, "true");
+	if (!_voxelWorldMgr->init(1024, 256, compressChunks->boolVal())) {
 		Log::error("Failed to init map with id %i", _mapId);
 		return false;
 	}
@@ -132,6 +141,7 @@ bool Map::init() {
 	const core::String& worldParamData = _filesystem->load("worldparams.lua");
 	const core::String& biomesData = _filesystem->load("biomes.lua");
 	_pager->init(_voxelWorldMgr->volumeData(), worldParamData, biomesData);
+	_pager->setWriteBackInterval(core::Var::get(cfg::ServerChunkWriteBackInterval, "5000")->intVal());
 	_pager->setSeed(seed->uintVal());
 	_pager->setNoiseOffset(glm::vec2(0.0f));
 
@@ -37,6 +37,8 @@ private:
 	core::String _mapIdStr;
 	voxelworld::WorldMgr* _voxelWorldMgr = nullptr;
 	voxelworld::WorldPagerPtr _pager;
+	// the amount of flushed chunks of the pager that were already reported as metric
+	uint32_t _reportedFlushedChunks = 0u;
 
 	core::EventBusPtr _eventBus;
 	io::FilesystemPtr _filesystem;
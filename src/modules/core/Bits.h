@@ -5,6 +5,9 @@
 #pragma once
 
 #include <stdint.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 namespace core {
 
@@ -13,4 +16,43 @@ constexpr uint32_t bits(uint32_t x, uint8_t offset, uint8_t len) {
 	return tmp & ((1u << len) - 1u);
 }
 
+/**
+ * @return The index of the lowest set bit
+ * @note The result is undefined if @c mask is @c 0
+ */
+inline int countTrailingZeros(uint64_t mask) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctzll(mask);
+#endif
+}
+
+/**
+ * @return The amount of zero bits above the highest set bit
+ * @note The result is undefined if @c mask is @c 0
+ */
+inline int countLeadingZeros(uint64_t mask) {
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanReverse64(&index, mask);
+	return 63 - (int)index;
+#else
+	return __builtin_clzll(mask);
+#endif
+}
+
+/**
+ * @return The amount of set bits
+ */
+inline int countSetBits(uint64_t mask) {
+#if defined(_MSC_VER)
+	return (int)__popcnt64(mask);
+#else
+	return __builtin_popcountll(mask);
+#endif
+}
+
 } // namespace core
@@ -0,0 +1,117 @@
+/**
+ * @file
+ */
+
+#include "ClosestColorTree.h"
+#include "core/Color.h"
+#include <glm/common.hpp>
+#include <glm/exponential.hpp>
+#include <algorithm>
+
+namespace core {
+
+/**
+ * @brief Ranges of this size are searched linearly
+ */
+static const int LeafSize = 8;
+
+static const float AxisWeights[3] = {Color::DistanceWeightHue, Color::DistanceWeightSaturation,
+									 Color::DistanceWeightBrightness};
+
+void ClosestColorTree::build(const glm::vec4 *colors, int amount) {
+	_nodes.clear();
+	_nodes.reserve(amount);
+	for (int i = 0; i < amount; ++i) {
+		Node node;
+		Color::getHSB(colors[i], node.hsb.x, node.hsb.y, node.hsb.z);
+		node.index = i;
+		node.axis = 0;
+		_nodes.push_back(node);
+	}
+	build(0, amount);
+}
+
+void ClosestColorTree::clear() {
+	_nodes.clear();
+}
+
+void ClosestColorTree::build(int begin, int end) {
+	if (end - begin <= LeafSize) {
+		return;
+	}
+	glm::vec3 mins = _nodes[begin].hsb;
+	glm::vec3 maxs = mins;
+	for (int i = begin + 1; i < end; ++i) {
+		mins = glm::min(mins, _nodes[i].hsb);
+		maxs = glm::max(maxs, _nodes[i].hsb);
+	}
+	int axis = 0;
+	float maxSpread = -1.0f;
+	for (int i = 0; i < 3; ++i) {
+		const float spread = AxisWeights[i] * (maxs[i] - mins[i]) * (maxs[i] - mins[i]);
+		if (spread > maxSpread) {
+			maxSpread = spread;
+			axis = i;
+		}
+	}
+	const int mid = (begin + end) / 2;
+	std::nth_element(_nodes.begin() + begin, _nodes.begin() + mid, _nodes.begin() + end,
+					 [axis](const Node &a, const Node &b) { return a.hsb[axis] < b.hsb[axis]; });
+	_nodes[mid].axis = axis;
+	build(begin, mid);
+	build(mid + 1, end);
+}
+
+void ClosestColorTree::visit(const Node &node, const glm::vec3 &hsb, float &minDistance, int &minIndex) {
+	const float val = Color::getHSBDistance(node.hsb.x, node.hsb.y, node.hsb.z, hsb.x, hsb.y, hsb.z);
+	if (val < minDistance || (val == minDistance && node.index < minIndex)) {
+		minDistance = val;
+		minIndex = node.index;
+	}
+}
+
+void ClosestColorTree::search(int begin, int end, const glm::vec3 &hsb, float &minDistance, int &minIndex) const {
+	if (end - begin <= LeafSize) {
+		for (int i = begin; i < end; ++i) {
+			visit(_nodes[i], hsb, minDistance, minIndex);
+		}
+		return;
+	}
+	const int mid = (begin + end) / 2;
+	const Node &node = _nodes[mid];
+	visit(node, hsb, minDistance, minIndex);
+	const float diff = hsb[node.axis] - node.hsb[node.axis];
+	if (diff < 0.0f) {
+		search(begin, mid, hsb, minDistance, minIndex);
+	} else {
+		search(mid + 1, end, hsb, minDistance, minIndex);
+	}
+	// this is computed like the term of the axis in the distance function - it's never bigger than the distance of
+	// any color on the other side. Equal distances must still be visited as they might have a lower index.
+	const float planeDistance = AxisWeights[node.axis] * (float)glm::pow(diff, 2);
+	if (planeDistance > minDistance) {
+		return;
+	}
+	if (diff < 0.0f) {
+		search(mid + 1, end, hsb, minDistance, minIndex);
+	} else {
+		search(begin, mid, hsb, minDistance, minIndex);
+	}
+}
+
+int ClosestColorTree::closestMatch(const glm::vec4 &color, float *distance) const {
+	if (_nodes.empty()) {
+		return -1;
+	}
+	glm::vec3 hsb;
+	Color::getHSB(color, hsb.x, hsb.y, hsb.z);
+	float minDistance = FLT_MAX;
+	int minIndex = -1;
+	search(0, (int)_nodes.size(), hsb, minDistance, minIndex);
+	if (distance) {
+		*distance = minDistance;
+	}
+	return minIndex;
+}
+
+} // namespace core
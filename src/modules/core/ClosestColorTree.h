@@ -0,0 +1,51 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <vector>
+
+namespace core {
+
+/**
+ * @brief k-d tree over the hue, saturation and brightness of a list of colors to speed up the nearest color search
+ *
+ * The distances are the same as for @c Color::getDistance() and on equal distances the lowest index wins - the
+ * results are exactly those of the linear search in @c Color::getClosestMatch().
+ */
+class ClosestColorTree {
+private:
+	struct Node {
+		glm::vec3 hsb;
+		int index;
+		int axis;
+	};
+	std::vector<Node> _nodes;
+
+	void build(int begin, int end);
+	void search(int begin, int end, const glm::vec3 &hsb, float &minDistance, int &minIndex) const;
+	static void visit(const Node &node, const glm::vec3 &hsb, float &minDistance, int &minIndex);
+
+public:
+	/**
+	 * @param colors Normalized color values [0.0-1.0]
+	 */
+	void build(const glm::vec4 *colors, int amount);
+	void clear();
+
+	/**
+	 * @param color Normalized color value [0.0-1.0]
+	 * @param distance Optional parameter to get the calculated distance for the selected color entry
+	 * @return The index of the closest color or @c -1 if the tree is empty
+	 */
+	int closestMatch(const glm::vec4 &color, float *distance = nullptr) const;
+
+	inline int size() const {
+		return (int)_nodes.size();
+	}
+};
+
+} // namespace core
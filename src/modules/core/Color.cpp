@@ -3,6 +3,7 @@
  */
 
 #include "Color.h"
+#include "core/ColorReduction.h"
 #include "core/Common.h"
 #include "core/GLM.h"
 #include "core/Log.h"
@@ -46,6 +47,25 @@ const glm::vec4 Color::Brown = glm::vec4(107.f, 66, 38, 255) / glm::vec4(Color::
 const glm::vec4 Color::LightBrown = glm::vec4(150.f, 107, 72, 255) / glm::vec4(Color::magnitudef);
 const glm::vec4 Color::DarkBrown = glm::vec4(82.f, 43, 26, 255) / glm::vec4(Color::magnitudef);
 
+int Color::quantize(ColorReductionType type, RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors, core::ThreadPool *threadPool) {
+	if (type == ColorReductionType::Octree) {
+		return quantize(targetBuf, maxTargetBufColors, inputBuf, inputBufColors);
+	}
+	ColorHistogram histogram;
+	buildColorHistogram(inputBuf, inputBufColors, histogram, threadPool);
+	int n;
+	if (type == ColorReductionType::KMeans) {
+		n = quantizeKMeans(targetBuf, maxTargetBufColors, histogram, threadPool);
+	} else {
+		core_assert(type == ColorReductionType::MedianCut);
+		n = quantizeMedianCut(targetBuf, maxTargetBufColors, histogram);
+	}
+	for (size_t i = n; i < maxTargetBufColors; ++i) {
+		targetBuf[i] = RGBA(0xFFFFFFFFU);
+	}
+	return n;
+}
+
 int Color::quantize(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
 	core_assert(glm::isPowerOfTwo(maxTargetBufColors));
 	core_assert(maxTargetBufColors == 256);
@@ -183,21 +203,49 @@ glm::vec4 Color::fromHex(const char *hex) {
 	return fromRGBA(r, g, b, a);
 }
 
+static inline float toLinearRGB(float channel) {
+	if (channel <= 0.04045f) {
+		return channel / 12.92f;
+	}
+	return glm::pow((channel + 0.055f) / 1.055f, 2.4f);
+}
+
+static inline float toLabComponent(float t) {
+	if (t > 216.0f / 24389.0f) {
+		return glm::pow(t, 1.0f / 3.0f);
+	}
+	return (24389.0f / 27.0f * t + 16.0f) / 116.0f;
+}
+
+glm::vec3 Color::toCIELab(const RGBA rgba) {
+	const float r = toLinearRGB(rgba.r / magnitudef);
+	const float g = toLinearRGB(rgba.g / magnitudef);
+	const float b = toLinearRGB(rgba.b / magnitudef);
+	// sRGB to XYZ - normalized by the D65 reference white
+	const float x = toLabComponent((0.4124564f * r + 0.3575761f * g + 0.1804375f * b) / 0.95047f);
+	const float y = toLabComponent(0.2126729f * r + 0.7151522f * g + 0.0721750f * b);
+	const float z = toLabComponent((0.0193339f * r + 0.1191920f * g + 0.9503041f * b) / 1.08883f);
+	return glm::vec3(116.0f * y - 16.0f, 500.0f * (x - y), 200.0f * (y - z));
+}
+
+float Color::getDeltaE(const RGBA color1, const RGBA color2) {
+	return glm::distance(toCIELab(color1), toCIELab(color2));
+}
+
 float Color::getDistance(const glm::vec4 &color, float hue, float saturation, float brightness) {
 	float chue;
 	float csaturation;
 	float cbrightness;
 	core::Color::getHSB(color, chue, csaturation, cbrightness);
+	return getHSBDistance(chue, csaturation, cbrightness, hue, saturation, brightness);
+}
 
-	const float weightHue = 0.8f;
-	const float weightSaturation = 0.1f;
-	const float weightValue = 0.1f;
-
+float Color::getHSBDistance(float chue, float csaturation, float cbrightness, float hue, float saturation, float brightness) {
 	const float dH = chue - hue;
 	const float dS = csaturation - saturation;
 	const float dV = cbrightness - brightness;
-	const float val = weightHue * (float)glm::pow(dH, 2) + weightValue * (float)glm::pow(dV, 2) +
-					  weightSaturation * (float)glm::pow(dS, 2);
+	const float val = DistanceWeightHue * (float)glm::pow(dH, 2) + DistanceWeightBrightness * (float)glm::pow(dV, 2) +
+					  DistanceWeightSaturation * (float)glm::pow(dS, 2);
 	return val;
 }
 
@@ -12,6 +12,9 @@
 
 namespace core {
 
+class ThreadPool;
+enum class ColorReductionType : uint8_t;
+
 class Color {
 public:
 	static const uint32_t magnitude = 255;
@@ -46,8 +49,20 @@ public:
 		LightBrown,
 		DarkBrown;
 
+	/**
+	 * @brief The weights of the hue, saturation and brightness differences in the color distance
+	 */
+	static constexpr float DistanceWeightHue = 0.8f;
+	static constexpr float DistanceWeightSaturation = 0.1f;
+	static constexpr float DistanceWeightBrightness = 0.1f;
+
 	static float getDistance(RGBA rgba, RGBA rgba2);
 	static float getDistance(const glm::vec4& color, float hue, float saturation, float brightness);
+	/**
+	 * @brief The weighted distance of two colors given as hue, saturation and brightness
+	 * @sa getHSB()
+	 */
+	static float getHSBDistance(float chue, float csaturation, float cbrightness, float hue, float saturation, float brightness);
 	static float getDistance(RGBA color, float hue, float saturation, float brightness);
 
 	/**
@@ -84,7 +99,25 @@ public:
 
 	static core::String print(RGBA rgba);
 
+	/**
+	 * @brief Reduces the input colors to at most @c maxTargetBufColors colors with the octree algorithm
+	 * @return The amount of colors that were put into the target buffer - the remaining entries are set to white
+	 */
 	static int quantize(RGBA* targetBuf, size_t maxTargetBufColors, const RGBA* inputBuf, size_t inputBufColors);
+	/**
+	 * @param threadPool Optional pool that is used to split the work for large inputs
+	 * @sa ColorReductionType
+	 */
+	static int quantize(ColorReductionType type, RGBA* targetBuf, size_t maxTargetBufColors, const RGBA* inputBuf, size_t inputBufColors, core::ThreadPool *threadPool = nullptr);
+
+	/**
+	 * @return The color in the CIE L*a*b* color space (D65 white point)
+	 */
+	static glm::vec3 toCIELab(const RGBA rgba);
+	/**
+	 * @return The CIE76 color difference - a value of about @c 2.3 is the just noticeable difference
+	 */
+	static float getDeltaE(const RGBA color1, const RGBA color2);
 
 	static glm::vec4 fromRGBA(const RGBA rgba);
 	static glm::vec4 fromRGBA(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255);
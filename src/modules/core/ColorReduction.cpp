@@ -0,0 +1,413 @@
+/**
+ * @file
+ */
+
+#include "ColorReduction.h"
+#include "core/ArrayLength.h"
+#include "core/Assert.h"
+#include "core/Color.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+#include "core/concurrent/ParallelFor.h"
+#include <glm/vec3.hpp>
+#include <glm/geometric.hpp>
+#include <SDL_stdinc.h>
+#include <algorithm>
+#include <float.h>
+
+namespace core {
+
+static const char *ColorReductionTypeStr[] = {"Octree", "MedianCut", "KMeans"};
+static_assert(lengthof(ColorReductionTypeStr) == (int)ColorReductionType::Max, "Array sizes don't match");
+
+/**
+ * @brief The amount of input colors that are sorted in one go while building the histogram
+ */
+static const size_t HistogramChunkSize = 65536;
+/**
+ * @brief The amount of histogram bins that one thread processes in one go
+ */
+static const int BinChunkSize = 4096;
+static const int KMeansMaxIterations = 10;
+
+ColorReductionType toColorReductionType(const char *str) {
+	for (int i = 0; i < lengthof(ColorReductionTypeStr); ++i) {
+		if (SDL_strcasecmp(str, ColorReductionTypeStr[i]) == 0) {
+			return (ColorReductionType)i;
+		}
+	}
+	return ColorReductionType::Max;
+}
+
+const char *toColorReductionTypeString(ColorReductionType type) {
+	if (type >= ColorReductionType::Max) {
+		return "";
+	}
+	return ColorReductionTypeStr[(int)type];
+}
+
+/**
+ * @brief Sorts the given opaque colors and merges equal neighbours into one bin
+ */
+static void countSorted(uint32_t *colors, size_t n, ColorHistogram &histogram) {
+	std::sort(colors, colors + n);
+	histogram.reserve(histogram.size() + n);
+	for (size_t i = 0; i < n; ++i) {
+		if (!histogram.empty() && histogram.back().color == colors[i]) {
+			++histogram.back().count;
+			continue;
+		}
+		histogram.push_back(ColorBin{RGBA(colors[i]), 1u});
+	}
+}
+
+void buildColorHistogram(const RGBA *inputBuf, size_t inputBufColors, ColorHistogram &histogram,
+						 ThreadPool *threadPool) {
+	core_trace_scoped(BuildColorHistogram);
+	histogram.clear();
+	const RGBA alphaMask(0, 0, 0, 0xFF);
+	core::DynamicArray<uint32_t> colors;
+	colors.resize(inputBufColors);
+	for (size_t i = 0; i < inputBufColors; ++i) {
+		colors[i] = inputBuf[i].rgba | alphaMask.rgba;
+	}
+	const int chunks = (int)((inputBufColors + HistogramChunkSize - 1) / HistogramChunkSize);
+	if (chunks <= 1) {
+		countSorted(colors.data(), inputBufColors, histogram);
+		return;
+	}
+	core::DynamicArray<ColorHistogram> chunkHistograms;
+	chunkHistograms.resize(chunks);
+	core::parallelFor(threadPool, chunks, [&] (int chunk) {
+		const size_t begin = (size_t)chunk * HistogramChunkSize;
+		const size_t n = core_min(HistogramChunkSize, inputBufColors - begin);
+		countSorted(colors.data() + begin, n, chunkHistograms[chunk]);
+	});
+
+	// the chunk histograms are usually a lot smaller than the input - merge them in one go
+	ColorHistogram merged;
+	size_t mergedSize = 0u;
+	for (const ColorHistogram &chunkHistogram : chunkHistograms) {
+		mergedSize += chunkHistogram.size();
+	}
+	merged.reserve(mergedSize);
+	histogram.reserve(mergedSize);
+	for (const ColorHistogram &chunkHistogram : chunkHistograms) {
+		merged.append(chunkHistogram.data(), chunkHistogram.size());
+	}
+	std::sort(merged.data(), merged.data() + merged.size(), [] (const ColorBin &a, const ColorBin &b) {
+		return a.color.rgba < b.color.rgba;
+	});
+	for (const ColorBin &bin : merged) {
+		if (!histogram.empty() && histogram.back().color == bin.color) {
+			histogram.back().count += bin.count;
+			continue;
+		}
+		histogram.push_back(bin);
+	}
+}
+
+static inline glm::vec3 toVec3(RGBA color) {
+	return glm::vec3(color.r, color.g, color.b);
+}
+
+static inline RGBA toRGBA(const glm::dvec3 &sum, double count) {
+	const glm::dvec3 mean = sum / count + 0.5;
+	return RGBA((uint8_t)core_min(mean.x, 255.0), (uint8_t)core_min(mean.y, 255.0), (uint8_t)core_min(mean.z, 255.0));
+}
+
+/**
+ * @brief Fills the target buffer with the bins if there are not more of them than requested colors
+ */
+static int copyHistogram(RGBA *targetBuf, size_t maxTargetBufColors, const ColorHistogram &histogram) {
+	if (histogram.size() > maxTargetBufColors) {
+		return -1;
+	}
+	for (size_t i = 0; i < histogram.size(); ++i) {
+		targetBuf[i] = histogram[i].color;
+	}
+	return (int)histogram.size();
+}
+
+namespace {
+
+/**
+ * @brief A range of histogram bins
+ */
+struct ColorBox {
+	int begin;
+	int end;
+	double count;
+	glm::dvec3 sum;
+	/**
+	 * @brief The weighted sum of the squared distances to the mean color
+	 */
+	double error;
+	/**
+	 * @brief The channel with the largest variance
+	 */
+	int axis;
+};
+
+} // namespace
+
+static ColorBox createColorBox(const ColorBin *bins, int begin, int end) {
+	ColorBox box;
+	box.begin = begin;
+	box.end = end;
+	box.count = 0.0;
+	box.sum = glm::dvec3(0.0);
+	glm::dvec3 squares(0.0);
+	for (int i = begin; i < end; ++i) {
+		const double w = bins[i].count;
+		const glm::dvec3 c = toVec3(bins[i].color);
+		box.count += w;
+		box.sum += w * c;
+		squares += w * c * c;
+	}
+	const glm::dvec3 variance = squares - box.sum * box.sum / box.count;
+	box.error = variance.x + variance.y + variance.z;
+	box.axis = 0;
+	if (variance.y > variance[box.axis]) {
+		box.axis = 1;
+	}
+	if (variance.z > variance[box.axis]) {
+		box.axis = 2;
+	}
+	return box;
+}
+
+int quantizeMedianCut(RGBA *targetBuf, size_t maxTargetBufColors, const ColorHistogram &histogram) {
+	core_trace_scoped(QuantizeMedianCut);
+	const int n = copyHistogram(targetBuf, maxTargetBufColors, histogram);
+	if (n >= 0) {
+		return n;
+	}
+	ColorHistogram bins(histogram);
+	core::DynamicArray<ColorBox> boxes;
+	boxes.reserve(maxTargetBufColors);
+	boxes.push_back(createColorBox(bins.data(), 0, (int)bins.size()));
+	while (boxes.size() < maxTargetBufColors) {
+		size_t boxIndex = 0;
+		for (size_t i = 1; i < boxes.size(); ++i) {
+			if (boxes[i].error > boxes[boxIndex].error) {
+				boxIndex = i;
+			}
+		}
+		const ColorBox box = boxes[boxIndex];
+		if (box.error <= 0.0 || box.end - box.begin < 2) {
+			break;
+		}
+		const int axis = box.axis;
+		std::sort(bins.data() + box.begin, bins.data() + box.end, [axis] (const ColorBin &a, const ColorBin &b) {
+			return toVec3(a.color)[axis] < toVec3(b.color)[axis];
+		});
+		// split at the weighted median - but keep at least one bin on each side
+		const double half = box.count / 2.0;
+		double count = 0.0;
+		int split = box.begin + 1;
+		for (int i = box.begin; i < box.end - 1; ++i) {
+			count += bins[i].count;
+			split = i + 1;
+			if (count >= half) {
+				break;
+			}
+		}
+		boxes[boxIndex] = createColorBox(bins.data(), box.begin, split);
+		boxes.push_back(createColorBox(bins.data(), split, box.end));
+	}
+	for (size_t i = 0; i < boxes.size(); ++i) {
+		targetBuf[i] = toRGBA(boxes[i].sum, boxes[i].count);
+	}
+	return (int)boxes.size();
+}
+
+static inline float distanceSquared(const glm::vec3 &a, const glm::vec3 &b) {
+	const glm::vec3 d = a - b;
+	return glm::dot(d, d);
+}
+
+namespace {
+
+/**
+ * @brief The centroids sorted by their first component - the search starts at the centroid with the closest first
+ * component and stops in each direction as soon as that component alone is further away than the best match
+ */
+class SortedCentroids {
+private:
+	struct Entry {
+		glm::vec3 pos;
+		int index;
+	};
+	core::DynamicArray<Entry> _entries;
+
+	inline void visit(const Entry &entry, const glm::vec3 &color, float &minDistance, int &minIndex) const {
+		const float distance = distanceSquared(color, entry.pos);
+		if (distance < minDistance || (distance == minDistance && entry.index < minIndex)) {
+			minDistance = distance;
+			minIndex = entry.index;
+		}
+	}
+
+public:
+	void build(const glm::vec3 *centroids, int centroidCount) {
+		_entries.resize(centroidCount);
+		for (int i = 0; i < centroidCount; ++i) {
+			_entries[i] = Entry{centroids[i], i};
+		}
+		std::sort(_entries.data(), _entries.data() + _entries.size(), [] (const Entry &a, const Entry &b) {
+			return a.pos.x < b.pos.x;
+		});
+	}
+
+	int closest(const glm::vec3 &color) const {
+		const int n = (int)_entries.size();
+		const Entry *start = std::lower_bound(_entries.data(), _entries.data() + n, color.x, [] (const Entry &e, float x) {
+			return e.pos.x < x;
+		});
+		const int mid = (int)(start - _entries.data());
+		float minDistance = FLT_MAX;
+		int minIndex = 0;
+		for (int i = mid; i < n; ++i) {
+			const float dx = _entries[i].pos.x - color.x;
+			if (dx * dx > minDistance) {
+				break;
+			}
+			visit(_entries[i], color, minDistance, minIndex);
+		}
+		for (int i = mid - 1; i >= 0; --i) {
+			const float dx = color.x - _entries[i].pos.x;
+			if (dx * dx > minDistance) {
+				break;
+			}
+			visit(_entries[i], color, minDistance, minIndex);
+		}
+		return minIndex;
+	}
+};
+
+} // namespace
+
+int quantizeKMeans(RGBA *targetBuf, size_t maxTargetBufColors, const ColorHistogram &histogram,
+				   ThreadPool *threadPool) {
+	core_trace_scoped(QuantizeKMeans);
+	const int n = copyHistogram(targetBuf, maxTargetBufColors, histogram);
+	if (n >= 0) {
+		return n;
+	}
+	// the median cut boxes are the initial clusters
+	core::DynamicArray<RGBA> seeds;
+	seeds.resize(maxTargetBufColors);
+	const int k = quantizeMedianCut(seeds.data(), maxTargetBufColors, histogram);
+	core::DynamicArray<glm::dvec3> centroids;
+	centroids.resize(k);
+	core::DynamicArray<glm::vec3> centroidLabs;
+	centroidLabs.resize(k);
+	for (int c = 0; c < k; ++c) {
+		centroids[c] = toVec3(seeds[c]);
+	}
+
+	// the colors are assigned by their perceptual distance to the clusters - but the clusters are averaged in rgb
+	const int bins = (int)histogram.size();
+	const int chunks = (bins + BinChunkSize - 1) / BinChunkSize;
+	core::DynamicArray<glm::vec3> labs;
+	labs.resize(bins);
+	core::parallelFor(threadPool, chunks, [&] (int chunk) {
+		const int end = core_min((chunk + 1) * BinChunkSize, bins);
+		for (int i = chunk * BinChunkSize; i < end; ++i) {
+			labs[i] = Color::toCIELab(histogram[i].color);
+		}
+	});
+	core::DynamicArray<int> assignment;
+	assignment.resize(bins);
+	core::DynamicArray<int> closest;
+	closest.resize(bins);
+	for (int i = 0; i < bins; ++i) {
+		assignment[i] = -1;
+	}
+	core::DynamicArray<glm::dvec3> sums;
+	sums.resize(k);
+	core::DynamicArray<double> counts;
+	counts.resize(k);
+
+	SortedCentroids sortedCentroids;
+	for (int iteration = 0; iteration < KMeansMaxIterations; ++iteration) {
+		for (int c = 0; c < k; ++c) {
+			centroidLabs[c] = Color::toCIELab(toRGBA(centroids[c], 1.0));
+		}
+		sortedCentroids.build(centroidLabs.data(), k);
+		core::parallelFor(threadPool, chunks, [&] (int chunk) {
+			const int end = core_min((chunk + 1) * BinChunkSize, bins);
+			for (int i = chunk * BinChunkSize; i < end; ++i) {
+				closest[i] = sortedCentroids.closest(labs[i]);
+			}
+		});
+		int changed = 0;
+		for (int c = 0; c < k; ++c) {
+			sums[c] = glm::dvec3(0.0);
+			counts[c] = 0.0;
+		}
+		for (int i = 0; i < bins; ++i) {
+			const int c = closest[i];
+			if (assignment[i] != c) {
+				assignment[i] = c;
+				++changed;
+			}
+			const double w = histogram[i].count;
+			sums[c] += w * glm::dvec3(toVec3(histogram[i].color));
+			counts[c] += w;
+		}
+		for (int c = 0; c < k; ++c) {
+			// empty clusters keep their position
+			if (counts[c] > 0.0) {
+				centroids[c] = sums[c] / counts[c];
+			}
+		}
+		if (changed == 0) {
+			break;
+		}
+	}
+	for (int c = 0; c < k; ++c) {
+		targetBuf[c] = toRGBA(centroids[c], 1.0);
+	}
+	return k;
+}
+
+float meanDeltaE(const ColorHistogram &histogram, const RGBA *palette, size_t paletteColors, ThreadPool *threadPool) {
+	core_trace_scoped(MeanDeltaE);
+	if (histogram.empty() || paletteColors == 0u) {
+		return 0.0f;
+	}
+	core::DynamicArray<glm::vec3> labs;
+	labs.resize(paletteColors);
+	for (size_t i = 0; i < paletteColors; ++i) {
+		labs[i] = Color::toCIELab(palette[i]);
+	}
+	SortedCentroids sortedCentroids;
+	sortedCentroids.build(labs.data(), (int)paletteColors);
+	const int bins = (int)histogram.size();
+	const int chunks = (bins + BinChunkSize - 1) / BinChunkSize;
+	core::DynamicArray<double> errors;
+	errors.resize(chunks);
+	core::parallelFor(threadPool, chunks, [&] (int chunk) {
+		const int end = core_min((chunk + 1) * BinChunkSize, bins);
+		double error = 0.0;
+		for (int i = chunk * BinChunkSize; i < end; ++i) {
+			const glm::vec3 lab = Color::toCIELab(histogram[i].color);
+			const int closestIndex = sortedCentroids.closest(lab);
+			error += (double)histogram[i].count * glm::distance(lab, labs[closestIndex]);
+		}
+		errors[chunk] = error;
+	});
+	double error = 0.0;
+	double count = 0.0;
+	for (const double e : errors) {
+		error += e;
+	}
+	for (const ColorBin &bin : histogram) {
+		count += bin.count;
+	}
+	return (float)(error / count);
+}
+
+} // namespace core
@@ -0,0 +1,79 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/RGBA.h"
+#include "core/collection/DynamicArray.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core {
+
+class ThreadPool;
+
+/**
+ * @brief The algorithms that are available for @c Color::quantize()
+ */
+enum class ColorReductionType : uint8_t {
+	/**
+	 * @brief Averages the colors of a fixed 8x8x8 grid
+	 */
+	Octree,
+	/**
+	 * @brief Splits the color boxes with the largest error at the weighted median of their widest channel
+	 */
+	MedianCut,
+	/**
+	 * @brief Lloyd iterations that refine the clusters of the median cut by the perceptual color distance
+	 */
+	KMeans,
+
+	Max
+};
+
+/**
+ * @return The type for the given name (case insensitive) or @c ColorReductionType::Max if the name is unknown
+ */
+ColorReductionType toColorReductionType(const char *str);
+const char *toColorReductionTypeString(ColorReductionType type);
+
+/**
+ * @brief A color and the amount of input colors that are equal to it
+ */
+struct ColorBin {
+	RGBA color;
+	uint32_t count;
+};
+
+using ColorHistogram = core::DynamicArray<ColorBin>;
+
+/**
+ * @brief Counts the distinct colors of the input - the alpha channel is ignored
+ * @note The bins are sorted by color. Large inputs are split into chunks that are sorted concurrently if a thread
+ * pool is given.
+ */
+void buildColorHistogram(const RGBA *inputBuf, size_t inputBufColors, ColorHistogram &histogram,
+						 ThreadPool *threadPool = nullptr);
+
+/**
+ * @return The amount of colors that were put into the target buffer
+ */
+int quantizeMedianCut(RGBA *targetBuf, size_t maxTargetBufColors, const ColorHistogram &histogram);
+/**
+ * @note The clusters are seeded with the result of @c quantizeMedianCut() - equal input produces equal palettes
+ * @return The amount of colors that were put into the target buffer
+ */
+int quantizeKMeans(RGBA *targetBuf, size_t maxTargetBufColors, const ColorHistogram &histogram,
+				   ThreadPool *threadPool = nullptr);
+
+/**
+ * @brief Error metric for the color reduction: the mean CIE76 color difference between the input colors and their
+ * closest palette colors
+ * @sa Color::getDeltaE()
+ */
+float meanDeltaE(const ColorHistogram &histogram, const RGBA *palette, size_t paletteColors,
+				 ThreadPool *threadPool = nullptr);
+
+} // namespace core
@@ -46,6 +46,8 @@ constexpr const char *ClientShadowMap = "cl_shadowmap";
 constexpr const char *ClientBloom = "cl_bloom";
 constexpr const char *ClientWater = "cl_water";
 constexpr const char *ClientFog = "cl_fog";
+// The distance of the first level of detail band for the world meshes - every following band is twice as far away
+constexpr const char *ClientLODDistance = "cl_loddistance";
 constexpr const char *ClientCameraMaxTargetDistance = "cl_cameramaxtargetdistance";
 constexpr const char *ClientCameraZoomSpeed = "cl_camzoomspeed";
 constexpr const char *ClientCameraMinZoom = "cl_camminzoom";
@@ -64,6 +66,10 @@ constexpr const char *ServerPort = "sv_port";
 constexpr const char *ServerMaxClients = "sv_maxclients";
 constexpr const char *ServerPostgresLib = "sv_postgreslib";
 constexpr const char *ServerHttpPort = "sv_httpport";
+// compress the chunks of the paged volume that weren't used recently
+constexpr const char *ServerCompressChunks = "sv_compresschunks";
+// the interval in millis in which modified chunks are persisted
+constexpr const char *ServerChunkWriteBackInterval = "sv_chunkwritebackinterval";
 // the download urls for the chunks
 constexpr const char *ServerChunkBaseUrl = "sv_httpchunkurl";
 
@@ -73,9 +79,13 @@ constexpr const char *CoreMaxFPS = "core_maxfps";
 constexpr const char *CoreLogLevel = "core_loglevel";
 constexpr const char *CoreSysLog = "core_syslog";
 constexpr const char *CorePath = "core_path";
+// the algorithm that is used to reduce the colors of images or imported formats to a palette
+constexpr const char *CoreColorReduction = "core_colorreduction";
 
 // The size of the chunk that is extracted with each step
 constexpr const char *VoxelMeshSize = "voxel_meshsize";
+// Use the binary greedy mesher for the extraction of the chunks
+constexpr const char *VoxelMeshBinaryGreedy = "voxel_meshbinarygreedy";
 
 constexpr const char *DatabaseName = "db_name";
 constexpr const char *DatabaseHost = "db_host";
@@ -109,6 +109,13 @@ public:
 		release();
 	}
 
+	/**
+	 * @return The amount of @c SharedPtr instances that are sharing the pointer
+	 */
+	int useCount() const {
+		return count();
+	}
+
 	core::AtomicInt* refCnt() const {
 		return _refCnt;
 	}
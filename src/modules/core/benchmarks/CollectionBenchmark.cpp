@@ -1,4 +1,5 @@
 #include "app/benchmark/AbstractBenchmark.h"
+#include "core/collection/HashMap.h"
 #include "core/collection/Map.h"
 #include "core/Assert.h"
 #include <unordered_map>
@@ -53,8 +54,83 @@ BENCHMARK_DEFINE_F(MapBenchmark, compareToMapCore) (benchmark::State& state) {
 	}
 }
 
+BENCHMARK_DEFINE_F(MapBenchmark, compareToHashMapCore) (benchmark::State& state) {
+	core::HashMap<int64_t, int64_t, std::hash<int64_t>> map;
+	for (auto _ : state) {
+		const int64_t n = state.range(0);
+		for (int64_t i = 0; i < n; ++i) {
+			map.put(i, i);
+			int64_t value;
+			const bool found = map.get(i, value);
+			if (!found || value != i) {
+				state.SkipWithError("Failed!");
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Fills a new map with the amount of entries given as argument and looks all of them up again
+ * @param maxSize Only used for @c core::Map - the other maps have to grow
+ */
+template<class MAP>
+static void fillAndLookup(benchmark::State& state, int maxSize = 0) {
+	const int64_t n = state.range(0);
+	// spread the keys to not only hit consecutive buckets
+	const int64_t stride = 2654435761;
+	for (auto _ : state) {
+		MAP map(maxSize);
+		for (int64_t i = 0; i < n; ++i) {
+			map.put(i * stride, i);
+		}
+		for (int64_t i = 0; i < n; ++i) {
+			int64_t value;
+			if (!map.get(i * stride, value) || value != i) {
+				state.SkipWithError("Failed!");
+				break;
+			}
+		}
+		benchmark::DoNotOptimize(map);
+	}
+	state.SetItemsProcessed(state.iterations() * n);
+}
+
+struct StdUnorderedMap : public std::unordered_map<int64_t, int64_t> {
+	StdUnorderedMap(int) {
+	}
+	inline void put(int64_t key, int64_t value) {
+		(*this)[key] = value;
+	}
+	inline bool get(int64_t key, int64_t &value) const {
+		auto iter = this->find(key);
+		if (iter == this->end()) {
+			return false;
+		}
+		value = iter->second;
+		return true;
+	}
+};
+
+BENCHMARK_DEFINE_F(MapBenchmark, fillHashMapCore) (benchmark::State& state) {
+	fillAndLookup<core::HashMap<int64_t, int64_t, std::hash<int64_t>>>(state);
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, fillMapCore) (benchmark::State& state) {
+	fillAndLookup<core::Map<int64_t, int64_t, 4096, std::hash<int64_t>>>(state, (int)state.range(0));
+}
+
+BENCHMARK_DEFINE_F(MapBenchmark, fillUnorderedMapStd) (benchmark::State& state) {
+	fillAndLookup<StdUnorderedMap>(state);
+}
+
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapCore)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapStd)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToUnorderedMapStd)->RangeMultiplier(2)->Range(8, 512);
+BENCHMARK_REGISTER_F(MapBenchmark, compareToHashMapCore)->RangeMultiplier(2)->Range(8, 512);
+// core::Map has a fixed bucket count and degrades to long lists with a lot of entries - compare up to 1M only
+BENCHMARK_REGISTER_F(MapBenchmark, fillMapCore)->RangeMultiplier(10)->Range(1000, 1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(MapBenchmark, fillHashMapCore)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(MapBenchmark, fillUnorderedMapStd)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,79 @@
+/**
+ * @file
+ */
+
+#include "app/App.h"
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/ArrayLength.h"
+#include "core/Color.h"
+#include "core/ColorReduction.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/ThreadPool.h"
+
+class ColorReductionBenchmark : public app::AbstractBenchmark {
+protected:
+	static constexpr int Width = 1024;
+	static constexpr int Height = 1024;
+	core::DynamicArray<core::RGBA> _colors;
+	core::ColorHistogram _histogram;
+
+	bool onInitApp() override {
+		// smooth gradients with some noise - a lot of different colors like in a photo or a textured mesh
+		_colors.reserve((size_t)Width * Height);
+		uint32_t seed = 1u;
+		for (int y = 0; y < Height; ++y) {
+			for (int x = 0; x < Width; ++x) {
+				seed = seed * 1664525u + 1013904223u;
+				const int noise = (int)(seed >> 28u);
+				const uint8_t r = (uint8_t)((x * 255 / Width + noise) & 0xff);
+				const uint8_t g = (uint8_t)((y * 255 / Height + noise) & 0xff);
+				const uint8_t b = (uint8_t)(((x + y) * 127 / Height) & 0xff);
+				_colors.push_back(core::RGBA(r, g, b));
+			}
+		}
+		core::buildColorHistogram(_colors.data(), _colors.size(), _histogram);
+		return true;
+	}
+
+	void onCleanupApp() override {
+		_colors.release();
+		_histogram.release();
+	}
+};
+
+/**
+ * @brief Reduces the colors with the algorithm given as argument and reports the mean delta E of the result
+ * @sa core::ColorReductionType
+ */
+BENCHMARK_DEFINE_F(ColorReductionBenchmark, Quantize)(benchmark::State &state) {
+	const core::ColorReductionType type = (core::ColorReductionType)state.range(0);
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	core::RGBA targetBuf[256];
+	int n = 0;
+	for (auto _ : state) {
+		n = core::Color::quantize(type, targetBuf, lengthof(targetBuf), _colors.data(), _colors.size(), &threadPool);
+		benchmark::DoNotOptimize(targetBuf);
+	}
+	state.SetLabel(core::toColorReductionTypeString(type));
+	state.SetItemsProcessed((int64_t)state.iterations() * Width * Height);
+	state.counters["colors"] = n;
+	state.counters["deltaE"] = core::meanDeltaE(_histogram, targetBuf, n, &threadPool);
+}
+
+BENCHMARK_DEFINE_F(ColorReductionBenchmark, Histogram)(benchmark::State &state) {
+	core::ThreadPool *threadPool = state.range(0) ? &app::App::getInstance()->threadPool() : nullptr;
+	core::ColorHistogram histogram;
+	for (auto _ : state) {
+		core::buildColorHistogram(_colors.data(), _colors.size(), histogram, threadPool);
+		benchmark::DoNotOptimize(histogram.data());
+	}
+	state.SetItemsProcessed((int64_t)state.iterations() * Width * Height);
+	state.counters["bins"] = (double)histogram.size();
+}
+
+BENCHMARK_REGISTER_F(ColorReductionBenchmark, Quantize)
+	->Arg((int)core::ColorReductionType::Octree)
+	->Arg((int)core::ColorReductionType::MedianCut)
+	->Arg((int)core::ColorReductionType::KMeans)
+	->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ColorReductionBenchmark, Histogram)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
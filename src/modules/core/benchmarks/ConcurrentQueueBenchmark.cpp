@@ -0,0 +1,53 @@
+/**
+ * @file
+ */
+
+#include <benchmark/benchmark.h>
+#include "core/collection/ConcurrentQueue.h"
+#include "core/collection/LockFreeQueue.h"
+
+template<class QUEUE>
+static inline void push(QUEUE &queue, int value) {
+	queue.push(value);
+}
+
+static inline void push(core::BoundedLockFreeQueue<int> &queue, int value) {
+	while (!queue.push(value)) {
+	}
+}
+
+/**
+ * @brief Every thread pushes an entry and pops one again - all threads share the same queue
+ *
+ * This is the worst case for the contention on the queue, there is no work between the queue operations.
+ */
+template<class QUEUE>
+static void pushPop(benchmark::State &state, QUEUE &queue) {
+	int value = 0;
+	for (auto _ : state) {
+		push(queue, value);
+		while (!queue.pop(value)) {
+		}
+		benchmark::DoNotOptimize(value);
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+static void concurrentQueue(benchmark::State &state) {
+	static core::ConcurrentQueue<int> queue;
+	pushPop(state, queue);
+}
+
+static void boundedLockFreeQueue(benchmark::State &state) {
+	static core::BoundedLockFreeQueue<int> queue(1024);
+	pushPop(state, queue);
+}
+
+static void lockFreeQueue(benchmark::State &state) {
+	static core::LockFreeQueue<int> queue;
+	pushPop(state, queue);
+}
+
+BENCHMARK(concurrentQueue)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK(boundedLockFreeQueue)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK(lockFreeQueue)->ThreadRange(1, 32)->UseRealTime();
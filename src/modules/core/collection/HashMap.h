@@ -0,0 +1,391 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/Map.h"
+#include "core/Assert.h"
+#include "core/StandardLib.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <initializer_list>
+
+namespace core {
+
+/**
+ * @brief Hash map with open addressing that grows with the amount of entries
+ *
+ * The entries are stored in one power of two sized array and the collisions are resolved by linear probing with
+ * Robin Hood hashing - an entry that is further away from its home slot takes the slot of an entry that is closer
+ * to its own one. This keeps the probe sequences short even for high load factors. There is no allocation per entry.
+ *
+ * The interface is the same as for @c core::Map - but the pointers to the entries and the iterators are invalidated
+ * if an entry is added or removed.
+ *
+ * @note The hash values are scrambled with fibonacci hashing - hashers that just return the value are fine.
+ *
+ * @ingroup Collections
+ */
+template<typename KEYTYPE, typename VALUETYPE, typename HASHER = priv::DefaultHasher, typename COMPARE = priv::EqualCompare>
+class HashMap {
+public:
+	using value_type = VALUETYPE;
+	using key_type = KEYTYPE;
+
+	struct KeyValue {
+		inline KeyValue(const KEYTYPE& _key, const VALUETYPE& _value) :
+				key(_key), value(_value), first(key), second(value) {
+		}
+
+		inline KeyValue(const KEYTYPE& _key, VALUETYPE&& _value) :
+				key(_key), value(core::forward<VALUETYPE>(_value)), first(key), second(value) {
+		}
+
+		inline KeyValue(KeyValue &&other) noexcept :
+				key(core::move(other.key)), value(core::move(other.value)), first(key), second(value) {
+		}
+
+		KEYTYPE key;
+		VALUETYPE value;
+		const KEYTYPE &first;
+		const VALUETYPE &second;
+	};
+
+private:
+	static constexpr uint64_t FibonacciMultiplier = 11400714819323198485llu;
+	static constexpr size_t MinCapacity = 8u;
+
+	KeyValue *_entries = nullptr;
+	/**
+	 * @brief The distance of the entry to its home slot plus one - @c 0 marks an empty slot
+	 */
+	uint32_t *_distances = nullptr;
+	size_t _capacity = 0u;
+	size_t _size = 0u;
+	int _shift = 0;
+	HASHER _hasher;
+
+	inline size_t homeSlot(const KEYTYPE& key) const {
+		return (size_t)(((uint64_t)_hasher(key) * FibonacciMultiplier) >> _shift);
+	}
+
+	/**
+	 * @brief The max amount of entries before the map grows - the load factor is 0.75
+	 */
+	static inline size_t maxEntries(size_t capacity) {
+		return capacity - capacity / 4u;
+	}
+
+	size_t findSlot(const KEYTYPE& key) const {
+		if (_size == 0u) {
+			return _capacity;
+		}
+		const size_t mask = _capacity - 1u;
+		size_t slot = homeSlot(key);
+		for (uint32_t distance = 1u;; ++distance) {
+			// the entry would have taken this slot if it existed
+			if (_distances[slot] < distance) {
+				return _capacity;
+			}
+			if (COMPARE()(_entries[slot].key, key)) {
+				return slot;
+			}
+			slot = (slot + 1u) & mask;
+		}
+	}
+
+	/**
+	 * @brief Moves the given entry into the map - the key must not exist yet and the capacity must be big enough
+	 */
+	void insertNew(KeyValue &&entry) {
+		const size_t mask = _capacity - 1u;
+		size_t slot = homeSlot(entry.key);
+		uint32_t distance = 1u;
+		KeyValue carry(core::move(entry));
+		for (;;) {
+			if (_distances[slot] == 0u) {
+				new ((void *)&_entries[slot]) KeyValue(core::move(carry));
+				_distances[slot] = distance;
+				++_size;
+				return;
+			}
+			if (_distances[slot] < distance) {
+				// take the slot from the entry that is closer to its home slot and continue with that one
+				KeyValue tmp(core::move(_entries[slot]));
+				_entries[slot].~KeyValue();
+				new ((void *)&_entries[slot]) KeyValue(core::move(carry));
+				carry.~KeyValue();
+				new ((void *)&carry) KeyValue(core::move(tmp));
+				const uint32_t d = _distances[slot];
+				_distances[slot] = distance;
+				distance = d;
+			}
+			slot = (slot + 1u) & mask;
+			++distance;
+		}
+	}
+
+	void rehash(size_t capacity) {
+		core_assert(capacity >= MinCapacity && (capacity & (capacity - 1u)) == 0u);
+		KeyValue *oldEntries = _entries;
+		uint32_t *oldDistances = _distances;
+		const size_t oldCapacity = _capacity;
+		_entries = (KeyValue *)core_malloc(capacity * sizeof(KeyValue));
+		_distances = (uint32_t *)core_malloc(capacity * sizeof(uint32_t));
+		core_memset(_distances, 0, capacity * sizeof(uint32_t));
+		_capacity = capacity;
+		_shift = 64;
+		for (size_t c = capacity; c > 1u; c >>= 1u) {
+			--_shift;
+		}
+		_size = 0u;
+		for (size_t i = 0u; i < oldCapacity; ++i) {
+			if (oldDistances[i] != 0u) {
+				insertNew(core::move(oldEntries[i]));
+				oldEntries[i].~KeyValue();
+			}
+		}
+		core_free(oldEntries);
+		core_free(oldDistances);
+	}
+
+	/**
+	 * @brief Makes room for one more entry
+	 */
+	inline void grow() {
+		if (_size + 1u > maxEntries(_capacity)) {
+			rehash(_capacity == 0u ? MinCapacity : _capacity * 2u);
+		}
+	}
+
+	void release() {
+		clear();
+		core_free(_entries);
+		core_free(_distances);
+		_entries = nullptr;
+		_distances = nullptr;
+		_capacity = 0u;
+		_shift = 0;
+	}
+
+	void copyFrom(const HashMap& other) {
+		reserve(other.size());
+		for (auto i = other.begin(); i != other.end(); ++i) {
+			put(i->key, i->value);
+		}
+	}
+
+public:
+	HashMap(std::initializer_list<KeyValue> other) {
+		reserve(other.size());
+		for (auto i = other.begin(); i != other.end(); ++i) {
+			put(i->key, i->value);
+		}
+	}
+	/**
+	 * @param initialSize The amount of entries that can be added before the map grows
+	 */
+	HashMap(int initialSize = 0) {
+		if (initialSize > 0) {
+			reserve((size_t)initialSize);
+		}
+	}
+	HashMap(const HashMap& other) {
+		copyFrom(other);
+	}
+	HashMap(HashMap&& other) noexcept :
+			_entries(other._entries), _distances(other._distances), _capacity(other._capacity), _size(other._size),
+			_shift(other._shift), _hasher(other._hasher) {
+		other._entries = nullptr;
+		other._distances = nullptr;
+		other._capacity = 0u;
+		other._size = 0u;
+		other._shift = 0;
+	}
+	~HashMap() {
+		release();
+	}
+	HashMap &operator=(HashMap &&other) noexcept {
+		if (this != &other) {
+			release();
+			_entries = other._entries;
+			_distances = other._distances;
+			_capacity = other._capacity;
+			_size = other._size;
+			_shift = other._shift;
+			_hasher = other._hasher;
+			other._entries = nullptr;
+			other._distances = nullptr;
+			other._capacity = 0u;
+			other._size = 0u;
+			other._shift = 0;
+		}
+		return *this;
+	}
+
+	HashMap& operator=(const HashMap& other) {
+		if (this != &other) {
+			clear();
+			copyFrom(other);
+		}
+		return *this;
+	}
+
+	class iterator {
+	private:
+		const HashMap* _map;
+		size_t _slot;
+
+		inline void skipEmpty() {
+			while (_slot < _map->_capacity && _map->_distances[_slot] == 0u) {
+				++_slot;
+			}
+		}
+	public:
+		constexpr iterator() :
+			_map(nullptr), _slot(0) {
+		}
+
+		iterator(const HashMap* map, size_t slot) :
+				_map(map), _slot(slot) {
+			skipEmpty();
+		}
+
+		inline KeyValue* operator*() const {
+			return &_map->_entries[_slot];
+		}
+
+		iterator& operator++() {
+			++_slot;
+			skipEmpty();
+			return *this;
+		}
+
+		inline KeyValue* operator->() const {
+			return &_map->_entries[_slot];
+		}
+
+		inline bool operator!=(const iterator& rhs) const {
+			return _slot != rhs._slot || _map != rhs._map;
+		}
+
+		inline bool operator==(const iterator& rhs) const {
+			return _slot == rhs._slot && _map == rhs._map;
+		}
+	};
+
+	inline size_t size() const {
+		return _size;
+	}
+
+	inline bool empty() const {
+		return _size == 0u;
+	}
+
+	/**
+	 * @return The amount of slots - the map grows before all of them are used
+	 */
+	inline size_t capacity() const {
+		return _capacity;
+	}
+
+	/**
+	 * @brief Makes sure that the given amount of entries can be added without growing the map
+	 */
+	void reserve(size_t entries) {
+		size_t capacity = _capacity == 0u ? MinCapacity : _capacity;
+		while (maxEntries(capacity) < entries) {
+			capacity *= 2u;
+		}
+		if (capacity != _capacity) {
+			rehash(capacity);
+		}
+	}
+
+	bool get(const KEYTYPE& key, VALUETYPE& value) const {
+		const size_t slot = findSlot(key);
+		if (slot == _capacity) {
+			return false;
+		}
+		value = _entries[slot].value;
+		return true;
+	}
+
+	bool hasKey(const KEYTYPE& key) const {
+		return findSlot(key) != _capacity;
+	}
+
+	iterator find(const KEYTYPE& key) const {
+		return iterator(this, findSlot(key));
+	}
+
+	void emplace(const KEYTYPE& key, VALUETYPE&& value) {
+		const size_t slot = findSlot(key);
+		if (slot != _capacity) {
+			_entries[slot].value = core::forward<VALUETYPE>(value);
+			return;
+		}
+		grow();
+		insertNew(KeyValue(key, core::forward<VALUETYPE>(value)));
+	}
+
+	void put(const KEYTYPE& key, const VALUETYPE& value) {
+		const size_t slot = findSlot(key);
+		if (slot != _capacity) {
+			_entries[slot].value = value;
+			return;
+		}
+		grow();
+		insertNew(KeyValue(key, value));
+	}
+
+	iterator begin() const {
+		return iterator(this, 0u);
+	}
+
+	iterator end() const {
+		return iterator(this, _capacity);
+	}
+
+	/**
+	 * @note Keeps the capacity
+	 */
+	void clear() {
+		for (size_t i = 0u; i < _capacity; ++i) {
+			if (_distances[i] != 0u) {
+				_entries[i].~KeyValue();
+				_distances[i] = 0u;
+			}
+		}
+		_size = 0u;
+	}
+
+	inline void erase(const iterator& iter) {
+		remove(iter->key);
+	}
+
+	bool remove(const KEYTYPE& key) {
+		size_t slot = findSlot(key);
+		if (slot == _capacity) {
+			return false;
+		}
+		const size_t mask = _capacity - 1u;
+		_entries[slot].~KeyValue();
+		// shift the following entries of the probe sequence back by one slot
+		size_t next = (slot + 1u) & mask;
+		while (_distances[next] > 1u) {
+			new ((void *)&_entries[slot]) KeyValue(core::move(_entries[next]));
+			_entries[next].~KeyValue();
+			_distances[slot] = _distances[next] - 1u;
+			slot = next;
+			next = (next + 1u) & mask;
+		}
+		_distances[slot] = 0u;
+		--_size;
+		return true;
+	}
+};
+
+}
@@ -0,0 +1,496 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "core/concurrent/HazardPointer.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/Semaphore.h"
+#include "core/collection/DynamicArray.h"
+#include <atomic>
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core {
+
+namespace priv {
+
+/**
+ * @brief Lets the consumers of the lock-free queues sleep on a semaphore while the queue is empty
+ *
+ * The producers only touch the semaphore if there is a waiting consumer - otherwise pushing costs one fence and the
+ * load of the waiter count.
+ */
+class QueueWaiter {
+private:
+	core::Semaphore _semaphore{0u};
+	std::atomic<int> _waiters{0};
+	std::atomic<bool> _abort{false};
+
+public:
+	/**
+	 * @brief Must be called after an entry was published
+	 */
+	inline void notify() {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (_waiters.load(std::memory_order_relaxed) > 0) {
+			_semaphore.increase();
+		}
+	}
+
+	void abortWait() {
+		_abort.store(true);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int waiters = _waiters.load();
+		for (int i = 0; i < waiters; ++i) {
+			_semaphore.increase();
+		}
+	}
+
+	inline void reset() {
+		_abort.store(false);
+	}
+
+	/**
+	 * @param pop Tries to take an entry from the queue and returns @c true on success
+	 * @return @c false if the wait was aborted
+	 */
+	template<class FUNC>
+	bool wait(FUNC &&pop) {
+		for (;;) {
+			if (_abort.load()) {
+				return false;
+			}
+			if (pop()) {
+				return true;
+			}
+			_waiters.fetch_add(1);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			// an entry that was pushed before the producer saw us waiting must be found here
+			if (pop()) {
+				_waiters.fetch_sub(1);
+				return true;
+			}
+			if (_abort.load()) {
+				_waiters.fetch_sub(1);
+				return false;
+			}
+			const bool success = _semaphore.waitAndDecrease();
+			_waiters.fetch_sub(1);
+			if (!success) {
+				return false;
+			}
+		}
+	}
+};
+
+}
+
+/**
+ * @brief Bounded lock-free multi producer multi consumer queue
+ *
+ * A ring buffer where each cell has a sequence number that tells the producers and consumers whether the cell can be
+ * written or read for the current round (see Dmitry Vyukov's bounded MPMC queue). Producers and consumers only
+ * contend on their own position counter - there is no lock and no allocation after construction.
+ *
+ * @note @c push() fails if the queue is full - see @c LockFreeQueue for an unbounded version
+ * @sa ConcurrentQueue
+ * @ingroup Collections
+ */
+template<class Data>
+class BoundedLockFreeQueue {
+private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		alignas(Data) uint8_t storage[sizeof(Data)];
+
+		inline Data *data() {
+			return (Data *)storage;
+		}
+	};
+
+	Cell *_cells;
+	const size_t _mask;
+	// keep the producer and the consumer position on different cache lines
+	alignas(64) std::atomic<size_t> _enqueuePos{0u};
+	alignas(64) std::atomic<size_t> _dequeuePos{0u};
+	alignas(64) priv::QueueWaiter _waiter;
+
+	static size_t toCapacity(size_t capacity) {
+		size_t c = 2u;
+		while (c < capacity) {
+			c <<= 1u;
+		}
+		return c;
+	}
+
+	template<class T>
+	bool enqueue(T &&data) {
+		Cell *cell;
+		size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+		for (;;) {
+			cell = &_cells[pos & _mask];
+			const size_t seq = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+			if (diff == 0) {
+				if (_enqueuePos.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				// the cell of the previous round wasn't read yet
+				return false;
+			} else {
+				pos = _enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+		new ((void *)cell->storage) Data(core::forward<T>(data));
+		cell->sequence.store(pos + 1u, std::memory_order_release);
+		_waiter.notify();
+		return true;
+	}
+
+public:
+	using value_type = Data;
+	using Key = Data;
+
+	/**
+	 * @param capacity The max amount of entries - rounded up to the next power of two
+	 */
+	BoundedLockFreeQueue(size_t capacity = 1024u) : _mask(toCapacity(capacity) - 1u) {
+		_cells = (Cell *)core_malloc((_mask + 1u) * sizeof(Cell));
+		for (size_t i = 0u; i <= _mask; ++i) {
+			new ((void *)&_cells[i].sequence) std::atomic<size_t>(i);
+		}
+	}
+
+	~BoundedLockFreeQueue() {
+		abortWait();
+		clear();
+		core_free(_cells);
+	}
+
+	BoundedLockFreeQueue(const BoundedLockFreeQueue &) = delete;
+	BoundedLockFreeQueue &operator=(const BoundedLockFreeQueue &) = delete;
+
+	void abortWait() {
+		_waiter.abortWait();
+	}
+
+	void reset() {
+		_waiter.reset();
+	}
+
+	/**
+	 * @note Not thread safe in combination with a @c push()
+	 */
+	void clear() {
+		Data data;
+		while (pop(data)) {
+		}
+	}
+
+	inline size_t capacity() const {
+		return _mask + 1u;
+	}
+
+	/**
+	 * @return @c false if the queue is full - this is also the case if the consumer of the cell from the previous
+	 * round didn't finish reading it yet
+	 */
+	inline bool push(const Data &data) {
+		return enqueue(data);
+	}
+
+	/**
+	 * @return @c false if the queue is full - the data isn't moved then
+	 */
+	inline bool push(Data &&data) {
+		return enqueue(core::move(data));
+	}
+
+	template<typename ITER>
+	bool push(ITER first, ITER last) {
+		for (ITER i = first; i != last; ++i) {
+			if (!enqueue(*i)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @note Only a snapshot if other threads are modifying the queue
+	 */
+	inline uint32_t size() const {
+		const size_t dequeuePos = _dequeuePos.load();
+		const size_t enqueuePos = _enqueuePos.load();
+		const intptr_t diff = (intptr_t)enqueuePos - (intptr_t)dequeuePos;
+		return diff > 0 ? (uint32_t)diff : 0u;
+	}
+
+	inline bool empty() const {
+		return size() == 0u;
+	}
+
+	bool pop(Data &poppedValue) {
+		Cell *cell;
+		size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+		for (;;) {
+			cell = &_cells[pos & _mask];
+			const size_t seq = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1u);
+			if (diff == 0) {
+				if (_dequeuePos.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				// the cell wasn't written yet
+				return false;
+			} else {
+				pos = _dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+		Data *data = cell->data();
+		poppedValue = core::move(*data);
+		data->~Data();
+		cell->sequence.store(pos + _mask + 1u, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Blocks until an entry is available or @c abortWait() was called
+	 */
+	bool waitAndPop(Data &poppedValue) {
+		return _waiter.wait([&]() { return pop(poppedValue); });
+	}
+};
+
+/**
+ * @brief Unbounded lock-free multi producer multi consumer queue
+ *
+ * The entries are stored in a linked list of fixed size segments. Producers and consumers claim a cell of the
+ * segment by an atomic increment of its enqueue or dequeue index - only a full segment needs a compare and swap to
+ * link a new one. A consumer that reaches a cell before its producer marks it as taken and both of them retry with
+ * the next cell. Segments that were drained are freed once no thread holds a hazard pointer to them anymore.
+ *
+ * @sa BoundedLockFreeQueue
+ * @sa HazardPointer
+ * @ingroup Collections
+ */
+template<class Data, size_t SegmentSize = 1024u>
+class LockFreeQueue {
+private:
+	enum CellState : uint8_t { Empty, Filled, Taken };
+
+	struct Cell {
+		std::atomic<uint8_t> state{Empty};
+		alignas(Data) uint8_t storage[sizeof(Data)];
+
+		inline Data *data() {
+			return (Data *)storage;
+		}
+	};
+
+	struct Segment {
+		alignas(64) std::atomic<size_t> dequeueIdx{0u};
+		alignas(64) std::atomic<size_t> enqueueIdx{0u};
+		alignas(64) std::atomic<Segment *> next{nullptr};
+		Cell cells[SegmentSize];
+
+		~Segment() {
+			const size_t n = core_min(enqueueIdx.load(), SegmentSize);
+			for (size_t i = dequeueIdx.load(); i < n; ++i) {
+				if (cells[i].state.load() == Filled) {
+					cells[i].data()->~Data();
+				}
+			}
+		}
+	};
+
+	alignas(64) std::atomic<Segment *> _head;
+	alignas(64) std::atomic<Segment *> _tail;
+	alignas(64) priv::QueueWaiter _waiter;
+	core_trace_mutex(core::Lock, _retiredLock, "LockFreeQueue");
+	core::DynamicArray<Segment *> _retired;
+
+	/**
+	 * @brief Frees the unlinked segments that no thread is accessing anymore
+	 */
+	void retire(Segment *segment) {
+		core::ScopedLock lock(_retiredLock);
+		_retired.push_back(segment);
+		for (size_t i = 0u; i < _retired.size();) {
+			if (HazardPointer::isProtected(_retired[i])) {
+				++i;
+				continue;
+			}
+			delete _retired[i];
+			_retired.erase(i);
+		}
+	}
+
+	void enqueue(Data &&data) {
+		for (;;) {
+			Segment *tail = HazardPointer::protect(_tail);
+			const size_t idx = tail->enqueueIdx.fetch_add(1u);
+			if (idx >= SegmentSize) {
+				if (tail != _tail.load()) {
+					continue;
+				}
+				Segment *next = tail->next.load();
+				if (next != nullptr) {
+					_tail.compare_exchange_strong(tail, next);
+					continue;
+				}
+				Segment *segment = new Segment();
+				new ((void *)segment->cells[0].storage) Data(core::move(data));
+				segment->cells[0].state.store(Filled, std::memory_order_relaxed);
+				segment->enqueueIdx.store(1u, std::memory_order_relaxed);
+				Segment *expected = nullptr;
+				if (tail->next.compare_exchange_strong(expected, segment)) {
+					_tail.compare_exchange_strong(tail, segment);
+					HazardPointer::clear();
+					return;
+				}
+				data = core::move(*segment->cells[0].data());
+				delete segment;
+				continue;
+			}
+			Cell &cell = tail->cells[idx];
+			new ((void *)cell.storage) Data(core::move(data));
+			uint8_t expected = Empty;
+			if (cell.state.compare_exchange_strong(expected, Filled, std::memory_order_release)) {
+				HazardPointer::clear();
+				return;
+			}
+			// a consumer already gave up on this cell
+			data = core::move(*cell.data());
+			cell.data()->~Data();
+		}
+	}
+
+public:
+	using value_type = Data;
+	using Key = Data;
+
+	LockFreeQueue() {
+		Segment *segment = new Segment();
+		_head.store(segment);
+		_tail.store(segment);
+	}
+
+	~LockFreeQueue() {
+		abortWait();
+		Segment *segment = _head.load();
+		while (segment != nullptr) {
+			Segment *next = segment->next.load();
+			delete segment;
+			segment = next;
+		}
+		for (Segment *retired : _retired) {
+			delete retired;
+		}
+	}
+
+	LockFreeQueue(const LockFreeQueue &) = delete;
+	LockFreeQueue &operator=(const LockFreeQueue &) = delete;
+
+	void abortWait() {
+		_waiter.abortWait();
+	}
+
+	void reset() {
+		_waiter.reset();
+	}
+
+	void clear() {
+		Data data;
+		while (pop(data)) {
+		}
+	}
+
+	inline void push(const Data &data) {
+		enqueue(Data(data));
+		_waiter.notify();
+	}
+
+	inline void push(Data &&data) {
+		enqueue(core::move(data));
+		_waiter.notify();
+	}
+
+	template<typename ITER>
+	void push(ITER first, ITER last) {
+		for (ITER i = first; i != last; ++i) {
+			enqueue(Data(*i));
+		}
+		_waiter.notify();
+	}
+
+	template<typename... _Args>
+	void emplace(_Args &&...__args) {
+		enqueue(Data(core::forward<_Args>(__args)...));
+		_waiter.notify();
+	}
+
+	/**
+	 * @note Only a snapshot if other threads are modifying the queue
+	 */
+	bool empty() const {
+		Segment *head = HazardPointer::protect(_head);
+		const bool isEmpty = head->dequeueIdx.load() >= head->enqueueIdx.load() && head->next.load() == nullptr;
+		HazardPointer::clear();
+		return isEmpty;
+	}
+
+	bool pop(Data &poppedValue) {
+		for (;;) {
+			Segment *head = HazardPointer::protect(_head);
+			if (head->dequeueIdx.load() >= head->enqueueIdx.load() && head->next.load() == nullptr) {
+				break;
+			}
+			const size_t idx = head->dequeueIdx.fetch_add(1u);
+			if (idx >= SegmentSize) {
+				Segment *next = head->next.load();
+				if (next == nullptr) {
+					break;
+				}
+				// the tail must not point to the segment anymore before it can be freed
+				Segment *expected = head;
+				_tail.compare_exchange_strong(expected, next);
+				if (_head.compare_exchange_strong(head, next)) {
+					HazardPointer::clear();
+					retire(head);
+				}
+				continue;
+			}
+			Cell &cell = head->cells[idx];
+			if (cell.state.exchange(Taken, std::memory_order_acq_rel) == Empty) {
+				// the producer didn't publish the entry yet - it will retry with another cell
+				continue;
+			}
+			Data *data = cell.data();
+			poppedValue = core::move(*data);
+			data->~Data();
+			HazardPointer::clear();
+			return true;
+		}
+		HazardPointer::clear();
+		return false;
+	}
+
+	/**
+	 * @brief Blocks until an entry is available or @c abortWait() was called
+	 */
+	bool waitAndPop(Data &poppedValue) {
+		return _waiter.wait([&]() { return pop(poppedValue); });
+	}
+};
+
+}
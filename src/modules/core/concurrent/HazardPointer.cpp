@@ -0,0 +1,72 @@
+/**
+ * @file
+ */
+
+#include "HazardPointer.h"
+#include "core/Assert.h"
+
+namespace core {
+
+namespace {
+
+constexpr int MaxThreads = 512;
+
+// one cache line per slot - the slots are written by their owner for every operation
+struct alignas(64) HazardSlot {
+	std::atomic<void *> ptr{nullptr};
+	std::atomic<bool> used{false};
+};
+
+HazardSlot _slots[MaxThreads];
+// the amount of slots that were ever claimed - only those have to be checked
+std::atomic<int> _slotCount{0};
+
+HazardSlot *claimSlot() {
+	for (int i = 0; i < MaxThreads; ++i) {
+		bool expected = false;
+		if (_slots[i].used.load() || !_slots[i].used.compare_exchange_strong(expected, true)) {
+			continue;
+		}
+		int count = _slotCount.load();
+		while (count < i + 1 && !_slotCount.compare_exchange_weak(count, i + 1)) {
+		}
+		return &_slots[i];
+	}
+	core_assert_always(false);
+	return nullptr;
+}
+
+/**
+ * @brief Gives the slot back once the thread ends
+ */
+struct ThreadSlot {
+	HazardSlot *slot = claimSlot();
+
+	~ThreadSlot() {
+		slot->ptr.store(nullptr);
+		slot->used.store(false);
+	}
+};
+
+}
+
+std::atomic<void *> &HazardPointer::slot() {
+	static thread_local ThreadSlot threadSlot;
+	return threadSlot.slot->ptr;
+}
+
+void HazardPointer::clear() {
+	slot().store(nullptr, std::memory_order_release);
+}
+
+bool HazardPointer::isProtected(const void *ptr) {
+	const int n = _slotCount.load();
+	for (int i = 0; i < n; ++i) {
+		if (_slots[i].ptr.load() == ptr) {
+			return true;
+		}
+	}
+	return false;
+}
+
+}
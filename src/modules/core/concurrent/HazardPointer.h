@@ -0,0 +1,50 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include <atomic>
+
+namespace core {
+
+/**
+ * @brief Hazard pointers for the lock-free collections
+ *
+ * Every thread owns one slot that is published while it accesses a shared node of a lock-free collection. A node
+ * that was unlinked from the collection may only be freed if it isn't published in any of the slots.
+ *
+ * @note A thread can only protect one pointer at a time - the lock-free collections don't nest their operations.
+ */
+class HazardPointer {
+private:
+	static std::atomic<void *> &slot();
+
+public:
+	/**
+	 * @brief Loads the given pointer and publishes it until it is stable
+	 * @return The protected pointer that is safe to dereference until @c clear() is called
+	 */
+	template<class T>
+	static T *protect(const std::atomic<T *> &ptr) {
+		std::atomic<void *> &hazard = slot();
+		T *current = ptr.load();
+		for (;;) {
+			hazard.store(current);
+			T *reloaded = ptr.load();
+			if (reloaded == current) {
+				return current;
+			}
+			current = reloaded;
+		}
+	}
+
+	static void clear();
+
+	/**
+	 * @return @c true if any thread has the given pointer published in its slot
+	 */
+	static bool isProtected(const void *ptr);
+};
+
+}
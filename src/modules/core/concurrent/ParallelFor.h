@@ -0,0 +1,78 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Common.h"
+#include "core/SharedPtr.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
+
+namespace core {
+
+namespace priv {
+
+/**
+ * @brief Shared between the calling thread and the tasks - a task might only get executed after the caller returned
+ */
+struct ParallelFor {
+	core::AtomicInt next { 0 };
+	core::AtomicInt finished { 0 };
+	core_trace_mutex(core::Lock, lock, "ParallelFor");
+	core::ConditionVariable condition;
+
+	/**
+	 * @brief Processes indices until there are none left
+	 * @note The function is only called for indices that were not handed out yet - a task that starts after all
+	 * indices were processed doesn't touch it anymore.
+	 */
+	template<class F>
+	void run(int n, F &func) {
+		for (int i = next.increment(1); i < n; i = next.increment(1)) {
+			func(i);
+			if (finished.increment(1) + 1 == n) {
+				core::ScopedLock scoped(lock);
+				condition.notify_all();
+			}
+		}
+	}
+};
+
+}
+
+/**
+ * @brief Calls @c func(i) for each @c i in @c [0, n) with the threads of the given pool
+ *
+ * The indices are handed out one after another to the tasks and the calling thread. The calling thread takes part in
+ * the work and returns once all indices were processed - so @c func may reference data on the stack of the caller.
+ * It's safe to call this from a task of the given thread pool. Without a thread pool (or threads) everything is done
+ * by the calling thread.
+ */
+template<class F>
+void parallelFor(core::ThreadPool *threadPool, int n, F &&func) {
+	if (n <= 0) {
+		return;
+	}
+	if (threadPool == nullptr || threadPool->size() == 0u || n == 1) {
+		for (int i = 0; i < n; ++i) {
+			func(i);
+		}
+		return;
+	}
+	const core::SharedPtr<priv::ParallelFor> state = core::make_shared<priv::ParallelFor>();
+	auto *f = &func;
+	const int tasks = core_min((int)threadPool->size(), n - 1);
+	for (int i = 0; i < tasks; ++i) {
+		threadPool->enqueue([state, n, f] () {
+			state->run(n, *f);
+		});
+	}
+	state->run(n, func);
+	core::ScopedLock scoped(state->lock);
+	state->condition.wait(state->lock, [&] () { return state->finished == n; });
+}
+
+}
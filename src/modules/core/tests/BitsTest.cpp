@@ -22,4 +22,19 @@ TEST(BitsTest, extract1011) {
 	EXPECT_EQ(5u, bits(input, 1, 3));
 }
 
+TEST(BitsTest, bitScan) {
+	EXPECT_EQ(0, countTrailingZeros(1u));
+	EXPECT_EQ(63, countLeadingZeros(1u));
+	EXPECT_EQ(4, countTrailingZeros(0b110000u));
+	EXPECT_EQ(58, countLeadingZeros(0b110000u));
+	EXPECT_EQ(63, countTrailingZeros(1ull << 63));
+	EXPECT_EQ(0, countLeadingZeros(1ull << 63));
+}
+
+TEST(BitsTest, countSetBits) {
+	EXPECT_EQ(0, countSetBits(0u));
+	EXPECT_EQ(3, countSetBits(0b1011u));
+	EXPECT_EQ(64, countSetBits(~0ull));
+}
+
 }
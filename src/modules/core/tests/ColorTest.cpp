@@ -3,9 +3,13 @@
  */
 
 #include <gtest/gtest.h>
+#include "core/ClosestColorTree.h"
 #include "core/Color.h"
+#include "core/ColorReduction.h"
 #include "core/RGBA.h"
+#include "core/collection/DynamicArray.h"
 #include "core/ArrayLength.h"
+#include "core/concurrent/ThreadPool.h"
 #include <SDL_endian.h>
 
 namespace core {
@@ -78,6 +82,109 @@ TEST(ColorTest, testQuantize) {
 	EXPECT_EQ(219, n);
 }
 
+static void fillGradient(core::DynamicArray<core::RGBA> &colors) {
+	for (int y = 0; y < 128; ++y) {
+		for (int x = 0; x < 128; ++x) {
+			colors.push_back(core::RGBA(x * 2, y * 2, (x + y) % 256, (x * y) % 256));
+		}
+	}
+}
+
+TEST(ColorTest, testColorReductionType) {
+	for (int i = 0; i < (int)ColorReductionType::Max; ++i) {
+		const ColorReductionType type = (ColorReductionType)i;
+		EXPECT_EQ(type, toColorReductionType(toColorReductionTypeString(type)));
+	}
+	EXPECT_EQ(ColorReductionType::KMeans, toColorReductionType("kmeans"));
+	EXPECT_EQ(ColorReductionType::Max, toColorReductionType("foo"));
+}
+
+TEST(ColorTest, testColorHistogram) {
+	const core::RGBA buf[] {0xff000000, 0xff0000ff, 0x000000ff, 0xff000000, 0xff00ff00};
+	ColorHistogram histogram;
+	buildColorHistogram(buf, lengthof(buf), histogram);
+	ASSERT_EQ(3u, histogram.size());
+	EXPECT_EQ(core::RGBA(0xff000000), histogram[0].color);
+	EXPECT_EQ(2u, histogram[0].count);
+	EXPECT_EQ(core::RGBA(0xff0000ff), histogram[1].color);
+	EXPECT_EQ(2u, histogram[1].count);
+	EXPECT_EQ(1u, histogram[2].count);
+
+	core::DynamicArray<core::RGBA> colors;
+	fillGradient(colors);
+	core::ThreadPool threadPool(2, "ColorTest");
+	threadPool.init();
+	ColorHistogram parallelHistogram;
+	buildColorHistogram(colors.data(), colors.size(), histogram);
+	for (int i = 0; i < 4; ++i) {
+		fillGradient(colors);
+	}
+	buildColorHistogram(colors.data(), colors.size(), parallelHistogram, &threadPool);
+	ASSERT_EQ(histogram.size(), parallelHistogram.size());
+	for (size_t i = 0; i < histogram.size(); ++i) {
+		ASSERT_EQ(histogram[i].color, parallelHistogram[i].color);
+		ASSERT_EQ(histogram[i].count * 5u, parallelHistogram[i].count);
+	}
+}
+
+TEST(ColorTest, testDeltaE) {
+	const glm::vec3 white = core::Color::toCIELab(core::RGBA(255, 255, 255));
+	EXPECT_NEAR(100.0f, white.x, 0.01f);
+	EXPECT_NEAR(0.0f, white.y, 0.01f);
+	EXPECT_NEAR(0.0f, white.z, 0.01f);
+	EXPECT_NEAR(0.0f, core::Color::toCIELab(core::RGBA(0, 0, 0)).x, 0.01f);
+	EXPECT_FLOAT_EQ(0.0f, core::Color::getDeltaE(core::RGBA(10, 20, 30), core::RGBA(10, 20, 30)));
+	EXPECT_NEAR(100.0f, core::Color::getDeltaE(core::RGBA(0, 0, 0), core::RGBA(255, 255, 255)), 0.01f);
+}
+
+TEST(ColorTest, testQuantizeFewColors) {
+	const core::RGBA buf[] {0xff000000, 0xff7d7d7d, 0xff4cb376, 0xff7d7d7d};
+	for (int i = 1; i < (int)ColorReductionType::Max; ++i) {
+		core::RGBA targetBuf[256] {};
+		const int n = core::Color::quantize((ColorReductionType)i, targetBuf, lengthof(targetBuf), buf, lengthof(buf));
+		ASSERT_EQ(3, n);
+		EXPECT_EQ(core::RGBA(0xff000000), targetBuf[0]);
+		EXPECT_EQ(core::RGBA(0xff4cb376), targetBuf[1]);
+		EXPECT_EQ(core::RGBA(0xff7d7d7d), targetBuf[2]);
+		EXPECT_EQ(core::RGBA(0xffffffff), targetBuf[3]);
+	}
+}
+
+TEST(ColorTest, testQuantizeError) {
+	core::DynamicArray<core::RGBA> colors;
+	fillGradient(colors);
+	ColorHistogram histogram;
+	buildColorHistogram(colors.data(), colors.size(), histogram);
+	core::ThreadPool threadPool(2, "ColorTest");
+	threadPool.init();
+
+	float deltaE[(int)ColorReductionType::Max];
+	for (int i = 0; i < (int)ColorReductionType::Max; ++i) {
+		const ColorReductionType type = (ColorReductionType)i;
+		core::RGBA targetBuf[256] {};
+		const int n = core::Color::quantize(type, targetBuf, lengthof(targetBuf), colors.data(), colors.size(), &threadPool);
+		ASSERT_GT(n, 0) << toColorReductionTypeString(type);
+		ASSERT_LE(n, 256) << toColorReductionTypeString(type);
+		deltaE[i] = meanDeltaE(histogram, targetBuf, n, &threadPool);
+	}
+	EXPECT_LT(deltaE[(int)ColorReductionType::MedianCut], deltaE[(int)ColorReductionType::Octree]);
+	EXPECT_LT(deltaE[(int)ColorReductionType::KMeans], deltaE[(int)ColorReductionType::MedianCut]);
+}
+
+TEST(ColorTest, testQuantizeKMeansDeterministic) {
+	core::DynamicArray<core::RGBA> colors;
+	fillGradient(colors);
+	core::ThreadPool threadPool(2, "ColorTest");
+	threadPool.init();
+	core::RGBA targetBuf[256] {};
+	core::RGBA parallelTargetBuf[256] {};
+	const int n = core::Color::quantize(ColorReductionType::KMeans, targetBuf, lengthof(targetBuf), colors.data(), colors.size());
+	EXPECT_EQ(n, core::Color::quantize(ColorReductionType::KMeans, parallelTargetBuf, lengthof(parallelTargetBuf), colors.data(), colors.size(), &threadPool));
+	for (int i = 0; i < n; ++i) {
+		EXPECT_EQ(targetBuf[i], parallelTargetBuf[i]);
+	}
+}
+
 TEST(ColorTest, testClosestMatchExact) {
 	const glm::vec4 color(0.5f, 0.5f, 0.5f, 1.0f);
 	const std::vector<glm::vec4>& colors {
@@ -109,4 +216,33 @@ TEST(ColorTest, testClosestMatch) {
 	EXPECT_EQ(3, index);
 }
 
+TEST(ColorTest, testClosestColorTree) {
+	// duplicates and a lot of black entries - like the unused entries of a palette
+	glm::vec4 colors[200];
+	for (int i = 0; i < lengthof(colors); ++i) {
+		if (i >= 150) {
+			colors[i] = glm::vec4(0.0f);
+		} else if (i % 10 == 9) {
+			colors[i] = colors[i - 5];
+		} else {
+			colors[i] = core::Color::fromRGBA((i * 53) % 256, (i * 97 + 31) % 256, (i * 191 + 7) % 256);
+		}
+	}
+	core::DynamicArray<glm::vec4> list;
+	list.append(colors, lengthof(colors));
+	core::ClosestColorTree tree;
+	EXPECT_EQ(-1, tree.closestMatch(core::Color::White));
+	tree.build(colors, lengthof(colors));
+	for (int i = 0; i < 4096; ++i) {
+		const glm::vec4 color = core::Color::fromRGBA((i * 13) % 256, (i * 37) % 256, (i * 101) % 256);
+		float expectedDistance = 0.0f;
+		float distance = 0.0f;
+		ASSERT_EQ(core::Color::getClosestMatch(color, list, &expectedDistance), tree.closestMatch(color, &distance)) << i;
+		ASSERT_EQ(expectedDistance, distance);
+	}
+	for (const glm::vec4 &color : colors) {
+		ASSERT_EQ(core::Color::getClosestMatch(color, list), tree.closestMatch(color));
+	}
+}
+
 }
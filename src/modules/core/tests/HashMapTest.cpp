@@ -0,0 +1,197 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/collection/HashMap.h"
+#include "core/SharedPtr.h"
+#include "core/String.h"
+#include <unordered_map>
+
+namespace core {
+
+TEST(CoreHashMapTest, testPutGet) {
+	core::HashMap<int64_t, int64_t, std::hash<int64_t>> map;
+	map.put(1, 1);
+	map.put(1, 2);
+	map.put(2, 1);
+	map.put(3, 1337);
+	map.put(4, 42);
+	map.put(5, 111);
+	map.put(6, 1111);
+	EXPECT_EQ(6u, map.size());
+	int64_t value;
+	EXPECT_TRUE(map.get(1, value));
+	EXPECT_EQ(2, value);
+	EXPECT_TRUE(map.get(2, value));
+	EXPECT_EQ(1, value);
+	EXPECT_TRUE(map.get(3, value));
+	EXPECT_EQ(1337, value);
+	EXPECT_TRUE(map.get(4, value));
+	EXPECT_EQ(42, value);
+	EXPECT_TRUE(map.get(5, value));
+	EXPECT_EQ(111, value);
+	EXPECT_TRUE(map.get(6, value));
+	EXPECT_EQ(1111, value);
+	EXPECT_FALSE(map.get(7, value));
+}
+
+TEST(CoreHashMapTest, testGrow) {
+	core::HashMap<int64_t, int64_t> map;
+	EXPECT_EQ(0u, map.capacity());
+	for (int64_t i = 0; i < 100000; ++i) {
+		map.put(i * 4096, i);
+	}
+	EXPECT_EQ(100000u, map.size());
+	EXPECT_GE(map.capacity(), 100000u);
+	EXPECT_EQ(0u, map.capacity() & (map.capacity() - 1u));
+	int64_t value;
+	for (int64_t i = 0; i < 100000; ++i) {
+		ASSERT_TRUE(map.get(i * 4096, value));
+		ASSERT_EQ(i, value);
+	}
+}
+
+TEST(CoreHashMapTest, testReserve) {
+	core::HashMap<int64_t, int64_t> map(1000);
+	const size_t capacity = map.capacity();
+	for (int64_t i = 0; i < 1000; ++i) {
+		map.put(i, i);
+	}
+	EXPECT_EQ(capacity, map.capacity());
+}
+
+TEST(CoreHashMapTest, testClear) {
+	core::HashMap<int64_t, int64_t, std::hash<int64_t>> map;
+	for (int64_t i = 0; i < 16; ++i) {
+		map.put(i, i);
+	}
+	EXPECT_EQ(16u, map.size());
+	EXPECT_FALSE(map.empty());
+	map.clear();
+	EXPECT_EQ(0u, map.size());
+	EXPECT_TRUE(map.empty());
+	EXPECT_EQ(map.begin(), map.end());
+	EXPECT_FALSE(map.hasKey(1));
+}
+
+TEST(CoreHashMapTest, testFind) {
+	core::HashMap<int64_t, int64_t, std::hash<int64_t>> map;
+	EXPECT_EQ(map.end(), map.find(0));
+	for (int64_t i = 0; i < 1024; i += 2) {
+		map.put(i, i);
+	}
+	auto iter = map.find(0);
+	EXPECT_NE(map.end(), iter);
+	EXPECT_EQ(0u, iter->value);
+	iter->value = 42;
+	EXPECT_EQ(42, map.find(0)->second);
+
+	iter = map.find(1);
+	EXPECT_EQ(map.end(), iter);
+}
+
+TEST(CoreHashMapTest, testIterate) {
+	core::HashMap<int64_t, int64_t, std::hash<int64_t>> map;
+	EXPECT_EQ(map.begin(), map.end());
+	for (int64_t i = 0; i < 32; i += 2) {
+		map.put(i, i);
+	}
+	int cnt = 0;
+	for (auto iter = map.begin(); iter != map.end(); ++iter) {
+		EXPECT_EQ(iter->key, iter->value);
+		++cnt;
+	}
+	EXPECT_EQ(16, cnt);
+
+	for (int64_t i = 0; i < 1024; ++i) {
+		map.put(i, i);
+	}
+	EXPECT_EQ(1024u, map.size());
+	cnt = 0;
+	for (auto entry : map) {
+		EXPECT_EQ(entry->first, entry->second);
+		++cnt;
+	}
+	EXPECT_EQ(1024, cnt);
+}
+
+TEST(CoreHashMapTest, testRemove) {
+	// keep the keys in a few home slots to get long probe sequences that are shifted back on removal
+	core::HashMap<int64_t, int64_t> map;
+	std::unordered_map<int64_t, int64_t> expected;
+	for (int64_t i = 0; i < 2000; ++i) {
+		const int64_t key = (i % 7) * 1000003 + i / 7;
+		map.put(key, i);
+		expected[key] = i;
+	}
+	for (int64_t i = 0; i < 2000; i += 3) {
+		const int64_t key = (i % 7) * 1000003 + i / 7;
+		EXPECT_TRUE(map.remove(key));
+		EXPECT_FALSE(map.remove(key));
+		expected.erase(key);
+	}
+	ASSERT_EQ(expected.size(), map.size());
+	for (const auto &e : expected) {
+		int64_t value;
+		ASSERT_TRUE(map.get(e.first, value)) << e.first;
+		ASSERT_EQ(e.second, value);
+	}
+	size_t cnt = 0;
+	for (auto entry : map) {
+		ASSERT_EQ(1u, expected.count(entry->key));
+		++cnt;
+	}
+	EXPECT_EQ(expected.size(), cnt);
+}
+
+TEST(CoreHashMapTest, testStringSharedPtr) {
+	core::HashMap<core::String, core::SharedPtr<core::String>, core::StringHash> map;
+	auto foobar = core::SharedPtr<core::String>::create("foobar");
+	map.put("foobar", foobar);
+	map.put("barfoo", core::SharedPtr<core::String>::create("barfoo"));
+	map.put("foobar", core::SharedPtr<core::String>::create("barfoo"));
+	for (int i = 0; i < 100; ++i) {
+		map.emplace(core::String::format("%i", i), core::SharedPtr<core::String>::create("value"));
+	}
+	EXPECT_EQ(102u, map.size());
+	EXPECT_EQ("barfoo", *map.find("foobar")->value.get());
+	map.clear();
+	foobar = core::SharedPtr<core::String>();
+}
+
+TEST(CoreHashMapTest, testCopyAndMove) {
+	core::HashMap<int, int> map;
+	for (int i = 0; i < 100; ++i) {
+		map.put(i, i * 2);
+	}
+	core::HashMap<int, int> map2(map);
+	EXPECT_EQ(100u, map2.size());
+	map2.put(200, 1);
+	EXPECT_EQ(100u, map.size());
+	core::HashMap<int, int> map3;
+	map3 = map2;
+	EXPECT_EQ(101u, map3.size());
+	core::HashMap<int, int> map4(core::move(map3));
+	EXPECT_EQ(101u, map4.size());
+	EXPECT_EQ(0u, map3.size());
+	EXPECT_EQ(map3.begin(), map3.end());
+	int value;
+	EXPECT_TRUE(map4.get(50, value));
+	EXPECT_EQ(100, value);
+	map = core::move(map4);
+	EXPECT_TRUE(map.hasKey(200));
+}
+
+TEST(CoreHashMapTest, testErase) {
+	core::HashMap<int, int> map {{1, 2}, {3, 4}};
+	EXPECT_EQ(2u, map.size());
+	auto iter = map.find(1);
+	EXPECT_NE(iter, map.end());
+	map.erase(iter);
+	EXPECT_EQ(1u, map.size());
+	EXPECT_FALSE(map.hasKey(1));
+	EXPECT_TRUE(map.hasKey(3));
+}
+
+}
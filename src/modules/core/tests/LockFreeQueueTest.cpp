@@ -0,0 +1,196 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/collection/LockFreeQueue.h"
+#include "core/SharedPtr.h"
+#include <thread>
+#include <vector>
+
+namespace collection {
+
+class LockFreeQueueTest : public testing::Test {
+protected:
+	/**
+	 * @brief Every producer pushes its own range of values - all of them must be popped exactly once
+	 */
+	template<class QUEUE>
+	void pushPopConcurrent(QUEUE &queue, int producers, int consumers, uint32_t perProducer) {
+		const uint32_t total = perProducer * (uint32_t)producers;
+		std::vector<std::atomic<int>> seen(total);
+		std::atomic<uint32_t> popped{0u};
+		std::vector<std::thread> threads;
+		for (int p = 0; p < producers; ++p) {
+			threads.emplace_back([&queue, p, perProducer]() {
+				for (uint32_t i = 0u; i < perProducer; ++i) {
+					const uint32_t value = (uint32_t)p * perProducer + i;
+					while (!queue.push(value)) {
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+		for (int c = 0; c < consumers; ++c) {
+			threads.emplace_back([&queue, &seen, &popped, total]() {
+				while (popped.load() < total) {
+					uint32_t v;
+					if (queue.pop(v)) {
+						seen[v].fetch_add(1);
+						popped.fetch_add(1u);
+					}
+				}
+			});
+		}
+		for (std::thread &thread : threads) {
+			thread.join();
+		}
+		EXPECT_EQ(total, popped.load());
+		for (uint32_t i = 0u; i < total; ++i) {
+			ASSERT_EQ(1, seen[i].load()) << "value " << i;
+		}
+		EXPECT_TRUE(queue.empty());
+	}
+};
+
+// the unbounded queue has no return value for push - wrap it for the shared test helper
+struct UnboundedQueue : public core::LockFreeQueue<uint32_t, 64> {
+	bool push(uint32_t value) {
+		core::LockFreeQueue<uint32_t, 64>::push(value);
+		return true;
+	}
+};
+
+TEST_F(LockFreeQueueTest, testBoundedPushPop) {
+	core::BoundedLockFreeQueue<int> queue(1000);
+	EXPECT_EQ(1024u, queue.capacity());
+	EXPECT_TRUE(queue.empty());
+	for (int i = 0; i < 1024; ++i) {
+		ASSERT_TRUE(queue.push(i));
+	}
+	EXPECT_FALSE(queue.push(1024));
+	EXPECT_EQ(1024u, queue.size());
+	for (int i = 0; i < 1024; ++i) {
+		int v;
+		ASSERT_TRUE(queue.pop(v));
+		ASSERT_EQ(i, v);
+	}
+	int v;
+	EXPECT_FALSE(queue.pop(v));
+	EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(LockFreeQueueTest, testBoundedWrapAround) {
+	core::BoundedLockFreeQueue<int> queue(4);
+	for (int i = 0; i < 100; ++i) {
+		ASSERT_TRUE(queue.push(i));
+		ASSERT_TRUE(queue.push(i + 1));
+		int v;
+		ASSERT_TRUE(queue.pop(v));
+		ASSERT_EQ(i, v);
+		ASSERT_TRUE(queue.pop(v));
+		ASSERT_EQ(i + 1, v);
+	}
+}
+
+TEST_F(LockFreeQueueTest, testBoundedConcurrent) {
+	core::BoundedLockFreeQueue<uint32_t> queue(256);
+	pushPopConcurrent(queue, 4, 4, 20000u);
+}
+
+TEST_F(LockFreeQueueTest, testPushPop) {
+	core::LockFreeQueue<int, 16> queue;
+	EXPECT_TRUE(queue.empty());
+	for (int i = 0; i < 1000; ++i) {
+		queue.push(i);
+	}
+	EXPECT_FALSE(queue.empty());
+	for (int i = 0; i < 1000; ++i) {
+		int v;
+		ASSERT_TRUE(queue.pop(v));
+		ASSERT_EQ(i, v);
+	}
+	int v;
+	EXPECT_FALSE(queue.pop(v));
+	EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(LockFreeQueueTest, testConcurrent) {
+	UnboundedQueue queue;
+	pushPopConcurrent(queue, 4, 4, 20000u);
+}
+
+TEST_F(LockFreeQueueTest, testSharedPtr) {
+	auto ptr = core::SharedPtr<int>::create(42);
+	{
+		core::LockFreeQueue<core::SharedPtr<int>, 4> queue;
+		for (int i = 0; i < 10; ++i) {
+			queue.push(ptr);
+		}
+		core::SharedPtr<int> v;
+		ASSERT_TRUE(queue.pop(v));
+		EXPECT_EQ(42, *v.get());
+		// the remaining entries are released with the queue
+	}
+	core::BoundedLockFreeQueue<core::SharedPtr<int>> queue(8);
+	queue.push(ptr);
+	queue.clear();
+	EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(LockFreeQueueTest, testWaitAndPop) {
+	core::LockFreeQueue<uint32_t> queue;
+	const uint32_t n = 1000u;
+	std::thread thread([&]() {
+		for (uint32_t i = 0u; i < n; ++i) {
+			queue.push(i);
+		}
+	});
+	for (uint32_t i = 0u; i < n; ++i) {
+		uint32_t v;
+		ASSERT_TRUE(queue.waitAndPop(v));
+		ASSERT_EQ(i, v);
+	}
+	thread.join();
+}
+
+TEST_F(LockFreeQueueTest, testBoundedWaitAndPop) {
+	core::BoundedLockFreeQueue<uint32_t> queue(16);
+	const uint32_t n = 1000u;
+	std::thread thread([&]() {
+		for (uint32_t i = 0u; i < n; ++i) {
+			while (!queue.push(i)) {
+				std::this_thread::yield();
+			}
+		}
+	});
+	for (uint32_t i = 0u; i < n; ++i) {
+		uint32_t v;
+		ASSERT_TRUE(queue.waitAndPop(v));
+		ASSERT_EQ(i, v);
+	}
+	thread.join();
+}
+
+TEST_F(LockFreeQueueTest, testAbortWait) {
+	core::LockFreeQueue<int> queue;
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; ++i) {
+		threads.emplace_back([&]() {
+			int v;
+			EXPECT_FALSE(queue.waitAndPop(v));
+		});
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	queue.abortWait();
+	for (std::thread &thread : threads) {
+		thread.join();
+	}
+	queue.reset();
+	queue.push(1);
+	int v;
+	EXPECT_TRUE(queue.waitAndPop(v));
+	EXPECT_EQ(1, v);
+}
+
+}
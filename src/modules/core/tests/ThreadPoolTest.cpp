@@ -5,6 +5,8 @@
 #include <gtest/gtest.h>
 #include "core/concurrent/ThreadPool.h"
 #include "core/concurrent/Atomic.h"
+#include "core/concurrent/ParallelFor.h"
+#include <vector>
 
 namespace core {
 
@@ -42,4 +44,40 @@ TEST_F(ThreadPoolTest, testMultiplePush) {
 	ASSERT_EQ(x, _count) << "Not all threads were executed";
 }
 
+TEST_F(ThreadPoolTest, testParallelFor) {
+	const int n = 1000;
+	core::ThreadPool pool(2);
+	pool.init();
+	std::vector<int> calls(n, 0);
+	core::parallelFor(&pool, n, [&] (int i) {
+		++calls[i];
+		++_count;
+	});
+	EXPECT_EQ(n, _count);
+	for (int i = 0; i < n; ++i) {
+		ASSERT_EQ(1, calls[i]) << "Index " << i << " was not processed exactly once";
+	}
+	pool.shutdown(true);
+}
+
+TEST_F(ThreadPoolTest, testParallelForWithoutThreadPool) {
+	core::parallelFor(nullptr, 10, [this] (int) {
+		++_count;
+	});
+	EXPECT_EQ(10, _count);
+}
+
+TEST_F(ThreadPoolTest, testParallelForNested) {
+	// the tasks of the pool take part in the nested loops, too - this must not dead lock
+	core::ThreadPool pool(2);
+	pool.init();
+	core::parallelFor(&pool, 8, [&] (int) {
+		core::parallelFor(&pool, 8, [this] (int) {
+			++_count;
+		});
+	});
+	EXPECT_EQ(64, _count);
+	pool.shutdown(true);
+}
+
 }
@@ -118,6 +118,16 @@ inline float fBm(const glm::vec2 &v, uint8_t octaves = 4, float lacunarity = 2.0
 inline float fBm(const glm::vec3 &v, uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
 //! Returns a 4D simplex noise fractal brownian motion sum
 inline float fBm(const glm::vec4 &v, uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
+//! Computes the 2D simplex noise fractal brownian motion sum for @c n positions - the results are identical to the single point version
+void fBm(const glm::vec2 *in, float *out, size_t n, uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
+//! Computes the 3D simplex noise fractal brownian motion sum for @c n positions - the results are identical to the single point version
+void fBm(const glm::vec3 *in, float *out, size_t n, uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
+//! Computes the 2D simplex noise fractal brownian motion sum for a grid of @c width * @c height positions. The value at
+//! @c out[y * width + x] is the single point version for the position @code origin + glm::vec2(x, y) * step @endcode
+void fBmGrid(const glm::vec2 &origin, const glm::vec2 &step, int width, int height, float *out, uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
+//! Computes the 3D simplex noise fractal brownian motion sum for a grid of @c width * @c height * @c depth positions. The value at
+//! @c out[(z * height + y) * width + x] is the single point version for the position @code origin + glm::vec3(x, y, z) * step @endcode
+void fBmGrid(const glm::vec3 &origin, const glm::vec3 &step, int width, int height, int depth, float *out, uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
 
 //! Returns a 2D simplex cellular/worley noise fractal brownian motion sum
 inline float worleyfBm(const glm::vec2 &v, uint8_t octaves = 4, float lacunarity = 2.0f, float gain = 0.5f);
@@ -0,0 +1,163 @@
+/**
+ * @file
+ */
+
+#include "Simplex.h"
+#include "SimplexBatch.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <SDL_cpuinfo.h>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMPLEX_SSE2
+#endif
+
+namespace noise {
+
+static_assert(sizeof(glm::vec2) == 2 * sizeof(float), "Unexpected vec2 layout");
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "Unexpected vec3 layout");
+
+namespace batch {
+
+#ifdef SIMPLEX_SSE2
+struct SSE2 {
+	using F = __m128;
+	using I = __m128i;
+	static constexpr int Lanes = 4;
+
+	static inline F zero() { return _mm_setzero_ps(); }
+	static inline F set1(float v) { return _mm_set1_ps(v); }
+	static inline F load(const float *v) { return _mm_load_ps(v); }
+	static inline void store(float *out, F v) { _mm_store_ps(out, v); }
+	static inline void storeu(float *out, F v) { _mm_storeu_ps(out, v); }
+	static inline F add(F a, F b) { return _mm_add_ps(a, b); }
+	static inline F sub(F a, F b) { return _mm_sub_ps(a, b); }
+	static inline F mul(F a, F b) { return _mm_mul_ps(a, b); }
+	static inline F and_(F a, F b) { return _mm_and_ps(a, b); }
+	static inline F andnot(F a, F b) { return _mm_andnot_ps(a, b); }
+	static inline F or_(F a, F b) { return _mm_or_ps(a, b); }
+	static inline F xor_(F a, F b) { return _mm_xor_ps(a, b); }
+	static inline F gt(F a, F b) { return _mm_cmpgt_ps(a, b); }
+	static inline F ge(F a, F b) { return _mm_cmpge_ps(a, b); }
+	static inline F lt(F a, F b) { return _mm_cmplt_ps(a, b); }
+	static inline F ngt(F a, F b) { return _mm_cmpngt_ps(a, b); }
+
+	// (float)((double)v * d) for each lane
+	static inline F mulDouble(F v, double d) {
+		const __m128d dd = _mm_set1_pd(d);
+		const __m128d lo = _mm_mul_pd(_mm_cvtps_pd(v), dd);
+		const __m128d hi = _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(v, v)), dd);
+		return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+	}
+
+	// (float)((double)v + d) for each lane
+	static inline F addDouble(F v, double d) {
+		const __m128d dd = _mm_set1_pd(d);
+		const __m128d lo = _mm_add_pd(_mm_cvtps_pd(v), dd);
+		const __m128d hi = _mm_add_pd(_mm_cvtps_pd(_mm_movehl_ps(v, v)), dd);
+		return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+	}
+
+	static inline I set1i(int v) { return _mm_set1_epi32(v); }
+	static inline I iota() { return _mm_setr_epi32(0, 1, 2, 3); }
+	static inline I loadi(const int32_t *v) { return _mm_load_si128((const __m128i*)v); }
+	static inline void storei(int32_t *out, I v) { _mm_store_si128((__m128i*)out, v); }
+	static inline I addi(I a, I b) { return _mm_add_epi32(a, b); }
+	static inline I andi(I a, I b) { return _mm_and_si128(a, b); }
+	static inline I ori(I a, I b) { return _mm_or_si128(a, b); }
+	static inline I eqi(I a, I b) { return _mm_cmpeq_epi32(a, b); }
+	static inline I lti(I a, I b) { return _mm_cmplt_epi32(a, b); }
+	static inline F toFloat(I v) { return _mm_cvtepi32_ps(v); }
+	static inline I truncate(F v) { return _mm_cvttps_epi32(v); }
+	static inline F asFloat(I v) { return _mm_castsi128_ps(v); }
+	static inline I asInt(F v) { return _mm_castps_si128(v); }
+};
+#endif
+
+#ifdef SIMPLEX_AVX2
+static bool useAVX2() {
+	static const bool avx2 = SDL_HasAVX2() == SDL_TRUE;
+	return avx2;
+}
+#endif
+
+static inline Params params(uint8_t octaves, float lacunarity, float gain) {
+	return Params{details::perm, octaves, lacunarity, gain};
+}
+
+}
+
+void fBm(const glm::vec2 *in, float *out, size_t n, uint8_t octaves, float lacunarity, float gain) {
+	const float *positions = reinterpret_cast<const float*>(in);
+#ifdef SIMPLEX_AVX2
+	if (batch::useAVX2()) {
+		batch::fBmArrayAVX2(positions, 2, out, n, batch::params(octaves, lacunarity, gain));
+		return;
+	}
+#endif
+#ifdef SIMPLEX_SSE2
+	batch::fBmArray<batch::SSE2>(positions, 2, out, n, batch::params(octaves, lacunarity, gain));
+#else
+	for (size_t i = 0u; i < n; ++i) {
+		out[i] = fBm(in[i], octaves, lacunarity, gain);
+	}
+#endif
+}
+
+void fBm(const glm::vec3 *in, float *out, size_t n, uint8_t octaves, float lacunarity, float gain) {
+	const float *positions = reinterpret_cast<const float*>(in);
+#ifdef SIMPLEX_AVX2
+	if (batch::useAVX2()) {
+		batch::fBmArrayAVX2(positions, 3, out, n, batch::params(octaves, lacunarity, gain));
+		return;
+	}
+#endif
+#ifdef SIMPLEX_SSE2
+	batch::fBmArray<batch::SSE2>(positions, 3, out, n, batch::params(octaves, lacunarity, gain));
+#else
+	for (size_t i = 0u; i < n; ++i) {
+		out[i] = fBm(in[i], octaves, lacunarity, gain);
+	}
+#endif
+}
+
+void fBmGrid(const glm::vec2 &origin, const glm::vec2 &step, int width, int height, float *out, uint8_t octaves, float lacunarity, float gain) {
+#ifdef SIMPLEX_AVX2
+	if (batch::useAVX2()) {
+		batch::fBmGridAVX2(glm::value_ptr(origin), glm::value_ptr(step), width, height, out, batch::params(octaves, lacunarity, gain));
+		return;
+	}
+#endif
+#ifdef SIMPLEX_SSE2
+	batch::fBmGrid<batch::SSE2>(glm::value_ptr(origin), glm::value_ptr(step), width, height, out, batch::params(octaves, lacunarity, gain));
+#else
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			const glm::vec2 pos(origin.x + (float)x * step.x, origin.y + (float)y * step.y);
+			*out++ = fBm(pos, octaves, lacunarity, gain);
+		}
+	}
+#endif
+}
+
+void fBmGrid(const glm::vec3 &origin, const glm::vec3 &step, int width, int height, int depth, float *out, uint8_t octaves, float lacunarity, float gain) {
+#ifdef SIMPLEX_AVX2
+	if (batch::useAVX2()) {
+		batch::fBmGridAVX2(glm::value_ptr(origin), glm::value_ptr(step), width, height, depth, out, batch::params(octaves, lacunarity, gain));
+		return;
+	}
+#endif
+#ifdef SIMPLEX_SSE2
+	batch::fBmGrid<batch::SSE2>(glm::value_ptr(origin), glm::value_ptr(step), width, height, depth, out, batch::params(octaves, lacunarity, gain));
+#else
+	for (int z = 0; z < depth; ++z) {
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; ++x) {
+				const glm::vec3 pos(origin.x + (float)x * step.x, origin.y + (float)y * step.y, origin.z + (float)z * step.z);
+				*out++ = fBm(pos, octaves, lacunarity, gain);
+			}
+		}
+	}
+#endif
+}
+
+}
@@ -0,0 +1,303 @@
+/**
+ * @file
+ *
+ * Lane width independent simplex noise kernels for the batched fBm functions of Simplex.h. The kernels are
+ * instantiated with the SIMD traits of the translation unit that is compiled for a particular instruction set.
+ *
+ * Every operation mirrors the scalar implementation (including the double precision skewing factors and the
+ * FASTFLOOR behaviour) to produce bit identical results. The permutation table lookups are done per lane.
+ *
+ * Don't include anything here that might emit inline functions - this header is also compiled with
+ * instruction sets that are not available on every cpu.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace noise {
+namespace batch {
+
+struct Params {
+	const unsigned char *perm;
+	uint8_t octaves;
+	float lacunarity;
+	float gain;
+};
+
+// the same values as the skewing factors in Simplex.h
+constexpr double F2 = 0.366025403;
+constexpr double G2 = 0.211324865;
+constexpr double F3 = 0.333333333;
+constexpr double G3 = 0.166666667;
+
+template<class S>
+inline typename S::F negateIf(typename S::F v, typename S::F mask) {
+	return S::xor_(v, S::and_(mask, S::set1(-0.0f)));
+}
+
+template<class S>
+inline typename S::F select(typename S::F mask, typename S::F a, typename S::F b) {
+	return S::or_(S::and_(mask, a), S::andnot(mask, b));
+}
+
+template<class S>
+inline typename S::F bitSet(typename S::I h, int bit) {
+	const typename S::I b = S::set1i(bit);
+	return S::asFloat(S::eqi(S::andi(h, b), b));
+}
+
+template<class S>
+inline typename S::F grad(typename S::I hash, typename S::F x, typename S::F y) {
+	using F = typename S::F;
+	const typename S::I h = S::andi(hash, S::set1i(7));
+	const F lower = S::asFloat(S::lti(h, S::set1i(4)));
+	const F u = select<S>(lower, x, y);
+	const F v = S::mul(S::set1(2.0f), select<S>(lower, y, x));
+	return S::add(negateIf<S>(u, bitSet<S>(h, 1)), negateIf<S>(v, bitSet<S>(h, 2)));
+}
+
+template<class S>
+inline typename S::F grad(typename S::I hash, typename S::F x, typename S::F y, typename S::F z) {
+	using F = typename S::F;
+	const typename S::I h = S::andi(hash, S::set1i(15));
+	const F u = select<S>(S::asFloat(S::lti(h, S::set1i(8))), x, y);
+	const F h12or14 = S::asFloat(S::ori(S::eqi(h, S::set1i(12)), S::eqi(h, S::set1i(14))));
+	const F v = select<S>(S::asFloat(S::lti(h, S::set1i(4))), y, select<S>(h12or14, x, z));
+	return S::add(negateIf<S>(u, bitSet<S>(h, 1)), negateIf<S>(v, bitSet<S>(h, 2)));
+}
+
+// t * t * t * t * g - or zero if t is negative
+template<class S>
+inline typename S::F contribution(typename S::F t, typename S::F g) {
+	const typename S::F t2 = S::mul(t, t);
+	return S::andnot(S::lt(t, S::zero()), S::mul(S::mul(t2, t2), g));
+}
+
+// FASTFLOOR subtracts one for every value that is not greater than zero - the mask is -1 for those lanes
+template<class S>
+inline typename S::I fastFloor(typename S::F v) {
+	return S::addi(S::truncate(v), S::asInt(S::ngt(v, S::zero())));
+}
+
+template<class S>
+typename S::F noise(typename S::F x, typename S::F y, const unsigned char *perm) {
+	using F = typename S::F;
+	using I = typename S::I;
+	const F s = S::mulDouble(S::add(x, y), F2);
+	const I i = fastFloor<S>(S::add(x, s));
+	const I j = fastFloor<S>(S::add(y, s));
+	const F t = S::mulDouble(S::toFloat(S::addi(i, j)), G2);
+	const F x0 = S::sub(x, S::sub(S::toFloat(i), t));
+	const F y0 = S::sub(y, S::sub(S::toFloat(j), t));
+
+	const F one = S::set1(1.0f);
+	const F lowerTriangle = S::gt(x0, y0);
+	const F x1 = S::addDouble(S::sub(x0, S::and_(lowerTriangle, one)), G2);
+	const F y1 = S::addDouble(S::sub(y0, S::andnot(lowerTriangle, one)), G2);
+	const F x2 = S::addDouble(S::sub(x0, one), 2.0f * G2);
+	const F y2 = S::addDouble(S::sub(y0, one), 2.0f * G2);
+
+	alignas(32) int32_t is[S::Lanes], js[S::Lanes], i1s[S::Lanes];
+	S::storei(is, i);
+	S::storei(js, j);
+	S::storei(i1s, S::asInt(lowerTriangle));
+	alignas(32) int32_t gi0[S::Lanes], gi1[S::Lanes], gi2[S::Lanes];
+	for (int l = 0; l < S::Lanes; ++l) {
+		const int ii = is[l] & 0xff;
+		const int jj = js[l] & 0xff;
+		// the masks are either 0 or -1
+		const int i1 = -i1s[l];
+		const int j1 = 1 - i1;
+		gi0[l] = perm[ii + perm[jj]];
+		gi1[l] = perm[ii + i1 + perm[jj + j1]];
+		gi2[l] = perm[ii + 1 + perm[jj + 1]];
+	}
+
+	const F half = S::set1(0.5f);
+	const F t0 = S::sub(S::sub(half, S::mul(x0, x0)), S::mul(y0, y0));
+	const F t1 = S::sub(S::sub(half, S::mul(x1, x1)), S::mul(y1, y1));
+	const F t2 = S::sub(S::sub(half, S::mul(x2, x2)), S::mul(y2, y2));
+	const F n0 = contribution<S>(t0, grad<S>(S::loadi(gi0), x0, y0));
+	const F n1 = contribution<S>(t1, grad<S>(S::loadi(gi1), x1, y1));
+	const F n2 = contribution<S>(t2, grad<S>(S::loadi(gi2), x2, y2));
+	return S::mul(S::set1(40.0f), S::add(S::add(n0, n1), n2));
+}
+
+template<class S>
+typename S::F noise(typename S::F x, typename S::F y, typename S::F z, const unsigned char *perm) {
+	using F = typename S::F;
+	using I = typename S::I;
+	const F s = S::mulDouble(S::add(S::add(x, y), z), F3);
+	const I i = fastFloor<S>(S::add(x, s));
+	const I j = fastFloor<S>(S::add(y, s));
+	const I k = fastFloor<S>(S::add(z, s));
+	const F t = S::mulDouble(S::toFloat(S::addi(S::addi(i, j), k)), G3);
+	const F x0 = S::sub(x, S::sub(S::toFloat(i), t));
+	const F y0 = S::sub(y, S::sub(S::toFloat(j), t));
+	const F z0 = S::sub(z, S::sub(S::toFloat(k), t));
+
+	// the branches of the scalar version expressed as masks
+	const F allSet = S::asFloat(S::set1i(-1));
+	const F xy = S::ge(x0, y0);
+	const F yz = S::ge(y0, z0);
+	const F xz = S::ge(x0, z0);
+	const F i1 = S::and_(xy, S::or_(yz, xz));
+	const F j1 = S::andnot(xy, yz);
+	const F k1 = S::andnot(yz, S::andnot(S::and_(xy, xz), allSet));
+	const F i2 = S::or_(xy, S::and_(yz, xz));
+	const F j2 = S::or_(S::and_(xy, yz), S::andnot(xy, allSet));
+	const F k2 = S::andnot(S::and_(yz, S::or_(xy, xz)), allSet);
+
+	const F one = S::set1(1.0f);
+	const F x1 = S::addDouble(S::sub(x0, S::and_(i1, one)), G3);
+	const F y1 = S::addDouble(S::sub(y0, S::and_(j1, one)), G3);
+	const F z1 = S::addDouble(S::sub(z0, S::and_(k1, one)), G3);
+	const F x2 = S::addDouble(S::sub(x0, S::and_(i2, one)), 2.0f * G3);
+	const F y2 = S::addDouble(S::sub(y0, S::and_(j2, one)), 2.0f * G3);
+	const F z2 = S::addDouble(S::sub(z0, S::and_(k2, one)), 2.0f * G3);
+	const F x3 = S::addDouble(S::sub(x0, one), 3.0f * G3);
+	const F y3 = S::addDouble(S::sub(y0, one), 3.0f * G3);
+	const F z3 = S::addDouble(S::sub(z0, one), 3.0f * G3);
+
+	alignas(32) int32_t is[S::Lanes], js[S::Lanes], ks[S::Lanes];
+	alignas(32) int32_t i1s[S::Lanes], j1s[S::Lanes], k1s[S::Lanes], i2s[S::Lanes], j2s[S::Lanes], k2s[S::Lanes];
+	S::storei(is, i);
+	S::storei(js, j);
+	S::storei(ks, k);
+	S::storei(i1s, S::asInt(i1));
+	S::storei(j1s, S::asInt(j1));
+	S::storei(k1s, S::asInt(k1));
+	S::storei(i2s, S::asInt(i2));
+	S::storei(j2s, S::asInt(j2));
+	S::storei(k2s, S::asInt(k2));
+	alignas(32) int32_t gi0[S::Lanes], gi1[S::Lanes], gi2[S::Lanes], gi3[S::Lanes];
+	for (int l = 0; l < S::Lanes; ++l) {
+		const int ii = is[l] & 0xff;
+		const int jj = js[l] & 0xff;
+		const int kk = ks[l] & 0xff;
+		// the masks are either 0 or -1
+		gi0[l] = perm[ii + perm[jj + perm[kk]]];
+		gi1[l] = perm[ii - i1s[l] + perm[jj - j1s[l] + perm[kk - k1s[l]]]];
+		gi2[l] = perm[ii - i2s[l] + perm[jj - j2s[l] + perm[kk - k2s[l]]]];
+		gi3[l] = perm[ii + 1 + perm[jj + 1 + perm[kk + 1]]];
+	}
+
+	const F c = S::set1(0.6f);
+	const F t0 = S::sub(S::sub(S::sub(c, S::mul(x0, x0)), S::mul(y0, y0)), S::mul(z0, z0));
+	const F t1 = S::sub(S::sub(S::sub(c, S::mul(x1, x1)), S::mul(y1, y1)), S::mul(z1, z1));
+	const F t2 = S::sub(S::sub(S::sub(c, S::mul(x2, x2)), S::mul(y2, y2)), S::mul(z2, z2));
+	const F t3 = S::sub(S::sub(S::sub(c, S::mul(x3, x3)), S::mul(y3, y3)), S::mul(z3, z3));
+	const F n0 = contribution<S>(t0, grad<S>(S::loadi(gi0), x0, y0, z0));
+	const F n1 = contribution<S>(t1, grad<S>(S::loadi(gi1), x1, y1, z1));
+	const F n2 = contribution<S>(t2, grad<S>(S::loadi(gi2), x2, y2, z2));
+	const F n3 = contribution<S>(t3, grad<S>(S::loadi(gi3), x3, y3, z3));
+	return S::mul(S::set1(32.0f), S::add(S::add(S::add(n0, n1), n2), n3));
+}
+
+template<class S>
+typename S::F fBm(typename S::F x, typename S::F y, const Params &params) {
+	typename S::F sum = S::zero();
+	float freq = 1.0f;
+	float amp = 0.5f;
+	for (uint8_t i = 0; i < params.octaves; ++i) {
+		const typename S::F f = S::set1(freq);
+		const typename S::F n = noise<S>(S::mul(x, f), S::mul(y, f), params.perm);
+		sum = S::add(sum, S::mul(n, S::set1(amp)));
+		freq *= params.lacunarity;
+		amp *= params.gain;
+	}
+	return sum;
+}
+
+template<class S>
+typename S::F fBm(typename S::F x, typename S::F y, typename S::F z, const Params &params) {
+	typename S::F sum = S::zero();
+	float freq = 1.0f;
+	float amp = 0.5f;
+	for (uint8_t i = 0; i < params.octaves; ++i) {
+		const typename S::F f = S::set1(freq);
+		const typename S::F n = noise<S>(S::mul(x, f), S::mul(y, f), S::mul(z, f), params.perm);
+		sum = S::add(sum, S::mul(n, S::set1(amp)));
+		freq *= params.lacunarity;
+		amp *= params.gain;
+	}
+	return sum;
+}
+
+template<class S>
+void store(float *out, typename S::F v, int count) {
+	if (count == S::Lanes) {
+		S::storeu(out, v);
+		return;
+	}
+	alignas(32) float lanes[S::Lanes];
+	S::store(lanes, v);
+	for (int l = 0; l < count; ++l) {
+		out[l] = lanes[l];
+	}
+}
+
+/**
+ * @param in The positions with @c components floats each
+ */
+template<class S>
+void fBmArray(const float *in, int components, float *out, size_t n, const Params &params) {
+	alignas(32) float lanes[3][S::Lanes];
+	for (size_t i = 0u; i < n; i += S::Lanes) {
+		const int count = n - i < (size_t)S::Lanes ? (int)(n - i) : S::Lanes;
+		for (int l = 0; l < S::Lanes; ++l) {
+			// the last batch is padded with the last position
+			const float *pos = in + (i + (l < count ? l : count - 1)) * components;
+			for (int c = 0; c < components; ++c) {
+				lanes[c][l] = pos[c];
+			}
+		}
+		if (components == 2) {
+			store<S>(out + i, fBm<S>(S::load(lanes[0]), S::load(lanes[1]), params), count);
+		} else {
+			store<S>(out + i, fBm<S>(S::load(lanes[0]), S::load(lanes[1]), S::load(lanes[2]), params), count);
+		}
+	}
+}
+
+template<class S>
+typename S::F gridCoordinates(int start, float origin, float step) {
+	return S::add(S::set1(origin), S::mul(S::toFloat(S::addi(S::set1i(start), S::iota())), S::set1(step)));
+}
+
+template<class S>
+void fBmGrid(const float *origin, const float *step, int width, int height, float *out, const Params &params) {
+	for (int y = 0; y < height; ++y) {
+		const typename S::F vy = S::set1(origin[1] + (float)y * step[1]);
+		for (int x = 0; x < width; x += S::Lanes) {
+			const int count = width - x < S::Lanes ? width - x : S::Lanes;
+			store<S>(out + x, fBm<S>(gridCoordinates<S>(x, origin[0], step[0]), vy, params), count);
+		}
+		out += width;
+	}
+}
+
+template<class S>
+void fBmGrid(const float *origin, const float *step, int width, int height, int depth, float *out, const Params &params) {
+	for (int z = 0; z < depth; ++z) {
+		const typename S::F vz = S::set1(origin[2] + (float)z * step[2]);
+		for (int y = 0; y < height; ++y) {
+			const typename S::F vy = S::set1(origin[1] + (float)y * step[1]);
+			for (int x = 0; x < width; x += S::Lanes) {
+				const int count = width - x < S::Lanes ? width - x : S::Lanes;
+				store<S>(out + x, fBm<S>(gridCoordinates<S>(x, origin[0], step[0]), vy, vz, params), count);
+			}
+			out += width;
+		}
+	}
+}
+
+#ifdef SIMPLEX_AVX2
+void fBmArrayAVX2(const float *in, int components, float *out, size_t n, const Params &params);
+void fBmGridAVX2(const float *origin, const float *step, int width, int height, float *out, const Params &params);
+void fBmGridAVX2(const float *origin, const float *step, int width, int height, int depth, float *out, const Params &params);
+#endif
+
+}
+}
@@ -0,0 +1,82 @@
+/**
+ * @file
+ *
+ * This translation unit is compiled with avx2 support - it's only called if the cpu supports it. Don't include
+ * any header here that might emit inline functions that are shared with other translation units.
+ */
+
+#include "SimplexBatch.h"
+#include <immintrin.h>
+
+namespace noise {
+namespace batch {
+
+namespace {
+struct AVX2 {
+	using F = __m256;
+	using I = __m256i;
+	static constexpr int Lanes = 8;
+
+	static inline F zero() { return _mm256_setzero_ps(); }
+	static inline F set1(float v) { return _mm256_set1_ps(v); }
+	static inline F load(const float *v) { return _mm256_load_ps(v); }
+	static inline void store(float *out, F v) { _mm256_store_ps(out, v); }
+	static inline void storeu(float *out, F v) { _mm256_storeu_ps(out, v); }
+	static inline F add(F a, F b) { return _mm256_add_ps(a, b); }
+	static inline F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+	static inline F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+	static inline F and_(F a, F b) { return _mm256_and_ps(a, b); }
+	static inline F andnot(F a, F b) { return _mm256_andnot_ps(a, b); }
+	static inline F or_(F a, F b) { return _mm256_or_ps(a, b); }
+	static inline F xor_(F a, F b) { return _mm256_xor_ps(a, b); }
+	static inline F gt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	static inline F ge(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	static inline F lt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static inline F ngt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_NGT_UQ); }
+
+	// (float)((double)v * d) for each lane
+	static inline F mulDouble(F v, double d) {
+		const __m256d dd = _mm256_set1_pd(d);
+		const __m256d lo = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(v)), dd);
+		const __m256d hi = _mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)), dd);
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)), _mm256_cvtpd_ps(hi), 1);
+	}
+
+	// (float)((double)v + d) for each lane
+	static inline F addDouble(F v, double d) {
+		const __m256d dd = _mm256_set1_pd(d);
+		const __m256d lo = _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(v)), dd);
+		const __m256d hi = _mm256_add_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)), dd);
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(lo)), _mm256_cvtpd_ps(hi), 1);
+	}
+
+	static inline I set1i(int v) { return _mm256_set1_epi32(v); }
+	static inline I iota() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+	static inline I loadi(const int32_t *v) { return _mm256_load_si256((const __m256i*)v); }
+	static inline void storei(int32_t *out, I v) { _mm256_store_si256((__m256i*)out, v); }
+	static inline I addi(I a, I b) { return _mm256_add_epi32(a, b); }
+	static inline I andi(I a, I b) { return _mm256_and_si256(a, b); }
+	static inline I ori(I a, I b) { return _mm256_or_si256(a, b); }
+	static inline I eqi(I a, I b) { return _mm256_cmpeq_epi32(a, b); }
+	static inline I lti(I a, I b) { return _mm256_cmpgt_epi32(b, a); }
+	static inline F toFloat(I v) { return _mm256_cvtepi32_ps(v); }
+	static inline I truncate(F v) { return _mm256_cvttps_epi32(v); }
+	static inline F asFloat(I v) { return _mm256_castsi256_ps(v); }
+	static inline I asInt(F v) { return _mm256_castps_si256(v); }
+};
+}
+
+void fBmArrayAVX2(const float *in, int components, float *out, size_t n, const Params &params) {
+	fBmArray<AVX2>(in, components, out, n, params);
+}
+
+void fBmGridAVX2(const float *origin, const float *step, int width, int height, float *out, const Params &params) {
+	fBmGrid<AVX2>(origin, step, width, height, out, params);
+}
+
+void fBmGridAVX2(const float *origin, const float *step, int width, int height, int depth, float *out, const Params &params) {
+	fBmGrid<AVX2>(origin, step, width, height, depth, out, params);
+}
+
+}
+}
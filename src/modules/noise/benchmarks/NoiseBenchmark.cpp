@@ -0,0 +1,110 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "noise/Simplex.h"
+#include <vector>
+
+/**
+ * Compares the single point fBm functions with the batched and the grid versions. All of them compute the same
+ * values for a grid of @c state.range(0) * @c state.range(0) positions.
+ */
+class NoiseBenchmark: public app::AbstractBenchmark {
+protected:
+	const uint8_t _octaves = 4;
+	const float _lacunarity = 2.0f;
+	const float _gain = 0.5f;
+	const float _step = 0.013f;
+};
+
+BENCHMARK_DEFINE_F(NoiseBenchmark, fBm2DScalar) (benchmark::State& state) {
+	const int size = (int)state.range(0);
+	std::vector<float> out(size * size);
+	for (auto _ : state) {
+		float *o = out.data();
+		for (int y = 0; y < size; ++y) {
+			for (int x = 0; x < size; ++x) {
+				*o++ = noise::fBm(glm::vec2((float)x * _step, (float)y * _step), _octaves, _lacunarity, _gain);
+			}
+		}
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+BENCHMARK_DEFINE_F(NoiseBenchmark, fBm2DBatch) (benchmark::State& state) {
+	const int size = (int)state.range(0);
+	std::vector<glm::vec2> positions(size * size);
+	for (int y = 0; y < size; ++y) {
+		for (int x = 0; x < size; ++x) {
+			positions[y * size + x] = glm::vec2((float)x * _step, (float)y * _step);
+		}
+	}
+	std::vector<float> out(size * size);
+	for (auto _ : state) {
+		noise::fBm(positions.data(), out.data(), out.size(), _octaves, _lacunarity, _gain);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+BENCHMARK_DEFINE_F(NoiseBenchmark, fBm2DGrid) (benchmark::State& state) {
+	const int size = (int)state.range(0);
+	std::vector<float> out(size * size);
+	for (auto _ : state) {
+		noise::fBmGrid(glm::vec2(0.0f), glm::vec2(_step), size, size, out.data(), _octaves, _lacunarity, _gain);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+BENCHMARK_DEFINE_F(NoiseBenchmark, fBm3DScalar) (benchmark::State& state) {
+	const int size = (int)state.range(0);
+	std::vector<float> out(size * size);
+	for (auto _ : state) {
+		float *o = out.data();
+		for (int y = 0; y < size; ++y) {
+			for (int x = 0; x < size; ++x) {
+				*o++ = noise::fBm(glm::vec3((float)x * _step, (float)y * _step, 0.5f), _octaves, _lacunarity, _gain);
+			}
+		}
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+BENCHMARK_DEFINE_F(NoiseBenchmark, fBm3DBatch) (benchmark::State& state) {
+	const int size = (int)state.range(0);
+	std::vector<glm::vec3> positions(size * size);
+	for (int y = 0; y < size; ++y) {
+		for (int x = 0; x < size; ++x) {
+			positions[y * size + x] = glm::vec3((float)x * _step, (float)y * _step, 0.5f);
+		}
+	}
+	std::vector<float> out(size * size);
+	for (auto _ : state) {
+		noise::fBm(positions.data(), out.data(), out.size(), _octaves, _lacunarity, _gain);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+BENCHMARK_DEFINE_F(NoiseBenchmark, fBm3DGrid) (benchmark::State& state) {
+	const int size = (int)state.range(0);
+	std::vector<float> out(size * size);
+	for (auto _ : state) {
+		noise::fBmGrid(glm::vec3(0.0f, 0.0f, 0.5f), glm::vec3(_step), size, size, 1, out.data(), _octaves, _lacunarity, _gain);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * size * size);
+}
+
+BENCHMARK_REGISTER_F(NoiseBenchmark, fBm2DScalar)->RangeMultiplier(4)->Range(16, 256);
+BENCHMARK_REGISTER_F(NoiseBenchmark, fBm2DBatch)->RangeMultiplier(4)->Range(16, 256);
+BENCHMARK_REGISTER_F(NoiseBenchmark, fBm2DGrid)->RangeMultiplier(4)->Range(16, 256);
+BENCHMARK_REGISTER_F(NoiseBenchmark, fBm3DScalar)->RangeMultiplier(4)->Range(16, 256);
+BENCHMARK_REGISTER_F(NoiseBenchmark, fBm3DBatch)->RangeMultiplier(4)->Range(16, 256);
+BENCHMARK_REGISTER_F(NoiseBenchmark, fBm3DGrid)->RangeMultiplier(4)->Range(16, 256);
+
+BENCHMARK_MAIN();
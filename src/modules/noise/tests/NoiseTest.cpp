@@ -5,6 +5,7 @@
 #include "app/tests/AbstractTest.h"
 #include "compute/Compute.h"
 #include "noise/Noise.h"
+#include "noise/Simplex.h"
 #include "image/Image.h"
 #include "core/GLM.h"
 #include "core/StringUtil.h"
@@ -52,4 +53,63 @@ TEST_F(NoiseTest, testSeamlessNoiseCPU) {
 	seamlessNoise(false);
 }
 
+TEST_F(NoiseTest, testBatchfBm2D) {
+	const int n = 1023;
+	glm::vec2 positions[n];
+	for (int i = 0; i < n; ++i) {
+		positions[i] = glm::vec2((i - n / 2) * 0.173f, (i % 37) * -1.37f + 0.5f);
+	}
+	float batch[n];
+	noise::fBm(positions, batch, n, 5, 2.1f, 0.45f);
+	for (int i = 0; i < n; ++i) {
+		ASSERT_EQ(noise::fBm(positions[i], 5, 2.1f, 0.45f), batch[i]) << "Mismatch for " << positions[i].x << ":" << positions[i].y;
+	}
+}
+
+TEST_F(NoiseTest, testBatchfBm3D) {
+	const int n = 1023;
+	glm::vec3 positions[n];
+	for (int i = 0; i < n; ++i) {
+		positions[i] = glm::vec3((i - n / 2) * 0.173f, (float)(i % 64 - 32), (i % 37) * -1.37f + 0.5f);
+	}
+	float batch[n];
+	noise::fBm(positions, batch, n, 3, 2.0f, 0.5f);
+	for (int i = 0; i < n; ++i) {
+		ASSERT_EQ(noise::fBm(positions[i], 3, 2.0f, 0.5f), batch[i]) << "Mismatch for " << positions[i].x << ":" << positions[i].y << ":" << positions[i].z;
+	}
+}
+
+TEST_F(NoiseTest, testGridfBm2D) {
+	const int width = 37;
+	const int height = 5;
+	const glm::vec2 origin(-10.5f, 3.25f);
+	const glm::vec2 step(0.31f, 0.17f);
+	float grid[width * height];
+	noise::fBmGrid(origin, step, width, height, grid, 4, 2.0f, 0.5f);
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			const glm::vec2 pos(origin.x + (float)x * step.x, origin.y + (float)y * step.y);
+			ASSERT_EQ(noise::fBm(pos, 4, 2.0f, 0.5f), grid[y * width + x]) << "Mismatch for " << x << ":" << y;
+		}
+	}
+}
+
+TEST_F(NoiseTest, testGridfBm3D) {
+	const int width = 13;
+	const int height = 4;
+	const int depth = 3;
+	const glm::vec3 origin(-2.0f, 0.0f, 7.5f);
+	const glm::vec3 step(0.5f, 1.0f, 0.25f);
+	float grid[width * height * depth];
+	noise::fBmGrid(origin, step, width, height, depth, grid, 2, 2.0f, 0.5f);
+	for (int z = 0; z < depth; ++z) {
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; ++x) {
+				const glm::vec3 pos(origin.x + (float)x * step.x, origin.y + (float)y * step.y, origin.z + (float)z * step.z);
+				ASSERT_EQ(noise::fBm(pos, 2, 2.0f, 0.5f), grid[(z * height + y) * width + x]) << "Mismatch for " << x << ":" << y << ":" << z;
+			}
+		}
+	}
+}
+
 }
@@ -312,6 +312,7 @@ extern void uploadTexture(video::TextureType type, video::TextureFormat format,
 extern void drawElements(Primitive mode, size_t numIndices, DataType type, void* offset = nullptr);
 extern void drawElementsInstanced(Primitive mode, size_t numIndices, DataType type, size_t amount);
 extern void drawElementsBaseVertex(Primitive mode, size_t numIndices, DataType type, size_t indexSize, int baseIndex, int baseVertex);
+extern void drawElementsInstancedBaseVertex(Primitive mode, size_t numIndices, DataType type, size_t indexSize, int baseIndex, int baseVertex, size_t amount);
 /**
  * @sa IndirectDrawBuffer
  * @sa DrawElementsIndirectCommand
@@ -381,6 +382,11 @@ inline void drawElementsBaseVertex(Primitive mode, size_t numIndices, int baseIn
 	drawElementsBaseVertex(mode, numIndices, mapType<IndexType>(), sizeof(IndexType), baseIndex, baseVertex);
 }
 
+template<class IndexType>
+inline void drawElementsInstancedBaseVertex(Primitive mode, size_t numIndices, int baseIndex, int baseVertex, size_t amount) {
+	drawElementsInstancedBaseVertex(mode, numIndices, mapType<IndexType>(), sizeof(IndexType), baseIndex, baseVertex, amount);
+}
+
 inline bool hasFeature(Feature feature) {
 	return renderState().supports(feature);
 }
@@ -1628,6 +1628,22 @@ void drawElementsBaseVertex(Primitive mode, size_t numIndices, DataType type, si
 	checkError();
 }
 
+void drawElementsInstancedBaseVertex(Primitive mode, size_t numIndices, DataType type, size_t indexSize, int baseIndex, int baseVertex, size_t amount) {
+	video_trace_scoped(DrawElementsInstancedBaseVertex);
+	if (numIndices <= 0) {
+		return;
+	}
+	if (amount <= 0) {
+		return;
+	}
+	const GLenum glMode = _priv::Primitives[core::enumVal(mode)];
+	const GLenum glType = _priv::DataTypes[core::enumVal(type)];
+	core_assert_msg(_priv::s.vertexArrayHandle != InvalidId, "No vertex buffer is bound for this draw call");
+	video::validate(_priv::s.programHandle);
+	glDrawElementsInstancedBaseVertex(glMode, (GLsizei)numIndices, glType, GL_OFFSET_CAST(indexSize * baseIndex), (GLsizei)amount, (GLint)baseVertex);
+	checkError();
+}
+
 void drawArrays(Primitive mode, size_t count) {
 	video_trace_scoped(DrawArrays);
 	const GLenum glMode = _priv::Primitives[core::enumVal(mode)];
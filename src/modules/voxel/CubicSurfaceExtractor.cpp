@@ -3,7 +3,9 @@
  */
 
 #include "CubicSurfaceExtractor.h"
+#include "core/Bits.h"
 #include "core/Common.h"
+#include <glm/vector_relational.hpp>
 
 namespace voxel {
 
@@ -67,6 +69,8 @@ static bool mergeQuads(Quad& q1, Quad& q2, Mesh* meshCurrent, FUNC&& equal) {
 	return false;
 }
 
+static const IndexType MergedQuad = (std::numeric_limits<IndexType>::max)();
+
 static bool performQuadMerging(QuadList& quads, Mesh* meshCurrent, bool ambientOcclusion) {
 	core_trace_scoped(PerformQuadMerging);
 	bool didMerge = false;
@@ -76,22 +80,34 @@ static bool performQuadMerging(QuadList& quads, Mesh* meshCurrent, bool ambientO
 		equal = isSameColor;
 	}
 
-	for (QuadList::iterator outerIter = quads.begin(); outerIter != quads.end(); ++outerIter) {
-		QuadList::iterator innerIter = outerIter;
-		++innerIter;
-		while (innerIter != quads.end()) {
-			Quad& q1 = *outerIter;
-			Quad& q2 = *innerIter;
-
-			const bool result = mergeQuads(q1, q2, meshCurrent, equal);
+	// merged quads are flagged and removed after the pass to keep the memory of the list
+	const size_t n = quads.size();
+	for (size_t outer = 0; outer < n; ++outer) {
+		Quad& q1 = quads[outer];
+		if (q1.vertices[0] == MergedQuad) {
+			continue;
+		}
+		for (size_t inner = outer + 1; inner < n; ++inner) {
+			Quad& q2 = quads[inner];
+			if (q2.vertices[0] == MergedQuad) {
+				continue;
+			}
 
-			if (result) {
+			if (mergeQuads(q1, q2, meshCurrent, equal)) {
 				didMerge = true;
-				innerIter = quads.erase(innerIter);
-			} else {
-				++innerIter;
+				q2.vertices[0] = MergedQuad;
+			}
+		}
+	}
+
+	if (didMerge) {
+		size_t remaining = 0;
+		for (size_t i = 0; i < n; ++i) {
+			if (quads[i].vertices[0] != MergedQuad) {
+				quads[remaining++] = quads[i];
 			}
 		}
+		quads.erase(quads.begin() + remaining, quads.end());
 	}
 
 	return didMerge;
@@ -189,4 +205,261 @@ IndexType addVertex(bool reuseVertices, uint32_t x, uint32_t y, uint32_t z, cons
 	return 0; //Should never happen.
 }
 
+static inline bool isOpaque(VoxelType material) {
+	return !isAir(material) && !isTransparent(material);
+}
+
+/**
+ * @brief Setup of one face direction for the binary greedy mesher
+ */
+struct BinaryFaceDirection {
+	/** the axis that the face normal is pointing along */
+	int axis;
+	/** the tangent that is stored as bits in the face masks */
+	int u;
+	/** the tangent that selects the row of the face masks */
+	int v;
+	/** -1 for the negative faces, 1 for the positive faces */
+	int sign;
+	/** the quad corners in (u, v) - the order matches the quads of @c extractCubicMesh() */
+	uint8_t corners[4][2];
+};
+
+static const BinaryFaceDirection BinaryFaceDirections[] = {
+	{0, 2, 1, -1, {{0, 0}, {1, 0}, {1, 1}, {0, 1}}}, // NegativeX
+	{0, 2, 1,  1, {{0, 0}, {0, 1}, {1, 1}, {1, 0}}}, // PositiveX
+	{1, 0, 2, -1, {{0, 0}, {1, 0}, {1, 1}, {0, 1}}}, // NegativeY
+	{1, 0, 2,  1, {{0, 0}, {0, 1}, {1, 1}, {1, 0}}}, // PositiveY
+	{2, 0, 1, -1, {{0, 0}, {0, 1}, {1, 1}, {1, 0}}}, // NegativeZ
+	{2, 0, 1,  1, {{0, 0}, {1, 0}, {1, 1}, {0, 1}}}  // PositiveZ
+};
+
+/**
+ * @brief Greedy merges the faces of one direction of a @c BinaryMeshTile
+ *
+ * A face is identified by a key that contains the color, the flags and the ambient occlusion values
+ * of the four corners - faces are only merged if their keys are equal.
+ */
+class BinaryTileMesher {
+private:
+	static constexpr int ColorMask = 0xFF;
+	static constexpr int FlagsShift = 8;
+	static constexpr int AmbientOcclusionShift = 11;
+	/** no occlusion on any of the four corners */
+	static constexpr uint32_t NoAmbientOcclusion = 0xFFu << AmbientOcclusionShift;
+
+	BinaryMeshTile& _tile;
+	const BinaryFaceDirection& _dir;
+	Mesh* _result;
+	const glm::ivec3 _offset;
+	const bool _mergeQuads;
+	const bool _ambientOcclusion;
+
+	static inline int cornerShift(int su, int sv) {
+		return AmbientOcclusionShift + 2 * (su + 2 * sv);
+	}
+
+	static inline uint8_t cornerAmbientOcclusion(uint32_t key, int su, int sv) {
+		return (key >> cornerShift(su, sv)) & 3u;
+	}
+
+	/**
+	 * @return @c true if the ambient occlusion doesn't change along the u tangent and thus the face can be stretched along it
+	 */
+	static inline bool isConstantAlongU(uint32_t key) {
+		return cornerAmbientOcclusion(key, 0, 0) == cornerAmbientOcclusion(key, 1, 0)
+			&& cornerAmbientOcclusion(key, 0, 1) == cornerAmbientOcclusion(key, 1, 1);
+	}
+
+	static inline bool isConstantAlongV(uint32_t key) {
+		return cornerAmbientOcclusion(key, 0, 0) == cornerAmbientOcclusion(key, 0, 1)
+			&& cornerAmbientOcclusion(key, 1, 0) == cornerAmbientOcclusion(key, 1, 1);
+	}
+
+	inline bool isOpaque(const glm::ivec3& pos) const {
+		return (_tile.columns[1][pos.z * _tile.size.x + pos.x] >> pos.y) & 1u;
+	}
+
+	uint32_t faceKey(int layer, int u, int v) const {
+		glm::ivec3 pos;
+		pos[_dir.axis] = layer;
+		pos[_dir.u] = u;
+		pos[_dir.v] = v;
+		const Voxel& voxel = _tile.voxels[(pos.z * _tile.size.x + pos.x) * _tile.size.y + pos.y];
+		const uint32_t key = voxel.getColor() | (voxel.getFlags() << FlagsShift);
+		if (!_ambientOcclusion) {
+			return key | NoAmbientOcclusion;
+		}
+		// the ambient occlusion is calculated from the voxels around the one in front of the face
+		pos[_dir.axis] += _dir.sign;
+		bool neighbours[3][3];
+		for (int du = -1; du <= 1; ++du) {
+			for (int dv = -1; dv <= 1; ++dv) {
+				glm::ivec3 neighbour = pos;
+				neighbour[_dir.u] += du;
+				neighbour[_dir.v] += dv;
+				neighbours[du + 1][dv + 1] = isOpaque(neighbour);
+			}
+		}
+		uint32_t ao = 0u;
+		for (int su = 0; su <= 1; ++su) {
+			for (int sv = 0; sv <= 1; ++sv) {
+				const int du = su * 2;
+				const int dv = sv * 2;
+				ao |= (uint32_t)vertexAmbientOcclusion(neighbours[du][1], neighbours[1][dv], neighbours[du][dv]) << cornerShift(su, sv);
+			}
+		}
+		return key | ao;
+	}
+
+	void addQuad(int layer, int u, int v, int width, int height, uint32_t key) {
+		glm::ivec3 base;
+		// the tile coordinates include the border voxel - the negative faces are on the lower side of the voxel
+		base[_dir.axis] = _dir.sign < 0 ? layer - 1 : layer;
+		base[_dir.u] = u - 1;
+		base[_dir.v] = v - 1;
+		base += _offset;
+
+		IndexType indices[4];
+		uint8_t ao[4];
+		for (int i = 0; i < 4; ++i) {
+			const int su = _dir.corners[i][0];
+			const int sv = _dir.corners[i][1];
+			glm::ivec3 pos = base;
+			pos[_dir.u] += su * width;
+			pos[_dir.v] += sv * height;
+			VoxelVertex vertex;
+			vertex.position = pos;
+			vertex.colorIndex = key & ColorMask;
+			vertex.ambientOcclusion = ao[i] = cornerAmbientOcclusion(key, su, sv);
+			vertex.flags = (key >> FlagsShift) & 7u;
+			vertex.padding = 0u;
+			indices[i] = _result->addVertex(vertex);
+		}
+
+		// same triangulation as in meshify()
+		if (ao[3] + ao[1] > ao[0] + ao[2]) {
+			_result->addTriangle(indices[1], indices[2], indices[3]);
+			_result->addTriangle(indices[1], indices[3], indices[0]);
+		} else {
+			_result->addTriangle(indices[0], indices[1], indices[2]);
+			_result->addTriangle(indices[0], indices[2], indices[3]);
+		}
+	}
+
+public:
+	BinaryTileMesher(BinaryMeshTile& tile, const BinaryFaceDirection& dir, Mesh* result, const glm::ivec3& offset,
+			bool mergeQuads, bool ambientOcclusion) :
+			_tile(tile), _dir(dir), _result(result), _offset(offset), _mergeQuads(mergeQuads), _ambientOcclusion(ambientOcclusion) {
+	}
+
+	void meshify() {
+		const int layers = _tile.size[_dir.axis];
+		const int sizeU = _tile.size[_dir.u];
+		const int sizeV = _tile.size[_dir.v];
+		const uint64_t* columns = _tile.columns[_dir.axis].data();
+		_tile.faces.assign((size_t)layers * sizeV, 0u);
+		uint64_t* faces = _tile.faces.data();
+
+		{
+			core_trace_scoped(CullFaces);
+			// the faces on the lower border belong to this region - the faces on the upper border don't
+			const uint64_t interior = (1ull << (layers - 2)) - 1ull;
+			const uint64_t visibleMask = _dir.sign < 0 ? interior << 1 : interior;
+			for (int v = 1; v < sizeV - 1; ++v) {
+				for (int u = 1; u < sizeU - 1; ++u) {
+					const uint64_t column = columns[v * sizeU + u];
+					const uint64_t front = _dir.sign < 0 ? column << 1 : column >> 1;
+					uint64_t visible = column & ~front & visibleMask;
+					while (visible != 0u) {
+						const int layer = core::countTrailingZeros(visible);
+						faces[layer * sizeV + v] |= 1ull << u;
+						visible &= visible - 1u;
+					}
+				}
+			}
+		}
+
+		core_trace_scoped(MergeFaces);
+		for (int layer = 0; layer < layers; ++layer) {
+			uint64_t* rows = &faces[layer * sizeV];
+			for (int v = 1; v < sizeV - 1; ++v) {
+				while (rows[v] != 0u) {
+					const int u = core::countTrailingZeros(rows[v]);
+					const uint32_t key = faceKey(layer, u, v);
+					int width = 1;
+					if (_mergeQuads && isConstantAlongU(key)) {
+						// the border bit is never set - so this stops before the end of the mask
+						while (((rows[v] >> (u + width)) & 1u) && faceKey(layer, u + width, v) == key) {
+							++width;
+						}
+					}
+					const uint64_t run = ((1ull << width) - 1ull) << u;
+					rows[v] &= ~run;
+
+					int height = 1;
+					if (_mergeQuads && isConstantAlongV(key)) {
+						for (int nextV = v + 1; nextV < sizeV - 1; ++nextV) {
+							if ((rows[nextV] & run) != run) {
+								break;
+							}
+							bool same = true;
+							for (int i = 0; i < width; ++i) {
+								if (faceKey(layer, u + i, nextV) != key) {
+									same = false;
+									break;
+								}
+							}
+							if (!same) {
+								break;
+							}
+							rows[nextV] &= ~run;
+							++height;
+						}
+					}
+					addQuad(layer, u, v, width, height, key);
+				}
+			}
+		}
+	}
+};
+
+void meshifyBinaryTile(BinaryMeshTile& tile, const glm::ivec3& tileOffset, Mesh* result, bool mergeQuads, bool ambientOcclusion, const glm::ivec3& translate) {
+	core_trace_scoped(MeshifyBinaryTile);
+	const glm::ivec3& size = tile.size;
+	core_assert(glm::all(glm::lessThanEqual(size, glm::ivec3(BinaryMeshTileSize + 2))));
+	// x: (y, z) - y: (z, x) - z: (y, x) - the last one is the fastest changing coordinate
+	tile.columns[0].assign((size_t)size.y * size.z, 0u);
+	tile.columns[1].assign((size_t)size.z * size.x, 0u);
+	tile.columns[2].assign((size_t)size.y * size.x, 0u);
+	uint64_t* columnsX = tile.columns[0].data();
+	uint64_t* columnsY = tile.columns[1].data();
+	uint64_t* columnsZ = tile.columns[2].data();
+
+	{
+		core_trace_scoped(BuildColumns);
+		const Voxel* voxels = tile.voxels.data();
+		for (int z = 0; z < size.z; ++z) {
+			for (int x = 0; x < size.x; ++x) {
+				uint64_t column = 0u;
+				for (int y = 0; y < size.y; ++y, ++voxels) {
+					if (!isOpaque(voxels->getMaterial())) {
+						continue;
+					}
+					column |= 1ull << y;
+					columnsX[y * size.z + z] |= 1ull << x;
+					columnsZ[y * size.x + x] |= 1ull << z;
+				}
+				columnsY[z * size.x + x] = column;
+			}
+		}
+	}
+
+	const glm::ivec3 offset = tileOffset + translate;
+	for (const BinaryFaceDirection& dir : BinaryFaceDirections) {
+		BinaryTileMesher mesher(tile, dir, result, offset, mergeQuads, ambientOcclusion);
+		mesher.meshify();
+	}
+}
+
 }
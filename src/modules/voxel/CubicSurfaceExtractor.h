@@ -5,6 +5,7 @@
 #pragma once
 
 #include "Mesh.h"
+#include "PackedMesh.h"
 #include "Voxel.h"
 #include "VoxelVertex.h"
 #include "core/Common.h"
@@ -16,8 +17,8 @@
 #include "core/Trace.h"
 #include "Face.h"
 #include <glm/fwd.hpp>
+#include <glm/common.hpp>
 #include <glm/vec3.hpp>
-#include <list>
 #include <vector>
 
 namespace voxel {
@@ -56,21 +57,39 @@ static_assert(sizeof(VertexData) == 8, "Unexpected size of VertexData");
 
 class Array : public core::NonCopyable {
 private:
-	uint32_t _width;
-	uint32_t _height;
-	uint32_t _depth;
-	VertexData* _elements;
+	uint32_t _width = 0u;
+	uint32_t _height = 0u;
+	uint32_t _depth = 0u;
+	size_t _capacity = 0u;
+	VertexData* _elements = nullptr;
 public:
-	Array(uint32_t width, uint32_t height, uint32_t depth) :
-			_width(width), _height(height), _depth(depth) {
-		_elements = (VertexData*)core_malloc(width * height * depth * sizeof(VertexData));
-		clear();
+	Array() {
+	}
+
+	Array(uint32_t width, uint32_t height, uint32_t depth) {
+		resize(width, height, depth);
 	}
 
 	~Array() {
 		core_free(_elements);
 	}
 
+	/**
+	 * @brief Changes the dimensions and clears the array. Memory is only allocated if the array has to grow.
+	 */
+	void resize(uint32_t width, uint32_t height, uint32_t depth) {
+		const size_t size = (size_t)width * height * depth;
+		if (size > _capacity) {
+			core_free(_elements);
+			_elements = (VertexData*)core_malloc(size * sizeof(VertexData));
+			_capacity = size;
+		}
+		_width = width;
+		_height = height;
+		_depth = depth;
+		clear();
+	}
+
 	void clear() {
 		core_memset(_elements, 0x0, _width * _height * _depth * sizeof(VertexData));
 	}
@@ -82,13 +101,15 @@ public:
 
 	void swap(Array& other) {
 		core::exchange(_elements, other._elements);
+		core::exchange(_capacity, other._capacity);
 	}
 };
 
 /**
- * @brief Should be a list because random inserts which we need in @c performQuadMerging are O(1)
+ * @brief A plain array to keep the memory when the lists are cleared and reused. Merged quads are not erased
+ * one by one in @c performQuadMerging but removed in one go after each merge pass.
  */
-typedef std::list<Quad> QuadList;
+typedef std::vector<Quad> QuadList;
 typedef std::vector<QuadList> QuadListVector;
 
 /**
@@ -100,6 +121,71 @@ extern IndexType addVertex(bool reuseVertices, uint32_t x, uint32_t y, uint32_t
 
 extern void meshify(Mesh* result, bool mergeQuads, bool ambientOcclusion, QuadListVector& vecListQuads);
 
+/**
+ * @brief The max amount of voxels per axis that are meshed in one go by @c extractBinaryGreedyMesh(). Together with the
+ * border of one voxel on each side a voxel column along each axis fits into a 64 bit mask.
+ */
+const int BinaryMeshTileSize = 62;
+
+/**
+ * @brief Scratch memory for @c extractBinaryGreedyMesh() - holds the voxels of one tile including the one voxel border
+ * and the opaque voxel bitmasks per axis.
+ */
+struct BinaryMeshTile {
+	/** the size of the tile including the border */
+	glm::ivec3 size { 0 };
+	/** y is the fastest changing coordinate - followed by x and z */
+	std::vector<Voxel> voxels;
+	/** one column bitmask per axis for each position in the plane that is perpendicular to that axis */
+	std::vector<uint64_t> columns[3];
+	/** the visible faces of one direction - one bitmask row per layer and position along the second tangent */
+	std::vector<uint64_t> faces;
+
+	void resize(const glm::ivec3& paddedSize) {
+		size = paddedSize;
+		voxels.resize((size_t)size.x * size.y * size.z);
+	}
+};
+
+/**
+ * @brief Generates the quads for one tile that was filled by @c extractBinaryGreedyMesh()
+ * @param[in] tileOffset The lower corner of the tile (without the border) relative to the extraction region
+ */
+extern void meshifyBinaryTile(BinaryMeshTile& tile, const glm::ivec3& tileOffset, Mesh* result, bool mergeQuads, bool ambientOcclusion, const glm::ivec3& translate);
+
+/**
+ * @brief Reusable memory for the surface extraction
+ *
+ * The extraction needs slice caches for the vertex reuse and lists of quads for each face direction. Keep one instance
+ * per thread alive and hand it to the extraction functions - once the buffers have grown to the size of the extracted
+ * regions the extraction doesn't hit the allocator anymore (except for the given output mesh).
+ */
+struct SurfaceExtractionContext : public core::NonCopyable {
+	Array previousSliceVertices;
+	Array currentSliceVertices;
+	QuadListVector quads[core::enumVal(FaceNames::Max)];
+	BinaryMeshTile binaryTile;
+	/** scratch memory for @c Mesh::removeUnusedVertices() */
+	IndexArray vertexRemap;
+	/** the intermediate mesh for the extraction into a @c PackedMesh */
+	Mesh mesh;
+
+	/**
+	 * @brief Makes sure that there are at least @c amount empty quad lists for the given face
+	 * @note The lists are never shrunk to keep their memory - surplus lists are just empty.
+	 */
+	QuadListVector& prepareQuads(FaceNames face, size_t amount) {
+		QuadListVector& lists = quads[core::enumVal(face)];
+		if (lists.size() < amount) {
+			lists.resize(amount);
+		}
+		for (QuadList& list : lists) {
+			list.clear();
+		}
+		return lists;
+	}
+};
+
 /**
  * The CubicSurfaceExtractor creates a mesh in which each voxel appears to be rendered as a cube
  *
@@ -187,7 +273,7 @@ extern void meshify(Mesh* result, bool mergeQuads, bool ambientOcclusion, QuadLi
  * @li The user could provide a custom mesh class, e.g a thin wrapper around an openGL VBO to allow direct writing into this structure.
  */
 template<typename VolumeType, typename IsQuadNeeded>
-void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, IsQuadNeeded isQuadNeeded, const glm::ivec3& translate, bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true) {
+void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, IsQuadNeeded isQuadNeeded, const glm::ivec3& translate, SurfaceExtractionContext& ctx, bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true) {
 	core_trace_scoped(ExtractCubicMesh);
 
 	result->clear();
@@ -198,24 +284,26 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 	// Used to avoid creating duplicate vertices.
 	const int widthInCells = upper.x - offset.x;
 	const int heightInCells = upper.y - offset.y;
-	Array previousSliceVertices(widthInCells + 2, heightInCells + 2, MaxVerticesPerPosition);
-	Array currentSliceVertices(widthInCells + 2, heightInCells + 2, MaxVerticesPerPosition);
+	Array& previousSliceVertices = ctx.previousSliceVertices;
+	Array& currentSliceVertices = ctx.currentSliceVertices;
+	previousSliceVertices.resize(widthInCells + 2, heightInCells + 2, MaxVerticesPerPosition);
+	currentSliceVertices.resize(widthInCells + 2, heightInCells + 2, MaxVerticesPerPosition);
 
 	// During extraction we create a number of different lists of quads. All the
 	// quads in a given list are in the same plane and facing in the same direction.
-	QuadListVector vecQuads[core::enumVal(FaceNames::Max)];
+	QuadListVector* vecQuads = ctx.quads;
 
 	const int xSize = upper.x - offset.x + 2;
 	const int ySize = upper.y - offset.y + 2;
 	const int zSize = upper.z - offset.z + 2;
-	vecQuads[core::enumVal(FaceNames::NegativeX)].resize(xSize);
-	vecQuads[core::enumVal(FaceNames::PositiveX)].resize(xSize);
+	ctx.prepareQuads(FaceNames::NegativeX, xSize);
+	ctx.prepareQuads(FaceNames::PositiveX, xSize);
 
-	vecQuads[core::enumVal(FaceNames::NegativeY)].resize(ySize);
-	vecQuads[core::enumVal(FaceNames::PositiveY)].resize(ySize);
+	ctx.prepareQuads(FaceNames::NegativeY, ySize);
+	ctx.prepareQuads(FaceNames::PositiveY, ySize);
 
-	vecQuads[core::enumVal(FaceNames::NegativeZ)].resize(zSize);
-	vecQuads[core::enumVal(FaceNames::PositiveZ)].resize(zSize);
+	ctx.prepareQuads(FaceNames::NegativeZ, zSize);
+	ctx.prepareQuads(FaceNames::PositiveZ, zSize);
 
 	typename VolumeType::Sampler volumeSampler(volData);
 
@@ -377,8 +465,10 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 				}
 
 				// Z [F] BEHIND
+				// The face is on the plane between the voxel before and the current voxel. The neighbours that occlude
+				// its corners are in the slice of the current voxel (0pz) - not one slice behind the plane (1pz).
 				if (isQuadNeeded(voxelBeforeMaterial, voxelCurrentMaterial, FaceNames::PositiveZ)) {
-					const VoxelType _voxelRightBehind      = volumeSampler.peekVoxel1px0py1pz().getMaterial();
+					const VoxelType _voxelRightBehind      = volumeSampler.peekVoxel1px0py0pz().getMaterial();
 					const VoxelType _voxelAboveBehind      = volumeSampler.peekVoxel0px1py0pz().getMaterial();
 					const VoxelType _voxelAboveRightBehind = volumeSampler.peekVoxel1px1py0pz().getMaterial();
 					const VoxelType _voxelBelowRightBehind = volumeSampler.peekVoxel1px1ny0pz().getMaterial();
@@ -407,15 +497,113 @@ void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, I
 
 	{
 		core_trace_scoped(GenerateMesh);
-		for (QuadListVector& vecListQuads : vecQuads) {
-			meshify(result, mergeQuads, ambientOcclusion, vecListQuads);
+		for (int face = 0; face < core::enumVal(FaceNames::Max); ++face) {
+			meshify(result, mergeQuads, ambientOcclusion, vecQuads[face]);
 		}
 	}
 
-	result->removeUnusedVertices();
+	result->removeUnusedVertices(ctx.vertexRemap);
 	result->compressIndices();
 }
 
+/**
+ * @brief Convenience overload that allocates the memory for the extraction on each call
+ * @sa SurfaceExtractionContext
+ */
+template<typename VolumeType, typename IsQuadNeeded>
+void extractCubicMesh(VolumeType* volData, const Region& region, Mesh* result, IsQuadNeeded isQuadNeeded, const glm::ivec3& translate, bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true) {
+	SurfaceExtractionContext ctx;
+	extractCubicMesh(volData, region, result, isQuadNeeded, translate, ctx, mergeQuads, reuseVertices, ambientOcclusion);
+}
+
+/**
+ * @brief Extracts the region into a @c PackedMesh
+ * @return @c false if the mesh can't be packed - see @c PackedMesh::pack()
+ */
+template<typename VolumeType, typename IsQuadNeeded>
+bool extractCubicMesh(VolumeType* volData, const Region& region, PackedMesh* result, IsQuadNeeded isQuadNeeded, const glm::ivec3& translate, SurfaceExtractionContext& ctx, bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true) {
+	extractCubicMesh(volData, region, &ctx.mesh, isQuadNeeded, translate, ctx, mergeQuads, reuseVertices, ambientOcclusion);
+	return result->pack(ctx.mesh);
+}
+
+/**
+ * @brief Alternative backend for @c extractCubicMesh() that culls and merges the faces with bit operations
+ *
+ * The region is split into tiles of up to @c BinaryMeshTileSize voxels per axis. The voxels of a tile - plus a border of
+ * one voxel - are sampled only once and converted into 64 bit column masks along each axis. The visible faces are then
+ * found by shifting the columns against themselves and merged per layer by walking the set bits of the face masks.
+ *
+ * The generated mesh uses the same vertex format, winding, ambient occlusion and region boundary rules as
+ * @c extractCubicMesh() with @c IsQuadNeeded. Custom quad predicates are not supported, a face is generated between an
+ * opaque voxel and a voxel that is air or transparent. Quads are only merged if the color, the flags and the ambient
+ * occlusion along the merge direction match - so merging never changes the look of the mesh. Quads are not merged across
+ * tile borders and vertices are not shared between quads.
+ *
+ * @sa extractCubicMesh()
+ */
+template<typename VolumeType>
+void extractBinaryGreedyMesh(VolumeType* volData, const Region& region, Mesh* result, const glm::ivec3& translate, SurfaceExtractionContext& ctx, bool mergeQuads = true, bool ambientOcclusion = true) {
+	core_trace_scoped(ExtractBinaryGreedyMesh);
+
+	result->clear();
+	const glm::ivec3& offset = region.getLowerCorner();
+	const glm::ivec3& upper = region.getUpperCorner();
+	result->setOffset(offset);
+
+	BinaryMeshTile& tile = ctx.binaryTile;
+	typename VolumeType::Sampler volumeSampler(volData);
+
+	for (int32_t tileZ = offset.z; tileZ <= upper.z; tileZ += BinaryMeshTileSize) {
+		for (int32_t tileY = offset.y; tileY <= upper.y; tileY += BinaryMeshTileSize) {
+			for (int32_t tileX = offset.x; tileX <= upper.x; tileX += BinaryMeshTileSize) {
+				const glm::ivec3 tileLower(tileX, tileY, tileZ);
+				const glm::ivec3 tileUpper = glm::min(tileLower + (BinaryMeshTileSize - 1), upper);
+				const glm::ivec3 mins = tileLower - 1;
+				const glm::ivec3 maxs = tileUpper + 1;
+				tile.resize(maxs - mins + 1);
+				{
+					core_trace_scoped(SampleTile);
+					Voxel* voxels = tile.voxels.data();
+					for (int32_t z = mins.z; z <= maxs.z; ++z) {
+						for (int32_t x = mins.x; x <= maxs.x; ++x) {
+							volumeSampler.setPosition(x, mins.y, z);
+							for (int32_t y = mins.y; y <= maxs.y; ++y) {
+								*voxels++ = volumeSampler.voxel();
+								if (core_likely(y != maxs.y)) {
+									volumeSampler.movePositiveY();
+								}
+							}
+						}
+					}
+				}
+				meshifyBinaryTile(tile, tileLower - offset, result, mergeQuads, ambientOcclusion, translate);
+			}
+		}
+	}
+
+	result->compressIndices();
+}
+
+/**
+ * @brief Convenience overload that allocates the memory for the extraction on each call
+ * @sa SurfaceExtractionContext
+ */
+template<typename VolumeType>
+void extractBinaryGreedyMesh(VolumeType* volData, const Region& region, Mesh* result, const glm::ivec3& translate, bool mergeQuads = true, bool ambientOcclusion = true) {
+	SurfaceExtractionContext ctx;
+	extractBinaryGreedyMesh(volData, region, result, translate, ctx, mergeQuads, ambientOcclusion);
+}
+
+/**
+ * @brief Extracts the region into a @c PackedMesh
+ * @return @c false if the mesh can't be packed - see @c PackedMesh::pack()
+ */
+template<typename VolumeType>
+bool extractBinaryGreedyMesh(VolumeType* volData, const Region& region, PackedMesh* result, const glm::ivec3& translate, SurfaceExtractionContext& ctx, bool mergeQuads = true, bool ambientOcclusion = true) {
+	extractBinaryGreedyMesh(volData, region, &ctx.mesh, translate, ctx, mergeQuads, ambientOcclusion);
+	return result->pack(ctx.mesh);
+}
+
 }
 
 #undef BUFFERED_SAMPLER
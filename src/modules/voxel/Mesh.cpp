@@ -7,9 +7,12 @@
 #include "core/Common.h"
 #include "core/Trace.h"
 #include "core/Assert.h"
+#include "core/Log.h"
 #include "util/BufferUtil.h"
 #include <glm/vector_relational.hpp>
 #include <glm/common.hpp>
+#include <math.h>
+#include <unordered_map>
 
 namespace voxel {
 
@@ -167,20 +170,24 @@ IndexType Mesh::addVertex(const VoxelVertex& vertex) {
 }
 
 void Mesh::removeUnusedVertices() {
+	IndexArray newPos;
+	removeUnusedVertices(newPos);
+}
+
+void Mesh::removeUnusedVertices(IndexArray& newPos) {
 	const size_t vertices = _vecVertices.size();
 	const size_t indices = _vecIndices.size();
-	std::vector<bool> isVertexUsed(vertices);
-	std::fill(isVertexUsed.begin(), isVertexUsed.end(), false);
+	const IndexType unused = (std::numeric_limits<IndexType>::max)();
+	newPos.resize(vertices);
+	newPos.fill(unused);
 
 	for (size_t triCt = 0u; triCt < indices; ++triCt) {
-		IndexType v = _vecIndices[triCt];
-		isVertexUsed[v] = true;
+		newPos[_vecIndices[triCt]] = 0u;
 	}
 
-	int noOfUsedVertices = 0;
-	IndexArray newPos(vertices);
+	IndexType noOfUsedVertices = 0;
 	for (size_t vertCt = 0u; vertCt < vertices; ++vertCt) {
-		if (!isVertexUsed[vertCt]) {
+		if (newPos[vertCt] == unused) {
 			continue;
 		}
 		const VoxelVertex& v = _vecVertices[vertCt];
@@ -194,7 +201,6 @@ void Mesh::removeUnusedVertices() {
 	for (size_t triCt = 0u; triCt < indices; ++triCt) {
 		_vecIndices[triCt] = newPos[_vecIndices[triCt]];
 	}
-	_vecIndices.resize(indices);
 }
 
 void Mesh::compressIndices() {
@@ -210,6 +216,361 @@ void Mesh::compressIndices() {
 	util::indexCompress(&_vecIndices.front(), maxSize, _compressedIndexSize, _compressedIndices, maxSize);
 }
 
+bool Mesh::compactIndices(CompactIndexArray& out, SubMeshArray& subMeshes, uint32_t vertexOffset) const {
+	return voxel::compactIndices(_vecIndices.data(), _vecIndices.size(), vertexOffset, out, subMeshes);
+}
+
+static void addSubMesh(const IndexType *indices, size_t start, size_t end, uint32_t baseVertex, uint32_t vertexOffset, CompactIndexArray &out, SubMeshArray &subMeshes) {
+	SubMesh subMesh;
+	subMesh.baseIndex = (uint32_t)out.size();
+	subMesh.numIndices = (uint32_t)(end - start);
+	subMesh.baseVertex = baseVertex + vertexOffset;
+	for (size_t i = start; i < end; ++i) {
+		out.push_back((CompactIndexType)(indices[i] - baseVertex));
+	}
+	subMeshes.push_back(subMesh);
+}
+
+bool compactIndices(const IndexType *indices, size_t numIndices, uint32_t vertexOffset, CompactIndexArray &out, SubMeshArray &subMeshes) {
+	core_trace_scoped(CompactIndices);
+	core_assert_msg(numIndices % 3 == 0, "Expected triangles");
+	const uint32_t maxRange = (std::numeric_limits<CompactIndexType>::max)();
+	const size_t outSize = out.size();
+	const size_t subMeshesSize = subMeshes.size();
+	out.reserve(outSize + numIndices);
+
+	size_t start = 0u;
+	IndexType minIndex = (std::numeric_limits<IndexType>::max)();
+	IndexType maxIndex = 0u;
+	for (size_t i = 0u; i < numIndices; i += 3) {
+		const IndexType triMin = core_min(indices[i], core_min(indices[i + 1], indices[i + 2]));
+		const IndexType triMax = core_max(indices[i], core_max(indices[i + 1], indices[i + 2]));
+		if (triMax - triMin > maxRange) {
+			out.resize(outSize);
+			subMeshes.resize(subMeshesSize);
+			return false;
+		}
+		const IndexType newMin = core_min(minIndex, triMin);
+		const IndexType newMax = core_max(maxIndex, triMax);
+		if (newMax - newMin > maxRange) {
+			addSubMesh(indices, start, i, minIndex, vertexOffset, out, subMeshes);
+			start = i;
+			minIndex = triMin;
+			maxIndex = triMax;
+			continue;
+		}
+		minIndex = newMin;
+		maxIndex = newMax;
+	}
+	if (start < numIndices) {
+		addSubMesh(indices, start, numIndices, minIndex, vertexOffset, out, subMeshes);
+	}
+	return true;
+}
+
+void mergeMeshes(const Mesh* meshes, size_t n, Mesh* result) {
+	core_trace_scoped(MergeMeshes);
+	size_t vertices = 0u;
+	size_t indices = 0u;
+	for (size_t i = 0u; i < n; ++i) {
+		vertices += meshes[i].getNoOfVertices();
+		indices += meshes[i].getNoOfIndices();
+	}
+	VertexArray& vertexVector = result->getVertexVector();
+	IndexArray& indexVector = result->getIndexVector();
+	vertexVector.clear();
+	indexVector.clear();
+	vertexVector.reserve(vertices);
+	indexVector.reserve(indices);
+	for (size_t i = 0u; i < n; ++i) {
+		const Mesh& mesh = meshes[i];
+		const IndexType vertexOffset = (IndexType)vertexVector.size();
+		const size_t indexOffset = indexVector.size();
+		vertexVector.append(mesh.getRawVertexData(), mesh.getNoOfVertices());
+		indexVector.append(mesh.getRawIndexData(), mesh.getNoOfIndices());
+		if (vertexOffset == 0u) {
+			continue;
+		}
+		IndexType* rebase = indexVector.data() + indexOffset;
+		const size_t amount = mesh.getNoOfIndices();
+		for (size_t j = 0u; j < amount; ++j) {
+			rebase[j] += vertexOffset;
+		}
+	}
+}
+
+float averageCacheMissRatio(const IndexType *indices, size_t numIndices, int cacheSize) {
+	if (numIndices < 3u) {
+		return 0.0f;
+	}
+	IndexType maxIndex = 0u;
+	for (size_t i = 0u; i < numIndices; ++i) {
+		maxIndex = core_max(maxIndex, indices[i]);
+	}
+	// the value of the miss counter when the vertex was put into the cache
+	core::DynamicArray<int64_t> insertedAt;
+	insertedAt.resize(maxIndex + 1u);
+	insertedAt.fill(-1);
+	int64_t misses = 0;
+	for (size_t i = 0u; i < numIndices; ++i) {
+		int64_t &inserted = insertedAt[indices[i]];
+		if (inserted >= 0 && misses - inserted < cacheSize) {
+			continue;
+		}
+		inserted = misses;
+		++misses;
+	}
+	return (float)misses / (float)(numIndices / 3u);
+}
+
+namespace forsyth {
+
+static constexpr int CacheSize = 32;
+static constexpr int MaxValence = 64;
+
+class ScoreTable {
+private:
+	float _cache[CacheSize];
+	float _valence[MaxValence];
+
+	static float valenceScore(int activeTris) {
+		return 2.0f * powf((float)activeTris, -0.5f);
+	}
+
+public:
+	ScoreTable() {
+		for (int i = 0; i < CacheSize; ++i) {
+			if (i < 3) {
+				// the vertices of the last triangle get a fixed score to not favour one of the three
+				_cache[i] = 0.75f;
+			} else {
+				_cache[i] = powf(1.0f - (float)(i - 3) / (float)(CacheSize - 3), 1.5f);
+			}
+		}
+		_valence[0] = 0.0f;
+		for (int i = 1; i < MaxValence; ++i) {
+			_valence[i] = valenceScore(i);
+		}
+	}
+
+	inline float score(int cachePos, int activeTris) const {
+		if (activeTris == 0) {
+			// no triangle left that needs this vertex
+			return -1.0f;
+		}
+		float score = cachePos < 0 ? 0.0f : _cache[cachePos];
+		score += activeTris < MaxValence ? _valence[activeTris] : valenceScore(activeTris);
+		return score;
+	}
+};
+
+/**
+ * @brief Tom Forsyth's linear-speed vertex cache optimisation
+ * @see https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+ */
+static void optimize(const IndexType *indices, size_t numIndices, size_t numVertices, IndexType *out) {
+	core_trace_scoped(OptimizeVertexCache);
+	static const ScoreTable table;
+	const int numTris = (int)(numIndices / 3u);
+
+	core::DynamicArray<int> activeTris;
+	activeTris.resize(numVertices);
+	activeTris.fill(0);
+	for (size_t i = 0u; i < numIndices; ++i) {
+		++activeTris[indices[i]];
+	}
+	// the triangles of each vertex - the first activeTris entries are the ones that are not yet added
+	core::DynamicArray<int> triOffsets;
+	triOffsets.resize(numVertices + 1u);
+	int offset = 0;
+	for (size_t v = 0u; v < numVertices; ++v) {
+		triOffsets[v] = offset;
+		offset += activeTris[v];
+	}
+	triOffsets[numVertices] = offset;
+	core::DynamicArray<int> vertexTris;
+	vertexTris.resize(numIndices);
+	{
+		core::DynamicArray<int> fill;
+		fill.resize(numVertices);
+		fill.fill(0);
+		for (int t = 0; t < numTris; ++t) {
+			for (int c = 0; c < 3; ++c) {
+				const IndexType v = indices[t * 3 + c];
+				vertexTris[triOffsets[v] + fill[v]++] = t;
+			}
+		}
+	}
+
+	core::DynamicArray<int> cachePos;
+	cachePos.resize(numVertices);
+	cachePos.fill(-1);
+	core::DynamicArray<float> vertexScore;
+	vertexScore.resize(numVertices);
+	for (size_t v = 0u; v < numVertices; ++v) {
+		vertexScore[v] = table.score(-1, activeTris[v]);
+	}
+	core::DynamicArray<float> triScore;
+	triScore.resize(numTris);
+	core::DynamicArray<bool> triAdded;
+	triAdded.resize(numTris);
+	triAdded.fill(false);
+	int bestTri = -1;
+	float bestScore = -1.0f;
+	for (int t = 0; t < numTris; ++t) {
+		triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+		if (triScore[t] > bestScore) {
+			bestScore = triScore[t];
+			bestTri = t;
+		}
+	}
+
+	int cache[CacheSize + 3];
+	int cacheCount = 0;
+	int nextUnadded = 0;
+	for (int emitted = 0; emitted < numTris; ++emitted) {
+		if (bestTri < 0) {
+			// nothing in the cache is connected to a remaining triangle
+			while (triAdded[nextUnadded]) {
+				++nextUnadded;
+			}
+			bestTri = nextUnadded;
+		}
+		const int t = bestTri;
+		triAdded[t] = true;
+		const IndexType *tri = &indices[t * 3];
+		for (int c = 0; c < 3; ++c) {
+			const IndexType v = tri[c];
+			*out++ = v;
+			// remove the triangle from the active triangles of the vertex
+			int *tris = &vertexTris[triOffsets[v]];
+			const int active = activeTris[v];
+			for (int i = 0; i < active; ++i) {
+				if (tris[i] == t) {
+					tris[i] = tris[active - 1];
+					tris[active - 1] = t;
+					break;
+				}
+			}
+			--activeTris[v];
+		}
+
+		// the vertices of the triangle are moved to the front of the lru cache
+		int newCache[CacheSize + 3];
+		int newCount = 0;
+		for (int c = 0; c < 3; ++c) {
+			if (c > 0 && (tri[c] == tri[0] || (c == 2 && tri[c] == tri[1]))) {
+				continue;
+			}
+			newCache[newCount++] = (int)tri[c];
+		}
+		for (int i = 0; i < cacheCount; ++i) {
+			const int v = cache[i];
+			if (v != (int)tri[0] && v != (int)tri[1] && v != (int)tri[2]) {
+				newCache[newCount++] = v;
+			}
+		}
+
+		bestTri = -1;
+		bestScore = -1.0f;
+		for (int i = 0; i < newCount; ++i) {
+			const int v = newCache[i];
+			const int pos = i < CacheSize ? i : -1;
+			cachePos[v] = pos;
+			const float score = table.score(pos, activeTris[v]);
+			const float delta = score - vertexScore[v];
+			vertexScore[v] = score;
+			const int *tris = &vertexTris[triOffsets[v]];
+			for (int j = 0; j < activeTris[v]; ++j) {
+				const int vt = tris[j];
+				triScore[vt] += delta;
+				if (triScore[vt] > bestScore) {
+					bestScore = triScore[vt];
+					bestTri = vt;
+				}
+			}
+		}
+		cacheCount = core_min(newCount, CacheSize);
+		core_memcpy(cache, newCache, cacheCount * sizeof(int));
+	}
+}
+
+}
+
+// the layout of the key that identical vertices are welded with - the 16 bit coordinates are followed by the info bits
+// and the color index
+static constexpr int WeldAmbientOcclusionBits = 2;
+static constexpr int WeldFlagBits = 3;
+static constexpr int WeldInfoShift = 48;
+static constexpr int WeldColorShift = 56;
+static_assert(WeldInfoShift + WeldAmbientOcclusionBits + WeldFlagBits <= WeldColorShift, "The info bits overlap the color index");
+static_assert(WeldColorShift + 8 * sizeof(VoxelVertex::colorIndex) <= 64, "The color index doesn't fit into the key");
+
+MeshOptimizeStats Mesh::optimize(bool reorderTriangles) {
+	core_trace_scoped(MeshOptimize);
+	MeshOptimizeStats stats;
+	const size_t numIndices = _vecIndices.size();
+	stats.verticesBefore = _vecVertices.size();
+	stats.acmrBefore = averageCacheMissRatio(_vecIndices.data(), numIndices);
+	if (numIndices == 0u) {
+		stats.verticesAfter = stats.verticesBefore;
+		return stats;
+	}
+
+	// weld identical vertices
+	IndexArray remap;
+	remap.resize(_vecVertices.size());
+	{
+		core_trace_scoped(WeldVertices);
+		std::unordered_map<uint64_t, IndexType> vertexMap;
+		vertexMap.reserve(_vecVertices.size());
+		for (size_t i = 0u; i < _vecVertices.size(); ++i) {
+			const VoxelVertex &v = _vecVertices[i];
+			// only the used bits of the info byte - the padding bits might be uninitialized
+			const uint64_t info = (uint64_t)v.ambientOcclusion | ((uint64_t)v.flags << WeldAmbientOcclusionBits);
+			const uint64_t key = (uint64_t)(uint16_t)v.position.x | ((uint64_t)(uint16_t)v.position.y << 16)
+					| ((uint64_t)(uint16_t)v.position.z << 32) | (info << WeldInfoShift) | ((uint64_t)v.colorIndex << WeldColorShift);
+			remap[i] = vertexMap.emplace(key, (IndexType)i).first->second;
+		}
+		for (size_t i = 0u; i < numIndices; ++i) {
+			_vecIndices[i] = remap[_vecIndices[i]];
+		}
+	}
+
+	if (reorderTriangles) {
+		IndexArray optimized;
+		optimized.resize(numIndices);
+		forsyth::optimize(_vecIndices.data(), numIndices, _vecVertices.size(), optimized.data());
+		_vecIndices = core::move(optimized);
+
+		// sort the vertices by their first usage for a better locality of the vertex fetches
+		const IndexType unused = (std::numeric_limits<IndexType>::max)();
+		remap.fill(unused);
+		VertexArray vertices;
+		vertices.reserve(_vecVertices.size());
+		for (size_t i = 0u; i < numIndices; ++i) {
+			IndexType &index = _vecIndices[i];
+			if (remap[index] == unused) {
+				remap[index] = (IndexType)vertices.size();
+				vertices.push_back(_vecVertices[index]);
+			}
+			index = remap[index];
+		}
+		_vecVertices = core::move(vertices);
+	} else {
+		removeUnusedVertices(remap);
+	}
+
+	stats.verticesAfter = _vecVertices.size();
+	stats.acmrAfter = averageCacheMissRatio(_vecIndices.data(), numIndices);
+	if (_compressedIndices != nullptr) {
+		compressIndices();
+	}
+	Log::debug("Optimized mesh: vertices %i => %i, acmr %f => %f", (int)stats.verticesBefore, (int)stats.verticesAfter,
+			stats.acmrBefore, stats.acmrAfter);
+	return stats;
+}
+
 bool Mesh::operator<(const Mesh& rhs) const {
 	return glm::all(glm::lessThan(getOffset(), rhs.getOffset()));
 }
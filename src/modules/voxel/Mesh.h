@@ -11,6 +11,51 @@ namespace voxel {
 
 using VertexArray = core::DynamicArray<voxel::VoxelVertex>;
 using IndexArray = core::DynamicArray<voxel::IndexType>;
+using CompactIndexArray = core::DynamicArray<voxel::CompactIndexType>;
+
+/**
+ * @brief A range of compact indices that are relative to the given base vertex
+ * @sa glDrawElementsBaseVertex
+ */
+struct SubMesh {
+	/** the offset into the compact index buffer */
+	uint32_t baseIndex = 0u;
+	uint32_t numIndices = 0u;
+	/** added to each compact index to get the vertex in the vertex buffer */
+	uint32_t baseVertex = 0u;
+};
+using SubMeshArray = core::DynamicArray<voxel::SubMesh>;
+
+/**
+ * @brief Converts the given indices into 16 bit indices that are relative to the base vertex of their sub mesh.
+ *
+ * A new sub mesh is started whenever the vertices that are referenced by the next triangle wouldn't fit into the
+ * 16 bit range of the current sub mesh. The results are appended to the given arrays, so several meshes can share one
+ * index and vertex buffer.
+ *
+ * @param[in] vertexOffset Added to the base vertex of each sub mesh - the position of the mesh vertices in a shared
+ * vertex buffer.
+ * @return @c false if a single triangle references vertices that are too far apart to be expressed with 16 bit
+ * indices. Nothing is appended in this case.
+ */
+extern bool compactIndices(const IndexType *indices, size_t numIndices, uint32_t vertexOffset, CompactIndexArray &out, SubMeshArray &subMeshes);
+
+/**
+ * @brief The results of @c Mesh::optimize()
+ */
+struct MeshOptimizeStats {
+	size_t verticesBefore = 0u;
+	size_t verticesAfter = 0u;
+	/** average cache miss ratio - transformed vertices per triangle for a fifo cache */
+	float acmrBefore = 0.0f;
+	float acmrAfter = 0.0f;
+};
+
+/**
+ * @brief Simulates a fifo post transform vertex cache of the given size
+ * @return The amount of cache misses per triangle - between @c 0.5 (best case for a grid) and @c 3.0
+ */
+extern float averageCacheMissRatio(const IndexType *indices, size_t numIndices, int cacheSize = 32);
 
 /**
  * @brief A simple and general-purpose mesh class to represent the data returned by the surface extraction functions.
@@ -48,7 +93,27 @@ public:
 	void clear();
 	bool isEmpty() const;
 	void removeUnusedVertices();
+	/**
+	 * @param[in,out] scratch Memory that can be reused between the calls to avoid allocations
+	 */
+	void removeUnusedVertices(IndexArray& scratch);
 	void compressIndices();
+	/**
+	 * @brief Welds identical vertices and reorders the triangles for the post transform vertex cache of the gpu
+	 *
+	 * The triangles are reordered with Tom Forsyth's linear-speed vertex cache optimisation, the vertices are sorted
+	 * by their first usage afterwards.
+	 *
+	 * @param[in] reorderTriangles Only weld the vertices if this is @c false - some exporters rely on two consecutive
+	 * triangles forming a quad
+	 */
+	MeshOptimizeStats optimize(bool reorderTriangles = true);
+
+	/**
+	 * @brief Appends the 16 bit representation of the indices of this mesh
+	 * @sa voxel::compactIndices()
+	 */
+	bool compactIndices(CompactIndexArray& out, SubMeshArray& subMeshes, uint32_t vertexOffset = 0u) const;
 
 	const uint8_t* compressedIndices() const;
 	size_t compressedIndexSize() const;
@@ -71,4 +136,10 @@ inline size_t Mesh::compressedIndexSize() const {
 	return _compressedIndexSize;
 }
 
+/**
+ * @brief Concatenates the given meshes into the result mesh - the indices are rebased to the merged vertex buffer
+ * @note The offset of the result mesh is not changed
+ */
+extern void mergeMeshes(const Mesh* meshes, size_t n, Mesh* result);
+
 }
@@ -0,0 +1,220 @@
+/**
+ * @file
+ */
+
+#include "OccupancyMask.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include <glm/common.hpp>
+#include <algorithm>
+
+namespace voxel {
+
+/**
+ * @return The bits @c from to @c to (inclusive)
+ */
+static inline uint64_t rangeMask(int from, int to) {
+	const uint64_t upper = to >= 63 ? ~(uint64_t)0u : (((uint64_t)1u << (to + 1)) - 1u);
+	return upper & (~(uint64_t)0u << from);
+}
+
+OccupancyMask::OccupancyMask(const Region& region) : _region(region) {
+	const glm::ivec3& dim = region.getDimensionsInVoxels();
+	_wordsPerRow = (dim.x + 63) / 64;
+	_bricks = (dim + (BrickSize - 1)) / BrickSize;
+	_words.assign((size_t)_wordsPerRow * dim.y * dim.z, 0u);
+	_brickCounts.assign((size_t)_bricks.x * _bricks.y * _bricks.z, 0u);
+}
+
+void OccupancyMask::translate(const glm::ivec3& t) {
+	_region.shift(t.x, t.y, t.z);
+}
+
+void OccupancyMask::clear() {
+	std::fill(_words.begin(), _words.end(), 0u);
+	std::fill(_brickCounts.begin(), _brickCounts.end(), 0u);
+}
+
+void OccupancyMask::replace(int w, int32_t ly, int32_t lz, uint64_t bits, uint64_t mask) {
+	uint64_t& word = _words[rowIndex(ly, lz) + w];
+	const uint64_t old = word;
+	word = (old & ~mask) | (bits & mask);
+	if (word == old) {
+		return;
+	}
+	uint32_t& cnt = _brickCounts[brickIndex(w, ly, lz)];
+	cnt = (uint32_t)((int)cnt + core::countSetBits(word) - core::countSetBits(old));
+}
+
+bool OccupancyMask::set(int32_t x, int32_t y, int32_t z, bool occupied) {
+	if (!_region.containsPoint(x, y, z)) {
+		return false;
+	}
+	if (isOccupied(x, y, z) == occupied) {
+		return false;
+	}
+	const int32_t lx = x - _region.getLowerX();
+	const uint64_t bit = (uint64_t)1u << (lx % 64);
+	replace(lx / 64, y - _region.getLowerY(), z - _region.getLowerZ(), occupied ? bit : 0u, bit);
+	return true;
+}
+
+void OccupancyMask::setRow(int32_t x, int32_t y, int32_t z, int length, bool occupied) {
+	core_assert(_region.containsPoint(x, y, z) && _region.containsPoint(x + length - 1, y, z));
+	const int32_t ly = y - _region.getLowerY();
+	const int32_t lz = z - _region.getLowerZ();
+	int32_t lx = x - _region.getLowerX();
+	while (length > 0) {
+		const int offset = lx % 64;
+		const int n = core_min(64 - offset, length);
+		const uint64_t mask = rangeMask(offset, offset + n - 1);
+		replace(lx / 64, ly, lz, occupied ? mask : 0u, mask);
+		lx += n;
+		length -= n;
+	}
+}
+
+void OccupancyMask::updateRow(int32_t x, int32_t y, int32_t z, const Voxel* voxels, int length) {
+	core_assert(_region.containsPoint(x, y, z) && _region.containsPoint(x + length - 1, y, z));
+	const int32_t ly = y - _region.getLowerY();
+	const int32_t lz = z - _region.getLowerZ();
+	int32_t lx = x - _region.getLowerX();
+	while (length > 0) {
+		const int offset = lx % 64;
+		const int n = core_min(64 - offset, length);
+		uint64_t bits = 0u;
+		for (int i = 0; i < n; ++i) {
+			if (!isAir(voxels[i].getMaterial())) {
+				bits |= (uint64_t)1u << (offset + i);
+			}
+		}
+		replace(lx / 64, ly, lz, bits, rangeMask(offset, offset + n - 1));
+		voxels += n;
+		lx += n;
+		length -= n;
+	}
+}
+
+int OccupancyMask::countBits(const Region& region, bool stopAtFirst) const {
+	Region cropped(region);
+	cropped.cropTo(_region);
+	if (!cropped.isValid()) {
+		return 0;
+	}
+	const glm::ivec3 lo = cropped.getLowerCorner() - _region.getLowerCorner();
+	const glm::ivec3 hi = cropped.getUpperCorner() - _region.getLowerCorner();
+	const glm::ivec3& dim = _region.getDimensionsInVoxels();
+	int cnt = 0;
+	for (int bz = lo.z / BrickSize; bz <= hi.z / BrickSize; ++bz) {
+		for (int by = lo.y / BrickSize; by <= hi.y / BrickSize; ++by) {
+			for (int bx = lo.x / BrickSize; bx <= hi.x / BrickSize; ++bx) {
+				const uint32_t brickCount = _brickCounts[brickIndex(bx, by * BrickSize, bz * BrickSize)];
+				if (brickCount == 0u) {
+					continue;
+				}
+				const glm::ivec3 brickMins(bx * BrickSize, by * BrickSize, bz * BrickSize);
+				const glm::ivec3 brickMaxs = (glm::min)(brickMins + (BrickSize - 1), dim - 1);
+				const glm::ivec3 mins = (glm::max)(brickMins, lo);
+				const glm::ivec3 maxs = (glm::min)(brickMaxs, hi);
+				if (mins == brickMins && maxs == brickMaxs) {
+					if (stopAtFirst) {
+						return 1;
+					}
+					cnt += (int)brickCount;
+					continue;
+				}
+				const uint64_t mask = rangeMask(mins.x - brickMins.x, maxs.x - brickMins.x);
+				for (int32_t lz = mins.z; lz <= maxs.z; ++lz) {
+					for (int32_t ly = mins.y; ly <= maxs.y; ++ly) {
+						const uint64_t bits = _words[rowIndex(ly, lz) + bx] & mask;
+						if (bits == 0u) {
+							continue;
+						}
+						if (stopAtFirst) {
+							return 1;
+						}
+						cnt += core::countSetBits(bits);
+					}
+				}
+			}
+		}
+	}
+	return cnt;
+}
+
+bool OccupancyMask::isEmpty(const Region& region) const {
+	return countBits(region, true) == 0;
+}
+
+int OccupancyMask::count(const Region& region) const {
+	return countBits(region, false);
+}
+
+int OccupancyMask::count() const {
+	int cnt = 0;
+	for (uint32_t brickCount : _brickCounts) {
+		cnt += (int)brickCount;
+	}
+	return cnt;
+}
+
+Region OccupancyMask::calculateBounds() const {
+	const glm::ivec3& dim = _region.getDimensionsInVoxels();
+	glm::ivec3 mins(dim);
+	glm::ivec3 maxs(-1);
+	for (int bz = 0; bz < _bricks.z; ++bz) {
+		for (int by = 0; by < _bricks.y; ++by) {
+			for (int bx = 0; bx < _bricks.x; ++bx) {
+				if (_brickCounts[brickIndex(bx, by * BrickSize, bz * BrickSize)] == 0u) {
+					continue;
+				}
+				const int32_t maxZ = core_min((bz + 1) * BrickSize, dim.z);
+				const int32_t maxY = core_min((by + 1) * BrickSize, dim.y);
+				for (int32_t lz = bz * BrickSize; lz < maxZ; ++lz) {
+					for (int32_t ly = by * BrickSize; ly < maxY; ++ly) {
+						const uint64_t bits = _words[rowIndex(ly, lz) + bx];
+						if (bits == 0u) {
+							continue;
+						}
+						mins.x = core_min(mins.x, bx * 64 + core::countTrailingZeros(bits));
+						maxs.x = core_max(maxs.x, bx * 64 + 63 - core::countLeadingZeros(bits));
+						mins.y = core_min(mins.y, ly);
+						maxs.y = core_max(maxs.y, ly);
+						mins.z = core_min(mins.z, lz);
+						maxs.z = core_max(maxs.z, lz);
+					}
+				}
+			}
+		}
+	}
+	if (maxs.x < 0) {
+		return Region::InvalidRegion;
+	}
+	return Region(mins + _region.getLowerCorner(), maxs + _region.getLowerCorner());
+}
+
+bool OccupancyMask::isSurface(int32_t x, int32_t y, int32_t z) const {
+	if (!isOccupied(x, y, z)) {
+		return false;
+	}
+	return !isOccupied(x - 1, y, z) || !isOccupied(x + 1, y, z) || !isOccupied(x, y - 1, z) ||
+		   !isOccupied(x, y + 1, z) || !isOccupied(x, y, z - 1) || !isOccupied(x, y, z + 1);
+}
+
+uint64_t OccupancyMask::surfaceWord(int w, int32_t ly, int32_t lz) const {
+	const uint64_t bits = word(w, ly, lz);
+	if (bits == 0u) {
+		return 0u;
+	}
+	const uint64_t left = (bits << 1) | (word(w - 1, ly, lz) >> 63);
+	const uint64_t right = (bits >> 1) | (word(w + 1, ly, lz) << 63);
+	const uint64_t inner = left & right & word(w, ly - 1, lz) & word(w, ly + 1, lz) & word(w, ly, lz - 1) &
+						   word(w, ly, lz + 1);
+	return bits & ~inner;
+}
+
+size_t OccupancyMask::memoryUsage() const {
+	return sizeof(*this) + _words.capacity() * sizeof(uint64_t) + _brickCounts.capacity() * sizeof(uint32_t);
+}
+
+}
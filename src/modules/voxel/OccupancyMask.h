@@ -0,0 +1,165 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Region.h"
+#include "Voxel.h"
+#include "core/Bits.h"
+#include <glm/vec3.hpp>
+#include <stdint.h>
+#include <vector>
+
+namespace voxel {
+
+/**
+ * @brief One bit per voxel that tells whether the voxel is not air
+ *
+ * The bits are stored in rows along the x axis with 64 voxels per word. In addition the amount of occupied voxels
+ * is counted for each brick of @c BrickSize^3 voxels - this allows to skip large empty areas without touching the
+ * bits at all.
+ *
+ * All positions are given in volume coordinates.
+ *
+ * @sa RawVolume::enableOccupancy()
+ */
+class OccupancyMask {
+public:
+	static constexpr int BrickSize = 64;
+
+	OccupancyMask(const Region& region);
+
+	const Region& region() const;
+	void translate(const glm::ivec3& t);
+
+	bool isOccupied(int32_t x, int32_t y, int32_t z) const;
+	/**
+	 * @return @c true if the bit was changed
+	 */
+	bool set(int32_t x, int32_t y, int32_t z, bool occupied);
+	/**
+	 * @brief Sets the bits of @c length voxels of the row starting at the given position
+	 */
+	void setRow(int32_t x, int32_t y, int32_t z, int length, bool occupied);
+	/**
+	 * @brief Sets the bits of @c length voxels of the row starting at the given position from the given voxels
+	 */
+	void updateRow(int32_t x, int32_t y, int32_t z, const Voxel* voxels, int length);
+	void clear();
+
+	/**
+	 * @brief Checks whether there is no occupied voxel in the given region
+	 * @note The region is cropped to the region of the mask
+	 */
+	bool isEmpty(const Region& region) const;
+	/**
+	 * @return The amount of occupied voxels in the given region
+	 */
+	int count(const Region& region) const;
+	/**
+	 * @return The amount of occupied voxels
+	 */
+	int count() const;
+	/**
+	 * @return The smallest region that contains all occupied voxels or @c Region::InvalidRegion if there are none
+	 */
+	Region calculateBounds() const;
+
+	/**
+	 * @brief Checks whether the voxel is occupied and at least one of the six face neighbours is not
+	 * @note Positions outside of the mask are not occupied
+	 */
+	bool isSurface(int32_t x, int32_t y, int32_t z) const;
+	/**
+	 * @brief Calls the given functor with the position of each surface voxel
+	 *
+	 * The surface bits are computed for 64 voxels at once and the positions are extracted by a bit scan.
+	 * The visiting order is z, y and x from the lower to the upper corner.
+	 * @sa isSurface()
+	 * @return The amount of visited voxels
+	 */
+	template<class Func>
+	int visitSurface(Func&& func) const;
+
+	size_t memoryUsage() const;
+
+private:
+	inline int rowIndex(int32_t ly, int32_t lz) const;
+	inline int brickIndex(int bx, int32_t ly, int32_t lz) const;
+	/**
+	 * @return The word of the given row in local coordinates or @c 0 if the position is outside of the mask
+	 */
+	inline uint64_t word(int w, int32_t ly, int32_t lz) const;
+	/**
+	 * @brief Replaces the bits of @c bits in the given word and updates the brick counts
+	 */
+	void replace(int w, int32_t ly, int32_t lz, uint64_t bits, uint64_t mask);
+	/**
+	 * @param stopAtFirst Return @c 1 as soon as the first occupied voxel was found
+	 */
+	int countBits(const Region& region, bool stopAtFirst) const;
+	uint64_t surfaceWord(int w, int32_t ly, int32_t lz) const;
+
+	Region _region;
+	int _wordsPerRow;
+	glm::ivec3 _bricks;
+	std::vector<uint64_t> _words;
+	std::vector<uint32_t> _brickCounts;
+};
+
+inline const Region& OccupancyMask::region() const {
+	return _region;
+}
+
+inline int OccupancyMask::rowIndex(int32_t ly, int32_t lz) const {
+	return (ly + lz * _region.getHeightInVoxels()) * _wordsPerRow;
+}
+
+inline int OccupancyMask::brickIndex(int bx, int32_t ly, int32_t lz) const {
+	return bx + (ly / BrickSize) * _bricks.x + (lz / BrickSize) * _bricks.x * _bricks.y;
+}
+
+inline uint64_t OccupancyMask::word(int w, int32_t ly, int32_t lz) const {
+	if (w < 0 || w >= _wordsPerRow || ly < 0 || ly >= _region.getHeightInVoxels() || lz < 0 ||
+		lz >= _region.getDepthInVoxels()) {
+		return 0u;
+	}
+	return _words[rowIndex(ly, lz) + w];
+}
+
+inline bool OccupancyMask::isOccupied(int32_t x, int32_t y, int32_t z) const {
+	if (!_region.containsPoint(x, y, z)) {
+		return false;
+	}
+	const int32_t lx = x - _region.getLowerX();
+	const uint64_t w = _words[rowIndex(y - _region.getLowerY(), z - _region.getLowerZ()) + lx / 64];
+	return (w >> (lx % 64)) & 1u;
+}
+
+template<class Func>
+int OccupancyMask::visitSurface(Func&& func) const {
+	const glm::ivec3& mins = _region.getLowerCorner();
+	const int height = _region.getHeightInVoxels();
+	const int depth = _region.getDepthInVoxels();
+	int cnt = 0;
+	for (int32_t lz = 0; lz < depth; ++lz) {
+		for (int32_t ly = 0; ly < height; ++ly) {
+			for (int w = 0; w < _wordsPerRow; ++w) {
+				if (_brickCounts[brickIndex(w, ly, lz)] == 0u) {
+					continue;
+				}
+				uint64_t surface = surfaceWord(w, ly, lz);
+				while (surface != 0u) {
+					const int bit = core::countTrailingZeros(surface);
+					surface &= surface - 1u;
+					func(mins.x + w * 64 + bit, mins.y + ly, mins.z + lz);
+					++cnt;
+				}
+			}
+		}
+	}
+	return cnt;
+}
+
+}
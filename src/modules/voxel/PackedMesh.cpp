@@ -0,0 +1,90 @@
+/**
+ * @file
+ */
+
+#include "PackedMesh.h"
+#include "core/Assert.h"
+#include "core/Trace.h"
+#include <glm/common.hpp>
+#include <glm/vector_relational.hpp>
+
+namespace voxel {
+
+static constexpr uint32_t PositionMask = (1u << PackedMesh::PositionBits) - 1u;
+static constexpr int ShiftY = PackedMesh::PositionBits;
+static constexpr int ShiftZ = PackedMesh::PositionBits * 2;
+static constexpr int ShiftAmbientOcclusion = PackedMesh::PositionBits * 3;
+static constexpr int ShiftFlags = ShiftAmbientOcclusion + 2;
+static_assert(ShiftFlags + 3 == 32, "The packed vertex data doesn't fill 32 bits");
+
+PackedVoxelVertex PackedMesh::packVertex(const VoxelVertex& vertex, const glm::ivec3& origin) {
+	const glm::ivec3 pos = glm::ivec3(vertex.position) - origin;
+	core_assert_msg(glm::all(glm::greaterThanEqual(pos, glm::ivec3(0))), "Vertex position is below the origin");
+	core_assert_msg(glm::all(glm::lessThanEqual(pos, glm::ivec3(MaxExtent))), "Vertex position exceeds the packed range");
+	PackedVoxelVertex packed;
+	packed.data = (uint32_t)pos.x | ((uint32_t)pos.y << ShiftY) | ((uint32_t)pos.z << ShiftZ)
+			| ((uint32_t)vertex.ambientOcclusion << ShiftAmbientOcclusion) | ((uint32_t)vertex.flags << ShiftFlags);
+	packed.colorIndex = vertex.colorIndex;
+	return packed;
+}
+
+VoxelVertex PackedMesh::unpackVertex(const PackedVoxelVertex& packed, const glm::ivec3& origin) {
+	const uint32_t data = packed.data;
+	const glm::ivec3 pos(data & PositionMask, (data >> ShiftY) & PositionMask, (data >> ShiftZ) & PositionMask);
+	VoxelVertex vertex;
+	vertex.position = pos + origin;
+	vertex.ambientOcclusion = (data >> ShiftAmbientOcclusion) & 3u;
+	vertex.flags = (data >> ShiftFlags) & 7u;
+	vertex.padding = 0u;
+	vertex.colorIndex = packed.colorIndex;
+	return vertex;
+}
+
+bool PackedMesh::pack(const Mesh& mesh) {
+	core_trace_scoped(PackMesh);
+	clear();
+	const VertexArray& vertices = mesh.getVertexVector();
+	_offset = mesh.getOffset();
+	if (vertices.empty()) {
+		_vecIndices = mesh.getIndexVector();
+		return true;
+	}
+	glm::ivec3 mins(vertices[0].position);
+	glm::ivec3 maxs(mins);
+	for (const VoxelVertex& vertex : vertices) {
+		const glm::ivec3 pos(vertex.position);
+		mins = glm::min(mins, pos);
+		maxs = glm::max(maxs, pos);
+	}
+	if (glm::any(glm::greaterThan(maxs - mins, glm::ivec3(MaxExtent)))) {
+		return false;
+	}
+	_origin = mins;
+	_vecVertices.reserve(vertices.size());
+	for (const VoxelVertex& vertex : vertices) {
+		_vecVertices.push_back(packVertex(vertex, _origin));
+	}
+	_vecIndices = mesh.getIndexVector();
+	return true;
+}
+
+void PackedMesh::unpack(Mesh& mesh) const {
+	core_trace_scoped(UnpackMesh);
+	mesh.clear();
+	mesh.setOffset(_offset);
+	VertexArray& vertices = mesh.getVertexVector();
+	vertices.reserve(_vecVertices.size());
+	for (const PackedVoxelVertex& vertex : _vecVertices) {
+		vertices.push_back(unpackVertex(vertex, _origin));
+	}
+	mesh.getIndexVector() = _vecIndices;
+}
+
+void PackedMesh::clear() {
+	_vecVertices.clear();
+	_vecIndices.clear();
+	_origin = glm::ivec3(0);
+	_offset = glm::ivec3(0);
+}
+
+}
@@ -0,0 +1,102 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Mesh.h"
+
+namespace voxel {
+
+#pragma pack(push, 1)
+/**
+ * @brief Quantized version of the @c VoxelVertex
+ *
+ * The position is stored relative to the origin of the @c PackedMesh with 9 bits per axis. Together with the ambient
+ * occlusion and the flags it fits into 32 bits - the color index is stored in an extra byte.
+ */
+struct PackedVoxelVertex {
+	uint32_t data;
+	uint8_t colorIndex;
+};
+#pragma pack(pop)
+static_assert(sizeof(PackedVoxelVertex) == 5, "Unexpected size of the packed vertex struct");
+
+using PackedVertexArray = core::DynamicArray<voxel::PackedVoxelVertex>;
+
+/**
+ * @brief Memory saving representation of a @c Mesh - see @c PackedVoxelVertex
+ */
+class PackedMesh {
+public:
+	static constexpr int PositionBits = 9;
+	/** the max distance between two vertex positions on each axis */
+	static constexpr int MaxExtent = (1 << PositionBits) - 1;
+
+	static PackedVoxelVertex packVertex(const VoxelVertex& vertex, const glm::ivec3& origin);
+	static VoxelVertex unpackVertex(const PackedVoxelVertex& vertex, const glm::ivec3& origin);
+
+	/**
+	 * @brief Converts the given mesh - the origin is the min vertex position
+	 * @return @c false if the vertices of the mesh are spread over more than @c MaxExtent voxels on any axis. The
+	 * packed mesh is empty in this case.
+	 */
+	bool pack(const Mesh& mesh);
+	/**
+	 * @brief Restores the mesh that was given to @c pack()
+	 */
+	void unpack(Mesh& mesh) const;
+
+	size_t getNoOfVertices() const;
+	size_t getNoOfIndices() const;
+	const PackedVertexArray& getVertexVector() const;
+	const IndexArray& getIndexVector() const;
+
+	/**
+	 * @brief The position that the quantized vertex positions are relative to
+	 */
+	const glm::ivec3& getOrigin() const;
+	/**
+	 * @sa Mesh::getOffset()
+	 */
+	const glm::ivec3& getOffset() const;
+
+	void clear();
+	bool isEmpty() const;
+
+private:
+	PackedVertexArray _vecVertices;
+	IndexArray _vecIndices;
+	glm::ivec3 _origin { 0 };
+	glm::ivec3 _offset { 0 };
+};
+
+inline size_t PackedMesh::getNoOfVertices() const {
+	return _vecVertices.size();
+}
+
+inline size_t PackedMesh::getNoOfIndices() const {
+	return _vecIndices.size();
+}
+
+inline const PackedVertexArray& PackedMesh::getVertexVector() const {
+	return _vecVertices;
+}
+
+inline const IndexArray& PackedMesh::getIndexVector() const {
+	return _vecIndices;
+}
+
+inline const glm::ivec3& PackedMesh::getOrigin() const {
+	return _origin;
+}
+
+inline const glm::ivec3& PackedMesh::getOffset() const {
+	return _offset;
+}
+
+inline bool PackedMesh::isEmpty() const {
+	return _vecVertices.empty() || _vecIndices.empty();
+}
+
+}
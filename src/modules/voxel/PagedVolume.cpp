@@ -10,6 +10,7 @@
 #include "math/Functions.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtc/round.hpp>
+#include <limits>
 
 namespace voxel {
 
@@ -21,9 +22,11 @@ namespace voxel {
  * @param targetMemoryUsageInBytes The upper limit to how much memory this PagedVolume should aim to use.
  * @param chunkSideLength The size of the chunks making up the volume. Small chunks will compress/decompress faster, but there will also be
  * more of them meaning voxel access could be slower.
+ * @param compressChunks Chunks that were not accessed recently are compressed with a chunk local palette. This allows to keep
+ * a lot more chunks in memory for the same @c targetMemoryUsageInBytes.
  */
-PagedVolume::PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes, uint16_t chunkSideLength) :
-		_chunkSideLength(chunkSideLength), _pager(pager), _region(0, 0, 0, -1, -1, -1) {
+PagedVolume::PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes, uint16_t chunkSideLength, bool compressChunks) :
+		_compressChunks(compressChunks), _chunkSideLength(chunkSideLength), _pager(pager), _region(0, 0, 0, -1, -1, -1) {
 	// Validation of parameters
 	core_assert_msg(_pager, "You must provide a valid pager when constructing a PagedVolume");
 	core_assert_msg(targetMemoryUsageInBytes >= 1 * 1024 * 1024, "Target memory usage is too small to be practical");
@@ -47,10 +50,17 @@ PagedVolume::PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes, uint16
 				targetMemoryUsageInBytes / (1024 * 1024), _chunkCountLimit, chunkSizeInBytes / 1024);
 	}
 	_chunkCountLimit = core_max(_chunkCountLimit, minPracticalNoOfChunks);
+	_memoryLimitInBytes = (size_t)_chunkCountLimit * chunkSizeInBytes;
+	if (_compressChunks) {
+		// Only a fraction of the chunks is kept uncompressed - the memory limit is
+		// enforced on the real memory usage of the chunks.
+		_uncompressedChunkLimit = core_max(_chunkCountLimit / 4u, minPracticalNoOfChunks);
+		_chunkCountLimit *= MaxCompressionFactor;
+	}
 
 	// Inform the user about the chosen memory configuration.
 	Log::debug("Memory usage limit for volume now set to %uMb (%u chunks of %uKb each).",
-			(_chunkCountLimit * chunkSizeInBytes) / (1024 * 1024), _chunkCountLimit, chunkSizeInBytes / 1024);
+			(uint32_t)(_memoryLimitInBytes / (1024 * 1024)), _chunkCountLimit, chunkSizeInBytes / 1024);
 }
 
 /**
@@ -58,6 +68,7 @@ PagedVolume::PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes, uint16
  * data via the dataOverflowHandler() if desired.
  */
 PagedVolume::~PagedVolume() {
+	shutdownPagingThreads();
 	flushAll();
 }
 
@@ -69,7 +80,7 @@ PagedVolume::~PagedVolume() {
  * @param uZPos The @c z position of the voxel
  * @return The voxel value
  */
-const Voxel& PagedVolume::voxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const {
+Voxel PagedVolume::voxel(int32_t uXPos, int32_t uYPos, int32_t uZPos) const {
 	return voxel(glm::ivec3(uXPos, uYPos, uZPos));
 }
 
@@ -84,9 +95,9 @@ PagedVolume::ChunkPtr PagedVolume::chunk(const glm::ivec3& pos) const {
  * This version of the function is provided so that the wrap mode does not need
  * to be specified as a template parameter, as it may be confusing to some users.
  * @param v3dPos The 3D position of the voxel
- * @return The voxel value
+ * @return The voxel value - returned by value as the chunk might get compressed or evicted as soon as we release it
  */
-const Voxel& PagedVolume::voxel(const glm::ivec3& v3dPos) const {
+Voxel PagedVolume::voxel(const glm::ivec3& v3dPos) const {
 	const uint32_t xOffset = static_cast<uint32_t>(v3dPos.x & _chunkMask);
 	const uint32_t yOffset = static_cast<uint32_t>(v3dPos.y & _chunkMask);
 	const uint32_t zOffset = static_cast<uint32_t>(v3dPos.z & _chunkMask);
@@ -169,41 +180,116 @@ void PagedVolume::setVoxels(int32_t uXPos, int32_t uYPos, int32_t uZPos, int nx,
  * Removes all voxels from memory by removing all chunks. The application has the chance to persist the data via @c Pager::pageOut
  */
 void PagedVolume::flushAll() {
-	core::ScopedWriteLock writeLock(_volumeLock);
-	_chunks.clear();
+	// the chunks are only destroyed after the locks were released - modified chunks are paged out via the page out queue
+	core::DynamicArray<ChunkPtr> removed;
+	{
+		// the page in lock is always acquired before the volume lock
+		core::ScopedLock lock(_pageInLock);
+		core::ScopedWriteLock writeLock(_volumeLock);
+		removed.reserve(_chunks.size());
+		_chunks.visitAll([&](const glm::ivec3 &pos, const ChunkPtr &chunk) {
+			if (chunk->_dataModified) {
+				_pagingOut.emplace(pos, chunk);
+			} else {
+				removed.push_back(chunk);
+			}
+		});
+		_clock.clear();
+		_evictionHand = 0u;
+		_compressionHand = 0u;
+		_chunks.clear();
+		_chunkCount = 0u;
+		_memoryUsageInBytes = 0u;
+		_uncompressedChunks = 0u;
+	}
+	removed.clear();
+	pageOutEvictedChunks();
+}
+
+size_t PagedVolume::memoryUsageInBytes() const {
+	core::ScopedReadLock readLock(_volumeLock);
+	return _memoryUsageInBytes;
 }
 
 /**
- * As we have added a chunk we may have exceeded our target chunk limit. Search through the array to
- * determine how many chunks we have, as well as finding the oldest timestamp. Note that this is potentially
- * wasteful and we may instead wish to track how many chunks we have and/or delete a chunk at random (or
- * just check e.g. 10 and delete the oldest of those) but we'll see if this is a bottleneck first. Paging
- * the data in is probably more expensive.
+ * As we have added a chunk we may have exceeded our target chunk limit. This is a clock (second chance) approximation of
+ * a least recently used eviction: every access marks the chunk as referenced, the eviction hand walks over the resident
+ * chunks, clears the reference marks and evicts the first chunk that wasn't accessed since the hand passed it the last time.
+ * This makes the bookkeeping O(1) per access instead of searching for the chunk with the oldest access time.
+ *
+ * Modified chunks are not paged out here - they are moved to the page out queue and written by @c pageOutEvictedChunks()
+ * without holding the volume lock.
+ * @note The page in lock and the volume lock must be held.
  */
 void PagedVolume::deleteOldestChunkIfNeeded() const {
 	core_trace_scoped(DeleteOldestChunk);
-	ChunkMap::iterator oldestChunk = _chunks.end();
-	uint32_t oldestChunkTimestamp = _timestamper;
-	for (ChunkMap::iterator i = _chunks.begin(); i != _chunks.end(); ++i) {
-		const ChunkPtr& chunk = i->second;
-		if (chunk->_chunkLastAccessed < oldestChunkTimestamp) {
-			oldestChunkTimestamp = chunk->_chunkLastAccessed;
-			oldestChunk = i;
+	// after one full round all reference marks are cleared
+	const size_t maxSteps = 2u * _clock.size();
+	for (size_t step = 0u; step < maxSteps; ++step) {
+		if (_evictionHand >= _clock.size()) {
+			_evictionHand = 0u;
+		}
+		Chunk* chunk = _clock[_evictionHand];
+		if (chunk->_referenced.exchange(false)) {
+			++_evictionHand;
+			continue;
 		}
-	}
-	if (oldestChunk != _chunks.end()) {
 		Log::debug("delete oldest chunk - reached %u", _chunkCountLimit);
-		_chunks.erase(oldestChunk);
+		const glm::ivec3 pos = chunk->chunkPos();
+		_memoryUsageInBytes -= chunk->memoryUsageInBytes();
+		if (!chunk->isCompressed()) {
+			--_uncompressedChunks;
+		}
+		_clock[_evictionHand] = _clock.back();
+		_clock.pop();
+		--_chunkCount;
+		ChunkPtr removed;
+		if (_chunks.remove(pos, removed) && removed->_dataModified) {
+			_pagingOut.emplace(pos, core::move(removed));
+		}
+		return;
 	}
 }
 
-PagedVolume::ChunkPtr PagedVolume::createNewChunk(int32_t chunkX, int32_t chunkY, int32_t chunkZ) const {
+/**
+ * Compress the chunks that weren't used recently until we are below the limit of uncompressed chunks again. This uses its own
+ * clock hand and reference mark - see @c deleteOldestChunkIfNeeded(). Chunks that are still referenced outside of the volume
+ * (e.g. by a Sampler) are skipped, as they might hold pointers into the voxel data.
+ * @note The volume lock must be held.
+ */
+void PagedVolume::compressOldestChunksIfNeeded() const {
+	core_trace_scoped(CompressOldestChunks);
+	const size_t maxSteps = 2u * _clock.size();
+	for (size_t step = 0u; step < maxSteps && _uncompressedChunks > _uncompressedChunkLimit; ++step) {
+		if (_compressionHand >= _clock.size()) {
+			_compressionHand = 0u;
+		}
+		Chunk* chunk = _clock[_compressionHand++];
+		if (chunk->isCompressed() || chunk->_recentlyUsed.exchange(false)) {
+			continue;
+		}
+		// the reference count must be checked while nobody else is able to look up the chunk
+		_chunks.visitExclusive(chunk->chunkPos(), [this] (const ChunkPtr& c) {
+			if (c.useCount() > 1) {
+				return;
+			}
+			const uint32_t before = c->memoryUsageInBytes();
+			if (!c->compress()) {
+				// mark as used to not try it over and over again
+				c->_recentlyUsed = true;
+				return;
+			}
+			_memoryUsageInBytes -= before;
+			_memoryUsageInBytes += c->memoryUsageInBytes();
+			--_uncompressedChunks;
+		});
+	}
+}
+
+void PagedVolume::createNewChunk(const ChunkPtr& chunk) const {
 	core_trace_scoped(CreateNewChunk);
-	// The chunk was not found so we will create a new one.
-	glm::ivec3 pos(chunkX, chunkY, chunkZ);
-	Log::debug("create new chunk at %i:%i:%i", chunkX, chunkY, chunkZ);
-	ChunkPtr chunk = core::make_shared<Chunk>(pos, _chunkSideLength, _pager);
-	chunk->_chunkLastAccessed = ++_timestamper; // Important, as we may soon delete the oldest chunk
+	const glm::ivec3& pos = chunk->chunkPos();
+	Log::debug("create new chunk at %i:%i:%i", pos.x, pos.y, pos.z);
 
 	// Pass the chunk to the Pager to give it a chance to initialise it with any data
 	// From the coordinates of the chunk we deduce the coordinates of the contained voxels.
@@ -214,30 +300,358 @@ PagedVolume::ChunkPtr PagedVolume::createNewChunk(int32_t chunkX, int32_t chunkY
 	pctx.chunk = chunk;
 
 	// Page the data in
-	// We'll use this later to decide if data needs to be paged out again.
+	// We'll use this later to decide if data needs to be paged out again. The chunk counts as modified while it is
+	// filled - this way the writes of the pager don't end up in Pager::modified()
+	chunk->_dataModified = true;
 	chunk->_dataModified = _pager->pageIn(pctx);
-	Log::debug("finished creating new chunk at %i:%i:%i", chunkX, chunkY, chunkZ);
-
-	return chunk;
+	Log::debug("finished creating new chunk at %i:%i:%i", pos.x, pos.y, pos.z);
 }
 
 PagedVolume::ChunkPtr PagedVolume::chunk(int32_t chunkX, int32_t chunkY, int32_t chunkZ) const {
 	core_trace_scoped(PagedVolumeChunk);
-	core::ScopedWriteLock chunkWriteLock(_volumeLock);
 	const glm::ivec3 pos(chunkX, chunkY, chunkZ);
-	auto i = _chunks.find(pos);
-	if (i == _chunks.end()) {
-		const ChunkPtr& chunk = createNewChunk(chunkX, chunkY, chunkZ);
-		_chunks.put(pos, chunk);
-		const size_t chunkCount = _chunks.size();
-		if (chunkCount >= _chunkCountLimit) {
-			deleteOldestChunkIfNeeded();
+	ChunkPtr chunk;
+	// fast path - the chunk is resident and uncompressed, only the lock of the index shard is needed
+	_chunks.visit(pos, [&] (const ChunkPtr& c) {
+		c->touch();
+		if (c->isCompressed()) {
+			return;
 		}
+		chunk = c;
+	});
+	if (chunk) {
 		return chunk;
 	}
-	const ChunkPtr& chunk = i->second;
-	chunk->_chunkLastAccessed = ++_timestamper;
+	return pageInChunk(pos);
+}
+
+bool PagedVolume::residentChunk(const glm::ivec3& pos, ChunkPtr& chunk) const {
+	core::ScopedWriteLock chunkWriteLock(_volumeLock);
+	const bool resident = _chunks.visitExclusive(pos, [&] (const ChunkPtr& c) {
+		c->touch();
+		if (c->isCompressed()) {
+			_memoryUsageInBytes -= c->memoryUsageInBytes();
+			c->decompress();
+			_memoryUsageInBytes += c->memoryUsageInBytes();
+			++_uncompressedChunks;
+		}
+		chunk = c;
+	});
+	if (resident && _compressChunks) {
+		compressOldestChunksIfNeeded();
+	}
+	return resident;
+}
+
+bool PagedVolume::residentChunkSnapshot(const glm::ivec3& pos, ChunkPtr& chunk) const {
+	// compressing and decompressing a chunk needs the exclusive lock of the shard - the compressed data stays valid
+	// while it is visited here
+	return _chunks.visit(pos, [&] (const ChunkPtr& c) {
+		if (!c->isCompressed()) {
+			chunk = c;
+			return;
+		}
+		chunk = core::make_shared<Chunk>(pos, _chunkSideLength, _pager);
+		c->copyData(chunk->_data);
+		chunk->_dataModified = c->resetModified();
+	});
+}
+
+/**
+ * Makes the chunk resident and evicts other chunks if we are above the limits
+ * @note The page in lock must be held.
+ */
+void PagedVolume::addChunk(const ChunkPtr& chunk) const {
+	core::ScopedWriteLock chunkWriteLock(_volumeLock);
+	chunk->touch();
+	_chunks.put(chunk->chunkPos(), chunk);
+	_clock.push_back(chunk.get());
+	++_chunkCount;
+	_memoryUsageInBytes += chunk->memoryUsageInBytes();
+	if (!chunk->isCompressed()) {
+		++_uncompressedChunks;
+	}
+	if (_compressChunks) {
+		compressOldestChunksIfNeeded();
+	}
+	while (_chunkCount >= _chunkCountLimit || _memoryUsageInBytes > _memoryLimitInBytes) {
+		const size_t chunkCount = _chunkCount;
+		deleteOldestChunkIfNeeded();
+		if (chunkCount == _chunkCount) {
+			break;
+		}
+	}
+}
+
+/**
+ * @return @c true if the owner of the given chunk that is currently paged in is (maybe indirectly) waiting for a chunk that
+ * is paged in by the calling thread. Waiting for it would dead lock.
+ * @note The page in lock must be held.
+ */
+bool PagedVolume::waitsForCurrentThread(const PagingInChunk& pagingIn) const {
+	const std::thread::id self = std::this_thread::get_id();
+	std::thread::id owner = pagingIn.owner;
+	// each thread waits for at most one chunk - so the chain ends after visiting every waiting thread once
+	for (size_t i = 0u; i <= _waitingFor.size(); ++i) {
+		if (owner == self) {
+			return true;
+		}
+		auto waiting = _waitingFor.find(owner);
+		if (waiting == _waitingFor.end()) {
+			return false;
+		}
+		auto next = _pagingIn.find(waiting->second);
+		if (next == _pagingIn.end()) {
+			return false;
+		}
+		owner = next->second.owner;
+	}
+	return false;
+}
+
+/**
+ * Pages in the chunk without holding the volume lock - this allows to page in several chunks in parallel. If another thread
+ * is already paging in the same chunk, we wait for it to finish.
+ *
+ * A pager might write into neighbouring chunks. If such a chunk is paged in by the calling thread itself, or by a thread that
+ * is waiting for a chunk of the calling thread, the unfinished chunk is returned. In both cases nobody else is writing into it.
+ *
+ * @note The evicted modified chunks are handed over to @c Pager::pageOut() by the page out thread. If the paging threads
+ * are not running, this is done synchronously by the calling thread.
+ */
+PagedVolume::ChunkPtr PagedVolume::pageInChunk(const glm::ivec3& pos) const {
+	ChunkPtr chunk;
+	{
+		core::ScopedLock lock(_pageInLock);
+		// the chunk is resident once we return - a pending prefetch request for it is obsolete
+		_requestedChunks.erase(pos);
+		for (;;) {
+			// another thread might have paged in or decompressed the chunk while we were waiting for the lock
+			if (residentChunk(pos, chunk)) {
+				return chunk;
+			}
+			// the chunk was evicted but not yet paged out - just make it resident again
+			auto evicted = _pagingOut.find(pos);
+			if (evicted != _pagingOut.end()) {
+				chunk = core::move(evicted->second);
+				_pagingOut.erase(evicted);
+				addChunk(chunk);
+				return chunk;
+			}
+			auto i = _pagingIn.find(pos);
+			if (i == _pagingIn.end()) {
+				// the pager would load outdated data while the chunk is still written
+				if (_writingOut.find(pos) == _writingOut.end()) {
+					break;
+				}
+			} else if (waitsForCurrentThread(i->second)) {
+				// the owner is blocked until we are done - so we are the only one that is writing into the chunk
+				return i->second.chunk;
+			}
+			const std::thread::id self = std::this_thread::get_id();
+			_waitingFor[self] = pos;
+			_pageInCondition.wait(_pageInLock);
+			_waitingFor.erase(self);
+		}
+		chunk = core::make_shared<Chunk>(pos, _chunkSideLength, _pager);
+		_pagingIn.emplace(pos, PagingInChunk{chunk, std::this_thread::get_id()});
+	}
+
+	createNewChunk(chunk);
+
+	bool evicted;
+	{
+		core::ScopedLock lock(_pageInLock);
+		addChunk(chunk);
+		_pagingIn.erase(pos);
+		evicted = !_pagingOut.empty();
+	}
+	_pageInCondition.notify_all();
+	if (evicted) {
+		if (_pagingThreads != nullptr) {
+			_pageOutCondition.notify_one();
+		} else {
+			pageOutEvictedChunks();
+		}
+	}
+	return chunk;
+}
+
+/**
+ * Hands the evicted modified chunks over to the @c Pager in one batch - without holding the volume lock
+ */
+void PagedVolume::pageOutEvictedChunks() const {
+	core::DynamicArray<ChunkPtr> chunks;
+	core::DynamicArray<glm::ivec3> positions;
+	{
+		core::ScopedLock lock(_pageInLock);
+		if (_pagingOut.empty()) {
+			return;
+		}
+		chunks.reserve(_pagingOut.size());
+		positions.reserve(_pagingOut.size());
+		for (auto& e : _pagingOut) {
+			_writingOut.insert(e.first);
+			positions.push_back(e.first);
+			chunks.push_back(core::move(e.second));
+		}
+		_pagingOut.clear();
+	}
+	core_trace_scoped(PageOutChunks);
+	// the chunks are paged out explicitly - the destructor would only do it once the last reference is gone. A sampler
+	// or a write-back queue of the pager might still reference the chunk and a page in of the position could load
+	// outdated data then.
+	for (const ChunkPtr& chunk : chunks) {
+		if (!chunk->resetModified()) {
+			continue;
+		}
+		// other threads might still read the compressed data of a shared chunk - Chunk::voxel() decodes it
+		if (chunk.useCount() == 1) {
+			chunk->decompress();
+		}
+		_pager->pageOut(chunk.get());
+	}
+	chunks.clear();
+	{
+		core::ScopedLock lock(_pageInLock);
+		for (const glm::ivec3& pos : positions) {
+			_writingOut.erase(pos);
+		}
+	}
+	_pageInCondition.notify_all();
+}
+
+void PagedVolume::startPagingThreads(int threads) {
+	core_assert_msg(_pagingThreads == nullptr, "Paging threads are already running");
+	if (_pagingThreads != nullptr || threads <= 0) {
+		return;
+	}
+	_cancelPaging = false;
+	_chunkRequests.reset();
+	// one additional thread pages out the evicted chunks
+	_pagingThreads = new core::ThreadPool(threads + 1, "VolumePaging");
+	_pagingThreads->init();
+	for (int i = 0; i < threads; ++i) {
+		_pagingThreads->enqueue([this] () {while (!_cancelPaging) { prefetchChunks(); } });
+	}
+	_pagingThreads->enqueue([this] () {
+		while (!_cancelPaging) {
+			{
+				core::ScopedLock lock(_pageInLock);
+				while (_pagingOut.empty() && !_cancelPaging) {
+					_pageOutCondition.wait(_pageInLock);
+				}
+			}
+			pageOutEvictedChunks();
+		}
+	});
+}
+
+void PagedVolume::shutdownPagingThreads() {
+	if (_pagingThreads == nullptr) {
+		return;
+	}
+	{
+		core::ScopedLock lock(_pageInLock);
+		_cancelPaging = true;
+	}
+	_pageOutCondition.notify_all();
+	_chunkRequests.clear();
+	_chunkRequests.abortWait();
+	_pagingThreads->shutdown();
+	delete _pagingThreads;
+	_pagingThreads = nullptr;
+	{
+		core::ScopedLock lock(_pageInLock);
+		_requestedChunks.clear();
+	}
+	pageOutEvictedChunks();
+}
+
+void PagedVolume::prefetchChunks() {
+	ChunkRequest request;
+	if (!_chunkRequests.waitAndPop(request)) {
+		return;
+	}
+	core_trace_scoped(PrefetchChunk);
+	if (_chunks.visit(request.pos, [] (const ChunkPtr&) {})) {
+		core::ScopedLock lock(_pageInLock);
+		_requestedChunks.erase(request.pos);
+		return;
+	}
+	pageInChunk(request.pos);
+}
+
+void PagedVolume::requestChunks(const Region& region, int priority) const {
+	core_trace_scoped(RequestChunks);
+	const glm::ivec3& mins = chunkPos(region.getLowerCorner());
+	const glm::ivec3& maxs = chunkPos(region.getUpperCorner());
+	core::ScopedLock lock(_pageInLock);
+	for (int32_t z = mins.z; z <= maxs.z; ++z) {
+		for (int32_t y = mins.y; y <= maxs.y; ++y) {
+			for (int32_t x = mins.x; x <= maxs.x; ++x) {
+				const glm::ivec3 pos(x, y, z);
+				if (_chunks.visit(pos, [] (const ChunkPtr&) {})) {
+					continue;
+				}
+				if (_pagingIn.find(pos) != _pagingIn.end()) {
+					continue;
+				}
+				if (!_requestedChunks.insert(pos).second) {
+					continue;
+				}
+				_chunkRequests.push(ChunkRequest{pos, priority});
+			}
+		}
+	}
+}
+
+size_t PagedVolume::pendingChunkRequests() const {
+	return _chunkRequests.size();
+}
+
+bool PagedVolume::isChunkReady(const glm::ivec3& worldPos) const {
+	return _chunks.visit(chunkPos(worldPos), [] (const ChunkPtr&) {});
+}
+
+bool PagedVolume::isRegionReady(const Region& region) const {
+	const glm::ivec3& mins = chunkPos(region.getLowerCorner());
+	const glm::ivec3& maxs = chunkPos(region.getUpperCorner());
+	for (int32_t z = mins.z; z <= maxs.z; ++z) {
+		for (int32_t y = mins.y; y <= maxs.y; ++y) {
+			for (int32_t x = mins.x; x <= maxs.x; ++x) {
+				if (!_chunks.visit(glm::ivec3(x, y, z), [] (const ChunkPtr&) {})) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+void PagedVolume::setPlaceholderVoxel(const Voxel& voxel) {
+	ChunkPtr chunk = createPlaceholderChunk(voxel);
+	core::ScopedLock lock(_pageInLock);
+	_placeholderChunk = chunk;
+}
+
+PagedVolume::ChunkPtr PagedVolume::createPlaceholderChunk(const Voxel& voxel) const {
+	// the position is never used by a real chunk - this way a sampler can't mistake it for one
+	const glm::ivec3 pos((std::numeric_limits<int32_t>::min)());
+	ChunkPtr chunk = core::make_shared<Chunk>(pos, _chunkSideLength, _pager);
+	const uint32_t voxels = chunk->voxels();
+	for (uint32_t i = 0u; i < voxels; ++i) {
+		chunk->_data[i] = voxel;
+	}
 	return chunk;
 }
 
+PagedVolume::ChunkPtr PagedVolume::placeholderChunk() const {
+	core::ScopedLock lock(_pageInLock);
+	if (!_placeholderChunk) {
+		_placeholderChunk = createPlaceholderChunk(Voxel());
+	}
+	return _placeholderChunk;
+}
+
 }
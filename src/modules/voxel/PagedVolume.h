@@ -11,8 +11,16 @@
 #include "core/Assert.h"
 #include "core/concurrent/ReadWriteLock.h"
 #include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/ThreadPool.h"
 #include "core/collection/Map.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/ConcurrentPriorityQueue.h"
 #include "core/SharedPtr.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
 
 namespace voxel {
 
@@ -46,10 +54,37 @@ public:
 		~Chunk();
 
 		bool setData(const Voxel* voxels, size_t sizeInBytes);
+		/**
+		 * @return The uncompressed voxel data or @c nullptr if the chunk is currently compressed
+		 * @sa decompress()
+		 */
 		Voxel* data() const;
 		uint32_t dataSizeInBytes() const;
 		uint32_t voxels() const;
 
+		/**
+		 * @brief Replaces the flat voxel array by a chunk local palette and bit packed palette indices
+		 * @return @c false if the chunk is already compressed or if the amount of unique voxels is too high
+		 * to save any memory.
+		 * @note The caller must make sure that nobody holds a pointer into the uncompressed data.
+		 */
+		bool compress();
+		/**
+		 * @brief Restores the flat voxel array from the compressed representation.
+		 */
+		void decompress();
+		/**
+		 * @brief Writes the uncompressed voxel data into the given buffer without decompressing the chunk
+		 * @param[out] target Must be able to hold @c dataSizeInBytes() bytes
+		 */
+		void copyData(Voxel* target) const;
+		bool isCompressed() const;
+		/**
+		 * @return The amount of bytes that are currently allocated for the voxels of this chunk - this
+		 * depends on whether the chunk is compressed or not.
+		 */
+		uint32_t memoryUsageInBytes() const;
+
 		const Voxel& voxel(uint32_t x, uint32_t y, uint32_t z) const;
 		const Voxel& voxel(const glm::i16vec3& pos) const;
 
@@ -61,18 +96,60 @@ public:
 		const glm::ivec3& chunkPos() const;
 		int16_t sideLength() const;
 
+		/**
+		 * @return @c true if the voxels were changed since the chunk was paged in or since the last
+		 * @c resetModified() call. Modified chunks are handed over to @c Pager::pageOut() once they are evicted.
+		 */
+		bool isModified() const;
+		/**
+		 * @brief Clears the modified state - e.g. after the chunk was persisted
+		 * @return The previous modified state
+		 */
+		bool resetModified();
+
 	private:
-		// This is updated by the PagedVolume and used to discard the least recently used chunks.
-		uint32_t _chunkLastAccessed = 0u;
+		// Set on every access and cleared by the clock hands of the PagedVolume - a chunk that wasn't accessed
+		// since the hand passed it the last time is evicted (or compressed). Updated concurrently by all threads
+		// that are looking up this chunk.
+		core::AtomicBool _referenced { true };
+		core::AtomicBool _recentlyUsed { true };
+
+		inline void touch() {
+			// avoid the write if possible - the flags are shared between all threads
+			if (!_referenced) {
+				_referenced = true;
+			}
+			if (!_recentlyUsed) {
+				_recentlyUsed = true;
+			}
+		}
+
+		inline void markModified() {
+			// avoid the atomic write for every voxel
+			if (_dataModified) {
+				return;
+			}
+			if (!_dataModified.exchange(true)) {
+				_pager->modified(this);
+			}
+		}
 
 		static uint32_t calculateSizeInBytes(uint32_t sideLength);
 
 		Voxel* _data = nullptr;
+
+		// The compressed representation - only valid if _data is nullptr. Each voxel is stored as
+		// an index into the chunk local palette with _bitsPerIndex bits (0, 1, 2, 4 or 8).
+		Voxel* _palette = nullptr;
+		uint64_t* _indices = nullptr;
+		uint32_t _paletteSize = 0u;
+		uint8_t _bitsPerIndex = 0u;
 		uint16_t _sideLength = 0u;
 
 		// This is so we can tell whether a uncompressed chunk has to be recompressed and whether
 		// a compressed chunk has to be paged back to disk, or whether they can just be discarded.
-		bool _dataModified = false;
+		// Set by all writes to the voxels and might be reset by a pager thread after persisting the chunk.
+		core::AtomicBool _dataModified { false };
 
 		uint8_t _sideLengthPower = 0b0;
 		Pager* _pager;
@@ -82,6 +159,114 @@ public:
 	};
 	typedef core::SharedPtr<Chunk> ChunkPtr;
 
+	/**
+	 * @brief Concurrent map of chunk positions to chunks.
+	 *
+	 * The positions are distributed over several shards that are each guarded by their own lock and store the
+	 * chunks in an open addressing table with linear probing. Lookups from different threads thus only contend
+	 * if they hit the same shard at the same time - there is no global lock involved.
+	 */
+	class ChunkIndex : public core::NonCopyable {
+	private:
+		struct Entry {
+			glm::ivec3 pos { 0 };
+			ChunkPtr chunk;
+		};
+
+		struct Shard {
+			mutable core::ReadWriteLock lock { "chunkindex" };
+			Entry* entries core_thread_guarded_by(lock) = nullptr;
+			uint32_t capacity core_thread_guarded_by(lock) = 0u;
+			uint32_t size core_thread_guarded_by(lock) = 0u;
+		};
+
+		static constexpr uint32_t ShardCount = 64u;
+		static constexpr uint32_t InitialShardCapacity = 16u;
+		Shard _shards[ShardCount];
+
+		static inline uint32_t hash(const glm::ivec3& pos) {
+			return ((uint32_t)pos.x * 73856093u) ^ ((uint32_t)pos.y * 19349663u) ^ ((uint32_t)pos.z * 83492791u);
+		}
+
+		inline Shard& shard(uint32_t hashValue) const {
+			return const_cast<Shard&>(_shards[hashValue % ShardCount]);
+		}
+
+		// returns the slot of the given position or -1 if not found - the shard lock must be held
+		static int findSlot(const Shard& shard, const glm::ivec3& pos, uint32_t hashValue);
+		static void grow(Shard& shard);
+
+	public:
+		ChunkIndex() {}
+		~ChunkIndex();
+
+		/**
+		 * @brief Calls the given functor with the chunk at the given position while holding the shared
+		 * lock of the shard.
+		 * @return @c false if there is no chunk at the given position
+		 */
+		template<class FUNC>
+		bool visit(const glm::ivec3& pos, FUNC&& func) const {
+			const uint32_t hashValue = hash(pos);
+			const Shard& s = shard(hashValue);
+			core::ScopedReadLock lock(s.lock);
+			const int slot = findSlot(s, pos, hashValue);
+			if (slot == -1) {
+				return false;
+			}
+			func(s.entries[slot].chunk);
+			return true;
+		}
+
+		/**
+		 * @brief Calls the given functor with the chunk at the given position while holding the exclusive
+		 * lock of the shard. Nobody is able to obtain a reference to the chunk meanwhile.
+		 * @return @c false if there is no chunk at the given position
+		 */
+		template<class FUNC>
+		bool visitExclusive(const glm::ivec3& pos, FUNC&& func) {
+			const uint32_t hashValue = hash(pos);
+			Shard& s = shard(hashValue);
+			core::ScopedWriteLock lock(s.lock);
+			const int slot = findSlot(s, pos, hashValue);
+			if (slot == -1) {
+				return false;
+			}
+			func(s.entries[slot].chunk);
+			return true;
+		}
+
+		/**
+		 * @brief Calls the given functor for every chunk. Every shard is locked while its chunks are visited.
+		 */
+		template<class FUNC>
+		void visitAll(FUNC&& func) const {
+			for (uint32_t i = 0u; i < ShardCount; ++i) {
+				const Shard& s = _shards[i];
+				core::ScopedReadLock lock(s.lock);
+				for (uint32_t slot = 0u; slot < s.capacity; ++slot) {
+					const Entry& entry = s.entries[slot];
+					if (entry.chunk) {
+						func(entry.pos, entry.chunk);
+					}
+				}
+			}
+		}
+
+		bool get(const glm::ivec3& pos, ChunkPtr& chunk) const;
+		/**
+		 * @brief Adds or replaces the chunk at the given position
+		 */
+		void put(const glm::ivec3& pos, const ChunkPtr& chunk);
+		bool remove(const glm::ivec3& pos);
+		/**
+		 * @param[out] removed The removed chunk - this allows to control where the chunk is destroyed
+		 */
+		bool remove(const glm::ivec3& pos, ChunkPtr& removed);
+		void clear();
+		size_t size() const;
+	};
+
 	struct PagerContext {
 		Region region;
 		ChunkPtr chunk;
@@ -104,9 +289,24 @@ public:
 
 		/**
 		 * @return @c true if the chunk was modified (created), @c false if it was just loaded
+		 * @note This is called without holding the volume lock - different chunks might be paged in
+		 * concurrently if @c PagedVolume::startPagingThreads() was called or several threads access the volume.
 		 */
 		virtual bool pageIn(PagerContext& ctx) = 0;
 		virtual void pageOut(Chunk* chunk) = 0;
+		/**
+		 * @brief Called for the first write into a chunk after it was paged in or after @c Chunk::resetModified()
+		 * @note This is called by the thread that writes into the chunk - but not for the writes of @c pageIn() into
+		 * the chunk that is paged in
+		 */
+		virtual void modified(Chunk* chunk) {
+		}
+		/**
+		 * @brief Persists and stops the asynchronous write-back of modified chunks (if any). This must be called
+		 * before the volume is destroyed - the pager must not access the volume anymore afterwards.
+		 */
+		virtual void shutdownWriteBack() {
+		}
 	};
 
 	typedef core::SharedPtr<Pager> PagerPtr;
@@ -135,8 +335,16 @@ public:
 		virtual void setPosition(int32_t xPos, int32_t yPos, int32_t zPos);
 		/**
 		 * @brief Set the given voxel to the current position in the sampler
+		 * @return @c false if the position is not yet paged in and the sampler is in non-blocking mode
 		 */
 		bool setVoxel(const Voxel& voxel);
+
+		/**
+		 * @brief In non-blocking mode the sampler doesn't wait for chunks to get paged in. Missing chunks are
+		 * requested via @c PagedVolume::requestChunks() and the placeholder voxel is returned until they are ready.
+		 * @sa PagedVolume::setPlaceholderVoxel()
+		 */
+		void setNonBlocking(bool nonBlocking);
 		glm::ivec3 position() const;
 
 		/**
@@ -212,17 +420,22 @@ public:
 		int32_t _lastZChunk = 0;
 
 		const uint16_t _chunkSideLengthMinusOne;
+		bool _nonBlocking = false;
+		// the current chunk isn't paged in yet and the placeholder chunk is used instead
+		bool _placeholder = false;
+
+		ChunkPtr chunk(int32_t xChunk, int32_t yChunk, int32_t zChunk) const;
 	};
 
 public:
 	/** @brief Constructor for creating a fixed size volume. */
-	PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes = 256 * 1024 * 1024, uint16_t chunkSideLength = 32);
+	PagedVolume(Pager* pager, uint32_t targetMemoryUsageInBytes = 256 * 1024 * 1024, uint16_t chunkSideLength = 32, bool compressChunks = false);
 	~PagedVolume();
 
 	/** @brief Gets a voxel at the position given by <tt>x,y,z</tt> coordinates */
-	const Voxel& voxel(int32_t x, int32_t y, int32_t z) const;
+	Voxel voxel(int32_t x, int32_t y, int32_t z) const;
 	/** @brief Gets a voxel at the position given by a 3D vector */
-	const Voxel& voxel(const glm::ivec3& v3dPos) const;
+	Voxel voxel(const glm::ivec3& v3dPos) const;
 
 	const Region& region() const;
 
@@ -249,6 +462,59 @@ public:
 		return _chunkSideLength;
 	}
 
+	/**
+	 * @return The amount of bytes that are currently used for the voxels of all resident chunks
+	 */
+	size_t memoryUsageInBytes() const;
+
+	/**
+	 * @brief Starts the worker threads that page in the chunks that were requested via @c requestChunks(). An additional
+	 * thread pages out the evicted chunks.
+	 * @note The @c Pager must be able to handle concurrent @c Pager::pageIn() calls
+	 * @note Without the paging threads the evicted modified chunks are paged out by the thread that caused the eviction -
+	 * e.g. a sampler. It is blocked until @c Pager::pageOut() returned.
+	 */
+	void startPagingThreads(int threads = 2);
+	/**
+	 * @brief Stops the paging workers and drops all pending chunk requests. Evicted chunks are paged out.
+	 */
+	void shutdownPagingThreads();
+	/**
+	 * @brief Queue all chunks that intersect the given region to get paged in by the prefetch threads.
+	 * Chunks that are already resident or queued are skipped.
+	 * @param priority Requests with higher priority values are paged in first
+	 */
+	void requestChunks(const Region& region, int priority = 0) const;
+	/**
+	 * @return The amount of chunk requests that weren't yet handled by the prefetch threads
+	 */
+	size_t pendingChunkRequests() const;
+	/**
+	 * @return @c true if the chunk that contains the given voxel position is resident - accessing it won't block
+	 */
+	bool isChunkReady(const glm::ivec3& worldPos) const;
+	/**
+	 * @return @c true if all chunks that intersect the given region are resident
+	 */
+	bool isRegionReady(const Region& region) const;
+	/**
+	 * @brief Looks up the chunk at the given chunk position without paging it in. A compressed chunk is decompressed.
+	 * @return @c false if the chunk is not resident
+	 */
+	bool residentChunk(const glm::ivec3& pos, ChunkPtr& chunk) const;
+	/**
+	 * @brief Looks up the chunk at the given chunk position without paging it in or decompressing it. For a compressed
+	 * chunk a detached copy of its voxels is returned - the modified state is moved over to the copy. This allows to
+	 * persist resident chunks without touching the volume lock.
+	 * @return @c false if the chunk is not resident
+	 */
+	bool residentChunkSnapshot(const glm::ivec3& pos, ChunkPtr& chunk) const;
+	/**
+	 * @brief The voxel that non-blocking samplers return for positions that aren't paged in yet
+	 * @sa Sampler::setNonBlocking()
+	 */
+	void setPlaceholderVoxel(const Voxel& voxel);
+
 protected:
 	/// Copy constructor
 	PagedVolume(const PagedVolume& rhs);
@@ -257,16 +523,43 @@ protected:
 	PagedVolume& operator=(const PagedVolume& rhs);
 
 private:
+	struct PagingInChunk {
+		ChunkPtr chunk;
+		// the thread that executes the Pager::pageIn() call for this chunk
+		std::thread::id owner;
+	};
+
 	ChunkPtr chunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
-	ChunkPtr createNewChunk(int32_t uChunkX, int32_t uChunkY, int32_t uChunkZ) const;
+	void createNewChunk(const ChunkPtr& chunk) const;
+	ChunkPtr pageInChunk(const glm::ivec3& pos) const;
+	bool waitsForCurrentThread(const PagingInChunk& pagingIn) const;
+	ChunkPtr createPlaceholderChunk(const Voxel& voxel) const;
+	ChunkPtr placeholderChunk() const;
+	void prefetchChunks();
+	void addChunk(const ChunkPtr& chunk) const;
+	void pageOutEvictedChunks() const;
 	void deleteOldestChunkIfNeeded() const;
+	void compressOldestChunksIfNeeded() const;
 
-	mutable int32_t _timestamper = 0;
+	// the max amount of (compressed) chunks per uncompressed chunk that would fit into the memory limit
+	static constexpr uint32_t MaxCompressionFactor = 16u;
 
 	uint32_t _chunkCountLimit = 0u;
-
-	typedef core::Map<glm::ivec3, ChunkPtr, 64, glm::hash<glm::ivec3>> ChunkMap;
-	mutable ChunkMap _chunks core_thread_guarded_by(_volumeLock);
+	// only used if chunk compression is active - the amount of chunks that are kept decompressed
+	uint32_t _uncompressedChunkLimit = 0u;
+	mutable uint32_t _uncompressedChunks = 0u;
+	size_t _memoryLimitInBytes = 0u;
+	mutable size_t _memoryUsageInBytes = 0u;
+	mutable size_t _chunkCount = 0u;
+	bool _compressChunks;
+
+	// Lookups of resident chunks don't need the volume lock - it's only acquired to page in, compress
+	// or delete chunks.
+	mutable ChunkIndex _chunks;
+	// All resident chunks in the order the clock hands visit them - owned by @c _chunks. Guarded by the volume lock.
+	mutable core::DynamicArray<Chunk*> _clock;
+	mutable size_t _evictionHand = 0u;
+	mutable size_t _compressionHand = 0u;
 
 	// The size of the chunks
 	uint16_t _chunkSideLength;
@@ -278,6 +571,32 @@ private:
 	Region _region;
 
 	mutable core::ReadWriteLock _volumeLock{"pagedvolume"};
+
+	struct ChunkRequest {
+		glm::ivec3 pos;
+		int priority;
+
+		inline bool operator<(const ChunkRequest& rhs) const {
+			return priority < rhs.priority;
+		}
+	};
+
+	// Chunks are paged in and out without holding the volume lock. This lock guards the chunks that are currently
+	// paged in or out and the queued chunk requests. It must always be acquired before the volume lock.
+	mutable core_trace_mutex(core::Lock, _pageInLock, "PagedVolumePageIn");
+	mutable core::ConditionVariable _pageInCondition;
+	mutable core::ConditionVariable _pageOutCondition;
+	mutable std::unordered_map<glm::ivec3, PagingInChunk, glm::hash<glm::ivec3>> _pagingIn;
+	// the chunk positions the paging threads are waiting for - used to detect pagers that wait for each other
+	mutable std::unordered_map<std::thread::id, glm::ivec3> _waitingFor;
+	// evicted modified chunks that are waiting to get paged out - they are resident again if requested in the meantime
+	mutable std::unordered_map<glm::ivec3, ChunkPtr, glm::hash<glm::ivec3>> _pagingOut;
+	mutable std::unordered_set<glm::ivec3, glm::hash<glm::ivec3>> _writingOut;
+	mutable std::unordered_set<glm::ivec3, glm::hash<glm::ivec3>> _requestedChunks;
+	mutable core::ConcurrentPriorityQueue<ChunkRequest> _chunkRequests;
+	core::ThreadPool* _pagingThreads = nullptr;
+	core::AtomicBool _cancelPaging { false };
+	mutable ChunkPtr _placeholderChunk;
 };
 
 inline const Voxel& PagedVolume::Sampler::voxel() const {
@@ -7,6 +7,7 @@
 #include "math/Functions.h"
 #include "core/Common.h"
 #include "core/StandardLib.h"
+#include "core/Trace.h"
 
 namespace voxel {
 
@@ -27,18 +28,158 @@ PagedVolume::Chunk::Chunk(const glm::ivec3& pos, uint16_t sideLength, Pager* pag
 
 PagedVolume::Chunk::~Chunk() {
 	if (_dataModified && _pager) {
+		decompress();
 		_pager->pageOut(this);
 	}
 
 	core_free(_data);
 	_data = nullptr;
+	core_free(_palette);
+	_palette = nullptr;
+	core_free(_indices);
+	_indices = nullptr;
+}
+
+// Max amount of unique voxels in a chunk to still compress it. Anything above would need more
+// than 8 bits per index and wouldn't save enough memory compared to the uncompressed data.
+static constexpr uint32_t MaxPaletteEntries = 256u;
+static_assert(sizeof(Voxel) == sizeof(uint16_t), "Voxel is expected to be 16 bits");
+
+static inline uint16_t voxelKey(const Voxel& voxel) {
+	uint16_t key;
+	core_memcpy(&key, &voxel, sizeof(key));
+	return key;
+}
+
+static inline uint8_t bitsForPaletteSize(uint32_t paletteSize) {
+	// only power of two bit widths - this way an index never crosses a word boundary
+	if (paletteSize <= 1u) {
+		return 0u;
+	}
+	if (paletteSize <= 2u) {
+		return 1u;
+	}
+	if (paletteSize <= 4u) {
+		return 2u;
+	}
+	if (paletteSize <= 16u) {
+		return 4u;
+	}
+	return 8u;
+}
+
+bool PagedVolume::Chunk::compress() {
+	if (_data == nullptr) {
+		return false;
+	}
+	core_trace_scoped(ChunkCompress);
+	const uint32_t voxelCount = voxels();
+
+	// open addressing table that maps the raw voxel value to the palette index
+	constexpr uint32_t TableSize = MaxPaletteEntries * 2u;
+	uint16_t tableKeys[TableSize];
+	int16_t tableValues[TableSize];
+	for (uint32_t i = 0u; i < TableSize; ++i) {
+		tableValues[i] = -1;
+	}
+	Voxel palette[MaxPaletteEntries];
+	uint32_t paletteSize = 0u;
+
+	uint8_t* paletteIndices = (uint8_t*)core_malloc(voxelCount);
+	for (uint32_t i = 0u; i < voxelCount; ++i) {
+		const uint16_t key = voxelKey(_data[i]);
+		uint32_t slot = (key * 2654435761u) & (TableSize - 1u);
+		while (tableValues[slot] != -1 && tableKeys[slot] != key) {
+			slot = (slot + 1u) & (TableSize - 1u);
+		}
+		if (tableValues[slot] == -1) {
+			if (paletteSize >= MaxPaletteEntries) {
+				core_free(paletteIndices);
+				return false;
+			}
+			tableKeys[slot] = key;
+			tableValues[slot] = (int16_t)paletteSize;
+			palette[paletteSize++] = _data[i];
+		}
+		paletteIndices[i] = (uint8_t)tableValues[slot];
+	}
+
+	_bitsPerIndex = bitsForPaletteSize(paletteSize);
+	_paletteSize = paletteSize;
+	_palette = (Voxel*)core_malloc(paletteSize * sizeof(Voxel));
+	core_memcpy(_palette, palette, paletteSize * sizeof(Voxel));
+	if (_bitsPerIndex > 0u) {
+		const uint32_t indicesPerWord = 64u / _bitsPerIndex;
+		const uint32_t words = (voxelCount + indicesPerWord - 1u) / indicesPerWord;
+		_indices = (uint64_t*)core_malloc(words * sizeof(uint64_t));
+		core_memset(_indices, 0, words * sizeof(uint64_t));
+		for (uint32_t i = 0u; i < voxelCount; ++i) {
+			const uint32_t shift = (i % indicesPerWord) * _bitsPerIndex;
+			_indices[i / indicesPerWord] |= (uint64_t)paletteIndices[i] << shift;
+		}
+	}
+	core_free(paletteIndices);
+	core_free(_data);
+	_data = nullptr;
+	return true;
+}
+
+void PagedVolume::Chunk::decompress() {
+	if (_data != nullptr) {
+		return;
+	}
+	core_trace_scoped(ChunkDecompress);
+	Voxel* data = (Voxel*)core_malloc(dataSizeInBytes());
+	copyData(data);
+	_data = data;
+	core_free(_palette);
+	_palette = nullptr;
+	core_free(_indices);
+	_indices = nullptr;
+	_paletteSize = 0u;
+	_bitsPerIndex = 0u;
+}
+
+void PagedVolume::Chunk::copyData(Voxel* target) const {
+	const uint32_t voxelCount = voxels();
+	if (_data != nullptr) {
+		core_memcpy(target, _data, dataSizeInBytes());
+	} else if (_bitsPerIndex == 0u) {
+		for (uint32_t i = 0u; i < voxelCount; ++i) {
+			target[i] = _palette[0];
+		}
+	} else {
+		const uint32_t indicesPerWord = 64u / _bitsPerIndex;
+		const uint64_t mask = (1u << _bitsPerIndex) - 1u;
+		for (uint32_t i = 0u; i < voxelCount; ++i) {
+			const uint32_t shift = (i % indicesPerWord) * _bitsPerIndex;
+			target[i] = _palette[(_indices[i / indicesPerWord] >> shift) & mask];
+		}
+	}
+}
+
+bool PagedVolume::Chunk::isCompressed() const {
+	return _data == nullptr;
+}
+
+uint32_t PagedVolume::Chunk::memoryUsageInBytes() const {
+	if (_data != nullptr) {
+		return dataSizeInBytes();
+	}
+	uint32_t indexBytes = 0u;
+	if (_bitsPerIndex > 0u) {
+		const uint32_t indicesPerWord = 64u / _bitsPerIndex;
+		indexBytes = (voxels() + indicesPerWord - 1u) / indicesPerWord * (uint32_t)sizeof(uint64_t);
+	}
+	return _paletteSize * (uint32_t)sizeof(Voxel) + indexBytes;
 }
 
 bool PagedVolume::Chunk::setData(const Voxel* voxels, size_t sizeInBytes) {
 	if (sizeInBytes != dataSizeInBytes()) {
 		return false;
 	}
-	_dataModified = true;
+	decompress();
+	markModified();
 	core_memcpy((uint8_t*)_data, (const uint8_t*)voxels, sizeInBytes);
 	return true;
 }
@@ -61,10 +202,19 @@ const Voxel& PagedVolume::Chunk::voxel(uint32_t x, uint32_t y, uint32_t z) const
 	core_assert_msg(x < _sideLength, "Supplied position is outside of the chunk. asserted %u > %u", x, _sideLength);
 	core_assert_msg(y < _sideLength, "Supplied position is outside of the chunk. asserted %u > %u", y, _sideLength);
 	core_assert_msg(z < _sideLength, "Supplied position is outside of the chunk. asserted %u > %u", z, _sideLength);
-	core_assert_msg(_data, "No uncompressed data - chunk must be decompressed before accessing voxels.");
 
 	const uint32_t index = morton256_x[x] | morton256_y[y] | morton256_z[z];
-	return _data[index];
+	if (_data != nullptr) {
+		return _data[index];
+	}
+	// decode the voxel directly from the compressed representation
+	if (_bitsPerIndex == 0u) {
+		return _palette[0];
+	}
+	const uint32_t indicesPerWord = 64u / _bitsPerIndex;
+	const uint32_t shift = (index % indicesPerWord) * _bitsPerIndex;
+	const uint64_t mask = (1u << _bitsPerIndex) - 1u;
+	return _palette[(_indices[index / indicesPerWord] >> shift) & mask];
 }
 
 const Voxel& PagedVolume::Chunk::voxel(const glm::i16vec3& pos) const {
@@ -81,7 +231,7 @@ void PagedVolume::Chunk::setVoxel(uint32_t x, uint32_t y, uint32_t z, const Voxe
 
 	const uint32_t index = morton256_x[x] | morton256_y[y] | morton256_z[z];
 	_data[index] = value;
-	_dataModified = true;
+	markModified();
 }
 
 void PagedVolume::Chunk::setVoxels(uint32_t x, uint32_t z, const Voxel* values, int amount) {
@@ -101,13 +251,21 @@ void PagedVolume::Chunk::setVoxels(uint32_t x, uint32_t y, uint32_t z, const Vox
 		const uint32_t index = morton256_x[x] | morton256_y[i] | morton256_z[z];
 		_data[index] = values[i];
 	}
-	_dataModified = true;
+	markModified();
 }
 
 int16_t PagedVolume::Chunk::sideLength() const {
 	return _sideLength;
 }
 
+bool PagedVolume::Chunk::isModified() const {
+	return _dataModified;
+}
+
+bool PagedVolume::Chunk::resetModified() {
+	return _dataModified.exchange(false);
+}
+
 const glm::ivec3& PagedVolume::Chunk::chunkPos() const {
 	return _chunkSpacePosition;
 }
@@ -0,0 +1,144 @@
+/**
+ * @file
+ */
+
+#include "PagedVolume.h"
+
+namespace voxel {
+
+PagedVolume::ChunkIndex::~ChunkIndex() {
+	clear();
+}
+
+int PagedVolume::ChunkIndex::findSlot(const Shard& shard, const glm::ivec3& pos, uint32_t hashValue) {
+	if (shard.capacity == 0u) {
+		return -1;
+	}
+	const uint32_t mask = shard.capacity - 1u;
+	// the lower bits are used to select the shard
+	uint32_t slot = (hashValue / ShardCount) & mask;
+	for (;;) {
+		const Entry& entry = shard.entries[slot];
+		if (!entry.chunk) {
+			return -1;
+		}
+		if (entry.pos == pos) {
+			return (int)slot;
+		}
+		slot = (slot + 1u) & mask;
+	}
+}
+
+void PagedVolume::ChunkIndex::grow(Shard& shard) {
+	Entry* oldEntries = shard.entries;
+	const uint32_t oldCapacity = shard.capacity;
+	shard.capacity = oldCapacity == 0u ? InitialShardCapacity : oldCapacity * 2u;
+	shard.entries = new Entry[shard.capacity];
+	const uint32_t mask = shard.capacity - 1u;
+	for (uint32_t i = 0u; i < oldCapacity; ++i) {
+		Entry& entry = oldEntries[i];
+		if (!entry.chunk) {
+			continue;
+		}
+		uint32_t slot = (hash(entry.pos) / ShardCount) & mask;
+		while (shard.entries[slot].chunk) {
+			slot = (slot + 1u) & mask;
+		}
+		shard.entries[slot].pos = entry.pos;
+		shard.entries[slot].chunk = core::move(entry.chunk);
+	}
+	delete[] oldEntries;
+}
+
+bool PagedVolume::ChunkIndex::get(const glm::ivec3& pos, ChunkPtr& chunk) const {
+	return visit(pos, [&chunk] (const ChunkPtr& c) {
+		chunk = c;
+	});
+}
+
+void PagedVolume::ChunkIndex::put(const glm::ivec3& pos, const ChunkPtr& chunk) {
+	const uint32_t hashValue = hash(pos);
+	Shard& s = shard(hashValue);
+	core::ScopedWriteLock lock(s.lock);
+	const int existing = findSlot(s, pos, hashValue);
+	if (existing != -1) {
+		s.entries[existing].chunk = chunk;
+		return;
+	}
+	// keep the load factor below 0.75
+	if ((s.size + 1u) * 4u > s.capacity * 3u) {
+		grow(s);
+	}
+	const uint32_t mask = s.capacity - 1u;
+	uint32_t slot = (hashValue / ShardCount) & mask;
+	while (s.entries[slot].chunk) {
+		slot = (slot + 1u) & mask;
+	}
+	s.entries[slot].pos = pos;
+	s.entries[slot].chunk = chunk;
+	++s.size;
+}
+
+bool PagedVolume::ChunkIndex::remove(const glm::ivec3& pos) {
+	ChunkPtr removed;
+	return remove(pos, removed);
+}
+
+bool PagedVolume::ChunkIndex::remove(const glm::ivec3& pos, ChunkPtr& removed) {
+	const uint32_t hashValue = hash(pos);
+	Shard& s = shard(hashValue);
+	{
+		core::ScopedWriteLock lock(s.lock);
+		const int found = findSlot(s, pos, hashValue);
+		if (found == -1) {
+			return false;
+		}
+		// the chunk destructor might page out the data - don't do this while holding the lock
+		removed = core::move(s.entries[found].chunk);
+		--s.size;
+
+		// backward shift deletion - move the following entries of the probe sequence into the gap
+		const uint32_t mask = s.capacity - 1u;
+		uint32_t gap = (uint32_t)found;
+		uint32_t slot = (gap + 1u) & mask;
+		while (s.entries[slot].chunk) {
+			const uint32_t ideal = (hash(s.entries[slot].pos) / ShardCount) & mask;
+			// only move the entry if the gap is between its ideal slot and its current slot
+			if (((slot - ideal) & mask) >= ((slot - gap) & mask)) {
+				s.entries[gap].pos = s.entries[slot].pos;
+				s.entries[gap].chunk = core::move(s.entries[slot].chunk);
+				gap = slot;
+			}
+			slot = (slot + 1u) & mask;
+		}
+	}
+	return true;
+}
+
+void PagedVolume::ChunkIndex::clear() {
+	for (uint32_t i = 0u; i < ShardCount; ++i) {
+		Shard& s = _shards[i];
+		Entry* entries;
+		{
+			core::ScopedWriteLock lock(s.lock);
+			entries = s.entries;
+			s.entries = nullptr;
+			s.capacity = 0u;
+			s.size = 0u;
+		}
+		// the chunk destructors might page out the data - don't do this while holding the lock
+		delete[] entries;
+	}
+}
+
+size_t PagedVolume::ChunkIndex::size() const {
+	size_t n = 0u;
+	for (uint32_t i = 0u; i < ShardCount; ++i) {
+		const Shard& s = _shards[i];
+		core::ScopedReadLock lock(s.lock);
+		n += s.size;
+	}
+	return n;
+}
+
+}
@@ -34,6 +34,27 @@ PagedVolume::Sampler::Sampler(const PagedVolume& volume) :
 PagedVolume::Sampler::~Sampler() {
 }
 
+void PagedVolume::Sampler::setNonBlocking(bool nonBlocking) {
+	_nonBlocking = nonBlocking;
+	// force a new lookup of the current chunk
+	_currentVoxel = nullptr;
+}
+
+PagedVolume::ChunkPtr PagedVolume::Sampler::chunk(int32_t xChunk, int32_t yChunk, int32_t zChunk) const {
+	if (!_nonBlocking) {
+		return _volume->chunk(xChunk, yChunk, zChunk);
+	}
+	const glm::ivec3 pos(xChunk, yChunk, zChunk);
+	if (_volume->_chunks.visit(pos, [] (const ChunkPtr&) {})) {
+		// resident - this might still need to decompress the chunk, but doesn't page it in
+		return _volume->chunk(xChunk, yChunk, zChunk);
+	}
+	const int32_t chunkSideLength = _volume->_chunkSideLength;
+	const glm::ivec3 mins = pos * chunkSideLength;
+	_volume->requestChunks(Region(mins, mins + (chunkSideLength - 1)));
+	return _volume->placeholderChunk();
+}
+
 const Voxel& PagedVolume::Sampler::voxelAt(int x, int y, int z) const {
 	const int32_t xChunk = x >> _volume->_chunkSideLengthPower;
 	const int32_t yChunk = y >> _volume->_chunkSideLengthPower;
@@ -47,7 +68,7 @@ const Voxel& PagedVolume::Sampler::voxelAt(int x, int y, int z) const {
 			return _cachedChunk->voxel(xOffset, yOffset, zOffset);
 		}
 	}
-	_cachedChunk = _volume->chunk(xChunk, yChunk, zChunk);
+	_cachedChunk = chunk(xChunk, yChunk, zChunk);
 	return _cachedChunk->voxel(xOffset, yOffset, zOffset);
 }
 
@@ -59,19 +80,22 @@ void PagedVolume::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos)
 	const int32_t yChunk = yPos >> _volume->_chunkSideLengthPower;
 	const int32_t zChunk = zPos >> _volume->_chunkSideLengthPower;
 
-	if (_currentVoxel == nullptr || _lastXChunk != xChunk || _lastYChunk != yChunk || _lastZChunk != zChunk) {
+	if (_currentVoxel == nullptr || _placeholder || _lastXChunk != xChunk || _lastYChunk != yChunk || _lastZChunk != zChunk) {
 		if (_cachedChunk) {
 			const glm::ivec3& chunkPos = _cachedChunk->chunkPos();
 			if (chunkPos.x == xChunk && chunkPos.y == yChunk && chunkPos.z == zChunk) {
 				core::exchange(_cachedChunk, _currentChunk);
 			} else {
 				_cachedChunk = _currentChunk;
-				_currentChunk = _volume->chunk(xChunk, yChunk, zChunk);
+				_currentChunk = chunk(xChunk, yChunk, zChunk);
 			}
 		} else {
 			_cachedChunk = _currentChunk;
-			_currentChunk = _volume->chunk(xChunk, yChunk, zChunk);
+			_currentChunk = chunk(xChunk, yChunk, zChunk);
 		}
+		// the placeholder never matches the position of a real chunk
+		const glm::ivec3& chunkPos = _currentChunk->chunkPos();
+		_placeholder = chunkPos.x != xChunk || chunkPos.y != yChunk || chunkPos.z != zChunk;
 		_lastXChunk = xChunk;
 		_lastYChunk = yChunk;
 		_lastZChunk = zChunk;
@@ -90,13 +114,14 @@ void PagedVolume::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos)
 }
 
 bool PagedVolume::Sampler::setVoxel(const Voxel& voxel) {
-	if (_currentVoxel == nullptr) {
+	if (_currentVoxel == nullptr || _placeholder) {
 		return false;
 	}
 	//Need to think what effect this has on any existing iterators.
 	//core_assert_msg(false, "This function cannot be used on PagedVolume samplers.");
 	//TODO: the region is not updated properly - but we might not need this for paged volumes.
 	*_currentVoxel = voxel;
+	_currentChunk->markModified();
 	return true;
 }
 
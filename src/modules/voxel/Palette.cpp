@@ -5,12 +5,17 @@
 #include "Palette.h"
 #include "core/StandardLib.h"
 #include "app/App.h"
+#include "core/ClosestColorTree.h"
 #include "core/Color.h"
+#include "core/ColorReduction.h"
+#include "core/GameConfig.h"
+#include "core/Var.h"
 #include "core/Log.h"
 #include "core/String.h"
 #include "core/StringUtil.h"
 #include "core/ArrayLength.h"
 #include "core/collection/Buffer.h"
+#include "core/concurrent/ThreadPool.h"
 #include "core/RGBA.h"
 #include "image/Image.h"
 #include "io/File.h"
@@ -32,7 +37,10 @@ void Palette::markDirty() {
 }
 
 void Palette::quantize(const core::RGBA *inputColors, const size_t inputColorCount) {
-	colorCount = core::Color::quantize(colors, lengthof(colors), inputColors, inputColorCount);
+	const core::VarPtr &var = core::Var::getSafe(cfg::CoreColorReduction);
+	const core::ColorReductionType type = core::toColorReductionType(var->strVal().c_str());
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	colorCount = core::Color::quantize(type, colors, lengthof(colors), inputColors, inputColorCount, &threadPool);
 }
 
 bool Palette::addColorToPalette(core::RGBA rgba, bool skipSimilar) {
@@ -79,11 +87,63 @@ bool Palette::addColorToPalette(core::RGBA rgba, bool skipSimilar) {
 	return false;
 }
 
+namespace {
+
+/**
+ * @brief The nearest color trees of the palettes that were used last on the current thread
+ *
+ * The colors of a palette are modified in place at a lot of places - that's why the trees are validated against the
+ * colors on every lookup instead of relying on @c Palette::markDirty(). Each thread builds its own trees, the lookups
+ * don't need any locking this way.
+ */
+class ClosestColorTreeCache {
+private:
+	struct Entry {
+		PaletteColorArray colors {};
+		int colorCount = -1;
+		uint32_t lastUse = 0u;
+		core::ClosestColorTree tree;
+	};
+	Entry _entries[4];
+	uint32_t _useCounter = 0u;
+
+public:
+	const core::ClosestColorTree &get(const Palette &palette) {
+		Entry *oldest = &_entries[0];
+		for (Entry &entry : _entries) {
+			if (entry.colorCount == palette.colorCount &&
+				core_memcmp(entry.colors, palette.colors, palette.colorCount * sizeof(core::RGBA)) == 0) {
+				entry.lastUse = ++_useCounter;
+				return entry.tree;
+			}
+			if (entry.lastUse < oldest->lastUse) {
+				oldest = &entry;
+			}
+		}
+		core_memcpy(oldest->colors, palette.colors, sizeof(oldest->colors));
+		oldest->colorCount = palette.colorCount;
+		oldest->lastUse = ++_useCounter;
+		glm::vec4 colors[PaletteMaxColors];
+		for (int i = 0; i < palette.colorCount; ++i) {
+			colors[i] = core::Color::fromRGBA(palette.colors[i]);
+		}
+		oldest->tree.build(colors, palette.colorCount);
+		return oldest->tree;
+	}
+};
+
+} // namespace
+
 int Palette::getClosestMatch(const glm::vec4& color, float *distance, int skip) const {
 	if (size() == 0) {
 		return -1;
 	}
 
+	if (skip == -1) {
+		thread_local ClosestColorTreeCache cache;
+		return cache.get(*this).closestMatch(color, distance);
+	}
+
 	float minDistance = FLT_MAX;
 	int minIndex = -1;
 
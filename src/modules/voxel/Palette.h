@@ -78,9 +78,12 @@ public:
 	void setGlow(uint8_t idx, float factor = 1.0f);
 
 	/**
+	 * @note The search is sped up by a nearest color tree that is built on demand for each thread. The tree is
+	 * rebuilt once the colors were changed. If @c skip is given, all colors are compared one by one.
 	 * @param color Normalized color value [0.0-1.0]
 	 * @param distance Optional parameter to get the calculated distance for the selected color entry
 	 * @return int The index to the palette color
+	 * @sa core::ClosestColorTree
 	 */
 	int getClosestMatch(const glm::vec4& color, float *distance = nullptr, int skip = -1) const;
 	int getClosestMatch(const core::RGBA rgba, float *distance = nullptr, int skip = -1) const;
@@ -91,6 +94,9 @@ public:
 	 * @note Only use this for single colors - not for a lot of them. This method is quite slow
 	 */
 	bool addColorToPalette(core::RGBA rgba, bool skipSimilar = true);
+	/**
+	 * @brief Reduces the given colors to the palette colors with the algorithm of the @c cfg::CoreColorReduction var
+	 */
 	void quantize(const core::RGBA *inputColors, const size_t inputColorCount);
 	/**
 	 * @brief Convert the RGBA color values in the range [0-255] to float color values in the range [0.0-1.0]
@@ -0,0 +1,227 @@
+/**
+ * @file
+ */
+
+#include "PaletteLookup.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+
+namespace voxel {
+
+/**
+ * @brief A color is only stored within this amount of slots after its hash position
+ */
+static constexpr uint32_t ProbeLength = 8u;
+static constexpr uint64_t UsedSlot = (uint64_t)1u << 40u;
+
+static inline uint32_t hashColor(core::RGBA rgba) {
+	uint32_t x = rgba.rgba;
+	x ^= x >> 16u;
+	x *= 0x7feb352du;
+	x ^= x >> 15u;
+	x *= 0x846ca68bu;
+	x ^= x >> 16u;
+	return x;
+}
+
+static inline uint64_t createSlot(core::RGBA rgba, uint8_t paletteIndex) {
+	return UsedSlot | ((uint64_t)rgba.rgba << 8u) | paletteIndex;
+}
+
+static inline uint32_t slotColor(uint64_t slot) {
+	return (uint32_t)(slot >> 8u);
+}
+
+static inline uint8_t slotIndex(uint64_t slot) {
+	return (uint8_t)(slot & 0xffu);
+}
+
+static uint32_t maxCapacity(int maxSize) {
+	uint32_t capacity = ProbeLength;
+	while (capacity < (uint32_t)maxSize) {
+		capacity <<= 1u;
+	}
+	return capacity;
+}
+
+static voxel::Palette validPalette(const voxel::Palette &palette) {
+	if (palette.colorCount > 0) {
+		return palette;
+	}
+	voxel::Palette nippon;
+	nippon.nippon();
+	return nippon;
+}
+
+PaletteLookup::PaletteLookup(const voxel::Palette &palette, int maxSize)
+	: _palette(validPalette(palette)), _maxCapacity(maxCapacity(maxSize)) {
+	const uint32_t capacity = core_min((uint32_t)InitialSize, _maxCapacity);
+	_slots.resize(capacity);
+	_mask = capacity - 1u;
+}
+
+PaletteLookup::PaletteLookup(int maxSize) : PaletteLookup(voxel::Palette(), maxSize) {
+}
+
+bool PaletteLookup::insert(uint64_t slot, bool evict) {
+	const uint32_t hash = hashColor(core::RGBA(slotColor(slot)));
+	for (uint32_t i = 0u; i < ProbeLength; ++i) {
+		uint64_t &s = _slots[(hash + i) & _mask];
+		if (s == 0u) {
+			s = slot;
+			++_size;
+			return true;
+		}
+	}
+	if (!evict) {
+		return false;
+	}
+	// the victims are rotated through the probe window
+	_slots[(hash + _evictions % ProbeLength) & _mask] = slot;
+	++_evictions;
+	return true;
+}
+
+void PaletteLookup::grow() {
+	core_trace_scoped(PaletteLookupGrow);
+	const core::DynamicArray<uint64_t> old(core::move(_slots));
+	_slots = core::DynamicArray<uint64_t>();
+	_slots.resize(old.size() * 2);
+	_mask = (uint32_t)_slots.size() - 1u;
+	_size = 0;
+	for (uint64_t slot : old) {
+		if (slot != 0u) {
+			insert(slot, false);
+		}
+	}
+}
+
+uint8_t PaletteLookup::findClosestIndex(core::RGBA rgba) {
+	const uint32_t hash = hashColor(rgba);
+	for (uint32_t i = 0u; i < ProbeLength; ++i) {
+		const uint64_t slot = _slots[(hash + i) & _mask];
+		if (slot == 0u) {
+			break;
+		}
+		if (slotColor(slot) == rgba.rgba) {
+			return slotIndex(slot);
+		}
+	}
+	const uint8_t paletteIndex = (uint8_t)_palette.getClosestMatch(rgba);
+	const uint64_t slot = createSlot(rgba, paletteIndex);
+	const uint32_t capacity = (uint32_t)_slots.size();
+	if (capacity < _maxCapacity && (uint32_t)(_size + 1) * 2u > capacity) {
+		grow();
+	}
+	if (!insert(slot, false)) {
+		if (_slots.size() < _maxCapacity) {
+			grow();
+		}
+		insert(slot, true);
+	}
+	return paletteIndex;
+}
+
+struct ConcurrentPaletteLookup::Table {
+	std::atomic<uint64_t> *slots;
+	const uint32_t mask;
+	std::atomic<uint32_t> size{0u};
+	// the replaced table - released by the destructor of the lookup
+	Table *previous;
+
+	Table(uint32_t capacity, Table *_previous) : mask(capacity - 1u), previous(_previous) {
+		slots = new std::atomic<uint64_t>[capacity];
+		for (uint32_t i = 0u; i < capacity; ++i) {
+			slots[i].store(0u, std::memory_order_relaxed);
+		}
+	}
+
+	~Table() {
+		delete[] slots;
+	}
+
+	inline uint32_t capacity() const {
+		return mask + 1u;
+	}
+};
+
+ConcurrentPaletteLookup::ConcurrentPaletteLookup(const voxel::Palette &palette, int maxSize)
+	: _palette(validPalette(palette)), _maxCapacity(maxCapacity(maxSize)) {
+	_table.store(new Table(core_min((uint32_t)PaletteLookup::InitialSize, _maxCapacity), nullptr), std::memory_order_relaxed);
+}
+
+ConcurrentPaletteLookup::ConcurrentPaletteLookup(int maxSize) : ConcurrentPaletteLookup(voxel::Palette(), maxSize) {
+}
+
+ConcurrentPaletteLookup::~ConcurrentPaletteLookup() {
+	Table *table = _table.load(std::memory_order_acquire);
+	while (table != nullptr) {
+		Table *previous = table->previous;
+		delete table;
+		table = previous;
+	}
+}
+
+int ConcurrentPaletteLookup::capacity() const {
+	return (int)_table.load(std::memory_order_acquire)->capacity();
+}
+
+void ConcurrentPaletteLookup::grow(Table *table) {
+	core_trace_scoped(ConcurrentPaletteLookupGrow);
+	Table *bigger = new Table(table->capacity() * 2u, table);
+	// entries that are added to the old table meanwhile are just looked up again
+	for (uint32_t i = 0u; i < table->capacity(); ++i) {
+		const uint64_t slot = table->slots[i].load(std::memory_order_relaxed);
+		if (slot == 0u) {
+			continue;
+		}
+		const uint32_t hash = hashColor(core::RGBA(slotColor(slot)));
+		for (uint32_t p = 0u; p < ProbeLength; ++p) {
+			std::atomic<uint64_t> &s = bigger->slots[(hash + p) & bigger->mask];
+			if (s.load(std::memory_order_relaxed) == 0u) {
+				s.store(slot, std::memory_order_relaxed);
+				bigger->size.fetch_add(1u, std::memory_order_relaxed);
+				break;
+			}
+		}
+	}
+	// only the thread that filled the table to the limit grows it - but be safe anyway
+	if (!_table.compare_exchange_strong(table, bigger, std::memory_order_acq_rel)) {
+		delete bigger;
+	}
+}
+
+uint8_t ConcurrentPaletteLookup::findClosestIndex(core::RGBA rgba) {
+	// the slots contain the color and the index - there is no other data that must be synchronized
+	Table *table = _table.load(std::memory_order_acquire);
+	const uint32_t hash = hashColor(rgba);
+	for (uint32_t i = 0u; i < ProbeLength; ++i) {
+		const uint64_t slot = table->slots[(hash + i) & table->mask].load(std::memory_order_relaxed);
+		if (slot == 0u) {
+			break;
+		}
+		if (slotColor(slot) == rgba.rgba) {
+			return slotIndex(slot);
+		}
+	}
+	const uint8_t paletteIndex = (uint8_t)_palette.getClosestMatch(rgba);
+	const uint64_t slot = createSlot(rgba, paletteIndex);
+	for (uint32_t i = 0u; i < ProbeLength; ++i) {
+		uint64_t expected = 0u;
+		if (table->slots[(hash + i) & table->mask].compare_exchange_strong(expected, slot, std::memory_order_relaxed)) {
+			const uint32_t capacity = table->capacity();
+			if (capacity < _maxCapacity && table->size.fetch_add(1u, std::memory_order_relaxed) + 1u == capacity / 2u) {
+				grow(table);
+			}
+			return paletteIndex;
+		}
+		if (slotColor(expected) == rgba.rgba) {
+			return paletteIndex;
+		}
+	}
+	// the window is full - the victim is picked by the upper bits of the hash
+	table->slots[(hash + (hash >> 24u) % ProbeLength) & table->mask].store(slot, std::memory_order_relaxed);
+	return paletteIndex;
+}
+
+} // namespace voxel
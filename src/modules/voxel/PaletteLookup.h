@@ -5,25 +5,52 @@
 #pragma once
 
 #include "core/Color.h"
-#include "core/collection/Map.h"
+#include "core/NonCopyable.h"
+#include "core/collection/DynamicArray.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Palette.h"
+#include <atomic>
 
 namespace voxel {
 
+/**
+ * @brief Caches the closest palette color indices of rgba colors
+ *
+ * The cache is an open addressing hash table that grows until it reaches the given amount of entries. A color is
+ * only stored within a small probe window after its hash position. Once the table can't grow anymore, a color
+ * that doesn't find a free slot in its window replaces one of the entries there - the colors that are currently
+ * looked up stay cached this way.
+ *
+ * @note Not thread safe - see @c ConcurrentPaletteLookup
+ */
 class PaletteLookup {
+public:
+	/**
+	 * @brief The amount of entries the table starts with - it grows on demand up to the max size
+	 */
+	static constexpr int InitialSize = 4096;
+	static constexpr int DefaultMaxSize = 1 << 18;
+
 private:
 	voxel::Palette _palette;
-	core::Map<core::RGBA, uint8_t, 521> _paletteMap;
+	/**
+	 * @brief Each slot is the rgba color, the palette index and a marker bit - empty slots are @c 0
+	 */
+	core::DynamicArray<uint64_t> _slots;
+	uint32_t _mask;
+	uint32_t _maxCapacity;
+	int _size = 0;
+	uint32_t _evictions = 0u;
+
+	bool insert(uint64_t slot, bool evict);
+	void grow();
+
 public:
-	PaletteLookup(const voxel::Palette &palette, int maxSize = 32768) : _palette(palette), _paletteMap(maxSize) {
-		if (_palette.colorCount <= 0) {
-			_palette.nippon();
-		}
-	}
-	PaletteLookup(int maxSize = 32768) : _paletteMap(maxSize) {
-		_palette.nippon();
-	}
+	/**
+	 * @param maxSize The max amount of entries - the table needs 8 bytes per entry and starts with @c InitialSize entries
+	 */
+	PaletteLookup(const voxel::Palette &palette, int maxSize = DefaultMaxSize);
+	PaletteLookup(int maxSize = DefaultMaxSize);
 
 	inline const voxel::Palette &palette() const {
 		return _palette;
@@ -33,6 +60,17 @@ public:
 		return _palette;
 	}
 
+	/**
+	 * @return The amount of cached colors
+	 */
+	inline int size() const {
+		return _size;
+	}
+
+	inline int capacity() const {
+		return (int)_slots.size();
+	}
+
 	/**
 	 * @brief Find the closed index in the currently in-use palette for the given color
 	 * @param color Normalized color value [0.0-1.0]
@@ -46,16 +84,55 @@ public:
 	 * @brief Find the closed index in the currently in-use palette for the given color
 	 * @sa core::Color::getClosestMatch()
 	 */
-	uint8_t findClosestIndex(core::RGBA rgba) {
-		uint8_t paletteIndex = 0;
-		if (!_paletteMap.get(rgba, paletteIndex)) {
-			paletteIndex = _palette.getClosestMatch(rgba);
-			if (_paletteMap.size() < _paletteMap.capacity()) {
-				_paletteMap.put(rgba, paletteIndex);
-			}
-		}
-		return paletteIndex;
+	uint8_t findClosestIndex(core::RGBA rgba);
+};
+
+/**
+ * @brief Like @c PaletteLookup but it can be shared between threads
+ *
+ * The entries are read and written atomically without any locking. If two threads look up the same new color, both
+ * search the palette - one of the results is cached. Once the table is half full, a table with twice the size is
+ * published that starts with a copy of the entries. The replaced tables are only released by the destructor, as
+ * other threads might still access them.
+ *
+ * @note The palette can't be changed once the lookup was created
+ */
+class ConcurrentPaletteLookup : public core::NonCopyable {
+private:
+	struct Table;
+	const voxel::Palette _palette;
+	std::atomic<Table *> _table;
+	const uint32_t _maxCapacity;
+
+	void grow(Table *table);
+
+public:
+	/**
+	 * @param maxSize The max amount of entries - the table needs 8 bytes per entry and starts with
+	 * @c PaletteLookup::InitialSize entries
+	 */
+	ConcurrentPaletteLookup(const voxel::Palette &palette, int maxSize = PaletteLookup::DefaultMaxSize);
+	ConcurrentPaletteLookup(int maxSize = PaletteLookup::DefaultMaxSize);
+	~ConcurrentPaletteLookup();
+
+	inline const voxel::Palette &palette() const {
+		return _palette;
+	}
+
+	int capacity() const;
+
+	/**
+	 * @param color Normalized color value [0.0-1.0]
+	 * @sa PaletteLookup::findClosestIndex()
+	 */
+	inline uint8_t findClosestIndex(const glm::vec4 &color) {
+		return findClosestIndex(core::Color::getRGBA(color));
 	}
+
+	/**
+	 * @sa PaletteLookup::findClosestIndex()
+	 */
+	uint8_t findClosestIndex(core::RGBA rgba);
 };
 
 } // namespace voxel
@@ -0,0 +1,70 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "CubicSurfaceExtractor.h"
+#include "core/concurrent/ParallelFor.h"
+#include <vector>
+
+namespace voxel {
+
+/**
+ * @brief The default edge length of the tiles that are meshed concurrently by @c extractCubicMeshParallel()
+ */
+const int ParallelExtractionTileSize = 64;
+
+/**
+ * @brief Extracts the region of the volume with several threads
+ *
+ * The region is split into tiles of @c tileSize voxels per axis that are meshed concurrently. The volume is only read
+ * and not copied, so it must not get modified while the extraction is running. The tile meshes are merged into the
+ * result mesh afterwards. The calling thread takes part in the extraction - it's safe to call this from a task of the
+ * given thread pool. The tiles are handed out by @c core::parallelFor().
+ *
+ * The faces of a region are the same as the faces of its tiles, but quads are not merged and vertices are not shared
+ * across tile borders.
+ *
+ * @sa extractCubicMesh()
+ */
+template<typename VolumeType, typename IsQuadNeeded>
+void extractCubicMeshParallel(VolumeType* volData, const Region& region, Mesh* result, IsQuadNeeded isQuadNeeded, const glm::ivec3& translate, core::ThreadPool& threadPool, bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true, int tileSize = ParallelExtractionTileSize) {
+	core_trace_scoped(ExtractCubicMeshParallel);
+	core_assert(tileSize > 0);
+	const glm::ivec3& mins = region.getLowerCorner();
+	const glm::ivec3& maxs = region.getUpperCorner();
+	std::vector<Region> tiles;
+	for (int z = mins.z; z <= maxs.z; z += tileSize) {
+		for (int y = mins.y; y <= maxs.y; y += tileSize) {
+			for (int x = mins.x; x <= maxs.x; x += tileSize) {
+				const glm::ivec3 tileMins(x, y, z);
+				tiles.emplace_back(tileMins, glm::min(tileMins + (tileSize - 1), maxs));
+			}
+		}
+	}
+	const int n = (int)tiles.size();
+	if (n == 1) {
+		extractCubicMesh(volData, region, result, isQuadNeeded, translate, mergeQuads, reuseVertices, ambientOcclusion);
+		// same index format as the merged tiles
+		result->compressIndices();
+		return;
+	}
+	std::vector<Mesh> meshes(n);
+	core::parallelFor(&threadPool, n, [&] (int tile) {
+		// the scratch memory is kept per thread - a thread usually extracts several tiles
+		static thread_local SurfaceExtractionContext ctx;
+		const Region& tileRegion = tiles[tile];
+		const glm::ivec3 tileTranslate = translate + tileRegion.getLowerCorner() - mins;
+		extractCubicMesh(volData, tileRegion, &meshes[tile], isQuadNeeded, tileTranslate, ctx, mergeQuads, reuseVertices, ambientOcclusion);
+	});
+
+	{
+		core_trace_scoped(MergeTiles);
+		mergeMeshes(meshes.data(), meshes.size(), result);
+		result->setOffset(mins);
+		result->compressIndices();
+	}
+}
+
+}
@@ -3,9 +3,11 @@
  */
 
 #include "RawVolume.h"
+#include "OccupancyMask.h"
 #include "core/Assert.h"
 #include "core/StandardLib.h"
 #include <glm/common.hpp>
+#include <algorithm>
 #include <limits>
 
 namespace voxel {
@@ -28,8 +30,12 @@ RawVolume::RawVolume(const RawVolume* copy) :
 	_mins = copy->_mins;
 	_maxs = copy->_maxs;
 	_boundsValid = copy->_boundsValid;
+	_revision = copy->_revision;
 	_borderVoxel = copy->_borderVoxel;
 	core_memcpy((void*)_data, (void*)copy->_data, size);
+	if (copy->_occupancy != nullptr) {
+		_occupancy = new OccupancyMask(*copy->_occupancy);
+	}
 }
 
 RawVolume::RawVolume(const RawVolume& copy) :
@@ -40,8 +46,12 @@ RawVolume::RawVolume(const RawVolume& copy) :
 	_mins = copy._mins;
 	_maxs = copy._maxs;
 	_boundsValid = copy._boundsValid;
+	_revision = copy._revision;
 	_borderVoxel = copy._borderVoxel;
 	core_memcpy((void*)_data, (void*)copy._data, size);
+	if (copy._occupancy != nullptr) {
+		_occupancy = new OccupancyMask(*copy._occupancy);
+	}
 }
 
 RawVolume::RawVolume(const RawVolume& src, const Region& region, bool *onlyAir) : _region(region) {
@@ -68,28 +78,20 @@ RawVolume::RawVolume(const RawVolume& src, const Region& region, bool *onlyAir)
 		_boundsValid = false;
 		const glm::ivec3 &tgtMins = _region.getLowerCorner();
 		const glm::ivec3 &tgtMaxs = _region.getUpperCorner();
-		const glm::ivec3 &srcMins = src._region.getLowerCorner();
-		const int tgtYStride = _region.getWidthInVoxels();
-		const int tgtZStride = _region.getWidthInVoxels() * _region.getHeightInVoxels();
-		const int srcYStride = src._region.getWidthInVoxels();
-		const int srcZStride = src._region.getWidthInVoxels() * src._region.getHeightInVoxels();
-		for (int x = tgtMins.x; x <= tgtMaxs.x; ++x) {
-			const int32_t tgtXPos = x - tgtMins.x;
-			const int32_t srcXPos = x - srcMins.x;
+		const int rowLength = width();
+		for (int z = tgtMins.z; z <= tgtMaxs.z; ++z) {
 			for (int y = tgtMins.y; y <= tgtMaxs.y; ++y) {
-				const int32_t tgtYPos = y - tgtMins.y;
-				const int32_t srcYPos = y - srcMins.y;
-				const int tgtStrideLocal = tgtXPos + tgtYPos * tgtYStride;
-				const int srcStrideLocal = srcXPos + srcYPos * srcYStride;
-				for (int z = tgtMins.z; z <= tgtMaxs.z; ++z) {
-					const int32_t tgtZPos = z - tgtMins.z;
-					const int32_t srcZPos = z - srcMins.z;
-					const int tgtindex = tgtStrideLocal + tgtZPos * tgtZStride;
-					const int srcindex = srcStrideLocal + srcZPos * srcZStride;
-					_data[tgtindex] = src._data[srcindex];
-					if (onlyAir && !voxel::isAir(_data[tgtindex].getMaterial())) {
+				Voxel *tgtRow = _data + index(tgtMins.x, y, z);
+				const Voxel *srcRow = src._data + src.index(tgtMins.x, y, z);
+				core_memcpy((void *)tgtRow, (const void *)srcRow, rowLength * sizeof(Voxel));
+				if (onlyAir == nullptr) {
+					continue;
+				}
+				for (int x = 0; x < rowLength; ++x) {
+					if (!voxel::isAir(tgtRow[x].getMaterial())) {
 						*onlyAir = false;
 						onlyAir = nullptr;
+						break;
 					}
 				}
 			}
@@ -104,6 +106,9 @@ RawVolume::RawVolume(RawVolume&& move) noexcept {
 	_maxs = move._maxs;
 	_region = move._region;
 	_boundsValid = move._boundsValid;
+	_revision = move._revision;
+	_occupancy = move._occupancy;
+	move._occupancy = nullptr;
 }
 
 RawVolume::RawVolume(const Voxel* data, const voxel::Region& region) {
@@ -124,6 +129,37 @@ RawVolume::RawVolume(Voxel* data, const voxel::Region& region) :
 RawVolume::~RawVolume() {
 	core_free(_data);
 	_data = nullptr;
+	delete _occupancy;
+	_occupancy = nullptr;
+}
+
+void RawVolume::enableOccupancy() {
+	if (_occupancy != nullptr) {
+		return;
+	}
+	_occupancy = new OccupancyMask(_region);
+	const glm::ivec3& mins = _region.getLowerCorner();
+	const glm::ivec3& maxs = _region.getUpperCorner();
+	for (int32_t z = mins.z; z <= maxs.z; ++z) {
+		for (int32_t y = mins.y; y <= maxs.y; ++y) {
+			_occupancy->updateRow(mins.x, y, z, _data + index(mins.x, y, z), width());
+		}
+	}
+}
+
+void RawVolume::disableOccupancy() {
+	delete _occupancy;
+	_occupancy = nullptr;
+}
+
+void RawVolume::translate(const glm::ivec3& t) {
+	_region.shift(t.x, t.y, t.z);
+	_mins += t;
+	_maxs += t;
+	++_revision;
+	if (_occupancy != nullptr) {
+		_occupancy->translate(t);
+	}
 }
 
 Voxel* RawVolume::copyVoxels() const {
@@ -195,7 +231,11 @@ bool RawVolume::setVoxel(const glm::ivec3& pos, const Voxel& voxel) {
 	_mins = (glm::min)(_mins, pos);
 	_maxs = (glm::max)(_maxs, pos);
 	_boundsValid = true;
+	++_revision;
 	_data[index] = voxel;
+	if (_occupancy != nullptr) {
+		_occupancy->set(pos.x, pos.y, pos.z, !isAir(voxel.getMaterial()));
+	}
 	return true;
 }
 
@@ -220,11 +260,194 @@ void RawVolume::initialise(const Region& regValidRegion) {
 void RawVolume::clear() {
 	const size_t size = width() * height() * depth() * sizeof(Voxel);
 	core_memset(_data, 0, size);
+	if (_occupancy != nullptr) {
+		_occupancy->clear();
+	}
+	++_revision;
 	_mins = glm::ivec3((std::numeric_limits<int>::max)() / 2);
 	_maxs = glm::ivec3((std::numeric_limits<int>::min)() / 2);
 	_boundsValid = false;
 }
 
+void RawVolume::updateBounds(const Region& changed, Region* dirtyRegion) {
+	if (!changed.isValid()) {
+		return;
+	}
+	_mins = (glm::min)(_mins, changed.getLowerCorner());
+	_maxs = (glm::max)(_maxs, changed.getUpperCorner());
+	_boundsValid = true;
+	++_revision;
+	if (dirtyRegion == nullptr) {
+		return;
+	}
+	if (dirtyRegion->isValid()) {
+		dirtyRegion->accumulate(changed);
+	} else {
+		*dirtyRegion = changed;
+	}
+}
+
+/**
+ * @brief Accumulates the changed voxels of a row
+ */
+static inline void accumulateRow(Region& changed, int32_t x1, int32_t x2, int32_t y, int32_t z) {
+	if (changed.isValid()) {
+		changed.accumulate(x1, y, z);
+		changed.accumulate(x2, y, z);
+	} else {
+		changed = Region(x1, y, z, x2, y, z);
+	}
+}
+
+int RawVolume::fill(const Region& region, const Voxel& voxel, Region* dirtyRegion) {
+	Region fillRegion(region);
+	fillRegion.cropTo(_region);
+	if (!fillRegion.isValid()) {
+		return 0;
+	}
+	const glm::ivec3& mins = fillRegion.getLowerCorner();
+	const glm::ivec3& maxs = fillRegion.getUpperCorner();
+	const int rowLength = fillRegion.getWidthInVoxels();
+	Region changed = Region::InvalidRegion;
+	int cnt = 0;
+	for (int32_t z = mins.z; z <= maxs.z; ++z) {
+		for (int32_t y = mins.y; y <= maxs.y; ++y) {
+			Voxel* row = _data + index(mins.x, y, z);
+			int first = -1;
+			int last = -1;
+			for (int x = 0; x < rowLength; ++x) {
+				if (row[x].isSame(voxel)) {
+					continue;
+				}
+				if (first == -1) {
+					first = x;
+				}
+				last = x;
+				++cnt;
+			}
+			if (first == -1) {
+				continue;
+			}
+			std::fill(row + first, row + last + 1, voxel);
+			if (_occupancy != nullptr) {
+				_occupancy->setRow(mins.x + first, y, z, last - first + 1, !isAir(voxel.getMaterial()));
+			}
+			accumulateRow(changed, mins.x + first, mins.x + last, y, z);
+		}
+	}
+	updateBounds(changed, dirtyRegion);
+	return cnt;
+}
+
+bool RawVolume::cropCopyRegion(const RawVolume& src, Region& srcRegion, glm::ivec3& destMins) const {
+	const glm::ivec3 offset = destMins - srcRegion.getLowerCorner();
+	srcRegion.cropTo(src._region);
+	Region destRegion(srcRegion);
+	destRegion.shift(offset);
+	destRegion.cropTo(_region);
+	if (!destRegion.isValid()) {
+		return false;
+	}
+	srcRegion = destRegion;
+	srcRegion.shift(-offset);
+	destMins = destRegion.getLowerCorner();
+	return true;
+}
+
+int RawVolume::copyFrom(const RawVolume& src, const Region& srcRegion, const glm::ivec3& destMins, Region* dirtyRegion) {
+	core_assert_msg(&src != this, "Copying inside the same volume is not supported");
+	Region copyRegion(srcRegion);
+	glm::ivec3 destPos(destMins);
+	if (!cropCopyRegion(src, copyRegion, destPos)) {
+		return 0;
+	}
+	const glm::ivec3& srcMins = copyRegion.getLowerCorner();
+	const glm::ivec3& dim = copyRegion.getDimensionsInVoxels();
+	const size_t rowSize = dim.x * sizeof(Voxel);
+	Region changed = Region::InvalidRegion;
+	int cnt = 0;
+	for (int32_t z = 0; z < dim.z; ++z) {
+		for (int32_t y = 0; y < dim.y; ++y) {
+			Voxel* destRow = _data + index(destPos.x, destPos.y + y, destPos.z + z);
+			const Voxel* srcRow = src._data + src.index(srcMins.x, srcMins.y + y, srcMins.z + z);
+			if (core_memcmp((const void*)destRow, (const void*)srcRow, rowSize) == 0) {
+				continue;
+			}
+			int first = -1;
+			int last = -1;
+			for (int x = 0; x < dim.x; ++x) {
+				if (destRow[x].isSame(srcRow[x])) {
+					continue;
+				}
+				if (first == -1) {
+					first = x;
+				}
+				last = x;
+				++cnt;
+			}
+			// also copies the flags of voxels that are otherwise the same
+			core_memcpy((void*)destRow, (const void*)srcRow, rowSize);
+			if (first != -1) {
+				accumulateRow(changed, destPos.x + first, destPos.x + last, destPos.y + y, destPos.z + z);
+				if (_occupancy != nullptr) {
+					_occupancy->updateRow(destPos.x + first, destPos.y + y, destPos.z + z, destRow + first, last - first + 1);
+				}
+			}
+		}
+	}
+	updateBounds(changed, dirtyRegion);
+	return cnt;
+}
+
+int RawVolume::mergeFrom(const RawVolume& src, const Region& srcRegion, const glm::ivec3& destMins, Region* dirtyRegion) {
+	core_assert_msg(&src != this, "Merging inside the same volume is not supported");
+	Region copyRegion(srcRegion);
+	glm::ivec3 destPos(destMins);
+	if (!cropCopyRegion(src, copyRegion, destPos)) {
+		return 0;
+	}
+	const glm::ivec3& srcMins = copyRegion.getLowerCorner();
+	const glm::ivec3& dim = copyRegion.getDimensionsInVoxels();
+	Region changed = Region::InvalidRegion;
+	int cnt = 0;
+	for (int32_t z = 0; z < dim.z; ++z) {
+		for (int32_t y = 0; y < dim.y; ++y) {
+			Voxel* destRow = _data + index(destPos.x, destPos.y + y, destPos.z + z);
+			const Voxel* srcRow = src._data + src.index(srcMins.x, srcMins.y + y, srcMins.z + z);
+			int first = -1;
+			int last = -1;
+			int x = 0;
+			while (x < dim.x) {
+				while (x < dim.x && isAir(srcRow[x].getMaterial())) {
+					++x;
+				}
+				const int runStart = x;
+				for (; x < dim.x && !isAir(srcRow[x].getMaterial()); ++x) {
+					if (destRow[x].isSame(srcRow[x])) {
+						continue;
+					}
+					if (first == -1) {
+						first = x;
+					}
+					last = x;
+					++cnt;
+				}
+				if (x > runStart) {
+					core_memcpy((void*)(destRow + runStart), (const void*)(srcRow + runStart), (x - runStart) * sizeof(Voxel));
+				}
+			}
+			if (first != -1) {
+				accumulateRow(changed, destPos.x + first, destPos.x + last, destPos.y + y, destPos.z + z);
+				if (_occupancy != nullptr) {
+					_occupancy->updateRow(destPos.x + first, destPos.y + y, destPos.z + z, destRow + first, last - first + 1);
+				}
+			}
+		}
+	}
+	updateBounds(changed, dirtyRegion);
+	return cnt;
+}
+
 RawVolume::Sampler::Sampler(const RawVolume* volume) :
 		_volume(const_cast<RawVolume*>(volume)) {
 }
@@ -241,9 +464,13 @@ bool RawVolume::Sampler::setVoxel(const Voxel& voxel) {
 		return false;
 	}
 	*_currentVoxel = voxel;
+	if (_volume->_occupancy != nullptr) {
+		_volume->_occupancy->set(_posInVolume.x, _posInVolume.y, _posInVolume.z, !isAir(voxel.getMaterial()));
+	}
 	_volume->_mins = (glm::min)(_volume->_mins, _posInVolume);
 	_volume->_maxs = (glm::max)(_volume->_maxs, _posInVolume);
 	_volume->_boundsValid = true;
+	++_volume->_revision;
 	return true;
 }
 
@@ -10,6 +10,8 @@
 
 namespace voxel {
 
+class OccupancyMask;
+
 /**
  * Simple volume implementation which stores data in a single large 3D array.
  *
@@ -178,21 +180,80 @@ public:
 
 	void clear();
 
+	/**
+	 * @brief Sets all voxels of the given region to the given voxel
+	 *
+	 * The region is cropped to the region of the volume. The voxels are written row by row along the x axis.
+	 * @param[out] dirtyRegion If not @c nullptr the region of the changed voxels is accumulated into it
+	 * @return The amount of voxels that were changed - see @c Voxel::isSame()
+	 */
+	int fill(const Region& region, const Voxel& voxel, Region* dirtyRegion = nullptr);
+	/**
+	 * @brief Copies the voxels of the given region of the source volume into this volume
+	 *
+	 * Air voxels are copied, too. The regions are cropped to the volumes. The voxels are copied row by row along the
+	 * x axis.
+	 * @param[in] srcRegion The region of the source volume to copy
+	 * @param[in] destMins The position in this volume that the lower corner of the source region is copied to
+	 * @param[out] dirtyRegion If not @c nullptr the region of the changed voxels is accumulated into it
+	 * @return The amount of voxels that were changed - see @c Voxel::isSame()
+	 * @note The source volume must not be this volume
+	 * @sa mergeFrom()
+	 */
+	int copyFrom(const RawVolume& src, const Region& srcRegion, const glm::ivec3& destMins, Region* dirtyRegion = nullptr);
+	/**
+	 * @brief Like @c copyFrom() but air voxels of the source volume are skipped
+	 *
+	 * The runs of solid voxels of each row are copied in one go.
+	 */
+	int mergeFrom(const RawVolume& src, const Region& srcRegion, const glm::ivec3& destMins, Region* dirtyRegion = nullptr);
+
 	inline const uint8_t* data() const {
 		return (const uint8_t*)_data;
 	}
 
 	/**
-	 * @brief Shift the region of the volume by the given coordinates
+	 * @return A counter that is increased whenever voxels of the volume are changed - see @c Voxel::isSame()
+	 * @note Use this to invalidate data that was computed from the voxels
+	 */
+	inline uint32_t revision() const {
+		return _revision;
+	}
+
+	/**
+	 * @brief Builds the occupancy mask of the volume
+	 *
+	 * Once enabled the mask is kept in sync by all methods that modify the voxels. This speeds up empty space
+	 * checks on large and mostly empty volumes - at the cost of one bit per voxel and slightly slower writes.
+	 * @sa occupancy()
 	 */
-	void translate(const glm::ivec3& t) {
-		_region.shift(t.x, t.y, t.z);
-		_mins += t;
-		_maxs += t;
+	void enableOccupancy();
+	void disableOccupancy();
+	/**
+	 * @return The occupancy mask or @c nullptr if it's not enabled
+	 * @sa enableOccupancy()
+	 */
+	inline const OccupancyMask* occupancy() const {
+		return _occupancy;
 	}
 
+	/**
+	 * @brief Shift the region of the volume by the given coordinates
+	 */
+	void translate(const glm::ivec3& t);
+
 private:
 	void initialise(const Region& region);
+	/**
+	 * @return The offset of the given position in the voxel data
+	 */
+	inline int index(int32_t x, int32_t y, int32_t z) const;
+	/**
+	 * @brief Crops the source region against both volumes
+	 * @return @c false if nothing of the source region is copied
+	 */
+	bool cropCopyRegion(const RawVolume& src, Region& srcRegion, glm::ivec3& destMins) const;
+	void updateBounds(const Region& changed, Region* dirtyRegion);
 
 	/** The size of the volume */
 	Region _region;
@@ -206,6 +267,9 @@ private:
 	glm::ivec3 _mins;
 	glm::ivec3 _maxs;
 	bool _boundsValid;
+	uint32_t _revision = 0u;
+
+	OccupancyMask* _occupancy = nullptr;
 };
 
 inline const Region& RawVolume::region() const {
@@ -242,6 +306,11 @@ inline glm::ivec3 RawVolume::maxs() const {
 	return _maxs;
 }
 
+inline int RawVolume::index(int32_t x, int32_t y, int32_t z) const {
+	const glm::ivec3& lowerCorner = _region.getLowerCorner();
+	return (x - lowerCorner.x) + (y - lowerCorner.y) * width() + (z - lowerCorner.z) * _region.stride();
+}
+
 inline const Voxel& RawVolume::voxel(const glm::ivec3& pos) const {
 	return voxel(pos.x, pos.y, pos.z);
 }
@@ -143,21 +143,73 @@ public:
 		return true;
 	}
 
+	/**
+	 * @brief Sets all voxels of the given region - the region is cropped to the valid region of the wrapper
+	 * @return The amount of changed voxels
+	 * @sa RawVolume::fill()
+	 */
+	inline int fill(const Region& region, const Voxel& voxel) {
+		Region fillRegion(region);
+		fillRegion.cropTo(_region);
+		if (!fillRegion.isValid()) {
+			return 0;
+		}
+		return _volume->fill(fillRegion, voxel, &_dirtyRegion);
+	}
+
+	/**
+	 * @sa RawVolume::copyFrom()
+	 */
+	inline int copyFrom(const RawVolume& src, const Region& srcRegion, const glm::ivec3& destMins) {
+		Region copyRegion;
+		glm::ivec3 destPos;
+		if (!cropToValidRegion(srcRegion, destMins, copyRegion, destPos)) {
+			return 0;
+		}
+		return _volume->copyFrom(src, copyRegion, destPos, &_dirtyRegion);
+	}
+
+	/**
+	 * @sa RawVolume::mergeFrom()
+	 */
+	inline int mergeFrom(const RawVolume& src, const Region& srcRegion, const glm::ivec3& destMins) {
+		Region copyRegion;
+		glm::ivec3 destPos;
+		if (!cropToValidRegion(srcRegion, destMins, copyRegion, destPos)) {
+			return 0;
+		}
+		return _volume->mergeFrom(src, copyRegion, destPos, &_dirtyRegion);
+	}
+
 	inline bool setVoxels(int x, int z, const Voxel* voxels, int amount) {
-		for (int y = 0; y < amount; ++y) {
-			setVoxel(x, y, z, voxels[y]);
+		return setVoxels(x, 0, z, 1, 1, voxels, amount);
+	}
+
+	/**
+	 * @brief Sets @c nx * @c nz columns with the given @c amount of voxels starting at the given position
+	 */
+	inline bool setVoxels(int x, int y, int z, int nx, int nz, const Voxel* voxels, int amount) {
+		for (int ny = 0; ny < amount; ++ny) {
+			fill(Region(x, y + ny, z, x + nx - 1, y + ny, z + nz - 1), voxels[ny]);
 		}
 		return true;
 	}
 
-	inline bool setVoxels(int x, int y, int z, int nx, int nz, const Voxel* voxels, int amount) {
-		for (int j = 0; j < nx; ++j) {
-			for (int k = 0; k < nz; ++k) {
-				for (int ny = 0; ny < amount; ++ny) {
-					setVoxel(x + j, y + ny, z + k, voxels[ny]);
-				}
-			}
+private:
+	/**
+	 * @brief Crops the source region of a copy to the part that ends up in the valid region of the wrapper
+	 */
+	bool cropToValidRegion(const Region& srcRegion, const glm::ivec3& destMins, Region& copyRegion, glm::ivec3& destPos) const {
+		const glm::ivec3 offset = destMins - srcRegion.getLowerCorner();
+		Region destRegion(srcRegion);
+		destRegion.shift(offset);
+		destRegion.cropTo(_region);
+		if (!destRegion.isValid()) {
+			return false;
 		}
+		copyRegion = destRegion;
+		copyRegion.shift(-offset);
+		destPos = destRegion.getLowerCorner();
 		return true;
 	}
 };
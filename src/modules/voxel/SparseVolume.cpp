@@ -0,0 +1,376 @@
+/**
+ * @file
+ */
+
+#include "SparseVolume.h"
+#include "RawVolume.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include <unordered_map>
+
+namespace voxel {
+
+/**
+ * @brief Compares all voxel values - including the flags
+ */
+static inline bool isEqual(const Voxel& a, const Voxel& b) {
+	return a.isSame(b) && a.getFlags() == b.getFlags();
+}
+
+static uint64_t hashBytes(const void* data, size_t size) {
+	const uint8_t* bytes = (const uint8_t*)data;
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+/**
+ * @brief Adds bricks and nodes to the volume - with deduplication identical bricks and nodes are only stored once
+ */
+class SparseVolume::Builder {
+private:
+	SparseVolume& _volume;
+	const bool _deduplicate;
+	std::unordered_multimap<uint64_t, uint32_t> _brickMap;
+	std::unordered_multimap<uint64_t, uint32_t> _nodeMap;
+
+public:
+	Builder(SparseVolume& volume, bool deduplicate) : _volume(volume), _deduplicate(deduplicate) {
+	}
+
+	uint32_t addBrick(const Brick& brick) {
+		const Voxel& first = brick.voxels[0];
+		bool uniform = true;
+		for (int i = 1; i < BrickVoxels; ++i) {
+			if (!isEqual(first, brick.voxels[i])) {
+				uniform = false;
+				break;
+			}
+		}
+		if (uniform) {
+			return _volume.uniformRef(first);
+		}
+		if (!_deduplicate) {
+			_volume._bricks.push_back(brick);
+			return (uint32_t)_volume._bricks.size() - 1u;
+		}
+		const uint64_t hash = hashBytes(&brick, sizeof(brick));
+		auto range = _brickMap.equal_range(hash);
+		for (auto i = range.first; i != range.second; ++i) {
+			if (core_memcmp(&_volume._bricks[i->second], &brick, sizeof(brick)) == 0) {
+				return i->second;
+			}
+		}
+		const uint32_t ref = (uint32_t)_volume._bricks.size();
+		_volume._bricks.push_back(brick);
+		_brickMap.emplace(hash, ref);
+		return ref;
+	}
+
+	uint32_t addNode(const Node& node) {
+		bool uniform = isUniform(node.children[0]);
+		for (int i = 1; uniform && i < 8; ++i) {
+			uniform = node.children[i] == node.children[0];
+		}
+		if (uniform) {
+			return node.children[0];
+		}
+		if (!_deduplicate) {
+			_volume._nodes.push_back(node);
+			return (uint32_t)_volume._nodes.size() - 1u;
+		}
+		const uint64_t hash = hashBytes(&node, sizeof(node));
+		auto range = _nodeMap.equal_range(hash);
+		for (auto i = range.first; i != range.second; ++i) {
+			if (core_memcmp(&_volume._nodes[i->second], &node, sizeof(node)) == 0) {
+				return i->second;
+			}
+		}
+		const uint32_t ref = (uint32_t)_volume._nodes.size();
+		_volume._nodes.push_back(node);
+		_nodeMap.emplace(hash, ref);
+		return ref;
+	}
+
+	/**
+	 * @param mins The lower corner of the node relative to the lower corner of the volume
+	 */
+	uint32_t build(const RawVolume& source, const glm::ivec3& mins, int size) {
+		const Region& region = _volume._region;
+		const glm::ivec3 lower = region.getLowerCorner() + mins;
+		const Region nodeRegion(lower, lower + (size - 1));
+		if (!intersects(region, nodeRegion)) {
+			return _volume.uniformRef(Voxel());
+		}
+		if (size == BrickSize) {
+			Brick brick;
+			Voxel* voxel = brick.voxels;
+			for (int z = 0; z < BrickSize; ++z) {
+				for (int y = 0; y < BrickSize; ++y) {
+					for (int x = 0; x < BrickSize; ++x) {
+						const glm::ivec3 pos(lower.x + x, lower.y + y, lower.z + z);
+						*voxel++ = region.containsPoint(pos) ? source.voxel(pos) : Voxel();
+					}
+				}
+			}
+			return addBrick(brick);
+		}
+		const int half = size / 2;
+		Node node;
+		for (int i = 0; i < 8; ++i) {
+			const glm::ivec3 childMins(mins.x + (i & 1) * half, mins.y + ((i >> 1) & 1) * half, mins.z + ((i >> 2) & 1) * half);
+			node.children[i] = build(source, childMins, half);
+		}
+		return addNode(node);
+	}
+
+	/**
+	 * @brief Adds the given subtree of another volume
+	 */
+	uint32_t copy(const SparseVolume& source, uint32_t ref, int size) {
+		if (isUniform(ref)) {
+			return _volume.uniformRef(source._uniformVoxels[ref & ~UniformBit]);
+		}
+		if (size == BrickSize) {
+			return addBrick(source._bricks[ref]);
+		}
+		const int half = size / 2;
+		Node node;
+		for (int i = 0; i < 8; ++i) {
+			node.children[i] = copy(source, source._nodes[ref].children[i], half);
+		}
+		return addNode(node);
+	}
+};
+
+/**
+ * @note std::vector::shrink_to_fit() is a no-op for libstdc++ if exceptions are disabled
+ */
+template<class T>
+static void shrinkToFit(std::vector<T>& v) {
+	std::vector<T>(v).swap(v);
+}
+
+static int treeSize(const Region& region) {
+	const glm::ivec3& dim = region.getDimensionsInVoxels();
+	const int maxDim = core_max(dim.x, core_max(dim.y, dim.z));
+	int size = SparseVolume::BrickSize;
+	while (size < maxDim) {
+		size *= 2;
+	}
+	return size;
+}
+
+SparseVolume::SparseVolume(const Region& region) : _region(region), _size(treeSize(region)) {
+	core_assert_msg(region.isValid(), "Invalid region for the sparse volume");
+	_root = uniformRef(Voxel());
+}
+
+SparseVolume::SparseVolume(const RawVolume& volume, bool deduplicate) :
+		_region(volume.region()), _borderVoxel(volume.borderValue()), _size(treeSize(volume.region())),
+		_deduplicated(deduplicate) {
+	core_trace_scoped(SparseVolumeFromRawVolume);
+	uniformRef(Voxel());
+	Builder builder(*this, deduplicate);
+	_root = builder.build(volume, glm::ivec3(0), _size);
+	shrinkToFit(_nodes);
+	shrinkToFit(_bricks);
+}
+
+uint32_t SparseVolume::uniformRef(const Voxel& voxel) {
+	// there are usually only a few different uniform values - air is always the first one
+	const uint32_t n = (uint32_t)_uniformVoxels.size();
+	for (uint32_t i = 0u; i < n; ++i) {
+		if (isEqual(_uniformVoxels[i], voxel)) {
+			return i | UniformBit;
+		}
+	}
+	_uniformVoxels.push_back(voxel);
+	return n | UniformBit;
+}
+
+const Voxel& SparseVolume::lookup(const glm::ivec3& pos, Leaf& leaf) const {
+	if (!_region.containsPoint(pos)) {
+		leaf.size = 0;
+		return _borderVoxel;
+	}
+	const glm::ivec3& lower = _region.getLowerCorner();
+	const glm::ivec3 local = pos - lower;
+	glm::ivec3 mins(0);
+	int size = _size;
+	uint32_t ref = _root;
+	while (!isUniform(ref) && size > BrickSize) {
+		size >>= 1;
+		int child = 0;
+		if (local.x >= mins.x + size) {
+			child |= 1;
+			mins.x += size;
+		}
+		if (local.y >= mins.y + size) {
+			child |= 2;
+			mins.y += size;
+		}
+		if (local.z >= mins.z + size) {
+			child |= 4;
+			mins.z += size;
+		}
+		ref = _nodes[ref].children[child];
+	}
+	leaf.mins = lower + mins;
+	leaf.size = size;
+	if (isUniform(ref)) {
+		leaf.uniform = true;
+		leaf.voxels = &_uniformVoxels[ref & ~UniformBit];
+		return *leaf.voxels;
+	}
+	leaf.uniform = false;
+	leaf.voxels = _bricks[ref].voxels;
+	return leaf.voxel(pos);
+}
+
+bool SparseVolume::setVoxel(const glm::ivec3& pos, const Voxel& voxel) {
+	core_assert_msg(!_deduplicated, "Deduplicated volumes can't be modified");
+	if (_deduplicated || !_region.containsPoint(pos)) {
+		return false;
+	}
+	const glm::ivec3 local = pos - _region.getLowerCorner();
+	glm::ivec3 mins(0);
+	int size = _size;
+	// the node that holds the current reference - -1 for the root
+	int parent = -1;
+	int slot = 0;
+	auto ref = [&] () -> uint32_t& {
+		return parent == -1 ? _root : _nodes[parent].children[slot];
+	};
+	while (size > BrickSize) {
+		if (isUniform(ref())) {
+			if (isEqual(_uniformVoxels[ref() & ~UniformBit], voxel)) {
+				return false;
+			}
+			Node node;
+			for (int i = 0; i < 8; ++i) {
+				node.children[i] = ref();
+			}
+			const uint32_t nodeRef = (uint32_t)_nodes.size();
+			_nodes.push_back(node);
+			ref() = nodeRef;
+		}
+		size >>= 1;
+		int child = 0;
+		if (local.x >= mins.x + size) {
+			child |= 1;
+			mins.x += size;
+		}
+		if (local.y >= mins.y + size) {
+			child |= 2;
+			mins.y += size;
+		}
+		if (local.z >= mins.z + size) {
+			child |= 4;
+			mins.z += size;
+		}
+		parent = (int)ref();
+		slot = child;
+	}
+	if (isUniform(ref())) {
+		const Voxel uniform = _uniformVoxels[ref() & ~UniformBit];
+		if (isEqual(uniform, voxel)) {
+			return false;
+		}
+		Brick brick;
+		for (int i = 0; i < BrickVoxels; ++i) {
+			brick.voxels[i] = uniform;
+		}
+		const uint32_t brickRef = (uint32_t)_bricks.size();
+		_bricks.push_back(brick);
+		ref() = brickRef;
+	}
+	const glm::ivec3 brickPos = local - mins;
+	Voxel& target = _bricks[ref()].voxels[brickPos.x + (brickPos.y + brickPos.z * BrickSize) * BrickSize];
+	if (isEqual(target, voxel)) {
+		return false;
+	}
+	target = voxel;
+	return true;
+}
+
+void SparseVolume::deduplicate() {
+	core_trace_scoped(SparseVolumeDeduplicate);
+	if (_deduplicated) {
+		return;
+	}
+	// the copy also collapses the uniform bricks and nodes that setVoxel() might have created
+	const SparseVolume source(*this);
+	_nodes.clear();
+	_bricks.clear();
+	_uniformVoxels.clear();
+	uniformRef(Voxel());
+	Builder builder(*this, true);
+	_root = builder.copy(source, source._root, _size);
+	shrinkToFit(_nodes);
+	shrinkToFit(_bricks);
+	_deduplicated = true;
+}
+
+RawVolume* SparseVolume::toRawVolume() const {
+	core_trace_scoped(SparseVolumeToRawVolume);
+	RawVolume* volume = new RawVolume(_region);
+	volume->setBorderValue(_borderVoxel);
+	struct Entry {
+		uint32_t ref;
+		glm::ivec3 mins;
+		int size;
+	};
+	std::vector<Entry> stack;
+	stack.push_back({_root, _region.getLowerCorner(), _size});
+	while (!stack.empty()) {
+		const Entry e = stack.back();
+		stack.pop_back();
+		if (isUniform(e.ref)) {
+			const Voxel& voxel = _uniformVoxels[e.ref & ~UniformBit];
+			if (!isAir(voxel.getMaterial())) {
+				volume->fill(Region(e.mins, e.mins + (e.size - 1)), voxel);
+			}
+			continue;
+		}
+		if (e.size == BrickSize) {
+			const Voxel* voxel = _bricks[e.ref].voxels;
+			for (int z = 0; z < BrickSize; ++z) {
+				for (int y = 0; y < BrickSize; ++y) {
+					for (int x = 0; x < BrickSize; ++x, ++voxel) {
+						const glm::ivec3 pos(e.mins.x + x, e.mins.y + y, e.mins.z + z);
+						if (isAir(voxel->getMaterial()) || !_region.containsPoint(pos)) {
+							continue;
+						}
+						volume->setVoxel(pos, *voxel);
+					}
+				}
+			}
+			continue;
+		}
+		const int half = e.size / 2;
+		for (int i = 0; i < 8; ++i) {
+			const glm::ivec3 childMins(e.mins.x + (i & 1) * half, e.mins.y + ((i >> 1) & 1) * half, e.mins.z + ((i >> 2) & 1) * half);
+			stack.push_back({_nodes[e.ref].children[i], childMins, half});
+		}
+	}
+	return volume;
+}
+
+size_t SparseVolume::memoryUsage() const {
+	return sizeof(*this) + _nodes.capacity() * sizeof(Node) + _bricks.capacity() * sizeof(Brick)
+		+ _uniformVoxels.capacity() * sizeof(Voxel);
+}
+
+SparseVolume::Sampler::Sampler(const SparseVolume& volume) : _volume(&volume) {
+}
+
+SparseVolume::Sampler::Sampler(const SparseVolume* volume) : _volume(volume) {
+}
+
+}
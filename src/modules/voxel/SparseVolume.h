@@ -0,0 +1,402 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Voxel.h"
+#include "Region.h"
+#include <glm/vec3.hpp>
+#include <vector>
+
+namespace voxel {
+
+class RawVolume;
+
+/**
+ * @brief Sparse voxel octree for big volumes that are mostly air
+ *
+ * Nodes whose voxels are all the same are collapsed into a single value - no matter how big they are. The leaves of the
+ * tree are bricks of @c BrickSize voxels per axis. With deduplication enabled identical bricks and nodes are only stored
+ * once, which turns the tree into a directed acyclic graph (DAG).
+ *
+ * The volume is meant to be read-mostly - a deduplicated volume can't be modified anymore as nodes are shared.
+ *
+ * @sa RawVolume
+ */
+class SparseVolume {
+public:
+	/** the edge length of the leaf bricks */
+	static constexpr int BrickSize = 4;
+	static constexpr int BrickVoxels = BrickSize * BrickSize * BrickSize;
+
+	/**
+	 * @brief The part of the tree that a position was found in
+	 */
+	struct Leaf {
+		/** the lower corner of the leaf in volume coordinates */
+		glm::ivec3 mins { 0 };
+		/** the edge length of the leaf - @c 0 if the position is outside the volume */
+		int size = 0;
+		/** either the single voxel of a uniform leaf or the @c BrickVoxels voxels of a brick */
+		const Voxel* voxels = nullptr;
+		bool uniform = false;
+
+		inline bool contains(const glm::ivec3& pos) const {
+			return pos.x >= mins.x && pos.y >= mins.y && pos.z >= mins.z && pos.x < mins.x + size && pos.y < mins.y + size && pos.z < mins.z + size;
+		}
+
+		inline const Voxel& voxel(const glm::ivec3& pos) const {
+			if (uniform) {
+				return *voxels;
+			}
+			const glm::ivec3 local = pos - mins;
+			return voxels[local.x + (local.y + local.z * BrickSize) * BrickSize];
+		}
+	};
+
+	/**
+	 * @brief Read-only sampler that caches the leaf of the last lookup - neighbouring positions are mostly in the same leaf
+	 */
+	class Sampler {
+	public:
+		Sampler(const SparseVolume& volume);
+		Sampler(const SparseVolume* volume);
+
+		const Voxel& voxel() const;
+		const Region& region() const;
+		bool currentPositionValid() const;
+
+		bool setPosition(const glm::ivec3& pos);
+		bool setPosition(int32_t x, int32_t y, int32_t z);
+		const glm::ivec3& position() const;
+
+		void movePositiveX();
+		void movePositiveY();
+		void movePositiveZ();
+
+		void moveNegativeX();
+		void moveNegativeY();
+		void moveNegativeZ();
+
+		const Voxel& peekVoxel1nx1ny1nz() const;
+		const Voxel& peekVoxel1nx1ny0pz() const;
+		const Voxel& peekVoxel1nx1ny1pz() const;
+		const Voxel& peekVoxel1nx0py1nz() const;
+		const Voxel& peekVoxel1nx0py0pz() const;
+		const Voxel& peekVoxel1nx0py1pz() const;
+		const Voxel& peekVoxel1nx1py1nz() const;
+		const Voxel& peekVoxel1nx1py0pz() const;
+		const Voxel& peekVoxel1nx1py1pz() const;
+
+		const Voxel& peekVoxel0px1ny1nz() const;
+		const Voxel& peekVoxel0px1ny0pz() const;
+		const Voxel& peekVoxel0px1ny1pz() const;
+		const Voxel& peekVoxel0px0py1nz() const;
+		const Voxel& peekVoxel0px0py0pz() const;
+		const Voxel& peekVoxel0px0py1pz() const;
+		const Voxel& peekVoxel0px1py1nz() const;
+		const Voxel& peekVoxel0px1py0pz() const;
+		const Voxel& peekVoxel0px1py1pz() const;
+
+		const Voxel& peekVoxel1px1ny1nz() const;
+		const Voxel& peekVoxel1px1ny0pz() const;
+		const Voxel& peekVoxel1px1ny1pz() const;
+		const Voxel& peekVoxel1px0py1nz() const;
+		const Voxel& peekVoxel1px0py0pz() const;
+		const Voxel& peekVoxel1px0py1pz() const;
+		const Voxel& peekVoxel1px1py1nz() const;
+		const Voxel& peekVoxel1px1py0pz() const;
+		const Voxel& peekVoxel1px1py1pz() const;
+
+	private:
+		const Voxel& peek(int32_t x, int32_t y, int32_t z) const;
+
+		const SparseVolume* _volume;
+		glm::ivec3 _posInVolume { 0 };
+		mutable Leaf _leaf;
+	};
+
+	/**
+	 * @brief Creates an empty volume - all voxels are air
+	 */
+	SparseVolume(const Region& region);
+	/**
+	 * @brief Converts the given volume
+	 * @param deduplicate Store identical bricks and nodes only once - the volume is read-only afterwards
+	 */
+	SparseVolume(const RawVolume& volume, bool deduplicate = true);
+
+	/**
+	 * @brief Converts the volume back into a @c RawVolume
+	 * @note It's the callers responsibility to delete the returned volume
+	 */
+	RawVolume* toRawVolume() const;
+
+	const Region& region() const;
+	const Voxel& borderValue() const;
+	void setBorderValue(const Voxel& voxel);
+
+	const Voxel& voxel(int32_t x, int32_t y, int32_t z) const;
+	const Voxel& voxel(const glm::ivec3& pos) const;
+	/**
+	 * @brief Looks up the voxel at the given position and the leaf of the tree it is stored in
+	 */
+	const Voxel& lookup(const glm::ivec3& pos, Leaf& leaf) const;
+
+	/**
+	 * @return @c false if the position is outside the volume or the voxel was already the same
+	 * @note Not possible on deduplicated volumes
+	 */
+	bool setVoxel(int32_t x, int32_t y, int32_t z, const Voxel& voxel);
+	bool setVoxel(const glm::ivec3& pos, const Voxel& voxel);
+
+	/**
+	 * @brief Stores identical bricks and nodes only once - the volume is read-only afterwards
+	 */
+	void deduplicate();
+	bool isDeduplicated() const;
+
+	size_t nodes() const;
+	size_t bricks() const;
+	/**
+	 * @return The amount of bytes that are allocated for the tree
+	 */
+	size_t memoryUsage() const;
+
+private:
+	/** marks a reference to a uniform value instead of a node or brick */
+	static constexpr uint32_t UniformBit = 1u << 31;
+
+	struct Node {
+		uint32_t children[8];
+	};
+
+	struct Brick {
+		Voxel voxels[BrickVoxels];
+	};
+
+	class Builder;
+
+	static inline bool isUniform(uint32_t ref) {
+		return (ref & UniformBit) != 0u;
+	}
+
+	uint32_t uniformRef(const Voxel& voxel);
+
+	Region _region;
+	Voxel _borderVoxel;
+	/** the edge length of the cube that is covered by the root node */
+	int _size = 0;
+	uint32_t _root = 0u;
+	bool _deduplicated = false;
+	// std::vector grows geometrically - there are millions of bricks in big volumes
+	std::vector<Node> _nodes;
+	std::vector<Brick> _bricks;
+	std::vector<Voxel> _uniformVoxels;
+};
+
+inline const Region& SparseVolume::region() const {
+	return _region;
+}
+
+inline const Voxel& SparseVolume::borderValue() const {
+	return _borderVoxel;
+}
+
+inline void SparseVolume::setBorderValue(const Voxel& voxel) {
+	_borderVoxel = voxel;
+}
+
+inline const Voxel& SparseVolume::voxel(const glm::ivec3& pos) const {
+	Leaf leaf;
+	return lookup(pos, leaf);
+}
+
+inline const Voxel& SparseVolume::voxel(int32_t x, int32_t y, int32_t z) const {
+	return voxel(glm::ivec3(x, y, z));
+}
+
+inline bool SparseVolume::setVoxel(int32_t x, int32_t y, int32_t z, const Voxel& voxel) {
+	return setVoxel(glm::ivec3(x, y, z), voxel);
+}
+
+inline bool SparseVolume::isDeduplicated() const {
+	return _deduplicated;
+}
+
+inline size_t SparseVolume::nodes() const {
+	return _nodes.size();
+}
+
+inline size_t SparseVolume::bricks() const {
+	return _bricks.size();
+}
+
+inline const Region& SparseVolume::Sampler::region() const {
+	return _volume->region();
+}
+
+inline bool SparseVolume::Sampler::currentPositionValid() const {
+	return _volume->region().containsPoint(_posInVolume);
+}
+
+inline const glm::ivec3& SparseVolume::Sampler::position() const {
+	return _posInVolume;
+}
+
+inline bool SparseVolume::Sampler::setPosition(const glm::ivec3& pos) {
+	_posInVolume = pos;
+	return currentPositionValid();
+}
+
+inline bool SparseVolume::Sampler::setPosition(int32_t x, int32_t y, int32_t z) {
+	return setPosition(glm::ivec3(x, y, z));
+}
+
+inline const Voxel& SparseVolume::Sampler::peek(int32_t x, int32_t y, int32_t z) const {
+	const glm::ivec3 pos(_posInVolume.x + x, _posInVolume.y + y, _posInVolume.z + z);
+	// leaves at the border of the volume might exceed the region
+	if (_leaf.contains(pos) && _volume->region().containsPoint(pos)) {
+		return _leaf.voxel(pos);
+	}
+	return _volume->lookup(pos, _leaf);
+}
+
+inline const Voxel& SparseVolume::Sampler::voxel() const {
+	return peek(0, 0, 0);
+}
+
+inline void SparseVolume::Sampler::movePositiveX() {
+	++_posInVolume.x;
+}
+
+inline void SparseVolume::Sampler::movePositiveY() {
+	++_posInVolume.y;
+}
+
+inline void SparseVolume::Sampler::movePositiveZ() {
+	++_posInVolume.z;
+}
+
+inline void SparseVolume::Sampler::moveNegativeX() {
+	--_posInVolume.x;
+}
+
+inline void SparseVolume::Sampler::moveNegativeY() {
+	--_posInVolume.y;
+}
+
+inline void SparseVolume::Sampler::moveNegativeZ() {
+	--_posInVolume.z;
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1nx1ny1nz() const {
+	return peek(-1, -1, -1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1nx1ny0pz() const {
+	return peek(-1, -1, 0);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1nx1ny1pz() const {
+	return peek(-1, -1, 1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1nx0py1nz() const {
+	return peek(-1, 0, -1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1nx0py0pz() const {
+	return peek(-1, 0, 0);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1nx0py1pz() const {
+	return peek(-1, 0, 1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1nx1py1nz() const {
+	return peek(-1, 1, -1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1nx1py0pz() const {
+	return peek(-1, 1, 0);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1nx1py1pz() const {
+	return peek(-1, 1, 1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel0px1ny1nz() const {
+	return peek(0, -1, -1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel0px1ny0pz() const {
+	return peek(0, -1, 0);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel0px1ny1pz() const {
+	return peek(0, -1, 1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel0px0py1nz() const {
+	return peek(0, 0, -1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel0px0py0pz() const {
+	return peek(0, 0, 0);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel0px0py1pz() const {
+	return peek(0, 0, 1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel0px1py1nz() const {
+	return peek(0, 1, -1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel0px1py0pz() const {
+	return peek(0, 1, 0);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel0px1py1pz() const {
+	return peek(0, 1, 1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1px1ny1nz() const {
+	return peek(1, -1, -1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1px1ny0pz() const {
+	return peek(1, -1, 0);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1px1ny1pz() const {
+	return peek(1, -1, 1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1px0py1nz() const {
+	return peek(1, 0, -1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1px0py0pz() const {
+	return peek(1, 0, 0);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1px0py1pz() const {
+	return peek(1, 0, 1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1px1py1nz() const {
+	return peek(1, 1, -1);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1px1py0pz() const {
+	return peek(1, 1, 0);
+}
+
+inline const Voxel& SparseVolume::Sampler::peekVoxel1px1py1pz() const {
+	return peek(1, 1, 1);
+}
+
+}
@@ -28,7 +28,11 @@ struct VoxelVertex {
 };
 static_assert(sizeof(VoxelVertex) == 8, "Unexpected size of the vertex struct");
 
-// TODO: maybe reduce to uint16_t and use glDrawElementsBaseVertex
 typedef uint32_t IndexType;
+/**
+ * @brief Index type for the compact index buffers - the indices are relative to the base vertex of a @c SubMesh
+ * @sa Mesh::compactIndices()
+ */
+typedef uint16_t CompactIndexType;
 
 }
@@ -0,0 +1,234 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+#include "voxel/ParallelSurfaceExtractor.h"
+#include <map>
+#include <tuple>
+
+namespace voxel {
+
+class CubicSurfaceExtractorTest: public AbstractVoxelTest {
+protected:
+	// axis, normal direction, plane, color
+	using SurfaceKey = std::tuple<int, int, int, int>;
+	// position, axis, normal direction
+	using CornerKey = std::tuple<int, int, int, int, int>;
+
+	static glm::ivec3 normal(const Mesh& mesh, size_t triangle, int& axis) {
+		const glm::ivec3 p0(mesh.getVertex(mesh.getIndex(triangle + 0)).position);
+		const glm::ivec3 p1(mesh.getVertex(mesh.getIndex(triangle + 1)).position);
+		const glm::ivec3 p2(mesh.getVertex(mesh.getIndex(triangle + 2)).position);
+		const glm::ivec3 a = p1 - p0;
+		const glm::ivec3 b = p2 - p0;
+		const glm::ivec3 n(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+		axis = n.x != 0 ? 0 : (n.y != 0 ? 1 : 2);
+		return n;
+	}
+
+	/**
+	 * @return twice the covered area per face direction, plane and color
+	 */
+	static std::map<SurfaceKey, int> surface(const Mesh& mesh) {
+		std::map<SurfaceKey, int> areas;
+		for (size_t i = 0; i < mesh.getNoOfIndices(); i += 3) {
+			int axis;
+			const glm::ivec3 n = normal(mesh, i, axis);
+			const VoxelVertex& v = mesh.getVertex(mesh.getIndex(i));
+			areas[SurfaceKey(axis, n[axis] > 0, v.position[axis], v.colorIndex)] += glm::abs(n[axis]);
+		}
+		return areas;
+	}
+
+	static std::map<CornerKey, int> ambientOcclusion(const Mesh& mesh) {
+		std::map<CornerKey, int> corners;
+		for (size_t i = 0; i < mesh.getNoOfIndices(); i += 3) {
+			int axis;
+			const glm::ivec3 n = normal(mesh, i, axis);
+			for (size_t j = i; j < i + 3; ++j) {
+				const VoxelVertex& v = mesh.getVertex(mesh.getIndex(j));
+				corners[CornerKey(v.position.x, v.position.y, v.position.z, axis, n[axis] > 0)] = v.ambientOcclusion;
+			}
+		}
+		return corners;
+	}
+
+	void fill(RawVolume& volume) {
+		const Region& region = volume.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				const int height = 4 + (x / 7 + z / 3) % 8;
+				for (int y = region.getLowerY(); y <= height; ++y) {
+					if ((x * 7 + y * 13 + z * 31) % 23 == 0) {
+						continue;
+					}
+					if (y == height && (x + z) % 9 == 0) {
+						volume.setVoxel(x, y, z, createVoxel(VoxelType::Water, 0));
+					} else {
+						volume.setVoxel(x, y, z, createVoxel(VoxelType::Generic, 1 + (x / 10 + y / 5) % 3));
+					}
+				}
+			}
+		}
+	}
+};
+
+TEST_F(CubicSurfaceExtractorTest, testBinaryGreedyMatchesSurface) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(79, 15, 11)));
+	fill(volume);
+	// larger than one tile along x and not aligned to the volume
+	const Region region(glm::ivec3(1, 0, 1), glm::ivec3(75, 14, 10));
+	const glm::ivec3 translate(3, -2, 5);
+
+	Mesh classic(1024, 1024, true);
+	extractCubicMesh(&volume, region, &classic, IsQuadNeeded(), translate, false, true);
+	Mesh binary(1024, 1024, true);
+	extractBinaryGreedyMesh(&volume, region, &binary, translate);
+	ASSERT_GT(classic.getNoOfIndices(), 0u);
+	EXPECT_LT(binary.getNoOfIndices(), classic.getNoOfIndices());
+	EXPECT_EQ(classic.getOffset(), binary.getOffset());
+
+	EXPECT_EQ(surface(classic), surface(binary));
+
+	const std::map<CornerKey, int> expected = ambientOcclusion(classic);
+	const std::map<CornerKey, int> corners = ambientOcclusion(binary);
+	for (const auto& e : corners) {
+		auto iter = expected.find(e.first);
+		ASSERT_NE(expected.end(), iter) << "No face corner at this position in the classic mesh";
+		EXPECT_EQ(iter->second, e.second);
+	}
+}
+
+TEST_F(CubicSurfaceExtractorTest, testBinaryGreedyWithoutMerging) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(31, 15, 31)));
+	fill(volume);
+	const Region& region = volume.region();
+
+	Mesh classic(1024, 1024, true);
+	extractCubicMesh(&volume, region, &classic, IsQuadNeeded(), region.getLowerCorner(), false, true);
+	Mesh binary(1024, 1024, true);
+	extractBinaryGreedyMesh(&volume, region, &binary, region.getLowerCorner(), false);
+	EXPECT_EQ(classic.getNoOfIndices(), binary.getNoOfIndices());
+	EXPECT_EQ(surface(classic), surface(binary));
+	EXPECT_EQ(ambientOcclusion(classic), ambientOcclusion(binary));
+}
+
+TEST_F(CubicSurfaceExtractorTest, testReuseContext) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(31, 15, 31)));
+	fill(volume);
+	const Region small(glm::ivec3(4), glm::ivec3(11));
+	const Region& large = volume.region();
+
+	Mesh expectedSmall(1024, 1024, true);
+	extractCubicMesh(&volume, small, &expectedSmall, IsQuadNeeded(), small.getLowerCorner());
+	Mesh expectedLarge(1024, 1024, true);
+	extractCubicMesh(&volume, large, &expectedLarge, IsQuadNeeded(), large.getLowerCorner());
+
+	SurfaceExtractionContext ctx;
+	Mesh mesh(1024, 1024, true);
+	// the buffers of the large extraction must not leak into the smaller one
+	extractCubicMesh(&volume, large, &mesh, IsQuadNeeded(), large.getLowerCorner(), ctx);
+	EXPECT_EQ(surface(expectedLarge), surface(mesh));
+	EXPECT_EQ(expectedLarge.getNoOfIndices(), mesh.getNoOfIndices());
+	extractCubicMesh(&volume, small, &mesh, IsQuadNeeded(), small.getLowerCorner(), ctx);
+	EXPECT_EQ(surface(expectedSmall), surface(mesh));
+	EXPECT_EQ(expectedSmall.getNoOfIndices(), mesh.getNoOfIndices());
+	EXPECT_EQ(expectedSmall.getNoOfVertices(), mesh.getNoOfVertices());
+	extractBinaryGreedyMesh(&volume, small, &mesh, small.getLowerCorner(), ctx);
+	EXPECT_EQ(surface(expectedSmall), surface(mesh));
+}
+
+TEST_F(CubicSurfaceExtractorTest, testParallel) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(79, 15, 40)));
+	fill(volume);
+	const Region region(glm::ivec3(1, 0, 1), glm::ivec3(78, 15, 39));
+	const glm::ivec3 translate(3, -2, 5);
+	core::ThreadPool threadPool(2, "Extraction");
+	threadPool.init();
+
+	Mesh expected(1024, 1024, true);
+	extractCubicMesh(&volume, region, &expected, IsQuadNeeded(), translate, false, true);
+	Mesh mesh(1024, 1024, true);
+	// tiles that don't divide the region
+	extractCubicMeshParallel(&volume, region, &mesh, IsQuadNeeded(), translate, threadPool, false, true, true, 16);
+	EXPECT_EQ(expected.getOffset(), mesh.getOffset());
+	EXPECT_EQ(expected.getNoOfIndices(), mesh.getNoOfIndices());
+	EXPECT_EQ(surface(expected), surface(mesh));
+	EXPECT_EQ(ambientOcclusion(expected), ambientOcclusion(mesh));
+	for (size_t i = 0; i < mesh.getNoOfIndices(); ++i) {
+		ASSERT_LT(mesh.getIndex(i), mesh.getNoOfVertices());
+	}
+
+	Mesh merged(1024, 1024, true);
+	extractCubicMeshParallel(&volume, region, &merged, IsQuadNeeded(), translate, threadPool, true, true, true, 16);
+	EXPECT_EQ(surface(expected), surface(merged));
+	threadPool.shutdown(true);
+}
+
+TEST_F(CubicSurfaceExtractorTest, testParallelSingleTile) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(31, 15, 31)));
+	fill(volume);
+	core::ThreadPool threadPool(2, "Extraction");
+	threadPool.init();
+
+	// the single tile is extracted directly - the indices must be in the same format as for several tiles
+	Mesh single(1024, 1024, true);
+	extractCubicMeshParallel(&volume, volume.region(), &single, IsQuadNeeded(), glm::ivec3(0), threadPool, false, true, true, 32);
+	Mesh tiled(1024, 1024, true);
+	extractCubicMeshParallel(&volume, volume.region(), &tiled, IsQuadNeeded(), glm::ivec3(0), threadPool, false, true, true, 16);
+	ASSERT_FALSE(single.isEmpty());
+	ASSERT_NE(nullptr, single.compressedIndices());
+	ASSERT_NE(nullptr, tiled.compressedIndices());
+	EXPECT_EQ(tiled.compressedIndexSize(), single.compressedIndexSize());
+	threadPool.shutdown(true);
+}
+
+TEST_F(CubicSurfaceExtractorTest, testPositiveZAmbientOcclusion) {
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	// the occluder is next to the right edge of the positive z face of the voxel at 1:1:1
+	RawVolume occluded(Region(glm::ivec3(0), glm::ivec3(3)));
+	occluded.setVoxel(1, 1, 1, voxel);
+	occluded.setVoxel(2, 1, 2, voxel);
+	// the occluder is one voxel further away and doesn't touch the face
+	RawVolume free(Region(glm::ivec3(0), glm::ivec3(3)));
+	free.setVoxel(1, 1, 1, voxel);
+	free.setVoxel(2, 1, 3, voxel);
+
+	Mesh occludedMesh(1024, 1024, true);
+	extractCubicMesh(&occluded, occluded.region(), &occludedMesh, IsQuadNeeded(), glm::ivec3(0), false, false);
+	Mesh freeMesh(1024, 1024, true);
+	extractCubicMesh(&free, free.region(), &freeMesh, IsQuadNeeded(), glm::ivec3(0), false, false);
+	const std::map<CornerKey, int> occludedCorners = ambientOcclusion(occludedMesh);
+	const std::map<CornerKey, int> freeCorners = ambientOcclusion(freeMesh);
+	for (int y = 1; y <= 2; ++y) {
+		const CornerKey left(1, y, 2, 2, true);
+		const CornerKey right(2, y, 2, 2, true);
+		ASSERT_EQ(1u, occludedCorners.count(left));
+		ASSERT_EQ(1u, occludedCorners.count(right));
+		ASSERT_EQ(1u, freeCorners.count(left));
+		ASSERT_EQ(1u, freeCorners.count(right));
+		EXPECT_EQ(3, occludedCorners.at(left));
+		EXPECT_EQ(2, occludedCorners.at(right)) << "The occluder in the plane of the face must darken the corner";
+		EXPECT_EQ(3, freeCorners.at(left));
+		EXPECT_EQ(3, freeCorners.at(right)) << "The voxel behind the plane of the face must not darken the corner";
+	}
+
+	// both extractors must agree on the occlusion of the positive z faces
+	Mesh binaryMesh(1024, 1024, true);
+	extractBinaryGreedyMesh(&occluded, occluded.region(), &binaryMesh, glm::ivec3(0), false);
+	EXPECT_EQ(occludedCorners, ambientOcclusion(binaryMesh));
+	extractBinaryGreedyMesh(&free, free.region(), &binaryMesh, glm::ivec3(0), false);
+	EXPECT_EQ(freeCorners, ambientOcclusion(binaryMesh));
+}
+
+TEST_F(CubicSurfaceExtractorTest, testBinaryGreedyEmpty) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(15)));
+	Mesh binary(1024, 1024, true);
+	extractBinaryGreedyMesh(&volume, volume.region(), &binary, glm::ivec3(0));
+	EXPECT_TRUE(binary.isEmpty());
+}
+
+}
@@ -0,0 +1,229 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+#include "voxel/Mesh.h"
+#include "core/ArrayLength.h"
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+namespace voxel {
+
+class MeshTest: public AbstractVoxelTest {
+protected:
+	/**
+	 * @brief Resolves the compact indices back into vertex indices
+	 */
+	static IndexArray expand(const CompactIndexArray& compact, const SubMeshArray& subMeshes) {
+		IndexArray indices;
+		indices.reserve(compact.size());
+		for (const SubMesh& subMesh : subMeshes) {
+			for (uint32_t i = 0u; i < subMesh.numIndices; ++i) {
+				indices.push_back(subMesh.baseVertex + compact[subMesh.baseIndex + i]);
+			}
+		}
+		return indices;
+	}
+
+	static void expectEqual(const IndexArray& expected, const IndexArray& indices) {
+		ASSERT_EQ(expected.size(), indices.size());
+		for (size_t i = 0u; i < expected.size(); ++i) {
+			ASSERT_EQ(expected[i], indices[i]) << "Index " << i << " differs";
+		}
+	}
+
+	/**
+	 * @brief Creates a mesh with more vertices than 16 bit indices can address
+	 */
+	static void createLargeMesh(Mesh& mesh, int quads) {
+		VoxelVertex vertex;
+		vertex.info = 0u;
+		vertex.colorIndex = 1u;
+		for (int i = 0; i < quads; ++i) {
+			vertex.position = glm::vec<3, int16_t, glm::highp>(i % 1024, i / 1024, 0);
+			const IndexType i0 = mesh.addVertex(vertex);
+			const IndexType i1 = mesh.addVertex(vertex);
+			const IndexType i2 = mesh.addVertex(vertex);
+			const IndexType i3 = mesh.addVertex(vertex);
+			mesh.addTriangle(i0, i1, i2);
+			mesh.addTriangle(i0, i2, i3);
+		}
+	}
+};
+
+TEST_F(MeshTest, testCompactIndicesSingleSubMesh) {
+	RawVolume volume(Region(0, 15));
+	for (int i = 0; i <= 15; i += 2) {
+		volume.setVoxel(i, i, i, createVoxel(VoxelType::Generic, 1));
+	}
+	Mesh mesh(1024, 1024, true);
+	extractCubicMesh(&volume, volume.region(), &mesh, IsQuadNeeded(), glm::ivec3(0), true, true);
+	ASSERT_FALSE(mesh.isEmpty());
+
+	CompactIndexArray compact;
+	SubMeshArray subMeshes;
+	ASSERT_TRUE(mesh.compactIndices(compact, subMeshes));
+	ASSERT_EQ(1u, subMeshes.size());
+	EXPECT_EQ(0u, subMeshes[0].baseIndex);
+	EXPECT_EQ(mesh.getNoOfIndices(), subMeshes[0].numIndices);
+	expectEqual(mesh.getIndexVector(), expand(compact, subMeshes));
+	EXPECT_EQ(mesh.getNoOfIndices() * sizeof(IndexType), 2 * compact.size() * sizeof(CompactIndexType));
+}
+
+TEST_F(MeshTest, testCompactIndicesSplit) {
+	Mesh mesh(50000 * 4, 50000 * 6, true);
+	createLargeMesh(mesh, 50000);
+	ASSERT_GT(mesh.getNoOfVertices(), 3u * 65536u);
+
+	CompactIndexArray compact;
+	SubMeshArray subMeshes;
+	ASSERT_TRUE(mesh.compactIndices(compact, subMeshes));
+	ASSERT_EQ(4u, subMeshes.size());
+	uint32_t baseIndex = 0u;
+	for (const SubMesh& subMesh : subMeshes) {
+		EXPECT_EQ(baseIndex, subMesh.baseIndex);
+		EXPECT_EQ(0u, subMesh.numIndices % 3u);
+		baseIndex += subMesh.numIndices;
+	}
+	EXPECT_EQ(mesh.getNoOfIndices(), compact.size());
+	expectEqual(mesh.getIndexVector(), expand(compact, subMeshes));
+}
+
+TEST_F(MeshTest, testCompactIndicesSharedBuffer) {
+	Mesh mesh1(20000 * 4, 20000 * 6, true);
+	createLargeMesh(mesh1, 20000);
+	Mesh mesh2(1024, 1024, true);
+	createLargeMesh(mesh2, 100);
+
+	CompactIndexArray compact;
+	SubMeshArray subMeshes;
+	ASSERT_TRUE(mesh1.compactIndices(compact, subMeshes));
+	ASSERT_TRUE(mesh2.compactIndices(compact, subMeshes, (uint32_t)mesh1.getNoOfVertices()));
+
+	IndexArray expected = mesh1.getIndexVector();
+	expected.reserve(compact.size());
+	for (IndexType index : mesh2.getIndexVector()) {
+		expected.push_back(index + (IndexType)mesh1.getNoOfVertices());
+	}
+	expectEqual(expected, expand(compact, subMeshes));
+}
+
+TEST_F(MeshTest, testCompactIndicesConcatenated) {
+	// many small region meshes in one buffer - as the volume renderer uploads them
+	IndexArray concatenated;
+	IndexType offset = 0u;
+	for (int i = 0; i < 200; ++i) {
+		Mesh mesh(1024, 1024, true);
+		createLargeMesh(mesh, 100);
+		for (IndexType index : mesh.getIndexVector()) {
+			concatenated.push_back(index + offset);
+		}
+		offset += (IndexType)mesh.getNoOfVertices();
+	}
+	ASSERT_GT(offset, 65536u);
+
+	CompactIndexArray compact;
+	SubMeshArray subMeshes;
+	ASSERT_TRUE(compactIndices(concatenated.data(), concatenated.size(), 0u, compact, subMeshes));
+	EXPECT_EQ(2u, subMeshes.size()) << "Consecutive meshes should share a sub mesh while they fit into 16 bit";
+	expectEqual(concatenated, expand(compact, subMeshes));
+}
+
+TEST_F(MeshTest, testOptimize) {
+	RawVolume volume(Region(0, 23));
+	const Region& region = volume.region();
+	for (int z = 0; z <= region.getUpperZ(); ++z) {
+		for (int x = 0; x <= region.getUpperX(); ++x) {
+			const int height = 3 + (x / 4 + z / 3) % 6;
+			for (int y = 0; y <= height; ++y) {
+				volume.setVoxel(x, y, z, createVoxel(VoxelType::Generic, 1 + (x / 6) % 2));
+			}
+		}
+	}
+	Mesh mesh(1024, 1024, true);
+	// the binary mesher doesn't share vertices between quads
+	extractBinaryGreedyMesh(&volume, region, &mesh, glm::ivec3(0), false);
+	ASSERT_FALSE(mesh.isEmpty());
+	Mesh expected = mesh;
+
+	const MeshOptimizeStats stats = mesh.optimize();
+	EXPECT_EQ(expected.getNoOfVertices(), stats.verticesBefore);
+	EXPECT_EQ(mesh.getNoOfVertices(), stats.verticesAfter);
+	EXPECT_LT(stats.verticesAfter, stats.verticesBefore / 2);
+	EXPECT_LT(stats.acmrAfter, stats.acmrBefore);
+	EXPECT_LT(stats.acmrAfter, 1.0f);
+	ASSERT_EQ(expected.getNoOfIndices(), mesh.getNoOfIndices());
+
+	// the same triangles must be rendered - in a different order
+	auto key = [] (const Mesh& m, size_t i) {
+		const VoxelVertex& v = m.getVertex(m.getIndex(i));
+		return std::make_tuple(v.position.x, v.position.y, v.position.z, (int)v.info, (int)v.colorIndex);
+	};
+	using Triangle = std::tuple<decltype(key(mesh, 0)), decltype(key(mesh, 0)), decltype(key(mesh, 0))>;
+	std::vector<Triangle> expectedTriangles;
+	std::vector<Triangle> triangles;
+	for (size_t i = 0; i < mesh.getNoOfIndices(); i += 3) {
+		expectedTriangles.emplace_back(key(expected, i), key(expected, i + 1), key(expected, i + 2));
+		triangles.emplace_back(key(mesh, i), key(mesh, i + 1), key(mesh, i + 2));
+	}
+	std::sort(expectedTriangles.begin(), expectedTriangles.end());
+	std::sort(triangles.begin(), triangles.end());
+	EXPECT_TRUE(expectedTriangles == triangles);
+}
+
+TEST_F(MeshTest, testOptimizeKeepTriangleOrder) {
+	RawVolume volume(Region(0, 7));
+	for (int i = 0; i <= 7; ++i) {
+		volume.setVoxel(i, 0, 0, createVoxel(VoxelType::Generic, 1));
+		volume.setVoxel(0, i, 1, createVoxel(VoxelType::Generic, 2));
+	}
+	Mesh mesh(1024, 1024, true);
+	extractBinaryGreedyMesh(&volume, volume.region(), &mesh, glm::ivec3(0), false);
+	const Mesh expected = mesh;
+	const MeshOptimizeStats stats = mesh.optimize(false);
+	EXPECT_LT(stats.verticesAfter, stats.verticesBefore);
+	ASSERT_EQ(expected.getNoOfIndices(), mesh.getNoOfIndices());
+	for (size_t i = 0; i < mesh.getNoOfIndices(); ++i) {
+		const VoxelVertex& e = expected.getVertex(expected.getIndex(i));
+		const VoxelVertex& v = mesh.getVertex(mesh.getIndex(i));
+		ASSERT_EQ(glm::ivec3(e.position), glm::ivec3(v.position));
+		ASSERT_EQ(e.info, v.info);
+		ASSERT_EQ(e.colorIndex, v.colorIndex);
+	}
+}
+
+TEST_F(MeshTest, testOptimizeIgnoresPaddingBits) {
+	Mesh mesh(16, 16, true);
+	VoxelVertex vertices[4];
+	for (int i = 0; i < 4; ++i) {
+		vertices[i].position = glm::vec<3, int16_t, glm::highp>(i & 1, i >> 1, 0);
+		vertices[i].info = 0u;
+		vertices[i].ambientOcclusion = 3;
+		vertices[i].flags = 1;
+		vertices[i].colorIndex = 255;
+	}
+	mesh.addTriangle(mesh.addVertex(vertices[0]), mesh.addVertex(vertices[1]), mesh.addVertex(vertices[2]));
+	// the same vertices with garbage in the unused bits
+	for (VoxelVertex& v : vertices) {
+		v.padding = 7;
+	}
+	mesh.addTriangle(mesh.addVertex(vertices[2]), mesh.addVertex(vertices[1]), mesh.addVertex(vertices[3]));
+	const MeshOptimizeStats stats = mesh.optimize(false);
+	EXPECT_EQ(6u, stats.verticesBefore);
+	EXPECT_EQ(4u, stats.verticesAfter);
+}
+
+TEST_F(MeshTest, testCompactIndicesTriangleOutOfRange) {
+	const IndexType indices[] = {0u, 1u, 2u, 0u, 2u, 70000u};
+	CompactIndexArray compact;
+	SubMeshArray subMeshes;
+	EXPECT_FALSE(compactIndices(indices, lengthof(indices), 0u, compact, subMeshes));
+	EXPECT_TRUE(compact.empty());
+	EXPECT_TRUE(subMeshes.empty());
+}
+
+}
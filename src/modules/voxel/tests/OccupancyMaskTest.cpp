@@ -0,0 +1,171 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/OccupancyMask.h"
+#include "voxel/RawVolume.h"
+
+namespace voxel {
+
+class OccupancyMaskTest: public AbstractVoxelTest {
+protected:
+	/**
+	 * @brief Spans more than one word per row and more than one brick on each axis
+	 */
+	const Region _region{glm::ivec3(-5, 2, -70), glm::ivec3(130, 70, 2)};
+
+	static void expectInSync(const RawVolume& volume) {
+		const OccupancyMask* mask = volume.occupancy();
+		ASSERT_NE(nullptr, mask);
+		ASSERT_EQ(volume.region(), mask->region());
+		const Region& region = volume.region();
+		int cnt = 0;
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					const bool occupied = !isAir(volume.voxel(x, y, z).getMaterial());
+					ASSERT_EQ(occupied, mask->isOccupied(x, y, z)) << "Voxel at " << x << ":" << y << ":" << z;
+					if (occupied) {
+						++cnt;
+					}
+				}
+			}
+		}
+		EXPECT_EQ(cnt, mask->count());
+	}
+
+	/**
+	 * @brief Reference implementation that checks the voxels one by one
+	 */
+	static int countPerVoxel(const RawVolume& volume, const Region& region) {
+		int cnt = 0;
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if (volume.region().containsPoint(x, y, z) && !isAir(volume.voxel(x, y, z).getMaterial())) {
+						++cnt;
+					}
+				}
+			}
+		}
+		return cnt;
+	}
+};
+
+TEST_F(OccupancyMaskTest, testSync) {
+	RawVolume volume(_region);
+	volume.setVoxel(0, 10, -3, createVoxel(VoxelType::Generic, 1));
+	volume.enableOccupancy();
+	expectInSync(volume);
+
+	const Voxel voxel = createVoxel(VoxelType::Generic, 2);
+	volume.setVoxel(63, 2, -70, voxel);
+	volume.setVoxel(64, 2, -70, voxel);
+	volume.setVoxel(130, 70, 2, voxel);
+	volume.setVoxel(0, 10, -3, Voxel());
+	expectInSync(volume);
+
+	volume.fill(Region(glm::ivec3(-10, 5, -20), glm::ivec3(100, 9, -10)), voxel);
+	expectInSync(volume);
+	volume.fill(Region(glm::ivec3(20, 6, -15), glm::ivec3(70, 8, -12)), Voxel());
+	expectInSync(volume);
+
+	RawVolume src(Region(glm::ivec3(0), glm::ivec3(80, 10, 10)));
+	for (int x = 0; x <= 80; x += 3) {
+		src.setVoxel(x, x % 11, x % 7, createVoxel(VoxelType::Generic, 3));
+	}
+	volume.copyFrom(src, src.region(), glm::ivec3(30, 20, -40));
+	expectInSync(volume);
+	volume.mergeFrom(src, src.region(), glm::ivec3(-20, 3, -16));
+	expectInSync(volume);
+
+	RawVolume::Sampler sampler(volume);
+	sampler.setPosition(1, 60, -50);
+	sampler.setVoxel(voxel);
+	expectInSync(volume);
+
+	const RawVolume copy(volume);
+	expectInSync(copy);
+
+	volume.translate(glm::ivec3(3, -2, 1));
+	expectInSync(volume);
+
+	volume.clear();
+	expectInSync(volume);
+	EXPECT_EQ(0, volume.occupancy()->count());
+
+	volume.disableOccupancy();
+	EXPECT_EQ(nullptr, volume.occupancy());
+}
+
+TEST_F(OccupancyMaskTest, testIsEmptyAndCount) {
+	RawVolume volume(_region);
+	volume.enableOccupancy();
+	const OccupancyMask* mask = volume.occupancy();
+	EXPECT_TRUE(mask->isEmpty(_region));
+	volume.fill(Region(glm::ivec3(60, 30, -60), glm::ivec3(70, 67, -50)), createVoxel(VoxelType::Generic, 1));
+	volume.setVoxel(-5, 2, 2, createVoxel(VoxelType::Generic, 1));
+
+	const Region regions[] = {
+		_region,
+		Region(glm::ivec3(-100), glm::ivec3(100)),
+		Region(glm::ivec3(0, 0, -40), glm::ivec3(130, 70, 0)),
+		Region(glm::ivec3(59, 29, -61), glm::ivec3(60, 30, -60)),
+		Region(glm::ivec3(71, 30, -60), glm::ivec3(80, 67, -50)),
+		Region(glm::ivec3(-5, 2, 2), glm::ivec3(-5, 2, 2)),
+		Region(glm::ivec3(200), glm::ivec3(300))
+	};
+	for (const Region& region : regions) {
+		const int expected = countPerVoxel(volume, region);
+		EXPECT_EQ(expected, mask->count(region)) << region.toString();
+		EXPECT_EQ(expected == 0, mask->isEmpty(region)) << region.toString();
+	}
+}
+
+TEST_F(OccupancyMaskTest, testCalculateBounds) {
+	RawVolume volume(_region);
+	volume.enableOccupancy();
+	const OccupancyMask* mask = volume.occupancy();
+	EXPECT_FALSE(mask->calculateBounds().isValid());
+
+	volume.setVoxel(70, 40, -3, createVoxel(VoxelType::Generic, 1));
+	EXPECT_EQ(Region(glm::ivec3(70, 40, -3), glm::ivec3(70, 40, -3)), mask->calculateBounds());
+
+	volume.setVoxel(-2, 66, -65, createVoxel(VoxelType::Generic, 1));
+	volume.setVoxel(127, 3, -10, createVoxel(VoxelType::Generic, 1));
+	EXPECT_EQ(Region(glm::ivec3(-2, 3, -65), glm::ivec3(127, 66, -3)), mask->calculateBounds());
+
+	volume.setVoxel(-2, 66, -65, Voxel());
+	EXPECT_EQ(Region(glm::ivec3(70, 3, -10), glm::ivec3(127, 40, -3)), mask->calculateBounds());
+}
+
+TEST_F(OccupancyMaskTest, testVisitSurface) {
+	RawVolume volume(_region);
+	volume.enableOccupancy();
+	volume.fill(Region(glm::ivec3(10, 10, -60), glm::ivec3(100, 66, -1)), createVoxel(VoxelType::Generic, 1));
+	volume.fill(Region(glm::ivec3(-5, 2, -70), glm::ivec3(0, 4, -68)), createVoxel(VoxelType::Generic, 1));
+	volume.setVoxel(50, 30, -30, Voxel());
+	const OccupancyMask* mask = volume.occupancy();
+
+	int expected = 0;
+	for (int z = _region.getLowerZ(); z <= _region.getUpperZ(); ++z) {
+		for (int y = _region.getLowerY(); y <= _region.getUpperY(); ++y) {
+			for (int x = _region.getLowerX(); x <= _region.getUpperX(); ++x) {
+				if (mask->isSurface(x, y, z)) {
+					++expected;
+				}
+			}
+		}
+	}
+	EXPECT_TRUE(mask->isSurface(50, 30, -31));
+	EXPECT_FALSE(mask->isSurface(50, 31, -31));
+	int cnt = 0;
+	EXPECT_EQ(expected, mask->visitSurface([&](int x, int y, int z) {
+		EXPECT_TRUE(mask->isSurface(x, y, z)) << x << ":" << y << ":" << z;
+		++cnt;
+	}));
+	EXPECT_EQ(expected, cnt);
+}
+
+}
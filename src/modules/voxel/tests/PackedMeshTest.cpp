@@ -0,0 +1,114 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+#include "voxel/PackedMesh.h"
+
+namespace voxel {
+
+class PackedMeshTest: public AbstractVoxelTest {
+protected:
+	static void expectEqual(const Mesh& expected, const Mesh& mesh) {
+		EXPECT_EQ(expected.getOffset(), mesh.getOffset());
+		ASSERT_EQ(expected.getNoOfVertices(), mesh.getNoOfVertices());
+		for (size_t i = 0u; i < expected.getNoOfVertices(); ++i) {
+			const VoxelVertex& e = expected.getVertex(i);
+			const VoxelVertex& v = mesh.getVertex(i);
+			ASSERT_EQ(glm::ivec3(e.position), glm::ivec3(v.position)) << "Vertex " << i;
+			ASSERT_EQ(e.ambientOcclusion, v.ambientOcclusion) << "Vertex " << i;
+			ASSERT_EQ(e.flags, v.flags) << "Vertex " << i;
+			ASSERT_EQ(e.colorIndex, v.colorIndex) << "Vertex " << i;
+		}
+		ASSERT_EQ(expected.getNoOfIndices(), mesh.getNoOfIndices());
+		for (size_t i = 0u; i < expected.getNoOfIndices(); ++i) {
+			ASSERT_EQ(expected.getIndex(i), mesh.getIndex(i)) << "Index " << i;
+		}
+	}
+
+	static VoxelVertex vertex(int x, int y, int z, uint8_t ao, uint8_t flags, uint8_t color) {
+		VoxelVertex v;
+		v.position = glm::vec<3, int16_t, glm::highp>(x, y, z);
+		v.ambientOcclusion = ao;
+		v.flags = flags;
+		v.padding = 0u;
+		v.colorIndex = color;
+		return v;
+	}
+};
+
+TEST_F(PackedMeshTest, testVertexRoundTrip) {
+	const glm::ivec3 origin(-100, 20, 3);
+	for (int ao = 0; ao < 4; ++ao) {
+		for (int flags = 0; flags < 8; ++flags) {
+			for (int color = 0; color < 256; color += 17) {
+				const VoxelVertex v = vertex(origin.x + color, origin.y + PackedMesh::MaxExtent, origin.z, ao, flags, color);
+				const VoxelVertex u = PackedMesh::unpackVertex(PackedMesh::packVertex(v, origin), origin);
+				EXPECT_EQ(glm::ivec3(v.position), glm::ivec3(u.position));
+				EXPECT_EQ(v.ambientOcclusion, u.ambientOcclusion);
+				EXPECT_EQ(v.flags, u.flags);
+				EXPECT_EQ(v.colorIndex, u.colorIndex);
+			}
+		}
+	}
+}
+
+TEST_F(PackedMeshTest, testExtractedMeshRoundTrip) {
+	RawVolume volume(Region(glm::ivec3(-20, -5, 0), glm::ivec3(27, 30, 15)));
+	const Region& region = volume.region();
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+			const int height = (x * 3 + z * 5) % 25;
+			for (int y = region.getLowerY(); y <= height; ++y) {
+				Voxel voxel = createVoxel(VoxelType::Generic, (x + y + z) & 255);
+				voxel.setFlags((x + z) & 7);
+				volume.setVoxel(x, y, z, voxel);
+			}
+		}
+	}
+	Mesh mesh(65536, 65536, true);
+	const glm::ivec3 translate(5, -7, 11);
+	extractCubicMesh(&volume, region, &mesh, IsQuadNeeded(), translate);
+	ASSERT_FALSE(mesh.isEmpty());
+
+	PackedMesh packed;
+	ASSERT_TRUE(packed.pack(mesh));
+	EXPECT_EQ(mesh.getNoOfVertices(), packed.getNoOfVertices());
+	EXPECT_LT(packed.getNoOfVertices() * sizeof(PackedVoxelVertex), mesh.getNoOfVertices() * sizeof(VoxelVertex));
+	Mesh unpacked;
+	packed.unpack(unpacked);
+	expectEqual(mesh, unpacked);
+
+	SurfaceExtractionContext ctx;
+	PackedMesh extracted;
+	ASSERT_TRUE(extractCubicMesh(&volume, region, &extracted, IsQuadNeeded(), translate, ctx));
+	extracted.unpack(unpacked);
+	expectEqual(mesh, unpacked);
+}
+
+TEST_F(PackedMeshTest, testExceedsExtent) {
+	Mesh mesh(16, 16, true);
+	const IndexType i0 = mesh.addVertex(vertex(0, 0, 0, 3, 0, 1));
+	const IndexType i1 = mesh.addVertex(vertex(PackedMesh::MaxExtent + 1, 0, 0, 3, 0, 1));
+	const IndexType i2 = mesh.addVertex(vertex(0, 1, 0, 3, 0, 1));
+	mesh.addTriangle(i0, i1, i2);
+	PackedMesh packed;
+	EXPECT_FALSE(packed.pack(mesh));
+	EXPECT_TRUE(packed.isEmpty());
+}
+
+TEST_F(PackedMeshTest, testEmpty) {
+	Mesh mesh(16, 16, true);
+	mesh.setOffset(glm::ivec3(1, 2, 3));
+	PackedMesh packed;
+	ASSERT_TRUE(packed.pack(mesh));
+	EXPECT_TRUE(packed.isEmpty());
+	Mesh unpacked;
+	packed.unpack(unpacked);
+	EXPECT_TRUE(unpacked.isEmpty());
+	EXPECT_EQ(glm::ivec3(1, 2, 3), unpacked.getOffset());
+}
+
+}
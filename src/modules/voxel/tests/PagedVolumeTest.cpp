@@ -0,0 +1,476 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxel/PagedVolume.h"
+#include "core/concurrent/Atomic.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace voxel {
+
+class PagedVolumeTest: public app::AbstractTest {
+protected:
+	class Pager: public PagedVolume::Pager {
+	public:
+		core::AtomicInt _pageIns { 0 };
+		core::AtomicInt _pageOuts { 0 };
+
+		bool pageIn(PagedVolume::PagerContext& ctx) override {
+			++_pageIns;
+			const Region& region = ctx.region;
+			for (int z = 0; z < region.getDepthInVoxels(); ++z) {
+				for (int y = 0; y < region.getHeightInVoxels(); ++y) {
+					for (int x = 0; x < region.getWidthInVoxels(); ++x) {
+						if (y < region.getHeightInVoxels() / 2) {
+							ctx.chunk->setVoxel(x, y, z, createVoxel(VoxelType::Dirt, (x + z) % 3));
+						}
+					}
+				}
+			}
+			return true;
+		}
+
+		void pageOut(PagedVolume::Chunk* chunk) override {
+			++_pageOuts;
+		}
+	};
+	Pager _pager;
+
+	bool waitForRegion(const PagedVolume& volume, const Region& region) {
+		for (int i = 0; i < 1000; ++i) {
+			if (volume.isRegionReady(region)) {
+				return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		return false;
+	}
+};
+
+TEST_F(PagedVolumeTest, testCompressChunk) {
+	PagedVolume::Chunk chunk(glm::ivec3(0), 16, &_pager);
+	chunk.setVoxel(1, 2, 3, createVoxel(VoxelType::Grass, 42));
+	chunk.setVoxel(15, 15, 15, Voxel(VoxelType::Rock, 1, 2));
+	const uint32_t uncompressedSize = chunk.memoryUsageInBytes();
+	ASSERT_TRUE(chunk.compress());
+	EXPECT_TRUE(chunk.isCompressed());
+	EXPECT_EQ(nullptr, chunk.data());
+	EXPECT_LT(chunk.memoryUsageInBytes(), uncompressedSize);
+
+	EXPECT_EQ(VoxelType::Grass, chunk.voxel(1, 2, 3).getMaterial());
+	EXPECT_EQ(42, chunk.voxel(1, 2, 3).getColor());
+	EXPECT_EQ(VoxelType::Air, chunk.voxel(0, 0, 0).getMaterial());
+
+	chunk.decompress();
+	EXPECT_FALSE(chunk.isCompressed());
+	EXPECT_EQ(uncompressedSize, chunk.memoryUsageInBytes());
+	EXPECT_EQ(VoxelType::Grass, chunk.voxel(1, 2, 3).getMaterial());
+	EXPECT_EQ(42, chunk.voxel(1, 2, 3).getColor());
+	EXPECT_EQ(VoxelType::Rock, chunk.voxel(15, 15, 15).getMaterial());
+	EXPECT_EQ(1, chunk.voxel(15, 15, 15).getColor());
+	EXPECT_EQ(2, chunk.voxel(15, 15, 15).getFlags());
+}
+
+TEST_F(PagedVolumeTest, testCompressUniformChunk) {
+	PagedVolume::Chunk chunk(glm::ivec3(0), 32, &_pager);
+	ASSERT_TRUE(chunk.compress());
+	EXPECT_EQ(sizeof(Voxel), chunk.memoryUsageInBytes());
+	EXPECT_EQ(VoxelType::Air, chunk.voxel(31, 31, 31).getMaterial());
+}
+
+TEST_F(PagedVolumeTest, testCompressTooManyColors) {
+	PagedVolume::Chunk chunk(glm::ivec3(0), 16, &_pager);
+	for (int i = 0; i < 256; ++i) {
+		chunk.setVoxel(i % 16, i / 16, 0, createVoxel(VoxelType::Generic, i));
+	}
+	chunk.setVoxel(0, 0, 1, createVoxel(VoxelType::Rock, 0));
+	EXPECT_FALSE(chunk.compress());
+	EXPECT_FALSE(chunk.isCompressed());
+}
+
+TEST_F(PagedVolumeTest, testCompressedVolume) {
+	const uint16_t sideLength = 16;
+	const uint32_t chunkSize = sideLength * sideLength * sideLength * sizeof(Voxel);
+	// limit the volume to 32 uncompressed chunks
+	PagedVolume volume(&_pager, 1024 * 1024, sideLength, true);
+	const int chunks = 8;
+	for (int z = 0; z < chunks; ++z) {
+		for (int x = 0; x < chunks; ++x) {
+			for (int y = 0; y < 2; ++y) {
+				volume.chunk(glm::ivec3(x * sideLength, y * sideLength, z * sideLength));
+			}
+		}
+	}
+	// none of the chunks should have been deleted - but most of them are compressed
+	EXPECT_LT(volume.memoryUsageInBytes(), chunks * chunks * 2 * chunkSize);
+
+	PagedVolume::Sampler sampler(volume);
+	for (int z = 0; z < chunks * sideLength; z += 3) {
+		for (int x = 0; x < chunks * sideLength; x += 3) {
+			for (int y = 0; y < 2 * sideLength; ++y) {
+				sampler.setPosition(x, y, z);
+				const Voxel& voxel = sampler.voxel();
+				if (y % sideLength < sideLength / 2) {
+					ASSERT_EQ(VoxelType::Dirt, voxel.getMaterial()) << x << ":" << y << ":" << z;
+					ASSERT_EQ((x % sideLength + z % sideLength) % 3, voxel.getColor()) << x << ":" << y << ":" << z;
+				} else {
+					ASSERT_EQ(VoxelType::Air, voxel.getMaterial()) << x << ":" << y << ":" << z;
+				}
+			}
+		}
+	}
+}
+
+
+TEST_F(PagedVolumeTest, testResidentChunkSnapshot) {
+	const uint16_t sideLength = 16;
+	PagedVolume volume(&_pager, 1024 * 1024, sideLength, true);
+	const int chunks = 8;
+	for (int z = 0; z < chunks; ++z) {
+		for (int x = 0; x < chunks; ++x) {
+			volume.chunk(glm::ivec3(x * sideLength, 0, z * sideLength));
+		}
+	}
+	const size_t memoryUsage = volume.memoryUsageInBytes();
+	for (int z = 0; z < chunks; ++z) {
+		for (int x = 0; x < chunks; ++x) {
+			PagedVolume::ChunkPtr chunk;
+			ASSERT_TRUE(volume.residentChunkSnapshot(glm::ivec3(x, 0, z), chunk));
+			ASSERT_NE(nullptr, chunk->data());
+			EXPECT_TRUE(chunk->isModified());
+			EXPECT_EQ(VoxelType::Dirt, chunk->voxel(1, 1, 1).getMaterial());
+			EXPECT_EQ(VoxelType::Air, chunk->voxel(1, sideLength - 1, 1).getMaterial());
+			chunk->resetModified();
+		}
+	}
+	// the compressed chunks were not decompressed
+	EXPECT_EQ(memoryUsage, volume.memoryUsageInBytes());
+	PagedVolume::ChunkPtr chunk;
+	EXPECT_FALSE(volume.residentChunkSnapshot(glm::ivec3(chunks, 0, 0), chunk));
+}
+
+TEST_F(PagedVolumeTest, testModifiedNotCalledForPageIn) {
+	class ModifiedPager: public Pager {
+	public:
+		core::AtomicInt _modified { 0 };
+
+		void modified(PagedVolume::Chunk* chunk) override {
+			++_modified;
+		}
+	};
+	ModifiedPager pager;
+	PagedVolume volume(&pager, 1024 * 1024, 16);
+	PagedVolume::ChunkPtr chunk = volume.chunk(glm::ivec3(0));
+	EXPECT_TRUE(chunk->isModified());
+	EXPECT_EQ(0, (int)pager._modified);
+	chunk->resetModified();
+	volume.setVoxel(1, 1, 1, createVoxel(VoxelType::Rock, 0));
+	EXPECT_EQ(1, (int)pager._modified);
+}
+
+TEST_F(PagedVolumeTest, testChunkIndex) {
+	PagedVolume::ChunkIndex index;
+	const int n = 16;
+	for (int z = -n; z < n; ++z) {
+		for (int x = -n; x < n; ++x) {
+			const glm::ivec3 pos(x, 0, z);
+			index.put(pos, core::make_shared<PagedVolume::Chunk>(pos, 1, &_pager));
+		}
+	}
+	ASSERT_EQ((size_t)(4 * n * n), index.size());
+	for (int z = -n; z < n; z += 2) {
+		for (int x = -n; x < n; ++x) {
+			ASSERT_TRUE(index.remove(glm::ivec3(x, 0, z)));
+		}
+	}
+	ASSERT_EQ((size_t)(2 * n * n), index.size());
+	for (int z = -n; z < n; ++z) {
+		for (int x = -n; x < n; ++x) {
+			const glm::ivec3 pos(x, 0, z);
+			PagedVolume::ChunkPtr chunk;
+			if ((z + n) % 2 == 0) {
+				EXPECT_FALSE(index.get(pos, chunk));
+			} else {
+				ASSERT_TRUE(index.get(pos, chunk));
+				EXPECT_EQ(pos, chunk->chunkPos());
+			}
+		}
+	}
+	index.clear();
+	EXPECT_EQ(0u, index.size());
+}
+
+TEST_F(PagedVolumeTest, testChunkIndexConcurrent) {
+	PagedVolume::ChunkIndex index;
+	const int threadCount = 8;
+	const int n = 1024;
+	core::AtomicInt missing { 0 };
+	core::AtomicInt removed { 0 };
+	std::vector<std::thread> threads;
+	// all threads put and look up the same keys
+	for (int t = 0; t < threadCount; ++t) {
+		threads.emplace_back([&, t] () {
+			for (int i = 0; i < n; ++i) {
+				const glm::ivec3 pos((i + t * 31) % n, t % 2, 0);
+				index.put(pos, core::make_shared<PagedVolume::Chunk>(pos, 1, &_pager));
+				PagedVolume::ChunkPtr chunk;
+				if (!index.get(pos, chunk) || chunk->chunkPos() != pos) {
+					++missing;
+				}
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	threads.clear();
+	EXPECT_EQ(0, (int)missing);
+	ASSERT_EQ((size_t)(2 * n), index.size());
+
+	// all threads remove the same keys while looking up the remaining ones
+	for (int t = 0; t < threadCount; ++t) {
+		threads.emplace_back([&, t] () {
+			for (int i = 0; i < n; ++i) {
+				const int x = (i + t * 31) % n;
+				if (x % 2 == 0) {
+					if (index.remove(glm::ivec3(x, t % 2, 0))) {
+						++removed;
+					}
+				} else {
+					PagedVolume::ChunkPtr chunk;
+					if (!index.get(glm::ivec3(x, t % 2, 0), chunk)) {
+						++missing;
+					}
+				}
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+	EXPECT_EQ(0, (int)missing);
+	EXPECT_EQ(n, (int)removed);
+	ASSERT_EQ((size_t)n, index.size());
+	for (int y = 0; y < 2; ++y) {
+		for (int x = 0; x < n; ++x) {
+			const glm::ivec3 pos(x, y, 0);
+			PagedVolume::ChunkPtr chunk;
+			if (x % 2 == 0) {
+				EXPECT_FALSE(index.get(pos, chunk));
+			} else {
+				ASSERT_TRUE(index.get(pos, chunk));
+				EXPECT_EQ(pos, chunk->chunkPos());
+			}
+		}
+	}
+}
+
+TEST_F(PagedVolumeTest, testPageInNeighbourChunks) {
+	// the pager of each chunk writes into the neighbour chunk that is paged in by another thread
+	class NeighbourPager: public PagedVolume::Pager {
+	public:
+		PagedVolume* _volume = nullptr;
+
+		bool pageIn(PagedVolume::PagerContext& ctx) override {
+			const glm::ivec3& pos = ctx.chunk->chunkPos();
+			ctx.chunk->setVoxel(0, 0, 0, createVoxel(VoxelType::Dirt, 0));
+			// give the other thread the chance to start paging in its chunk
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			const glm::ivec3 neighbour(1 - pos.x, 0, 0);
+			_volume->chunk(neighbour * (int)_volume->chunkSideLength())->setVoxel(1, 1, 1, createVoxel(VoxelType::Grass, 0));
+			return true;
+		}
+
+		void pageOut(PagedVolume::Chunk* chunk) override {
+		}
+	};
+	NeighbourPager pager;
+	const uint16_t sideLength = 16;
+	PagedVolume volume(&pager, 4 * 1024 * 1024, sideLength);
+	pager._volume = &volume;
+	std::thread thread([&] () { volume.chunk(glm::ivec3(0)); });
+	volume.chunk(glm::ivec3(sideLength, 0, 0));
+	thread.join();
+	for (int x = 0; x < 2; ++x) {
+		const glm::ivec3 chunkMins(x * sideLength, 0, 0);
+		EXPECT_EQ(VoxelType::Dirt, volume.voxel(chunkMins).getMaterial());
+		EXPECT_EQ(VoxelType::Grass, volume.voxel(chunkMins + glm::ivec3(1)).getMaterial());
+	}
+}
+
+TEST_F(PagedVolumeTest, testRequestChunks) {
+	const uint16_t sideLength = 16;
+	PagedVolume volume(&_pager, 4 * 1024 * 1024, sideLength);
+	const Region region(0, 0, 0, 4 * sideLength - 1, sideLength - 1, 4 * sideLength - 1);
+	EXPECT_FALSE(volume.isRegionReady(region));
+	volume.requestChunks(region, 1);
+	// requesting the same chunks again must not queue them twice
+	volume.requestChunks(region, 2);
+	EXPECT_EQ(16u, volume.pendingChunkRequests());
+	volume.startPagingThreads(4);
+	ASSERT_TRUE(waitForRegion(volume, region));
+	EXPECT_EQ(16, (int)_pager._pageIns);
+	EXPECT_TRUE(volume.isChunkReady(glm::ivec3(sideLength * 3, 0, sideLength * 3)));
+	EXPECT_FALSE(volume.isChunkReady(glm::ivec3(sideLength * 4, 0, 0)));
+	EXPECT_EQ(VoxelType::Dirt, volume.voxel(1, 1, 1).getMaterial());
+	EXPECT_EQ(16, (int)_pager._pageIns);
+	volume.shutdownPagingThreads();
+}
+
+TEST_F(PagedVolumeTest, testNonBlockingSampler) {
+	const uint16_t sideLength = 16;
+	PagedVolume volume(&_pager, 4 * 1024 * 1024, sideLength);
+	volume.setPlaceholderVoxel(createVoxel(VoxelType::Rock, 1));
+	volume.startPagingThreads(1);
+	PagedVolume::Sampler sampler(volume);
+	sampler.setNonBlocking(true);
+	// this requests the chunk - the placeholder is returned until it's paged in
+	sampler.setPosition(1, 1, 1);
+	ASSERT_TRUE(waitForRegion(volume, Region(0, 0, 0, sideLength - 1, sideLength - 1, sideLength - 1)));
+	sampler.setPosition(1, 1, 1);
+	EXPECT_EQ(VoxelType::Dirt, sampler.voxel().getMaterial());
+	EXPECT_TRUE(sampler.setVoxel(createVoxel(VoxelType::Grass, 0)));
+	EXPECT_EQ(VoxelType::Grass, volume.voxel(1, 1, 1).getMaterial());
+	EXPECT_EQ(1, (int)_pager._pageIns);
+	volume.shutdownPagingThreads();
+}
+
+TEST_F(PagedVolumeTest, testNonBlockingSamplerPlaceholder) {
+	const uint16_t sideLength = 16;
+	PagedVolume volume(&_pager, 4 * 1024 * 1024, sideLength);
+	volume.setPlaceholderVoxel(createVoxel(VoxelType::Rock, 1));
+	// no paging threads - the chunk is never paged in
+	PagedVolume::Sampler sampler(volume);
+	sampler.setNonBlocking(true);
+	sampler.setPosition(1, 1, 1);
+	EXPECT_EQ(VoxelType::Rock, sampler.voxel().getMaterial());
+	EXPECT_EQ(VoxelType::Rock, sampler.peekVoxel1px1py1pz().getMaterial());
+	EXPECT_FALSE(sampler.setVoxel(createVoxel(VoxelType::Grass, 0)));
+	EXPECT_EQ(1u, volume.pendingChunkRequests());
+	EXPECT_EQ(0, (int)_pager._pageIns);
+}
+
+TEST_F(PagedVolumeTest, testEvictLeastRecentlyUsed) {
+	const uint16_t sideLength = 16;
+	// limits the volume to 128 chunks
+	PagedVolume volume(&_pager, 1024 * 1024, sideLength);
+	const glm::ivec3 hot(0);
+	const int chunks = 1024;
+	for (int i = 1; i < chunks; ++i) {
+		volume.chunk(glm::ivec3(i * sideLength, 0, 0));
+		volume.chunk(hot);
+	}
+	EXPECT_TRUE(volume.isChunkReady(hot));
+	EXPECT_FALSE(volume.isChunkReady(glm::ivec3(sideLength, 0, 0)));
+	EXPECT_TRUE(volume.isChunkReady(glm::ivec3((chunks - 1) * sideLength, 0, 0)));
+	EXPECT_EQ(chunks, (int)_pager._pageIns);
+	EXPECT_GT((int)_pager._pageOuts, 0);
+	volume.flushAll();
+	EXPECT_EQ(chunks, (int)_pager._pageOuts);
+}
+
+TEST_F(PagedVolumeTest, testEvictReferencedChunk) {
+	class OriginPager: public Pager {
+	public:
+		core::AtomicInt _originPageOuts { 0 };
+
+		void pageOut(PagedVolume::Chunk* chunk) override {
+			Pager::pageOut(chunk);
+			if (chunk->chunkPos() == glm::ivec3(0)) {
+				++_originPageOuts;
+			}
+		}
+	};
+	OriginPager pager;
+	const uint16_t sideLength = 16;
+	PagedVolume volume(&pager, 1024 * 1024, sideLength);
+	// e.g. a sampler or a write-back queue keeps the chunk alive while it is evicted
+	PagedVolume::ChunkPtr referenced = volume.chunk(glm::ivec3(0));
+	ASSERT_TRUE(referenced->isModified());
+	for (int i = 1; i < 4096 && volume.isChunkReady(glm::ivec3(0)); ++i) {
+		volume.chunk(glm::ivec3(i * sideLength, 0, 0));
+	}
+	ASSERT_FALSE(volume.isChunkReady(glm::ivec3(0)));
+	// the chunk must be paged out before it's paged in again - and not only once the last reference is gone
+	EXPECT_EQ(1, (int)pager._originPageOuts);
+	EXPECT_FALSE(referenced->isModified());
+	referenced = PagedVolume::ChunkPtr();
+	EXPECT_EQ(1, (int)pager._originPageOuts);
+}
+
+TEST_F(PagedVolumeTest, testEvictBackgroundPageOut) {
+	const uint16_t sideLength = 16;
+	PagedVolume volume(&_pager, 1024 * 1024, sideLength);
+	volume.startPagingThreads(2);
+	const int chunks = 512;
+	volume.requestChunks(Region(0, 0, 0, chunks * sideLength - 1, sideLength - 1, sideLength - 1));
+	for (int i = 0; i < 1000 && volume.pendingChunkRequests() > 0u; ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	volume.shutdownPagingThreads();
+	EXPECT_EQ(0u, volume.pendingChunkRequests());
+	// every chunk was paged in exactly once and all evicted chunks were paged out
+	EXPECT_EQ(chunks, (int)_pager._pageIns);
+	volume.flushAll();
+	EXPECT_EQ(chunks, (int)_pager._pageOuts);
+}
+
+TEST_F(PagedVolumeTest, testRequestChunkWhilePagingOut) {
+	// blocks the page out thread on the first evicted chunk - all chunks that are evicted afterwards stay in the page out queue
+	class BlockingPager: public Pager {
+	public:
+		core::AtomicBool _blocked { false };
+		core::AtomicBool _release { false };
+
+		void pageOut(PagedVolume::Chunk* chunk) override {
+			Pager::pageOut(chunk);
+			if (_release) {
+				return;
+			}
+			_blocked = true;
+			while (!_release) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		}
+	};
+	BlockingPager pager;
+	const uint16_t sideLength = 16;
+	PagedVolume volume(&pager, 1024 * 1024, sideLength);
+	volume.startPagingThreads(1);
+	int next = 1;
+	auto evict = [&] (const glm::ivec3& pos) {
+		for (int i = 0; i < 4096 && volume.isChunkReady(pos); ++i) {
+			volume.chunk(glm::ivec3(next++ * sideLength, 0, 0));
+		}
+		return !volume.isChunkReady(pos);
+	};
+	volume.chunk(glm::ivec3(0));
+	ASSERT_TRUE(evict(glm::ivec3(0)));
+	for (int i = 0; i < 1000 && !pager._blocked; ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	ASSERT_TRUE(pager._blocked);
+
+	const glm::ivec3 pos(next * sideLength, 0, 0);
+	const Region region(pos, pos + glm::ivec3(sideLength - 1));
+	volume.chunk(pos);
+	++next;
+	ASSERT_TRUE(evict(pos));
+	// the chunk is made resident again from the page out queue
+	volume.requestChunks(region);
+	ASSERT_TRUE(waitForRegion(volume, region));
+	// a later request for the same chunk must not be dropped
+	ASSERT_TRUE(evict(pos));
+	volume.requestChunks(region);
+	EXPECT_TRUE(waitForRegion(volume, region));
+	// the chunk was never paged in a second time
+	EXPECT_EQ(next, (int)pager._pageIns);
+
+	pager._release = true;
+	volume.shutdownPagingThreads();
+}
+
+}
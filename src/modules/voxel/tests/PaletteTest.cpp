@@ -6,10 +6,40 @@
 #include "app/tests/AbstractTest.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/PaletteLookup.h"
+#include "core/ColorReduction.h"
+#include "core/GameConfig.h"
+#include "core/Var.h"
+#include "core/concurrent/ThreadPool.h"
 
 namespace voxel {
 
-class PaletteTest : public app::AbstractTest {};
+class PaletteTest : public app::AbstractTest {
+protected:
+	/**
+	 * @brief Compares the lookups against the linear search over all palette colors
+	 */
+	static void expectSameClosestMatch(const Palette &pal) {
+		core::DynamicArray<glm::vec4> colors;
+		for (int i = 0; i < pal.colorCount; ++i) {
+			colors.push_back(core::Color::fromRGBA(pal.colors[i]));
+		}
+		for (int r = 0; r < 256; r += 17) {
+			for (int g = 0; g < 256; g += 17) {
+				for (int b = 0; b < 256; b += 17) {
+					const glm::vec4 color = core::Color::fromRGBA(r, g, b);
+					float expectedDistance = 0.0f;
+					float distance = 0.0f;
+					const int expected = core::Color::getClosestMatch(color, colors, &expectedDistance);
+					ASSERT_EQ(expected, pal.getClosestMatch(color, &distance)) << r << ":" << g << ":" << b;
+					ASSERT_EQ(expectedDistance, distance);
+				}
+			}
+		}
+		for (const glm::vec4 &color : colors) {
+			ASSERT_EQ(core::Color::getClosestMatch(color, colors), pal.getClosestMatch(color));
+		}
+	}
+};
 
 TEST_F(PaletteTest, testPaletteLookup) {
 	PaletteLookup pal;
@@ -18,6 +48,75 @@ TEST_F(PaletteTest, testPaletteLookup) {
 	EXPECT_EQ(0, pal.findClosestIndex(rgba));
 }
 
+TEST_F(PaletteTest, testPaletteLookupGrowAndEvict) {
+	PaletteLookup pal(16384);
+	const int initialCapacity = pal.capacity();
+	EXPECT_EQ(PaletteLookup::InitialSize, initialCapacity);
+	for (int i = 0; i < 20000; ++i) {
+		const core::RGBA rgba((uint8_t)i, (uint8_t)(i >> 8), (uint8_t)(i * 13 + 5));
+		ASSERT_EQ(pal.palette().getClosestMatch(rgba), pal.findClosestIndex(rgba)) << i;
+		ASSERT_LE(pal.size(), pal.capacity());
+	}
+	EXPECT_GT(pal.capacity(), initialCapacity);
+	EXPECT_EQ(16384, pal.capacity());
+	// the table is full - new colors are still cached
+	const core::RGBA rgba(1, 2, 3);
+	const uint8_t index = pal.findClosestIndex(rgba);
+	for (int i = 0; i < 10; ++i) {
+		EXPECT_EQ(index, pal.findClosestIndex(rgba));
+	}
+	EXPECT_EQ(pal.palette().getClosestMatch(rgba), index);
+}
+
+TEST_F(PaletteTest, testConcurrentPaletteLookup) {
+	ConcurrentPaletteLookup pal(1024);
+	core::ThreadPool threadPool(4, "PaletteLookup");
+	threadPool.init();
+	core::DynamicArray<std::future<bool>> futures;
+	for (int t = 0; t < 8; ++t) {
+		futures.emplace_back(threadPool.enqueue([&pal, t]() {
+			for (int i = 0; i < 4000; ++i) {
+				const int c = i + (t % 2) * 1000;
+				const core::RGBA rgba((uint8_t)(c * 7), (uint8_t)(c / 3), (uint8_t)(c * 13 + 5));
+				if (pal.palette().getClosestMatch(rgba) != pal.findClosestIndex(rgba)) {
+					return false;
+				}
+			}
+			return true;
+		}));
+	}
+	for (auto &f : futures) {
+		EXPECT_TRUE(f.get());
+	}
+	threadPool.shutdown();
+}
+
+TEST_F(PaletteTest, testConcurrentPaletteLookupGrow) {
+	ConcurrentPaletteLookup pal;
+	EXPECT_EQ(PaletteLookup::InitialSize, pal.capacity());
+	core::ThreadPool threadPool(4, "PaletteLookup");
+	threadPool.init();
+	core::DynamicArray<std::future<bool>> futures;
+	for (int t = 0; t < 4; ++t) {
+		futures.emplace_back(threadPool.enqueue([&pal, t]() {
+			for (int i = 0; i < 20000; ++i) {
+				const int c = i + t * 5000;
+				const core::RGBA rgba((uint8_t)c, (uint8_t)(c >> 8), (uint8_t)(c * 13 + 5));
+				if (pal.palette().getClosestMatch(rgba) != pal.findClosestIndex(rgba)) {
+					return false;
+				}
+			}
+			return true;
+		}));
+	}
+	for (auto &f : futures) {
+		EXPECT_TRUE(f.get());
+	}
+	threadPool.shutdown();
+	EXPECT_GT(pal.capacity(), PaletteLookup::InitialSize);
+	EXPECT_LE(pal.capacity(), PaletteLookup::DefaultMaxSize);
+}
+
 TEST_F(PaletteTest, testGimpPalette) {
 	Palette pal;
 	pal.nippon();
@@ -127,4 +226,49 @@ TEST_F(PaletteTest, testCreateAndLoadPalette) {
 	EXPECT_TRUE(voxel::overridePalette(palette));
 }
 
+TEST_F(PaletteTest, testCreatePaletteColorReduction) {
+	const image::ImagePtr& img = image::loadImage("test-palette-in.png", false);
+	ASSERT_TRUE(img->isLoaded()) << "Failed to load image: " << img->name();
+	core::DynamicArray<core::RGBA> colors;
+	for (int x = 0; x < img->width(); ++x) {
+		for (int y = 0; y < img->height(); ++y) {
+			colors.push_back(img->colorAt(x, y));
+		}
+	}
+	core::ColorHistogram histogram;
+	core::buildColorHistogram(colors.data(), colors.size(), histogram);
+
+	const core::VarPtr &var = core::Var::getSafe(cfg::CoreColorReduction);
+	float deltaE[(int)core::ColorReductionType::Max];
+	for (int i = 0; i < (int)core::ColorReductionType::Max; ++i) {
+		const char *type = core::toColorReductionTypeString((core::ColorReductionType)i);
+		var->setVal(type);
+		voxel::Palette palette;
+		ASSERT_TRUE(voxel::Palette::createPalette(img, palette)) << type;
+		deltaE[i] = core::meanDeltaE(histogram, palette.colors, palette.colorCount);
+	}
+	var->setVal(core::toColorReductionTypeString(core::ColorReductionType::Octree));
+	EXPECT_LT(deltaE[(int)core::ColorReductionType::MedianCut], deltaE[(int)core::ColorReductionType::Octree]);
+	EXPECT_LE(deltaE[(int)core::ColorReductionType::KMeans], deltaE[(int)core::ColorReductionType::Octree]);
+}
+
+TEST_F(PaletteTest, testClosestMatch) {
+	Palette pal;
+	pal.nippon();
+	expectSameClosestMatch(pal);
+	pal.minecraft();
+	expectSameClosestMatch(pal);
+	pal.magicaVoxel();
+	expectSameClosestMatch(pal);
+	pal.quake1();
+	expectSameClosestMatch(pal);
+
+	// the tree must get rebuilt for modified colors
+	pal.colors[10] = core::RGBA(255, 0, 0);
+	pal.colors[20] = core::RGBA(255, 0, 0);
+	pal.colorCount = 100;
+	expectSameClosestMatch(pal);
+	EXPECT_EQ(10, pal.getClosestMatch(core::Color::fromRGBA(255, 0, 0)));
+}
+
 } // namespace voxel
@@ -0,0 +1,154 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/RawVolume.h"
+
+namespace voxel {
+
+class RawVolumeTest: public AbstractVoxelTest {
+protected:
+	static void fillPattern(RawVolume& volume) {
+		const Region& region = volume.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if ((x + y * 3 + z * 5) % 4 == 0) {
+						continue;
+					}
+					volume.setVoxel(x, y, z, createVoxel(VoxelType::Generic, (x * 7 + y + z) & 255));
+				}
+			}
+		}
+	}
+
+	static void expectEqual(const RawVolume& expected, const RawVolume& volume) {
+		ASSERT_EQ(expected.region(), volume.region());
+		const Region& region = expected.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					ASSERT_TRUE(expected.voxel(x, y, z).isSame(volume.voxel(x, y, z))) << "Voxel at " << x << ":" << y << ":" << z;
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Reference implementation for the bulk copies
+	 */
+	static int copyPerVoxel(RawVolume& dest, const RawVolume& src, const Region& srcRegion, const glm::ivec3& destMins, bool skipAir) {
+		int cnt = 0;
+		for (int z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
+			for (int y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
+				for (int x = srcRegion.getLowerX(); x <= srcRegion.getUpperX(); ++x) {
+					const glm::ivec3 destPos = destMins + glm::ivec3(x, y, z) - srcRegion.getLowerCorner();
+					if (!src.region().containsPoint(x, y, z) || !dest.region().containsPoint(destPos)) {
+						continue;
+					}
+					const Voxel& voxel = src.voxel(x, y, z);
+					if (skipAir && isAir(voxel.getMaterial())) {
+						continue;
+					}
+					if (dest.setVoxel(destPos, voxel)) {
+						++cnt;
+					}
+				}
+			}
+		}
+		return cnt;
+	}
+};
+
+TEST_F(RawVolumeTest, testFill) {
+	RawVolume volume(Region(-4, 11));
+	RawVolume expected(volume.region());
+	fillPattern(volume);
+	fillPattern(expected);
+	const Voxel voxel = createVoxel(VoxelType::Generic, 42);
+	const Region region(glm::ivec3(-10, 2, 3), glm::ivec3(5, 20, 3));
+
+	int expectedCnt = 0;
+	Region fillRegion(region);
+	fillRegion.cropTo(expected.region());
+	for (int z = fillRegion.getLowerZ(); z <= fillRegion.getUpperZ(); ++z) {
+		for (int y = fillRegion.getLowerY(); y <= fillRegion.getUpperY(); ++y) {
+			for (int x = fillRegion.getLowerX(); x <= fillRegion.getUpperX(); ++x) {
+				if (expected.setVoxel(x, y, z, voxel)) {
+					++expectedCnt;
+				}
+			}
+		}
+	}
+	Region dirtyRegion = Region::InvalidRegion;
+	EXPECT_EQ(expectedCnt, volume.fill(region, voxel, &dirtyRegion));
+	expectEqual(expected, volume);
+	EXPECT_EQ(fillRegion, dirtyRegion);
+	EXPECT_EQ(0, volume.fill(region, voxel)) << "Nothing should change on the second fill";
+}
+
+TEST_F(RawVolumeTest, testFillOutside) {
+	RawVolume volume(Region(0, 7));
+	Region dirtyRegion = Region::InvalidRegion;
+	EXPECT_EQ(0, volume.fill(Region(8, 10), createVoxel(VoxelType::Generic, 1), &dirtyRegion));
+	EXPECT_FALSE(dirtyRegion.isValid());
+}
+
+TEST_F(RawVolumeTest, testCopyFrom) {
+	RawVolume src(Region(glm::ivec3(-3, 0, 2), glm::ivec3(12, 9, 17)));
+	fillPattern(src);
+	RawVolume volume(Region(0, 15));
+	RawVolume expected(volume.region());
+	volume.fill(volume.region(), createVoxel(VoxelType::Generic, 1));
+	expected.fill(expected.region(), createVoxel(VoxelType::Generic, 1));
+
+	const Region srcRegion(glm::ivec3(-5, 2, 4), glm::ivec3(10, 9, 30));
+	const glm::ivec3 destMins(3, -1, 2);
+	const int expectedCnt = copyPerVoxel(expected, src, srcRegion, destMins, false);
+	Region dirtyRegion = Region::InvalidRegion;
+	EXPECT_EQ(expectedCnt, volume.copyFrom(src, srcRegion, destMins, &dirtyRegion));
+	expectEqual(expected, volume);
+	EXPECT_TRUE(dirtyRegion.isValid());
+	EXPECT_EQ(0, volume.copyFrom(src, srcRegion, destMins));
+}
+
+TEST_F(RawVolumeTest, testMergeFrom) {
+	RawVolume src(Region(glm::ivec3(-3, 0, 2), glm::ivec3(12, 9, 17)));
+	fillPattern(src);
+	RawVolume volume(Region(0, 15));
+	RawVolume expected(volume.region());
+	volume.fill(volume.region(), createVoxel(VoxelType::Generic, 1));
+	expected.fill(expected.region(), createVoxel(VoxelType::Generic, 1));
+
+	const Region srcRegion(glm::ivec3(-5, 2, 4), glm::ivec3(10, 9, 30));
+	const glm::ivec3 destMins(3, -1, 2);
+	const int expectedCnt = copyPerVoxel(expected, src, srcRegion, destMins, true);
+	EXPECT_EQ(expectedCnt, volume.mergeFrom(src, srcRegion, destMins));
+	expectEqual(expected, volume);
+	// the air voxels of the source must not have been copied
+	EXPECT_FALSE(isAir(volume.voxel(3, 0, 2).getMaterial()));
+}
+
+TEST_F(RawVolumeTest, testSubRegionCopy) {
+	RawVolume src(Region(glm::ivec3(-3, 0, 2), glm::ivec3(12, 9, 17)));
+	fillPattern(src);
+	const Region region(glm::ivec3(0, 3, 5), glm::ivec3(7, 9, 12));
+	bool onlyAir = true;
+	RawVolume volume(src, region, &onlyAir);
+	EXPECT_FALSE(onlyAir);
+	ASSERT_EQ(region, volume.region());
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				ASSERT_TRUE(src.voxel(x, y, z).isSame(volume.voxel(x, y, z)));
+			}
+		}
+	}
+
+	RawVolume empty(Region(0, 7));
+	RawVolume emptyCopy(empty, Region(1, 5), &onlyAir);
+	EXPECT_TRUE(onlyAir);
+}
+
+}
@@ -46,4 +46,27 @@ TEST_F(RawVolumeWrapperTest, testSetMaxBoundary) {
 	EXPECT_FALSE(w.setVoxel(8, 7, 7, createVoxel(VoxelType::Air, 0)));
 }
 
+TEST_F(RawVolumeWrapperTest, testFillDirtyRegion) {
+	RawVolume v(Region(0, 15));
+	RawVolumeWrapper w(&v, Region(2, 9));
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	EXPECT_EQ(8 * 8 * 8, w.fill(Region(0, 15), voxel));
+	EXPECT_EQ(Region(2, 9), w.dirtyRegion());
+	EXPECT_TRUE(isAir(v.voxel(1, 1, 1).getMaterial()));
+	EXPECT_TRUE(isAir(v.voxel(10, 10, 10).getMaterial()));
+	EXPECT_EQ(0, w.fill(Region(0, 15), voxel));
+}
+
+TEST_F(RawVolumeWrapperTest, testSetVoxels) {
+	RawVolume v(Region(0, 7));
+	RawVolumeWrapper w(&v);
+	const Voxel voxels[] = {createVoxel(VoxelType::Generic, 1), createVoxel(VoxelType::Generic, 2), createVoxel(VoxelType::Generic, 3)};
+	EXPECT_TRUE(w.setVoxels(6, 1, 6, 4, 4, voxels, 3));
+	EXPECT_EQ(Region(glm::ivec3(6, 1, 6), glm::ivec3(7, 3, 7)), w.dirtyRegion());
+	for (int y = 1; y <= 3; ++y) {
+		EXPECT_EQ(y, v.voxel(7, y, 6).getColor());
+	}
+	EXPECT_TRUE(isAir(v.voxel(5, 1, 6).getMaterial()));
+}
+
 }
@@ -0,0 +1,163 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/IsQuadNeeded.h"
+#include "voxel/RawVolume.h"
+#include "voxel/SparseVolume.h"
+
+namespace voxel {
+
+class SparseVolumeTest: public AbstractVoxelTest {
+protected:
+	/**
+	 * @brief Mostly air with a terrain like surface and a few repeated pillars
+	 */
+	static void fillScene(RawVolume& volume) {
+		const Region& region = volume.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				const int height = region.getLowerY() + 2 + ((x / 3 + z / 5) & 3);
+				for (int y = region.getLowerY(); y <= height; ++y) {
+					volume.setVoxel(x, y, z, createVoxel(VoxelType::Generic, 1 + (y & 1)));
+				}
+				if ((x & 15) == 2 && (z & 15) == 2) {
+					for (int y = height; y <= region.getLowerY() + 20; ++y) {
+						Voxel voxel = createVoxel(VoxelType::Generic, 3);
+						voxel.setFlags(1);
+						volume.setVoxel(x, y, z, voxel);
+					}
+				}
+			}
+		}
+	}
+
+	static void expectEqual(const RawVolume& expected, const SparseVolume& volume) {
+		ASSERT_EQ(expected.region(), volume.region());
+		const Region& region = expected.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					const Voxel& e = expected.voxel(x, y, z);
+					const Voxel& v = volume.voxel(x, y, z);
+					ASSERT_TRUE(e.isSame(v)) << "Voxel at " << x << ":" << y << ":" << z;
+					ASSERT_EQ(e.getFlags(), v.getFlags()) << "Voxel at " << x << ":" << y << ":" << z;
+				}
+			}
+		}
+	}
+};
+
+TEST_F(SparseVolumeTest, testConvert) {
+	RawVolume volume(Region(glm::ivec3(-7, 3, 0), glm::ivec3(52, 40, 70)));
+	fillScene(volume);
+	const size_t rawSize = volume.width() * volume.height() * volume.depth() * sizeof(Voxel);
+
+	SparseVolume tree(volume, false);
+	EXPECT_FALSE(tree.isDeduplicated());
+	expectEqual(volume, tree);
+
+	SparseVolume dag(volume);
+	EXPECT_TRUE(dag.isDeduplicated());
+	expectEqual(volume, dag);
+	EXPECT_LT(dag.bricks(), tree.bricks());
+	EXPECT_LT(dag.memoryUsage(), tree.memoryUsage());
+	EXPECT_LT(dag.memoryUsage(), rawSize / 4);
+
+	RawVolume* converted = dag.toRawVolume();
+	ASSERT_NE(nullptr, converted);
+	ASSERT_EQ(volume.region(), converted->region());
+	expectEqual(*converted, dag);
+	delete converted;
+}
+
+TEST_F(SparseVolumeTest, testSetVoxel) {
+	const Region region(glm::ivec3(0), glm::ivec3(40, 20, 10));
+	SparseVolume volume(region);
+	RawVolume expected(region);
+	EXPECT_EQ(0u, volume.nodes());
+	EXPECT_EQ(0u, volume.bricks());
+	for (int i = 0; i <= 10; ++i) {
+		const Voxel voxel = createVoxel(VoxelType::Generic, i);
+		EXPECT_EQ(expected.setVoxel(i * 4, i * 2, i, voxel), volume.setVoxel(i * 4, i * 2, i, voxel));
+	}
+	EXPECT_FALSE(volume.setVoxel(0, 0, 0, createVoxel(VoxelType::Generic, 0)));
+	EXPECT_FALSE(volume.setVoxel(41, 0, 0, createVoxel(VoxelType::Generic, 1)));
+	expectEqual(expected, volume);
+
+	volume.deduplicate();
+	EXPECT_TRUE(volume.isDeduplicated());
+	expectEqual(expected, volume);
+}
+
+TEST_F(SparseVolumeTest, testDeduplicateCollapsesUniformNodes) {
+	const Region region(0, 15);
+	SparseVolume volume(region);
+	const Voxel voxel = createVoxel(VoxelType::Generic, 1);
+	for (int z = 0; z <= 15; ++z) {
+		for (int y = 0; y <= 15; ++y) {
+			for (int x = 0; x <= 15; ++x) {
+				volume.setVoxel(x, y, z, voxel);
+			}
+		}
+	}
+	EXPECT_GT(volume.bricks(), 0u);
+	volume.deduplicate();
+	EXPECT_EQ(0u, volume.nodes());
+	EXPECT_EQ(0u, volume.bricks());
+	EXPECT_TRUE(volume.voxel(7, 7, 7).isSame(voxel));
+}
+
+TEST_F(SparseVolumeTest, testSampler) {
+	RawVolume volume(Region(glm::ivec3(-3, 0, 1), glm::ivec3(20, 25, 9)));
+	fillScene(volume);
+	volume.setBorderValue(createVoxel(VoxelType::Generic, 5));
+	const SparseVolume sparse(volume);
+	RawVolume::Sampler expected(volume);
+	SparseVolume::Sampler sampler(sparse);
+	const Region& region = volume.region();
+	for (int z = region.getLowerZ() - 1; z <= region.getUpperZ() + 1; ++z) {
+		for (int y = region.getLowerY() - 1; y <= region.getUpperY() + 1; ++y) {
+			expected.setPosition(region.getLowerX() - 1, y, z);
+			sampler.setPosition(region.getLowerX() - 1, y, z);
+			for (int x = region.getLowerX() - 1; x <= region.getUpperX() + 1; ++x) {
+				ASSERT_EQ(expected.currentPositionValid(), sampler.currentPositionValid());
+				ASSERT_TRUE(expected.voxel().isSame(sampler.voxel())) << x << ":" << y << ":" << z;
+				ASSERT_TRUE(expected.peekVoxel1nx1ny1nz().isSame(sampler.peekVoxel1nx1ny1nz())) << x << ":" << y << ":" << z;
+				ASSERT_TRUE(expected.peekVoxel1px1py1pz().isSame(sampler.peekVoxel1px1py1pz())) << x << ":" << y << ":" << z;
+				ASSERT_TRUE(expected.peekVoxel0px1ny0pz().isSame(sampler.peekVoxel0px1ny0pz())) << x << ":" << y << ":" << z;
+				expected.movePositiveX();
+				sampler.movePositiveX();
+			}
+		}
+	}
+}
+
+TEST_F(SparseVolumeTest, testExtractCubicMesh) {
+	RawVolume volume(Region(glm::ivec3(0), glm::ivec3(47, 31, 47)));
+	fillScene(volume);
+	const SparseVolume sparse(volume);
+	const Region region(glm::ivec3(2, 0, 3), glm::ivec3(40, 31, 44));
+
+	Mesh expected(65536, 65536, true);
+	extractCubicMesh(&volume, region, &expected, IsQuadNeeded(), region.getLowerCorner());
+	Mesh mesh(65536, 65536, true);
+	extractCubicMesh(&sparse, region, &mesh, IsQuadNeeded(), region.getLowerCorner());
+	ASSERT_FALSE(expected.isEmpty());
+	ASSERT_EQ(expected.getNoOfVertices(), mesh.getNoOfVertices());
+	ASSERT_EQ(expected.getNoOfIndices(), mesh.getNoOfIndices());
+	for (size_t i = 0; i < expected.getNoOfVertices(); ++i) {
+		const VoxelVertex& e = expected.getVertex(i);
+		const VoxelVertex& v = mesh.getVertex(i);
+		ASSERT_EQ(glm::ivec3(e.position), glm::ivec3(v.position));
+		ASSERT_EQ(e.info, v.info);
+		ASSERT_EQ(e.colorIndex, v.colorIndex);
+	}
+	for (size_t i = 0; i < expected.getNoOfIndices(); ++i) {
+		ASSERT_EQ(expected.getIndex(i), mesh.getIndex(i));
+	}
+}
+
+}
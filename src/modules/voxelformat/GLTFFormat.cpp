@@ -776,30 +776,43 @@ bool GLTFFormat::subdivideShape(SceneGraphNode &node, const tinygltf::Model &mod
 		return core::move(subdivided);
 	};
 
+	struct PosVoxel {
+		glm::ivec3 pos;
+		voxel::Voxel voxel;
+	};
+	// the workers match the colors against the palette - they share the lookup cache
+	voxel::ConcurrentPaletteLookup palLookup;
+	auto voxelize = [&func, &palLookup](size_t indexOffset) {
+		const TriCollection &tris = func(indexOffset);
+		core::DynamicArray<PosVoxel> voxels;
+		if (!tris.empty()) {
+			PosMap posMap((int)tris.size() * 3);
+			transformTris(tris, posMap);
+			voxels.reserve(posMap.size());
+			for (const auto &entry : posMap) {
+				const PosSampling &pos = entry->second;
+				const uint8_t index = palLookup.findClosestIndex(pos.avgColor());
+				voxels.push_back({entry->first, voxel::createVoxel(voxel::VoxelType::Generic, index)});
+			}
+		}
+		return core::move(voxels);
+	};
+
 	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
 	const bool fillHollow = core::Var::getSafe(cfg::VoxformatFillHollow)->boolVal();
 	const size_t maxN = indices.size();
-	core::DynamicArray<std::future<TriCollection>> futures;
+	core::DynamicArray<std::future<core::DynamicArray<PosVoxel>>> futures;
 	futures.reserve(maxN / 3);
 	threadPool.reserve(futures.size());
 	for (size_t indexOffset = 0; indexOffset < maxN; indexOffset += 3) {
-		futures.emplace_back(threadPool.enqueue(func, indexOffset));
+		futures.emplace_back(threadPool.enqueue(voxelize, indexOffset));
 	}
-	voxel::PaletteLookup palLookup;
 	voxel::RawVolume *volume = node.volume();
 	int n = 0;
 	for (auto &f : futures) {
-		const TriCollection &tris = f.get();
-		if (!tris.empty()) {
-			PosMap posMap((int)tris.size() * 3);
-			transformTris(tris, posMap);
-			for (const auto &entry : posMap) {
-				const PosSampling &pos = entry->second;
-				const glm::vec4 &color = pos.avgColor();
-				const uint8_t index = palLookup.findClosestIndex(color);
-				const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, index);
-				volume->setVoxel(entry->first, voxel);
-			}
+		const core::DynamicArray<PosVoxel> &voxels = f.get();
+		for (const PosVoxel &v : voxels) {
+			volume->setVoxel(v.pos, v.voxel);
 		}
 		++n;
 		Log::debug("%i/%i", n, (int)maxN / 3);
@@ -575,6 +575,8 @@ bool GoxFormat::saveChunk_BL16(io::SeekableWriteStream& stream, const SceneGraph
 
 		// TODO: fix this properly - without mirroring
 		voxel::RawVolume *mirrored = voxelutil::mirrorAxis(node.volume(), math::Axis::Z);
+		// speeds up the empty block checks below
+		mirrored->enableOccupancy();
 		for (int by = mins.y; by <= maxs.y; by += BlockSize) {
 			for (int bz = mins.z; bz <= maxs.z; bz += BlockSize) {
 				for (int bx = mins.x; bx <= maxs.x; bx += BlockSize) {
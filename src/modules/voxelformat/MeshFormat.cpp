@@ -12,8 +12,10 @@
 #include "core/collection/DynamicArray.h"
 #include "core/collection/Map.h"
 #include "core/concurrent/Lock.h"
+#include "core/concurrent/ParallelFor.h"
 #include "core/concurrent/ThreadPool.h"
 #include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/ParallelSurfaceExtractor.h"
 #include "voxel/IsQuadNeeded.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/RawVolume.h"
@@ -96,19 +98,45 @@ void MeshFormat::transformTris(const TriCollection &subdivided, PosMap &posMap)
 	}
 }
 
+namespace {
+
+const size_t ColorChunkSize = 4096;
+
+} // namespace
+
 void MeshFormat::voxelizeTris(voxelformat::SceneGraphNode &node, const PosMap &posMap, bool fillHollow) {
 	Log::debug("create voxels");
 	voxel::RawVolume *volume = node.volume();
-	voxel::PaletteLookup palLookup;
+	core::DynamicArray<const PosMap::KeyValue *> entries;
+	entries.reserve(posMap.size());
 	for (const auto &entry : posMap) {
+		entries.push_back(entry);
+	}
+	// the colors are matched against the palette by the threads of the pool - they share the lookup cache
+	voxel::ConcurrentPaletteLookup palLookup;
+	core::DynamicArray<uint8_t> indices;
+	indices.resize(entries.size());
+	const int chunks = (int)((entries.size() + ColorChunkSize - 1) / ColorChunkSize);
+	// this is also called from within the pool threads - the caller takes part in the work instead of blocking
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	core::parallelFor(&threadPool, chunks, [&] (int chunk) {
+		if (stopExecution()) {
+			return;
+		}
+		const size_t end = core_min((size_t)(chunk + 1) * ColorChunkSize, entries.size());
+		for (size_t i = (size_t)chunk * ColorChunkSize; i < end; ++i) {
+			indices[i] = palLookup.findClosestIndex(entries[i]->second.avgColor());
+		}
+	});
+	if (stopExecution()) {
+		return;
+	}
+	for (size_t i = 0; i < entries.size(); ++i) {
 		if (stopExecution()) {
 			return;
 		}
-		const PosSampling &pos = entry->second;
-		const glm::vec4 &color = pos.avgColor();
-		const uint8_t index = palLookup.findClosestIndex(color);
-		const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, index);
-		volume->setVoxel(entry->first, voxel);
+		const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, indices[i]);
+		volume->setVoxel(entries[i]->first, voxel);
 	}
 	node.setPalette(palLookup.palette());
 	if (fillHollow) {
@@ -151,7 +179,12 @@ bool MeshFormat::saveGroups(const SceneGraph& sceneGraph, const core::String &fi
 			voxel::Mesh *mesh = new voxel::Mesh();
 			voxel::Region region = node.region();
 			region.shiftUpperCorner(1, 1, 1);
-			voxel::extractCubicMesh(node.volume(), region, mesh, voxel::IsQuadNeeded(), glm::ivec3(0), mergeQuads, reuseVertices, ambientOcclusion);
+			// large nodes are split into tiles that are meshed by the other threads of the pool, too
+			voxel::extractCubicMeshParallel(node.volume(), region, mesh, voxel::IsQuadNeeded(), glm::ivec3(0), threadPool, mergeQuads, reuseVertices, ambientOcclusion);
+			if (reuseVertices) {
+				// the quad export relies on two consecutive triangles forming a quad
+				mesh->optimize(!quads);
+			}
 			core::ScopedLock scoped(lock);
 			meshes.emplace_back(mesh, node, applyTransform);
 			meshIdxNodeMap.put(node.id(), (int)meshes.size() - 1);
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "Format.h"
+#include "core/collection/HashMap.h"
 #include "private/Tri.h"
 #include <glm/geometric.hpp>
 
@@ -70,7 +71,7 @@ public:
 		}
 	};
 
-	typedef core::Map<glm::ivec3, PosSampling, 64, glm::hash<glm::ivec3>> PosMap;
+	typedef core::HashMap<glm::ivec3, PosSampling, glm::hash<glm::ivec3>> PosMap;
 
 	/**
 	 * Subdivide until we brought the triangles down to the size of 1 or smaller
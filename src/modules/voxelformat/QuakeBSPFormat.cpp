@@ -15,8 +15,8 @@
 #include "core/StandardLib.h"
 #include "core/StringUtil.h"
 #include "core/Var.h"
-#include "core/collection/ConcurrentQueue.h"
 #include "core/collection/DynamicArray.h"
+#include "core/collection/LockFreeQueue.h"
 #include "core/concurrent/Concurrency.h"
 #include "core/concurrent/Lock.h"
 #include "core/concurrent/ThreadPool.h"
@@ -709,7 +709,8 @@ bool QuakeBSPFormat::voxelize(const core::DynamicArray<Texture> &textures, const
 	node.setVolume(volume, true);
 	node.setName(name);
 
-	core::ConcurrentQueue<Tri> producerTris(10000);
+	// all tris are queued before the workers start - the queue never runs full
+	core::BoundedLockFreeQueue<Tri> producerTris(numIndices / 3);
 	core_trace_mutex(core::Lock, voxelLock, "trilock");
 
 	for (int i = 0; i < numIndices; i += 3) {
@@ -10,6 +10,7 @@
 #include "voxel/RawVolume.h"
 #include "util/Easing.h"
 #include "voxelformat/SceneGraph.h"
+#include "voxelutil/VoxelUtil.h"
 
 #include <glm/ext/quaternion_common.hpp>
 #include <glm/ext/scalar_constants.hpp>
@@ -261,6 +262,7 @@ void SceneGraphNode::release() {
 		delete _volume;
 	}
 	_volume = nullptr;
+	_tightRegionVolume = nullptr;
 }
 
 void SceneGraphNode::releaseOwnership() {
@@ -294,6 +296,18 @@ const voxel::Region &SceneGraphNode::region() const {
 	return _volume->region();
 }
 
+const voxel::Region &SceneGraphNode::tightRegion() const {
+	if (_volume == nullptr) {
+		return voxel::Region::InvalidRegion;
+	}
+	if (_tightRegionVolume != _volume || _tightRegionRevision != _volume->revision()) {
+		_tightRegion = voxelutil::calculateTightRegion(*_volume);
+		_tightRegionVolume = _volume;
+		_tightRegionRevision = _volume->revision();
+	}
+	return _tightRegion;
+}
+
 void SceneGraphNode::translate(const glm::ivec3 &v, FrameIndex frameIdx) {
 	if (frameIdx == (FrameIndex)-1) {
 		for (SceneGraphKeyFrame &kf : _keyFrames) {
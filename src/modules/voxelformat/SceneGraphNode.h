@@ -205,6 +205,13 @@ protected:
 	core::StringMap<core::String> _properties;
 	core::Optional<voxel::Palette> _palette;
 
+	/**
+	 * @brief Cache for tightRegion() - valid for the given volume revision
+	 */
+	mutable voxel::Region _tightRegion;
+	mutable const voxel::RawVolume *_tightRegionVolume = nullptr;
+	mutable uint32_t _tightRegionRevision = 0u;
+
 	/**
 	 * @brief Called in emplace() if a parent id is given
 	 */
@@ -273,6 +280,13 @@ public:
 	 * @return voxel::Region instance that is invalid when the volume is not set for this instance.
 	 */
 	const voxel::Region &region() const;
+	/**
+	 * @return The smallest region that contains all solid voxels of the volume. This is invalid if there are none
+	 * or if the volume is not set.
+	 * @note The region is cached until the volume is modified
+	 * @sa voxelutil::calculateTightRegion()
+	 */
+	const voxel::Region &tightRegion() const;
 	/**
 	 * @param volume voxel::RawVolume instance. Might be @c nullptr.
 	 * @param transferOwnership this is @c true if the volume should get deleted by this class, @c false if
@@ -0,0 +1,89 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/ArrayLength.h"
+#include "core/ScopedPtr.h"
+#include "io/FileStream.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/RawVolume.h"
+#include "voxel/SparseVolume.h"
+#include "voxelformat/SceneGraph.h"
+#include "voxelformat/VolumeFormat.h"
+
+/**
+ * @brief Memory usage of the sparse volume compared to the raw volume for the test assets
+ */
+class SparseVolumeBenchmark : public app::AbstractBenchmark {
+protected:
+	core::ScopedPtr<voxel::RawVolume> _volume;
+
+public:
+	static constexpr const char *Files[] = {"r.0.-2.mca", "aceofspades.vxl", "cc.vxl", "test.kv6", "vox_character.vox", "qubicle.qb"};
+
+	bool onInitApp() override {
+		return voxel::initDefaultPalette();
+	}
+
+	void SetUp(benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		const core::String filename = Files[state.range(0)];
+		voxelformat::SceneGraph sceneGraph;
+		const io::FilePtr &file = io::filesystem()->open(filename);
+		if (!file->validHandle()) {
+			state.SkipWithError("Could not open the file");
+			return;
+		}
+		io::FileStream stream(file);
+		if (!voxelformat::loadFormat(filename, stream, sceneGraph)) {
+			state.SkipWithError("Could not load the file");
+			return;
+		}
+		_volume = sceneGraph.merge().first;
+		state.SetLabel(filename.c_str());
+	}
+
+	void TearDown(benchmark::State &state) override {
+		_volume = nullptr;
+		app::AbstractBenchmark::TearDown(state);
+	}
+
+	void setCounters(benchmark::State &state, const voxel::SparseVolume &sparse) const {
+		const voxel::Region &region = _volume->region();
+		const double rawBytes = (double)region.getWidthInVoxels() * region.getHeightInVoxels() * region.getDepthInVoxels() * sizeof(voxel::Voxel);
+		state.counters["RawBytes"] = benchmark::Counter(rawBytes, benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+		state.counters["SparseBytes"] = benchmark::Counter((double)sparse.memoryUsage(), benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+		state.counters["Ratio"] = (double)sparse.memoryUsage() / rawBytes;
+		state.counters["Bricks"] = (double)sparse.bricks();
+	}
+};
+
+constexpr const char *SparseVolumeBenchmark::Files[];
+
+BENCHMARK_DEFINE_F(SparseVolumeBenchmark, Tree)(benchmark::State &state) {
+	if (!_volume) {
+		return;
+	}
+	for (auto _ : state) {
+		const voxel::SparseVolume sparse(*_volume, false);
+		benchmark::DoNotOptimize(sparse.nodes());
+		setCounters(state, sparse);
+	}
+}
+
+BENCHMARK_DEFINE_F(SparseVolumeBenchmark, DAG)(benchmark::State &state) {
+	if (!_volume) {
+		return;
+	}
+	for (auto _ : state) {
+		const voxel::SparseVolume sparse(*_volume, true);
+		benchmark::DoNotOptimize(sparse.nodes());
+		setCounters(state, sparse);
+	}
+}
+
+BENCHMARK_REGISTER_F(SparseVolumeBenchmark, Tree)->DenseRange(0, lengthof(SparseVolumeBenchmark::Files) - 1)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(SparseVolumeBenchmark, DAG)->DenseRange(0, lengthof(SparseVolumeBenchmark::Files) - 1)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
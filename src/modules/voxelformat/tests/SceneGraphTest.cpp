@@ -168,4 +168,24 @@ TEST_F(SceneGraphTest, testKeyframes) {
 	EXPECT_EQ(1u, node.keyFrames().size());
 }
 
+TEST_F(SceneGraphTest, testTightRegion) {
+	SceneGraphNode node;
+	EXPECT_FALSE(node.tightRegion().isValid());
+	voxel::RawVolume *volume = new voxel::RawVolume(voxel::Region(-4, 20));
+	node.setVolume(volume, true);
+	EXPECT_FALSE(node.tightRegion().isValid());
+
+	volume->setVoxel(2, 3, 4, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	EXPECT_EQ(voxel::Region(glm::ivec3(2, 3, 4), glm::ivec3(2, 3, 4)), node.tightRegion());
+	volume->fill(voxel::Region(glm::ivec3(-1, 5, 0), glm::ivec3(1, 7, 18)), voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	EXPECT_EQ(voxel::Region(glm::ivec3(-1, 3, 0), glm::ivec3(2, 7, 18)), node.tightRegion());
+	volume->setVoxel(2, 3, 4, voxel::Voxel());
+	EXPECT_EQ(voxel::Region(glm::ivec3(-1, 5, 0), glm::ivec3(1, 7, 18)), node.tightRegion());
+
+	voxel::RawVolume *other = new voxel::RawVolume(voxel::Region(0, 3));
+	other->setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	node.setVolume(other, true);
+	EXPECT_EQ(voxel::Region(1, 1), node.tightRegion());
+}
+
 }
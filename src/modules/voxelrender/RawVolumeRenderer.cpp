@@ -35,6 +35,7 @@
 #include "VoxelShaderConstants.h"
 #include "voxel/IsQuadNeeded.h"
 #include <SDL.h>
+#include <memory>
 
 namespace voxelrender {
 
@@ -45,6 +46,7 @@ RawVolumeRenderer::RawVolumeRenderer() :
 
 void RawVolumeRenderer::construct() {
 	core::Var::get(cfg::VoxelMeshSize, "64", core::CV_READONLY);
+	core::Var::get(cfg::VoxelMeshBinaryGreedy, "true", "Use the binary greedy mesher for the extraction", core::Var::boolValidator);
 }
 
 bool RawVolumeRenderer::resize(const glm::ivec2 &size) {
@@ -74,6 +76,7 @@ bool RawVolumeRenderer::init(const glm::ivec2 &size) {
 	_shadowMap = core::Var::getSafe(cfg::ClientShadowMap);
 	_bloom = core::Var::getSafe(cfg::ClientBloom);
 	_meshSize = core::Var::getSafe(cfg::VoxelMeshSize);
+	_binaryGreedy = core::Var::getSafe(cfg::VoxelMeshBinaryGreedy);
 
 	_threadPool.init();
 	Log::debug("Threadpool size: %i", (int)_threadPool.size());
@@ -171,15 +174,32 @@ bool RawVolumeRenderer::scheduleExtractions(size_t maxExtraction) {
 			continue;
 		}
 		const voxel::Region& finalRegion = _extractRegions[i].region;
-		bool onlyAir = true;
-		voxel::RawVolume copy(v, voxel::Region(finalRegion.getLowerCorner() - 2, finalRegion.getUpperCorner() + 2), &onlyAir);
+		const voxel::Region copyRegion(finalRegion.getLowerCorner() - 2, finalRegion.getUpperCorner() + 2);
+		// handed back to the pool once the task is done - or dropped by clearPendingExtractions()
+		const std::shared_ptr<voxel::RawVolume> copy(acquireExtractionVolume(copyRegion.getDimensionsInVoxels()),
+				[this] (voxel::RawVolume* volume) { releaseExtractionVolume(volume); });
+		copy->setBorderValue(v->borderValue());
+		// voxels outside of the source volume stay air
+		const bool onlyAir = copy->copyFrom(*v, copyRegion, glm::ivec3(0)) == 0;
 		const glm::ivec3& mins = finalRegion.getLowerCorner();
 		if (!onlyAir) {
-			_threadPool.enqueue([movedCopy = core::move(copy), mins, idx, finalRegion, this] () {
+			// the region in the coordinates of the copy
+			voxel::Region extractRegion(finalRegion);
+			extractRegion.shift(-copyRegion.getLowerCorner());
+			const bool binaryGreedy = _binaryGreedy->boolVal();
+			_threadPool.enqueue([copy, mins, idx, extractRegion, binaryGreedy, this] () {
 				++_runningExtractorTasks;
-				voxel::Mesh mesh(65536, 65536, true);
-				voxel::extractCubicMesh(&movedCopy, finalRegion, &mesh, voxel::IsQuadNeeded(), mins);
-				_pendingQueue.emplace(mins, idx, core::move(mesh));
+				// the extraction memory and the mesh are kept alive per worker thread
+				static thread_local voxel::SurfaceExtractionContext ctx;
+				if (binaryGreedy) {
+					voxel::extractBinaryGreedyMesh(copy.get(), extractRegion, &ctx.mesh, mins, ctx);
+				} else {
+					voxel::extractCubicMesh(copy.get(), extractRegion, &ctx.mesh, voxel::IsQuadNeeded(), mins, ctx);
+				}
+				ctx.mesh.setOffset(mins);
+				ctx.mesh.optimize();
+				// only the used memory is handed over
+				_pendingQueue.emplace(mins, idx, voxel::Mesh(ctx.mesh));
 				Log::debug("Enqueue mesh for idx: %i (%i:%i:%i)", idx, mins.x, mins.y, mins.z);
 				--_runningExtractorTasks;
 			});
@@ -196,6 +216,35 @@ bool RawVolumeRenderer::scheduleExtractions(size_t maxExtraction) {
 	return true;
 }
 
+voxel::RawVolume* RawVolumeRenderer::acquireExtractionVolume(const glm::ivec3& dimensions) {
+	voxel::RawVolume* volume = nullptr;
+	{
+		core::ScopedLock lock(_extractionVolumesLock);
+		if (!_extractionVolumes.empty()) {
+			volume = _extractionVolumes.back();
+			_extractionVolumes.pop();
+		}
+	}
+	if (volume != nullptr && volume->region().getDimensionsInVoxels() == dimensions) {
+		volume->clear();
+		return volume;
+	}
+	delete volume;
+	return new voxel::RawVolume(voxel::Region(glm::ivec3(0), dimensions - 1));
+}
+
+void RawVolumeRenderer::releaseExtractionVolume(voxel::RawVolume* volume) {
+	{
+		core::ScopedLock lock(_extractionVolumesLock);
+		// keep enough volumes for the running tasks and the ones that are scheduled in the meantime
+		if (_extractionVolumes.size() <= _threadPool.size()) {
+			_extractionVolumes.push_back(volume);
+			return;
+		}
+	}
+	delete volume;
+}
+
 void RawVolumeRenderer::update() {
 	scheduleExtractions();
 	ExtractionCtx result;
@@ -245,13 +294,12 @@ bool RawVolumeRenderer::updateBufferForVolume(int idx) {
 
 	const size_t verticesBufSize = vertCount * sizeof(voxel::VoxelVertex);
 	voxel::VoxelVertex* verticesBuf = (voxel::VoxelVertex*)core_malloc(verticesBufSize);
-	const size_t indicesBufSize = indCount * sizeof(voxel::IndexType);
-	voxel::IndexType* indicesBuf = (voxel::IndexType*)core_malloc(indicesBufSize);
+	voxel::IndexArray concatIndices;
+	concatIndices.reserve(indCount);
 
 	voxel::VoxelVertex* verticesPos = verticesBuf;
-	voxel::IndexType* indicesPos = indicesBuf;
 
-	voxel::IndexType offset = (voxel::IndexType)0;
+	voxel::IndexType offset = 0u;
 	for (auto& i : _meshes) {
 		const Meshes& meshes = i.second;
 		const voxel::Mesh* mesh = meshes[idx];
@@ -261,30 +309,34 @@ bool RawVolumeRenderer::updateBufferForVolume(int idx) {
 		const voxel::VertexArray& vertexVector = mesh->getVertexVector();
 		const voxel::IndexArray& indexVector = mesh->getIndexVector();
 		core_memcpy(verticesPos, &vertexVector[0], vertexVector.size() * sizeof(voxel::VoxelVertex));
-		core_memcpy(indicesPos, &indexVector[0], indexVector.size() * sizeof(voxel::IndexType));
-
-		for (size_t i = 0; i < indexVector.size(); ++i) {
-			*indicesPos++ += offset;
+		for (voxel::IndexType index : indexVector) {
+			concatIndices.push_back(index + offset);
 		}
 
 		verticesPos += vertexVector.size();
-		offset += vertexVector.size();
+		offset += (voxel::IndexType)vertexVector.size();
+	}
+
+	// compact the indices of all meshes at once - consecutive meshes share a sub mesh as long as they fit into 16 bit
+	voxel::CompactIndexArray indicesBuf;
+	state._subMeshes.clear();
+	if (!voxel::compactIndices(concatIndices.data(), concatIndices.size(), 0u, indicesBuf, state._subMeshes)) {
+		Log::error("Failed to convert the indices of volume %i", idx);
+		core_free(verticesBuf);
+		return false;
 	}
 
 	if (!state._vertexBuffer.update(state._vertexBufferIndex, verticesBuf, verticesBufSize)) {
 		Log::error("Failed to update the vertex buffer");
-		core_free(indicesBuf);
 		core_free(verticesBuf);
 		return false;
 	}
 	core_free(verticesBuf);
 
-	if (!state._vertexBuffer.update(state._indexBufferIndex, indicesBuf, indicesBufSize)) {
+	if (!state._vertexBuffer.update(state._indexBufferIndex, indicesBuf.data(), indicesBuf.size() * sizeof(voxel::CompactIndexType))) {
 		Log::error("Failed to update the index buffer");
-		core_free(indicesBuf);
 		return false;
 	}
-	core_free(indicesBuf);
 	return true;
 }
 
@@ -305,7 +357,13 @@ bool RawVolumeRenderer::updateBufferForVolume(int idx, const voxel::VertexArray&
 		Log::error("Failed to update the vertex buffer");
 		return false;
 	}
-	if (!state._vertexBuffer.update(state._indexBufferIndex, &indices.front(), indices.size() * sizeof(voxel::IndexArray::value_type))) {
+	voxel::CompactIndexArray compactIndices;
+	state._subMeshes.clear();
+	if (!voxel::compactIndices(indices.data(), indices.size(), 0u, compactIndices, state._subMeshes)) {
+		Log::error("Failed to convert the indices");
+		return false;
+	}
+	if (!state._vertexBuffer.update(state._indexBufferIndex, compactIndices.data(), compactIndices.size() * sizeof(voxel::CompactIndexType))) {
 		Log::error("Failed to update the index buffer");
 		return false;
 	}
@@ -484,6 +542,13 @@ void RawVolumeRenderer::updatePalette(int idx) {
 	}
 }
 
+void RawVolumeRenderer::drawSubMeshes(const State& state) const {
+	for (const voxel::SubMesh& subMesh : state._subMeshes) {
+		video::drawElementsInstancedBaseVertex<voxel::CompactIndexType>(video::Primitive::Triangles, subMesh.numIndices,
+				(int)subMesh.baseIndex, (int)subMesh.baseVertex, state._amounts);
+	}
+}
+
 void RawVolumeRenderer::render(const video::Camera& camera, bool shadow) {
 	core_trace_scoped(RawVolumeRendererRender);
 	uint32_t indices[MAX_VOLUMES];
@@ -496,7 +561,7 @@ void RawVolumeRenderer::render(const video::Camera& camera, bool shadow) {
 		if (state._hidden) {
 			continue;
 		}
-		const uint32_t nIndices = state._vertexBuffer.elements(state._indexBufferIndex, 1, sizeof(voxel::IndexType));
+		const uint32_t nIndices = state._vertexBuffer.elements(state._indexBufferIndex, 1, sizeof(voxel::CompactIndexType));
 		if (nIndices <= 0) {
 			continue;
 		}
@@ -531,8 +596,7 @@ void RawVolumeRenderer::render(const video::Camera& camera, bool shadow) {
 					video::ScopedBuffer scopedBuf(state._vertexBuffer);
 					_shadowMapShader.setModel(state._models);
 					_shadowMapShader.setPivot(state._pivots);
-					static_assert(sizeof(voxel::IndexType) == sizeof(uint32_t), "Index type doesn't match");
-					video::drawElementsInstanced<voxel::IndexType>(video::Primitive::Triangles, indices[idx], state._amounts);
+					drawSubMeshes(state);
 				}
 				return true;
 			}, true);
@@ -585,7 +649,7 @@ void RawVolumeRenderer::render(const video::Camera& camera, bool shadow) {
 		_voxelShader.setGray(state._gray);
 		_voxelShader.setModel(state._models);
 		_voxelShader.setPivot(state._pivots);
-		video::drawElementsInstanced<voxel::IndexType>(video::Primitive::Triangles, indices[idx], state._amounts);
+		drawSubMeshes(state);
 	}
 	if (mode == video::PolygonMode::Points) {
 		video::disable(video::State::PolygonOffsetPoint);
@@ -686,6 +750,10 @@ void RawVolumeRenderer::setSunPosition(const glm::vec3& eye, const glm::vec3& ce
 
 core::DynamicArray<voxel::RawVolume*> RawVolumeRenderer::shutdown() {
 	_threadPool.shutdown();
+	for (voxel::RawVolume* volume : _extractionVolumes) {
+		delete volume;
+	}
+	_extractionVolumes.clear();
 	_voxelShader.shutdown();
 	_shadowMapShader.shutdown();
 	_materialBlock.shutdown();
@@ -9,6 +9,7 @@
 #include "core/collection/ConcurrentPriorityQueue.h"
 #include "core/concurrent/Atomic.h"
 #include "core/concurrent/Concurrency.h"
+#include "core/concurrent/Lock.h"
 #include "core/concurrent/ThreadPool.h"
 #include "render/BloomRenderer.h"
 #include "voxel/Palette.h"
@@ -59,6 +60,8 @@ protected:
 		int32_t _amounts = 1;
 		int32_t _vertexBufferIndex = -1;
 		int32_t _indexBufferIndex = -1;
+		/** the index buffer holds 16 bit indices - one draw call per sub mesh */
+		voxel::SubMeshArray _subMeshes;
 		glm::mat4 _models[shader::VoxelInstancedShaderConstants::getMaxInstances()];
 		glm::vec3 _pivots[shader::VoxelInstancedShaderConstants::getMaxInstances()];
 		video::Buffer _vertexBuffer;
@@ -80,6 +83,7 @@ protected:
 	render::BloomRenderer _bloomRenderer;
 
 	core::VarPtr _meshSize;
+	core::VarPtr _binaryGreedy;
 	core::VarPtr _shadowMap;
 	core::VarPtr _bloom;
 
@@ -98,7 +102,7 @@ protected:
 	struct ExtractionCtx {
 		ExtractionCtx() {}
 		ExtractionCtx(const glm::ivec3& _mins, int _idx, voxel::Mesh&& _mesh) :
-				mins(_mins), idx(_idx), mesh(_mesh) {
+				mins(_mins), idx(_idx), mesh(core::move(_mesh)) {
 		}
 		glm::ivec3 mins {};
 		int idx = -1;
@@ -111,10 +115,17 @@ protected:
 	core::ThreadPool _threadPool { core::halfcpus(), "VolumeRndr" };
 	core::AtomicInt _runningExtractorTasks { 0 };
 	core::ConcurrentPriorityQueue<ExtractionCtx> _pendingQueue;
+	// the copies of the extraction regions are recycled - the volume data must be copied for the tasks as it might
+	// get modified while they are running
+	core_trace_mutex(core::Lock, _extractionVolumesLock, "ExtractionVolumes");
+	core::DynamicArray<voxel::RawVolume*> _extractionVolumes;
+	voxel::RawVolume* acquireExtractionVolume(const glm::ivec3& dimensions);
+	void releaseExtractionVolume(voxel::RawVolume* volume);
 	void extractVolumeRegionToMesh(voxel::RawVolume* volume, const voxel::Region& region, voxel::Mesh* mesh) const;
 	voxel::Region calculateExtractRegion(int x, int y, int z, const glm::ivec3& meshSize) const;
 	void updatePalette(int idx);
 	void deleteMeshes(Meshes& meshes, int idx);
+	void drawSubMeshes(const State& state) const;
 public:
 	RawVolumeRenderer();
 
@@ -6,7 +6,9 @@
 
 #include "voxel/RawVolume.h"
 #include "VolumeMerger.h"
+#include "VoxelUtil.h"
 #include "core/Common.h"
+#include <type_traits>
 
 namespace voxelutil {
 
@@ -30,16 +32,21 @@ voxel::RawVolume* cropVolume(const voxel::RawVolume* volume, const glm::ivec3& m
 		return nullptr;
 	}
 	voxel::RawVolume* newVolume = new voxel::RawVolume(newRegion);
-	voxelutil::mergeVolumes(newVolume, volume, newRegion, voxel::Region(mins, maxs));
+	newVolume->copyFrom(*volume, newRegion, mins);
 	return newVolume;
 }
 
 /**
  * @brief Resizes a volume to cut off empty parts
+ * @note The default condition uses @c calculateTightRegion()
  */
 template<class CropSkipCondition = CropSkipEmpty>
 voxel::RawVolume* cropVolume(const voxel::RawVolume* volume, CropSkipCondition condition = CropSkipCondition()) {
 	core_trace_scoped(CropRawVolume);
+	if (std::is_same<CropSkipCondition, CropSkipEmpty>::value) {
+		const voxel::Region region = calculateTightRegion(*volume);
+		return cropVolume(volume, region.getLowerCorner(), region.getUpperCorner(), condition);
+	}
 	const glm::ivec3& mins = volume->mins();
 	const glm::ivec3& maxs = volume->maxs();
 	glm::ivec3 newMins((std::numeric_limits<int>::max)() / 2);
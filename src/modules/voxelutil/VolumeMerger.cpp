@@ -11,6 +11,39 @@
 
 namespace voxelutil {
 
+/**
+ * @brief Crops the source region to the part that is merged into the destination region
+ * @param[out] destMins The position that the lower corner of the cropped source region is merged to
+ */
+static bool mergeRegion(const voxel::Region& destReg, const voxel::Region& sourceReg, voxel::Region& srcRegion, glm::ivec3& destMins) {
+	const glm::ivec3 offset = destReg.getLowerCorner() - sourceReg.getLowerCorner();
+	srcRegion = destReg;
+	srcRegion.shift(-offset);
+	srcRegion.cropTo(sourceReg);
+	destMins = srcRegion.getLowerCorner() + offset;
+	return srcRegion.isValid();
+}
+
+int mergeVolumes(voxel::RawVolume* destination, const voxel::RawVolume* source, const voxel::Region& destReg, const voxel::Region& sourceReg, MergeSkipEmpty) {
+	core_trace_scoped(MergeRawVolumes);
+	voxel::Region srcRegion;
+	glm::ivec3 destMins;
+	if (!mergeRegion(destReg, sourceReg, srcRegion, destMins)) {
+		return 0;
+	}
+	return destination->mergeFrom(*source, srcRegion, destMins);
+}
+
+int mergeVolumes(voxel::RawVolumeWrapper* destination, const voxel::RawVolume* source, const voxel::Region& destReg, const voxel::Region& sourceReg, MergeSkipEmpty) {
+	core_trace_scoped(MergeRawVolumes);
+	voxel::Region srcRegion;
+	glm::ivec3 destMins;
+	if (!mergeRegion(destReg, sourceReg, srcRegion, destMins)) {
+		return 0;
+	}
+	return destination->mergeFrom(*source, srcRegion, destMins);
+}
+
 voxel::RawVolume* merge(const core::DynamicArray<const voxel::RawVolume*>& volumes) {
 	glm::ivec3 mins((std::numeric_limits<int32_t>::max)() / 2);
 	glm::ivec3 maxs((std::numeric_limits<int32_t>::min)() / 2);
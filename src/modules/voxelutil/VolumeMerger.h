@@ -6,6 +6,7 @@
 
 #include "core/collection/DynamicArray.h"
 #include "voxel/RawVolume.h"
+#include "voxel/RawVolumeWrapper.h"
 #include "core/Trace.h"
 #include "core/Assert.h"
 
@@ -51,6 +52,13 @@ int mergeVolumes(Volume1* destination, const Volume2* source, const voxel::Regio
 	return cnt;
 }
 
+/**
+ * @brief Skips the air voxels of the source volume - the solid voxels are copied row by row
+ * @sa voxel::RawVolume::mergeFrom()
+ */
+extern int mergeVolumes(voxel::RawVolume* destination, const voxel::RawVolume* source, const voxel::Region& destReg, const voxel::Region& sourceReg, MergeSkipEmpty mergeCondition = MergeSkipEmpty());
+extern int mergeVolumes(voxel::RawVolumeWrapper* destination, const voxel::RawVolume* source, const voxel::Region& destReg, const voxel::Region& sourceReg, MergeSkipEmpty mergeCondition = MergeSkipEmpty());
+
 /**
  * The given merge condition function must return false for voxels that should be skipped.
  * @sa MergeSkipEmpty
@@ -0,0 +1,327 @@
+/**
+ * @file
+ */
+
+#include "VolumeRescaler.h"
+#include "core/Assert.h"
+#include "core/ClosestColorTree.h"
+#include "core/Color.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "core/concurrent/ParallelFor.h"
+#include "voxel/RawVolume.h"
+#include <glm/vec4.hpp>
+
+namespace voxelutil {
+
+/**
+ * @brief Edge length of the destination bricks - one brick is processed by one thread
+ */
+static const int RescaleBrickSize = 16;
+
+namespace {
+
+/**
+ * @brief Memoizes the closest palette colors of averaged colors
+ *
+ * Flat areas produce the same averages over and over again - the palette is only searched once for them.
+ * The search itself uses the nearest color tree that is shared between the threads.
+ */
+class ClosestColorCache {
+private:
+	struct Entry {
+		glm::vec3 color{0.0f};
+		int index = -1;
+	};
+	static constexpr int Size = 1024;
+	Entry _entries[Size];
+	const core::ClosestColorTree &_tree;
+
+public:
+	ClosestColorCache(const core::ClosestColorTree &tree) : _tree(tree) {
+	}
+
+	int closestMatch(const glm::vec4 &color) {
+		uint32_t bits[3];
+		core_memcpy(bits, &color, sizeof(bits));
+		uint32_t hash = (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+		hash ^= hash >> 16;
+		Entry &entry = _entries[hash % Size];
+		const glm::vec3 rgb(color);
+		if (entry.index == -1 || entry.color != rgb) {
+			entry.color = rgb;
+			entry.index = _tree.closestMatch(color);
+		}
+		return entry.index;
+	}
+};
+
+/**
+ * @brief Read access to the source voxels with the same semantics as the sampler of the generic version
+ */
+class SourceVoxels {
+private:
+	const voxel::Voxel *_data;
+	const voxel::Region &_region;
+	const voxel::Voxel &_borderValue;
+	const int _width;
+	const int _stride;
+
+public:
+	SourceVoxels(const voxel::RawVolume &volume)
+		: _data((const voxel::Voxel *)volume.data()), _region(volume.region()), _borderValue(volume.borderValue()),
+		  _width(volume.region().getWidthInVoxels()), _stride(volume.region().stride()) {
+	}
+
+	inline bool contains(int32_t x, int32_t y, int32_t z) const {
+		return _region.containsPoint(x, y, z);
+	}
+
+	inline const voxel::Voxel &voxel(int32_t x, int32_t y, int32_t z) const {
+		if (!contains(x, y, z)) {
+			return _borderValue;
+		}
+		const glm::ivec3 &mins = _region.getLowerCorner();
+		return _data[(x - mins.x) + (y - mins.y) * _width + (z - mins.z) * _stride];
+	}
+
+	inline bool isAir(int32_t x, int32_t y, int32_t z) const {
+		return voxel(x, y, z).getMaterial() == voxel::VoxelType::Air;
+	}
+
+	/**
+	 * @sa voxelutil::isHidden()
+	 */
+	bool isHidden(int32_t x, int32_t y, int32_t z) const {
+		for (int32_t childZ = -1; childZ <= 1; ++childZ) {
+			for (int32_t childY = -1; childY <= 1; ++childY) {
+				for (int32_t childX = -1; childX <= 1; ++childX) {
+					if (childZ == 0 && childY == 0 && childX == 0) {
+						continue;
+					}
+					if (!contains(x + childX, y + childY, z + childZ)) {
+						return false;
+					}
+					if (!isBlocked(voxel(x + childX, y + childY, z + childZ).getMaterial())) {
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	float exposedFaces(int32_t x, int32_t y, int32_t z) const {
+		float exposedFaces = 0.0f;
+		if (isAir(x, y, z - 1)) {
+			++exposedFaces;
+		}
+		if (isAir(x, y, z + 1)) {
+			++exposedFaces;
+		}
+		if (isAir(x, y - 1, z)) {
+			++exposedFaces;
+		}
+		if (isAir(x, y + 1, z)) {
+			++exposedFaces;
+		}
+		if (isAir(x - 1, y, z)) {
+			++exposedFaces;
+		}
+		if (isAir(x + 1, y, z)) {
+			++exposedFaces;
+		}
+		return exposedFaces;
+	}
+};
+
+/**
+ * @brief The colors of the palette and the nearest color tree - built once and shared by all levels of a mip chain
+ */
+struct RescalePalette {
+	core::ClosestColorTree tree;
+	glm::vec4 colors[voxel::PaletteMaxColors];
+
+	RescalePalette() {
+		const voxel::Palette &palette = voxel::getPalette();
+		core::DynamicArray<glm::vec4> materialColors;
+		palette.toVec4f(materialColors);
+		tree.build(materialColors.data(), (int)materialColors.size());
+		for (int i = 0; i < voxel::PaletteMaxColors; ++i) {
+			colors[i] = core::Color::fromRGBA(palette.colors[i]);
+		}
+	}
+};
+
+} // namespace
+
+static void rescaleBricks(const voxel::RawVolume &sourceVolume, const voxel::Region &sourceRegion, voxel::RawVolume &destVolume, const voxel::Region &destRegion, const RescalePalette &rescalePalette, core::ThreadPool *threadPool) {
+	core_trace_scoped(RescaleVolumeParallel);
+	const core::ClosestColorTree &tree = rescalePalette.tree;
+	const glm::vec4 *colors = rescalePalette.colors;
+	const SourceVoxels src(sourceVolume);
+	const glm::ivec3 &dim = destRegion.getDimensionsInVoxels();
+	const glm::ivec3 bricks = (dim + (RescaleBrickSize - 1)) / RescaleBrickSize;
+	const int brickCount = bricks.x * bricks.y * bricks.z;
+	// the voxels of the destination region - every brick only writes its own voxels
+	voxel::Voxel *data = (voxel::Voxel *)core_malloc((size_t)dim.x * dim.y * dim.z * sizeof(voxel::Voxel));
+	const int stride = dim.x * dim.y;
+
+	auto brickRegion = [&] (int brick, glm::ivec3 &mins, glm::ivec3 &maxs) {
+		const glm::ivec3 b(brick % bricks.x, (brick / bricks.x) % bricks.y, brick / (bricks.x * bricks.y));
+		mins = b * RescaleBrickSize;
+		maxs = glm::min(mins + RescaleBrickSize, dim);
+	};
+
+	// see the generic version for a description of the two passes
+	core::parallelFor(threadPool, brickCount, [&] (int brick) {
+		ClosestColorCache cache(tree);
+		glm::ivec3 mins, maxs;
+		brickRegion(brick, mins, maxs);
+		for (int32_t z = mins.z; z < maxs.z; ++z) {
+			for (int32_t y = mins.y; y < maxs.y; ++y) {
+				for (int32_t x = mins.x; x < maxs.x; ++x) {
+					const glm::ivec3 srcPos = sourceRegion.getLowerCorner() + glm::ivec3(x, y, z) * 2;
+					float colorContributors = 0.0f;
+					float solidVoxels = 0.0f;
+					float avgColorRed = 0.0f;
+					float avgColorGreen = 0.0f;
+					float avgColorBlue = 0.0f;
+					voxel::Voxel colorGuardVoxel;
+					for (int32_t childZ = srcPos.z; childZ < srcPos.z + 2; ++childZ) {
+						for (int32_t childY = srcPos.y; childY < srcPos.y + 2; ++childY) {
+							for (int32_t childX = srcPos.x; childX < srcPos.x + 2; ++childX) {
+								if (!src.contains(childX, childY, childZ)) {
+									continue;
+								}
+								const voxel::Voxel &child = src.voxel(childX, childY, childZ);
+								if (isBlocked(child.getMaterial())) {
+									++solidVoxels;
+									if (src.isHidden(childX, childY, childZ)) {
+										colorGuardVoxel = child;
+										continue;
+									}
+									const glm::vec4 &color = colors[child.getColor()];
+									avgColorRed += color.r;
+									avgColorGreen += color.g;
+									avgColorBlue += color.b;
+									++colorContributors;
+								}
+							}
+						}
+					}
+					voxel::Voxel &voxel = data[x + y * dim.x + z * stride];
+					if (solidVoxels >= 7.0f) {
+						if (colorContributors <= 0.0f) {
+							const glm::vec4 &color = colors[colorGuardVoxel.getColor()];
+							avgColorRed += color.r;
+							avgColorGreen += color.g;
+							avgColorBlue += color.b;
+							++colorContributors;
+						}
+						const glm::vec4 avgColor(avgColorRed / colorContributors, avgColorGreen / colorContributors, avgColorBlue / colorContributors, 1.0f);
+						voxel = voxel::createVoxel(voxel::VoxelType::Generic, cache.closestMatch(avgColor));
+					} else {
+						voxel = voxel::Voxel();
+					}
+				}
+			}
+		}
+	});
+
+	// the volume takes the ownership of the data - the second pass keeps on writing into it
+	const voxel::RawVolume *result = voxel::RawVolume::createRaw(data, destRegion);
+	destVolume.copyFrom(*result, destRegion, destRegion.getLowerCorner());
+
+	// only the colors of the voxels are changed by this pass - the destination volume is not modified while
+	// the bricks are processed
+	core::parallelFor(threadPool, brickCount, [&] (int brick) {
+		ClosestColorCache cache(tree);
+		glm::ivec3 mins, maxs;
+		brickRegion(brick, mins, maxs);
+		for (int32_t z = mins.z; z < maxs.z; ++z) {
+			for (int32_t y = mins.y; y < maxs.y; ++y) {
+				for (int32_t x = mins.x; x < maxs.x; ++x) {
+					const glm::ivec3 dstPos = destRegion.getLowerCorner() + glm::ivec3(x, y, z);
+					if (destVolume.voxel(dstPos).getMaterial() == voxel::VoxelType::Air) {
+						continue;
+					}
+					if (destVolume.voxel(dstPos.x, dstPos.y, dstPos.z - 1).getMaterial() != voxel::VoxelType::Air
+							&& destVolume.voxel(dstPos.x, dstPos.y, dstPos.z + 1).getMaterial() != voxel::VoxelType::Air
+							&& destVolume.voxel(dstPos.x, dstPos.y - 1, dstPos.z).getMaterial() != voxel::VoxelType::Air
+							&& destVolume.voxel(dstPos.x, dstPos.y + 1, dstPos.z).getMaterial() != voxel::VoxelType::Air
+							&& destVolume.voxel(dstPos.x - 1, dstPos.y, dstPos.z).getMaterial() != voxel::VoxelType::Air
+							&& destVolume.voxel(dstPos.x + 1, dstPos.y, dstPos.z).getMaterial() != voxel::VoxelType::Air) {
+						continue;
+					}
+					const glm::ivec3 srcPos = sourceRegion.getLowerCorner() + glm::ivec3(x, y, z) * 2;
+					float totalRed = 0.0f;
+					float totalGreen = 0.0f;
+					float totalBlue = 0.0f;
+					float totalExposedFaces = 0.0f;
+					for (int32_t childZ = srcPos.z - 1; childZ < srcPos.z + 3; ++childZ) {
+						for (int32_t childY = srcPos.y - 1; childY < srcPos.y + 3; ++childY) {
+							for (int32_t childX = srcPos.x - 1; childX < srcPos.x + 3; ++childX) {
+								const voxel::Voxel &child = src.voxel(childX, childY, childZ);
+								if (child.getMaterial() == voxel::VoxelType::Air) {
+									continue;
+								}
+								const float exposedFaces = src.exposedFaces(childX, childY, childZ);
+								const glm::vec4 &color = colors[child.getColor()];
+								totalRed += color.r * exposedFaces;
+								totalGreen += color.g * exposedFaces;
+								totalBlue += color.b * exposedFaces;
+								totalExposedFaces += exposedFaces;
+							}
+						}
+					}
+					if (totalExposedFaces <= 0.01f) {
+						++totalExposedFaces;
+					}
+					const glm::vec4 avgColor(totalRed / totalExposedFaces, totalGreen / totalExposedFaces, totalBlue / totalExposedFaces, 1.0f);
+					data[x + y * dim.x + z * stride] = voxel::createVoxel(voxel::VoxelType::Generic, cache.closestMatch(avgColor));
+				}
+			}
+		}
+	});
+	destVolume.copyFrom(*result, destRegion, destRegion.getLowerCorner());
+	delete result;
+}
+
+void rescaleVolume(const voxel::RawVolume &sourceVolume, const voxel::Region &sourceRegion, voxel::RawVolume &destVolume, const voxel::Region &destRegion, core::ThreadPool *threadPool) {
+	if (!destRegion.isValid()) {
+		return;
+	}
+	const RescalePalette rescalePalette;
+	rescaleBricks(sourceVolume, sourceRegion, destVolume, destRegion, rescalePalette, threadPool);
+}
+
+voxel::Region downscaledRegion(const voxel::Region &region) {
+	const glm::ivec3 &targetDimensionsHalf = (region.getDimensionsInVoxels() / 2) - 1;
+	return voxel::Region(region.getLowerCorner(), region.getLowerCorner() + targetDimensionsHalf);
+}
+
+core::DynamicArray<voxel::RawVolume *> rescaleMipChain(const voxel::RawVolume &sourceVolume, int levels, core::ThreadPool *threadPool) {
+	core_trace_scoped(RescaleMipChain);
+	core::DynamicArray<voxel::RawVolume *> mips;
+	mips.reserve(levels);
+	if (levels <= 0) {
+		return mips;
+	}
+	const RescalePalette rescalePalette;
+	const voxel::RawVolume *source = &sourceVolume;
+	// every level reads the finished previous one - including voxels of the neighbouring bricks
+	for (int i = 0; i < levels; ++i) {
+		const voxel::Region &destRegion = downscaledRegion(source->region());
+		if (!destRegion.isValid()) {
+			break;
+		}
+		voxel::RawVolume *destVolume = new voxel::RawVolume(destRegion);
+		rescaleBricks(*source, source->region(), *destVolume, destRegion, rescalePalette, threadPool);
+		mips.push_back(destVolume);
+		source = destVolume;
+	}
+	return mips;
+}
+
+} // namespace voxelutil
@@ -10,6 +10,15 @@
 #include "voxel/Palette.h"
 #include "voxel/Voxel.h"
 #include "voxel/Region.h"
+#include "core/collection/DynamicArray.h"
+
+namespace core {
+class ThreadPool;
+}
+
+namespace voxel {
+class RawVolume;
+}
 
 namespace voxelutil {
 
@@ -37,6 +46,7 @@ static bool isHidden(Sampler &srcSampler) {
 
 /**
  * @brief Rescales a volume by sampling two voxels to produce one output voxel.
+ * @note The destination volume must support @c fill() - see @c voxel::RawVolume::fill()
  * @param[in] sourceVolume The source volume to resample
  * @param[in] destVolume The destination volume to resample into
  * @param[in] sourceRegion The region of the source volume to resample
@@ -52,6 +62,9 @@ void rescaleVolume(const SourceVolume& sourceVolume, const voxel::Region& source
 	core::DynamicArray<glm::vec4> materialColors;
 	palette.toVec4f(materialColors);
 
+	// the destination voxels that don't become solid are air
+	destVolume.fill(destRegion, voxel::Voxel());
+
 	const int32_t depth = destRegion.getDepthInVoxels();
 	const int32_t height = destRegion.getHeightInVoxels();
 	const int32_t width = destRegion.getWidthInVoxels();
@@ -109,9 +122,6 @@ void rescaleVolume(const SourceVolume& sourceVolume, const voxel::Region& source
 					const int index = core::Color::getClosestMatch(avgColor, materialColors);
 					voxel::Voxel voxel = createVoxel(voxel::VoxelType::Generic, index);
 					destVolume.setVoxel(dstPos, voxel);
-				} else {
-					const voxel::Voxel voxelAir;
-					destVolume.setVoxel(dstPos, voxelAir);
 				}
 			}
 		}
@@ -211,4 +221,30 @@ void rescaleVolume(const SourceVolume& sourceVolume, DestVolume& destVolume) {
 	rescaleVolume(sourceVolume, sourceVolume.region(), destVolume, destVolume.region());
 }
 
+/**
+ * @brief Same result as the generic @c rescaleVolume() - but the destination region is processed in bricks that are
+ * distributed over the given thread pool. The closest palette colors of the averaged colors are memoized.
+ * @param threadPool Might be @c nullptr to process all bricks on the calling thread
+ */
+void rescaleVolume(const voxel::RawVolume& sourceVolume, const voxel::Region& sourceRegion, voxel::RawVolume& destVolume, const voxel::Region& destRegion, core::ThreadPool* threadPool);
+
+/**
+ * @return The region that a downscaled volume of the given region covers. The lower corner stays the same.
+ * This is invalid if the region can't get halved anymore.
+ */
+voxel::Region downscaledRegion(const voxel::Region& region);
+
+/**
+ * @brief Downscales the given volume @c levels times. Each level is half the size of the previous one.
+ *
+ * The levels are built one after another - each one with the bricks of @c rescaleVolume() - and not in one traversal
+ * of the source bricks. The color pass of a level reads up to two voxels of the previous level around a brick,
+ * which come from the neighbouring bricks. One traversal for all levels would have to recompute a halo around each
+ * brick that grows with every level. So every level waits for the previous one. The palette lookup is only built once
+ * for the whole chain.
+ * @return The mip chain without the source volume. It stops early if a level can't get halved anymore.
+ * It's the caller's responsibility to free the volumes.
+ */
+core::DynamicArray<voxel::RawVolume*> rescaleMipChain(const voxel::RawVolume& sourceVolume, int levels, core::ThreadPool* threadPool);
+
 }
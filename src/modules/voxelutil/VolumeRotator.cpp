@@ -8,38 +8,137 @@
 #include "math/AABB.h"
 #include "core/GLM.h"
 #include "core/Assert.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "core/concurrent/ParallelFor.h"
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/euler_angles.hpp>
+#include <algorithm>
 
 namespace voxelutil {
 
-static inline glm::vec4 transform(const glm::mat4x4 &mat, const glm::ivec3 &pos, const glm::vec4 &pivot) {
-	return glm::floor(mat * (glm::vec4((float)pos.x + 0.5f, (float)pos.y + 0.5f, (float)pos.z + 0.5f, 1.0f) - pivot));
+/**
+ * @brief Edge length of the blocks of the source volume that are copied in one go. The scattered writes of the
+ * rotations stay in the cache this way.
+ */
+static const int PermutationBlockSize = 16;
+/**
+ * @brief Smaller volumes are not copied concurrently
+ */
+static const int ParallelPermutationMinVoxels = 128 * 128 * 128;
+
+/**
+ * @brief Maps the voxels of the source buffer to the destination buffer
+ *
+ * The destination index of the source voxel at the (zero based) position @c p is @c base + dot(p, step)
+ */
+struct Permutation {
+	int base = 0;
+	glm::ivec3 step{0};
+};
+
+static inline int dot(const glm::ivec3 &a, const glm::ivec3 &b) {
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static void permuteSlab(const voxel::Voxel *src, voxel::Voxel *dest, const glm::ivec3 &dim, const Permutation &perm, int zStart, int zEnd) {
+	const int bs = PermutationBlockSize;
+	for (int bz = zStart; bz < zEnd; bz += bs) {
+		const int ez = core_min(bz + bs, zEnd);
+		for (int by = 0; by < dim.y; by += bs) {
+			const int ey = core_min(by + bs, dim.y);
+			for (int bx = 0; bx < dim.x; bx += bs) {
+				const int n = core_min(bs, dim.x - bx);
+				for (int z = bz; z < ez; ++z) {
+					for (int y = by; y < ey; ++y) {
+						const voxel::Voxel *s = src + bx + (y + z * dim.y) * dim.x;
+						voxel::Voxel *d = dest + perm.base + bx * perm.step.x + y * perm.step.y + z * perm.step.z;
+						if (perm.step.x == 1) {
+							core_memcpy((void *)d, (const void *)s, n * sizeof(voxel::Voxel));
+						} else if (perm.step.x == -1) {
+							std::reverse_copy(s, s + n, d - (n - 1));
+						} else {
+							for (int x = 0; x < n; ++x, d += perm.step.x) {
+								*d = s[x];
+							}
+						}
+					}
+				}
+			}
+		}
+	}
 }
 
 /**
- * @param[in] source The RawVolume to rotate
- * @param[in] angles The angles for the x, y and z axis given in degrees
- * @return A new RawVolume. It's the caller's responsibility to free this
- * memory.
+ * @brief Creates a new volume for the given region and copies all voxels of the source into it
  */
-voxel::RawVolume* rotateVolume(const voxel::RawVolume* source, const glm::vec3& angles, const glm::vec3& pivot) {
+static voxel::RawVolume *permute(const voxel::RawVolume *source, const voxel::Region &region, const Permutation &perm, core::ThreadPool *threadPool) {
+	core_trace_scoped(PermuteVolume);
+	const glm::ivec3 &dim = source->region().getDimensionsInVoxels();
+	core_assert(dim.x * dim.y * dim.z == region.getWidthInVoxels() * region.getHeightInVoxels() * region.getDepthInVoxels());
+	const voxel::Voxel *src = (const voxel::Voxel *)source->data();
+	// every voxel is written - no need to clear the buffer
+	voxel::Voxel *dest = (voxel::Voxel *)core_malloc((size_t)dim.x * dim.y * dim.z * sizeof(voxel::Voxel));
+	const int slabs = (dim.z + PermutationBlockSize - 1) / PermutationBlockSize;
+	if (threadPool == nullptr || threadPool->size() == 0u || slabs == 1 || dim.x * dim.y * dim.z < ParallelPermutationMinVoxels) {
+		permuteSlab(src, dest, dim, perm, 0, dim.z);
+		return voxel::RawVolume::createRaw(dest, region);
+	}
+	// copies slabs of PermutationBlockSize z layers
+	core::parallelFor(threadPool, slabs, [&] (int slab) {
+		const int zStart = slab * PermutationBlockSize;
+		permuteSlab(src, dest, dim, perm, zStart, core_min(zStart + PermutationBlockSize, dim.z));
+	});
+	return voxel::RawVolume::createRaw(dest, region);
+}
+
+static inline glm::vec4 transform(const glm::mat4x4 &mat, const glm::ivec3 &pos, const glm::vec4 &pivot) {
+	return glm::floor(mat * (glm::vec4((float)pos.x + 0.5f, (float)pos.y + 0.5f, (float)pos.z + 0.5f, 1.0f) - pivot));
+}
+
+static glm::mat4 rotationMatrix(const glm::vec3 &angles) {
 	const float pitch = glm::radians(angles.x);
 	const float yaw = glm::radians(angles.y);
 	const float roll = glm::radians(angles.z);
-	const glm::mat4& mat = glm::eulerAngleXYZ(pitch, yaw, roll);
-	const voxel::Region& srcRegion = source->region();
-	const glm::ivec3 maxs = srcRegion.getDimensionsInCells();
+	return glm::eulerAngleXYZ(pitch, yaw, roll);
+}
 
+/**
+ * @return The region of the rotated volume before it's moved back to the center of the source volume
+ */
+static voxel::Region rotatedRegion(const glm::mat4 &mat, const voxel::Region &srcRegion, const glm::vec3 &pivot) {
+	const glm::ivec3 maxs = srcRegion.getDimensionsInCells();
 	const glm::ivec3& transformedMins = transform(mat, glm::ivec3(0), glm::vec4(pivot, 0.0f));
 	const glm::ivec3& transformedMaxs = transform(mat, maxs, glm::vec4(pivot, 0.0f));
-	const voxel::Region region(glm::min(transformedMins, transformedMaxs), glm::max(transformedMins, transformedMaxs));
+	return voxel::Region(glm::min(transformedMins, transformedMaxs), glm::max(transformedMins, transformedMaxs));
+}
+
+/**
+ * @brief Checks whether the rotation only swaps and flips the axes
+ * @param[out] axes The rotated unit vectors of the x, y and z axis
+ */
+static bool isAxisAligned(const glm::mat4 &mat, glm::ivec3 axes[3]) {
+	for (int j = 0; j < 3; ++j) {
+		for (int i = 0; i < 3; ++i) {
+			const float v = glm::round(mat[j][i]);
+			if (glm::abs(mat[j][i] - v) > 0.0001f) {
+				return false;
+			}
+			axes[j][i] = (int)v;
+		}
+	}
+	return true;
+}
+
+voxel::RawVolume* rotateVolumeGeneric(const voxel::RawVolume* source, const glm::vec3& angles, const glm::vec3& pivot) {
+	const glm::mat4& mat = rotationMatrix(angles);
+	const voxel::Region& srcRegion = source->region();
+	const voxel::Region region = rotatedRegion(mat, srcRegion, pivot);
 	voxel::RawVolume* destination = new voxel::RawVolume(region);
 	voxel::RawVolume::Sampler destSampler(destination);
 	voxel::RawVolume::Sampler srcSampler(source);
-
 	for (int32_t z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
 		for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
 			srcSampler.setPosition(srcRegion.getLowerX(), y, z);
@@ -61,14 +160,62 @@ voxel::RawVolume* rotateVolume(const voxel::RawVolume* source, const glm::vec3&
 	return destination;
 }
 
-voxel::RawVolume* rotateAxis(const voxel::RawVolume* source, math::Axis axis) {
+
+/**
+ * @param[in] source The RawVolume to rotate
+ * @param[in] angles The angles for the x, y and z axis given in degrees
+ * @return A new RawVolume. It's the caller's responsibility to free this
+ * memory.
+ */
+voxel::RawVolume* rotateVolume(const voxel::RawVolume* source, const glm::vec3& angles, const glm::vec3& pivot, core::ThreadPool* threadPool) {
+	const glm::mat4& mat = rotationMatrix(angles);
+	glm::ivec3 axes[3];
+	if (!isAxisAligned(mat, axes)) {
+		return rotateVolumeGeneric(source, angles, pivot);
+	}
+	core_trace_scoped(RotateVolumeAxisAligned);
+	const voxel::Region& srcRegion = source->region();
+	voxel::Region region = rotatedRegion(mat, srcRegion, pivot);
+	// the offset is taken from the generic transform to get exactly the same result
+	const glm::ivec3 origin = glm::ivec3(transform(mat, glm::ivec3(0), glm::vec4(pivot, 0.0f))) - region.getLowerCorner();
+	const glm::ivec3 strides(1, region.getWidthInVoxels(), region.stride());
+	Permutation perm;
+	perm.base = dot(origin, strides);
+	for (int j = 0; j < 3; ++j) {
+		perm.step[j] = dot(axes[j], strides);
+	}
+	region.shift(srcRegion.getCenter() - region.getCenter());
+	return permute(source, region, perm, threadPool);
+}
+
+voxel::RawVolume* rotateAxis(const voxel::RawVolume* source, math::Axis axis, core::ThreadPool* threadPool) {
 	const voxel::Region& region = source->region();
 	glm::vec3 rotVec{0.0f};
 	rotVec[math::getIndexForAxis(axis)] = 90.0f;
-	return rotateVolume(source, rotVec, region.getPivot());
+	return rotateVolume(source, rotVec, region.getPivot(), threadPool);
+}
+
+voxel::RawVolume* mirrorAxis(const voxel::RawVolume* source, math::Axis axis, core::ThreadPool* threadPool) {
+	if (axis != math::Axis::X && axis != math::Axis::Y && axis != math::Axis::Z) {
+		return new voxel::RawVolume(source);
+	}
+	core_trace_scoped(MirrorVolume);
+	const voxel::Region& region = source->region();
+	const int idx = math::getIndexForAxis(axis);
+	const glm::ivec3 strides(1, region.getWidthInVoxels(), region.stride());
+	Permutation perm;
+	perm.step = strides;
+	perm.step[idx] = -strides[idx];
+	perm.base = (region.getDimensionsInVoxels()[idx] - 1) * strides[idx];
+	voxel::RawVolume* destination = permute(source, region, perm, threadPool);
+	destination->setBorderValue(source->borderValue());
+	if (source->occupancy() != nullptr) {
+		destination->enableOccupancy();
+	}
+	return destination;
 }
 
-voxel::RawVolume* mirrorAxis(const voxel::RawVolume* source, math::Axis axis) {
+voxel::RawVolume* mirrorAxisGeneric(const voxel::RawVolume* source, math::Axis axis) {
 	const voxel::Region& srcRegion = source->region();
 	voxel::RawVolume* destination = new voxel::RawVolume(source);
 	voxel::RawVolume::Sampler destSampler(destination);
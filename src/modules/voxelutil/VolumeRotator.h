@@ -8,6 +8,10 @@
 #include <glm/fwd.hpp>
 #include <glm/vec3.hpp>
 
+namespace core {
+class ThreadPool;
+}
+
 namespace voxel {
 class RawVolume;
 class Voxel;
@@ -16,16 +20,32 @@ class Voxel;
 namespace voxelutil {
 /**
  * @brief Rotate the given volume by the given angles in degree
+ *
+ * Rotations by multiples of 90 degree only permute the voxels - these are copied over the voxel buffers directly.
+ * @param threadPool If given the voxels of large volumes are copied concurrently for these rotations
  */
-extern voxel::RawVolume *rotateVolume(const voxel::RawVolume *source, const glm::vec3 &angles, const glm::vec3 &pivot);
+extern voxel::RawVolume *rotateVolume(const voxel::RawVolume *source, const glm::vec3 &angles, const glm::vec3 &pivot, core::ThreadPool *threadPool = nullptr);
 /**
  * @brief Rotate the given volume on the given axis by 90 degree. This method does not lose any voxels
  * @note The volume size might differ
+ * @sa rotateVolume()
  */
-extern voxel::RawVolume *rotateAxis(const voxel::RawVolume *source, math::Axis axis);
+extern voxel::RawVolume *rotateAxis(const voxel::RawVolume *source, math::Axis axis, core::ThreadPool *threadPool = nullptr);
 /**
  * @brief Mirrors the given volume on the given axis
+ * @param threadPool If given the voxels of large volumes are copied concurrently
+ */
+extern voxel::RawVolume *mirrorAxis(const voxel::RawVolume *source, math::Axis axis, core::ThreadPool *threadPool = nullptr);
+
+/**
+ * @brief Rotates by transforming the position of every voxel
+ * @note This is the fallback of @c rotateVolume() for arbitrary angles. It's only exposed to verify the fast path.
+ */
+extern voxel::RawVolume *rotateVolumeGeneric(const voxel::RawVolume *source, const glm::vec3 &angles, const glm::vec3 &pivot);
+/**
+ * @brief Mirrors voxel by voxel with a sampler
+ * @note This is only exposed to verify the fast path of @c mirrorAxis()
  */
-extern voxel::RawVolume *mirrorAxis(const voxel::RawVolume *source, math::Axis axis);
+extern voxel::RawVolume *mirrorAxisGeneric(const voxel::RawVolume *source, math::Axis axis);
 
 } // namespace voxelutil
@@ -6,7 +6,10 @@
 
 #include "core/Common.h"
 #include "core/Trace.h"
+#include "voxel/OccupancyMask.h"
 #include "voxel/RawVolume.h"
+#include "voxel/SparseVolume.h"
+#include <utility>
 
 namespace voxelutil {
 
@@ -98,6 +101,55 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	return cnt;
 }
 
+/**
+ * @brief Skips whole uniform leaves of the sparse volume along the x axis if the condition rejects their voxel
+ * @note Only the orders that iterate x in the inner loop benefit from the sparse volume
+ */
+template <class Visitor, typename Condition = SkipEmpty>
+int visitVolume(const voxel::SparseVolume &volume, const voxel::Region &region, int xOff, int yOff, int zOff, Visitor &&visitor,
+				Condition condition = Condition(), VisitorOrder order = VisitorOrder::ZYX) {
+	if (order != VisitorOrder::ZYX && order != VisitorOrder::YZX) {
+		return visitVolume<voxel::SparseVolume, Visitor, Condition>(volume, region, xOff, yOff, zOff, std::forward<Visitor>(visitor), condition, order);
+	}
+	core_trace_scoped(VisitSparseVolume);
+	int cnt = 0;
+	const voxel::Region &volumeRegion = volume.region();
+	voxel::SparseVolume::Leaf leaf;
+	auto visitRow = [&] (int32_t y, int32_t z) {
+		for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += xOff) {
+			const glm::ivec3 pos(x, y, z);
+			const voxel::Voxel &voxel = leaf.contains(pos) && volumeRegion.containsPoint(pos) ? leaf.voxel(pos) : volume.lookup(pos, leaf);
+			if (condition(voxel)) {
+				visitor(x, y, z, voxel);
+				++cnt;
+				continue;
+			}
+			if (!leaf.uniform || leaf.size == 0) {
+				continue;
+			}
+			// all other positions of the leaf in this row are rejected, too
+			const int32_t leafUpperX = core_min(leaf.mins.x + leaf.size - 1, volumeRegion.getUpperX());
+			if (leafUpperX > x) {
+				x += (leafUpperX - x) / xOff * xOff;
+			}
+		}
+	};
+	if (order == VisitorOrder::ZYX) {
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += yOff) {
+				visitRow(y, z);
+			}
+		}
+	} else {
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += yOff) {
+			for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
+				visitRow(y, z);
+			}
+		}
+	}
+	return cnt;
+}
+
 template <class Volume, class Visitor, typename Condition = SkipEmpty>
 int visitVolume(const Volume &volume, int xOff, int yOff, int zOff, Visitor &&visitor, Condition condition = Condition(), VisitorOrder order = VisitorOrder::ZYX) {
 	const voxel::Region &region = volume.region();
@@ -114,4 +166,42 @@ int visitVolume(const Volume &volume, const voxel::Region &region, Visitor &&vis
 	return visitVolume(volume, region, 1, 1, 1, visitor, condition, order);
 }
 
+/**
+ * @brief Visits all solid voxels that have at least one face neighbour that is air
+ *
+ * Positions outside of the volume count as air. The voxels are visited in z, y, x order. If the occupancy mask
+ * of the volume is enabled the surface is computed for 64 voxels at once.
+ * @sa voxel::RawVolume::enableOccupancy()
+ * @return The amount of visited voxels
+ */
+template <class Visitor>
+int visitSurfaceVolume(const voxel::RawVolume &volume, Visitor &&visitor) {
+	core_trace_scoped(VisitSurfaceVolume);
+	if (const voxel::OccupancyMask *occupancy = volume.occupancy()) {
+		return occupancy->visitSurface(
+			[&](int x, int y, int z) { visitor(x, y, z, volume.voxel(x, y, z)); });
+	}
+	const voxel::Region &region = volume.region();
+	auto isAirAt = [&](int x, int y, int z) {
+		return !region.containsPoint(x, y, z) || voxel::isAir(volume.voxel(x, y, z).getMaterial());
+	};
+	int cnt = 0;
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				const voxel::Voxel &voxel = volume.voxel(x, y, z);
+				if (voxel::isAir(voxel.getMaterial())) {
+					continue;
+				}
+				if (isAirAt(x - 1, y, z) || isAirAt(x + 1, y, z) || isAirAt(x, y - 1, z) || isAirAt(x, y + 1, z) ||
+					isAirAt(x, y, z - 1) || isAirAt(x, y, z + 1)) {
+					visitor(x, y, z, voxel);
+					++cnt;
+				}
+			}
+		}
+	}
+	return cnt;
+}
+
 } // namespace voxelutil
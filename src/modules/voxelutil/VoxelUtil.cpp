@@ -5,11 +5,14 @@
 #include "VoxelUtil.h"
 #include "core/ArrayLength.h"
 #include "core/GLM.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
 #include "core/collection/Array3DView.h"
 #include "core/collection/Buffer.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/Set.h"
 #include "voxel/Face.h"
+#include "voxel/OccupancyMask.h"
 #include "voxel/RawVolumeWrapper.h"
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
@@ -61,6 +64,10 @@ bool isTouching(const voxel::RawVolume *volume, const glm::ivec3& pos) {
 }
 
 bool isEmpty(const voxel::RawVolume &v, const voxel::Region &region) {
+	const voxel::OccupancyMask *occupancy = v.occupancy();
+	if (occupancy != nullptr && (v.region().containsRegion(region) || !voxel::isBlocked(v.borderValue().getMaterial()))) {
+		return occupancy->isEmpty(region);
+	}
 	voxel::RawVolume::Sampler sampler(v);
 	for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += 1) {
 		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += 1) {
@@ -76,23 +83,140 @@ bool isEmpty(const voxel::RawVolume &v, const voxel::Region &region) {
 	return true;
 }
 
+/**
+ * @brief Bits of the material of four voxels in one 64 bit word
+ */
+static uint64_t materialMask() {
+	const voxel::Voxel voxel((voxel::VoxelType)0x1F, 0);
+	static_assert(sizeof(voxel) == sizeof(uint16_t), "Unexpected voxel size");
+	uint16_t mask;
+	core_memcpy(&mask, &voxel, sizeof(mask));
+	return (uint64_t)mask * 0x0001000100010001ull;
+}
+
+/**
+ * @return The index of the first solid voxel or @c -1 if all voxels are air
+ */
+static int firstSolid(const voxel::Voxel *row, int length, uint64_t mask) {
+	int x = 0;
+	for (; x + 4 <= length; x += 4) {
+		uint64_t voxels;
+		core_memcpy(&voxels, row + x, sizeof(voxels));
+		if (voxels & mask) {
+			break;
+		}
+	}
+	for (; x < length; ++x) {
+		if (!voxel::isAir(row[x].getMaterial())) {
+			return x;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @return The index of the last solid voxel or @c -1 if all voxels are air
+ */
+static int lastSolid(const voxel::Voxel *row, int length, uint64_t mask) {
+	int x = length;
+	for (; x - 4 >= 0; x -= 4) {
+		uint64_t voxels;
+		core_memcpy(&voxels, row + x - 4, sizeof(voxels));
+		if (voxels & mask) {
+			break;
+		}
+	}
+	for (--x; x >= 0; --x) {
+		if (!voxel::isAir(row[x].getMaterial())) {
+			return x;
+		}
+	}
+	return -1;
+}
+
+voxel::Region calculateTightRegion(const voxel::RawVolume &volume) {
+	core_trace_scoped(CalculateTightRegion);
+	if (const voxel::OccupancyMask *occupancy = volume.occupancy()) {
+		return occupancy->calculateBounds();
+	}
+	// the bounds of the volume only grow - so they are a good start for the search
+	voxel::Region bounds(volume.mins(), volume.maxs());
+	bounds.cropTo(volume.region());
+	if (!bounds.isValid()) {
+		return voxel::Region::InvalidRegion;
+	}
+	const uint64_t mask = materialMask();
+	const voxel::Voxel *data = (const voxel::Voxel *)volume.data();
+	const voxel::Region &region = volume.region();
+	const int width = region.getWidthInVoxels();
+	const int stride = region.stride();
+	glm::ivec3 mins = bounds.getLowerCorner();
+	glm::ivec3 maxs = bounds.getUpperCorner();
+	auto row = [&](int32_t y, int32_t z) {
+		return data + (mins.x - region.getLowerX()) + (y - region.getLowerY()) * width + (z - region.getLowerZ()) * stride;
+	};
+	auto isRowEmpty = [&](int32_t y, int32_t z) { return firstSolid(row(y, z), maxs.x - mins.x + 1, mask) == -1; };
+	auto isPlaneEmptyZ = [&](int32_t z) {
+		for (int32_t y = mins.y; y <= maxs.y; ++y) {
+			if (!isRowEmpty(y, z)) {
+				return false;
+			}
+		}
+		return true;
+	};
+	auto isPlaneEmptyY = [&](int32_t y) {
+		for (int32_t z = mins.z; z <= maxs.z; ++z) {
+			if (!isRowEmpty(y, z)) {
+				return false;
+			}
+		}
+		return true;
+	};
+
+	while (mins.z <= maxs.z && isPlaneEmptyZ(mins.z)) {
+		++mins.z;
+	}
+	if (mins.z > maxs.z) {
+		return voxel::Region::InvalidRegion;
+	}
+	while (isPlaneEmptyZ(maxs.z)) {
+		--maxs.z;
+	}
+	while (isPlaneEmptyY(mins.y)) {
+		++mins.y;
+	}
+	while (isPlaneEmptyY(maxs.y)) {
+		--maxs.y;
+	}
+
+	// only the voxels in front of the current x bounds must be checked for each row
+	int32_t minX = maxs.x;
+	int32_t maxX = mins.x;
+	for (int32_t z = mins.z; z <= maxs.z; ++z) {
+		for (int32_t y = mins.y; y <= maxs.y; ++y) {
+			const voxel::Voxel *voxels = row(y, z);
+			const int first = firstSolid(voxels, minX - mins.x, mask);
+			if (first != -1) {
+				minX = mins.x + first;
+			}
+			const int last = lastSolid(voxels + (maxX - mins.x) + 1, maxs.x - maxX, mask);
+			if (last != -1) {
+				maxX = maxX + 1 + last;
+			}
+		}
+	}
+	mins.x = minX;
+	maxs.x = maxX;
+	return voxel::Region(mins, maxs);
+}
+
 bool copy(const voxel::RawVolume &in, const voxel::Region &inRegion, voxel::RawVolume &out,
 		  const voxel::Region &outRegion) {
-	int32_t xIn, yIn, zIn;
-	int32_t xOut, yOut, zOut;
-	voxel::RawVolumeWrapper wrapper(&out);
+	voxel::RawVolumeWrapper wrapper(&out, outRegion);
 	const glm::ivec3 &inmins = inRegion.getLowerCorner();
-	const glm::ivec3 &inmaxs = inRegion.getUpperCorner();
 	const glm::ivec3 &outmins = outRegion.getLowerCorner();
-	const glm::ivec3 &outmaxs = outRegion.getUpperCorner();
-	for (zIn = inmins.z, zOut = outmins.z; zIn <= inmaxs.z && zOut <= outmaxs.z; ++zIn, ++zOut) {
-		for (yIn = inmins.y, yOut = outmins.y; yIn <= inmaxs.y && yOut <= outmaxs.y; ++yIn, ++yOut) {
-			for (xIn = inmins.x, xOut = outmins.x; xIn <= inmaxs.x && xOut <= outmaxs.x; ++xIn, ++xOut) {
-				const voxel::Voxel &voxel = in.voxel(xIn, yIn, zIn);
-				wrapper.setVoxel(xOut, yOut, zOut, voxel);
-			}
-		}
-	}
+	const glm::ivec3 inmaxs = (glm::min)(inRegion.getUpperCorner(), inmins + outRegion.getUpperCorner() - outmins);
+	wrapper.copyFrom(in, voxel::Region(inmins, inmaxs), outmins);
 	return wrapper.dirtyRegion().isValid();
 }
 
@@ -194,14 +318,24 @@ static void fillRegion(voxel::RawVolumeWrapper &in, const voxel::Voxel &voxel) {
 		}
 	}
 
-	visitVolume(
-		in, region, 1, 1, 1,
-		[&](int x, int y, int z, const voxel::Voxel &) {
-			if (!visited.get(x - mins.x, y - mins.y, z - mins.z)) {
-				in.setVoxel(x, y, z, voxel);
+	// fill the runs of enclosed voxels in each row
+	for (int z = 0; z < depth; ++z) {
+		for (int y = 0; y < height; ++y) {
+			int x = 0;
+			while (x < width) {
+				while (x < width && visited.get(x, y, z)) {
+					++x;
+				}
+				const int runStart = x;
+				while (x < width && !visited.get(x, y, z)) {
+					++x;
+				}
+				if (x > runStart) {
+					in.fill(voxel::Region(mins.x + runStart, mins.y + y, mins.z + z, mins.x + x - 1, mins.y + y, mins.z + z), voxel);
+				}
 			}
-		},
-		VisitAll());
+		}
+	}
 }
 
 void fillHollow(voxel::RawVolumeWrapper &in, const voxel::Voxel &voxel) {
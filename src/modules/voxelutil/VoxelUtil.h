@@ -28,10 +28,22 @@ bool isTouching(const voxel::RawVolume *volume, const glm::ivec3& pos);
 /**
  * @brief Checks whether the given region of the volume is only filled with air
  * @return @c true if no blocking voxel is inside the region, @c false otherwise
- * @sa voxel::isBlocked()
+ * @note Uses the occupancy mask of the volume if it's enabled
+ * @sa voxel::isBlocked(), voxel::RawVolume::enableOccupancy()
  */
 bool isEmpty(const voxel::RawVolume &in, const voxel::Region &region);
 
+/**
+ * @brief Calculates the smallest region that contains all solid voxels of the volume
+ *
+ * The planes of the volume bounds are scanned from the outside in - and the scan stops at the first plane that
+ * contains a solid voxel. The rows are checked for solid voxels directly on the voxel buffer.
+ * @note Uses the occupancy mask of the volume if it's enabled
+ * @return @c voxel::Region::InvalidRegion if there are no solid voxels
+ * @sa voxel::isAir()
+ */
+voxel::Region calculateTightRegion(const voxel::RawVolume &volume);
+
 using WalkCheckCallback = std::function<bool(const voxel::RawVolumeWrapper &, const glm::ivec3 &)>;
 using WalkExecCallback = std::function<bool(voxel::RawVolumeWrapper &, const glm::ivec3 &)>;
 
@@ -0,0 +1,80 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/Color.h"
+#include "image/Image.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/Palette.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/ImageUtils.h"
+#include <vector>
+
+class ImageUtilsBenchmark : public app::AbstractBenchmark {
+protected:
+	static constexpr int Width = 3840;
+	static constexpr int Height = 2160;
+	image::ImagePtr _image;
+
+	bool onInitApp() override {
+		if (!voxel::initDefaultPalette()) {
+			return false;
+		}
+		// smooth gradients with some noise - a lot of different colors like in a photo
+		std::vector<uint8_t> pixels((size_t)Width * Height * 4);
+		uint32_t seed = 1u;
+		for (int y = 0; y < Height; ++y) {
+			for (int x = 0; x < Width; ++x) {
+				seed = seed * 1664525u + 1013904223u;
+				const int noise = (int)(seed >> 28u);
+				uint8_t *pixel = &pixels[((size_t)y * Width + x) * 4];
+				pixel[0] = (uint8_t)((x * 255 / Width + noise) & 0xff);
+				pixel[1] = (uint8_t)((y * 255 / Height + noise) & 0xff);
+				pixel[2] = (uint8_t)(((x + y) * 127 / Height) & 0xff);
+				pixel[3] = 255;
+			}
+		}
+		_image = image::createEmptyImage("4k");
+		return _image->loadRGBA(pixels.data(), Width, Height);
+	}
+
+	void onCleanupApp() override {
+		_image = image::ImagePtr();
+	}
+};
+
+BENCHMARK_DEFINE_F(ImageUtilsBenchmark, ImportAsPlane4K)(benchmark::State &state) {
+	for (auto _ : state) {
+		voxel::RawVolume *volume = voxelutil::importAsPlane(_image);
+		benchmark::DoNotOptimize(volume);
+		delete volume;
+	}
+	state.SetItemsProcessed((int64_t)state.iterations() * Width * Height);
+}
+
+/**
+ * @brief The nearest color tree of the palette against the linear search for a part of the image
+ */
+BENCHMARK_DEFINE_F(ImageUtilsBenchmark, ClosestMatch)(benchmark::State &state) {
+	const voxel::Palette &palette = voxel::getPalette();
+	core::DynamicArray<glm::vec4> colors;
+	for (int i = 0; i < palette.colorCount; ++i) {
+		colors.push_back(core::Color::fromRGBA(palette.colors[i]));
+	}
+	const bool linear = state.range(0) == 0;
+	for (auto _ : state) {
+		int sum = 0;
+		for (int y = 0; y < 256; ++y) {
+			for (int x = 0; x < 256; ++x) {
+				const glm::vec4 &color = core::Color::fromRGBA(_image->colorAt(x * 15, y * 8));
+				sum += linear ? core::Color::getClosestMatch(color, colors) : palette.getClosestMatch(color);
+			}
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed((int64_t)state.iterations() * 256 * 256);
+}
+
+BENCHMARK_REGISTER_F(ImageUtilsBenchmark, ImportAsPlane4K)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(ImageUtilsBenchmark, ClosestMatch)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
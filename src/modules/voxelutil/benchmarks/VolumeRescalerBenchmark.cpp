@@ -0,0 +1,83 @@
+/**
+ * @file
+ */
+
+#include "app/App.h"
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/VolumeRescaler.h"
+
+class VolumeRescalerBenchmark : public app::AbstractBenchmark {
+protected:
+	voxel::RawVolume *_volume = nullptr;
+
+	bool onInitApp() override {
+		return voxel::initDefaultPalette();
+	}
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		const int size = (int)state.range(0);
+		_volume = new voxel::RawVolume(voxel::Region(0, size - 1));
+		const voxel::Region &region = _volume->region();
+		const glm::ivec3 &center = region.getCenter();
+		const int radius = size / 2 - 1;
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					const glm::ivec3 d = glm::ivec3(x, y, z) - center;
+					if (d.x * d.x + d.y * d.y + d.z * d.z <= radius * radius) {
+						_volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, (uint8_t)(y / 4 % 32 + 1)));
+					}
+				}
+			}
+		}
+	}
+
+	void TearDown(::benchmark::State &state) override {
+		delete _volume;
+		_volume = nullptr;
+		app::AbstractBenchmark::TearDown(state);
+	}
+};
+
+BENCHMARK_DEFINE_F(VolumeRescalerBenchmark, Generic)(benchmark::State &state) {
+	const voxel::Region &destRegion = voxelutil::downscaledRegion(_volume->region());
+	for (auto _ : state) {
+		voxel::RawVolume destVolume(destRegion);
+		voxelutil::rescaleVolume<voxel::RawVolume, voxel::RawVolume>(*_volume, destVolume);
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeRescalerBenchmark, Bricks)(benchmark::State &state) {
+	const voxel::Region &destRegion = voxelutil::downscaledRegion(_volume->region());
+	for (auto _ : state) {
+		voxel::RawVolume destVolume(destRegion);
+		voxelutil::rescaleVolume(*_volume, _volume->region(), destVolume, destRegion, nullptr);
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeRescalerBenchmark, Parallel)(benchmark::State &state) {
+	const voxel::Region &destRegion = voxelutil::downscaledRegion(_volume->region());
+	for (auto _ : state) {
+		voxel::RawVolume destVolume(destRegion);
+		voxelutil::rescaleVolume(*_volume, _volume->region(), destVolume, destRegion, &app::App::getInstance()->threadPool());
+	}
+}
+
+BENCHMARK_DEFINE_F(VolumeRescalerBenchmark, MipChain)(benchmark::State &state) {
+	for (auto _ : state) {
+		const core::DynamicArray<voxel::RawVolume *> &mips = voxelutil::rescaleMipChain(*_volume, 16, &app::App::getInstance()->threadPool());
+		for (voxel::RawVolume *mip : mips) {
+			delete mip;
+		}
+	}
+}
+
+BENCHMARK_REGISTER_F(VolumeRescalerBenchmark, Generic)->RangeMultiplier(2)->Range(64, 128)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VolumeRescalerBenchmark, Bricks)->RangeMultiplier(2)->Range(64, 128)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VolumeRescalerBenchmark, Parallel)->RangeMultiplier(2)->Range(64, 128)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VolumeRescalerBenchmark, MipChain)->RangeMultiplier(2)->Range(64, 128)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,122 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "app/App.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/VolumeRotator.h"
+
+class VolumeRotatorBenchmark : public app::AbstractBenchmark {
+protected:
+	voxel::RawVolume *_volume = nullptr;
+
+	static bool isSameVolume(const voxel::RawVolume *a, const voxel::RawVolume *b) {
+		if (a->region() != b->region()) {
+			return false;
+		}
+		const voxel::Region &region = a->region();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if (!a->voxel(x, y, z).isSame(b->voxel(x, y, z))) {
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		const int size = (int)state.range(0);
+		_volume = new voxel::RawVolume(voxel::Region(glm::ivec3(0), glm::ivec3(size - 1, size / 2 - 1, size + 2)));
+		const voxel::Region &region = _volume->region();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if ((x + y + z) % 3 != 0) {
+						_volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, (uint8_t)(x ^ y ^ z)));
+					}
+				}
+			}
+		}
+	}
+
+	void TearDown(::benchmark::State &state) override {
+		delete _volume;
+		_volume = nullptr;
+		app::AbstractBenchmark::TearDown(state);
+	}
+
+	/**
+	 * @brief Runs the given rotation and verifies the result against the generic implementation
+	 */
+	template<class Func>
+	void run(benchmark::State &state, bool mirror, Func &&func) {
+		const glm::vec3 angles(90.0f, 0.0f, 90.0f);
+		for (auto _ : state) {
+			voxel::RawVolume *v = func(angles);
+			benchmark::DoNotOptimize(v);
+			delete v;
+		}
+		voxel::RawVolume *expected = mirror ? voxelutil::mirrorAxisGeneric(_volume, math::Axis::Y)
+											: voxelutil::rotateVolumeGeneric(_volume, angles, _volume->region().getPivot());
+		voxel::RawVolume *actual = func(angles);
+		if (!isSameVolume(expected, actual)) {
+			state.SkipWithError("Result differs from the generic implementation");
+		}
+		delete actual;
+		delete expected;
+		state.SetBytesProcessed((int64_t)state.iterations() * _volume->region().voxels() * sizeof(voxel::Voxel));
+	}
+};
+
+BENCHMARK_DEFINE_F(VolumeRotatorBenchmark, RotateGeneric)(benchmark::State &state) {
+	run(state, false, [this](const glm::vec3 &angles) {
+		return voxelutil::rotateVolumeGeneric(_volume, angles, _volume->region().getPivot());
+	});
+}
+
+BENCHMARK_DEFINE_F(VolumeRotatorBenchmark, Rotate)(benchmark::State &state) {
+	run(state, false, [this](const glm::vec3 &angles) {
+		return voxelutil::rotateVolume(_volume, angles, _volume->region().getPivot());
+	});
+}
+
+BENCHMARK_DEFINE_F(VolumeRotatorBenchmark, RotateParallel)(benchmark::State &state) {
+	run(state, false, [this](const glm::vec3 &angles) {
+		return voxelutil::rotateVolume(_volume, angles, _volume->region().getPivot(), &app::App::getInstance()->threadPool());
+	});
+}
+
+BENCHMARK_DEFINE_F(VolumeRotatorBenchmark, MirrorGeneric)(benchmark::State &state) {
+	run(state, true, [this](const glm::vec3 &) {
+		return voxelutil::mirrorAxisGeneric(_volume, math::Axis::Y);
+	});
+}
+
+BENCHMARK_DEFINE_F(VolumeRotatorBenchmark, Mirror)(benchmark::State &state) {
+	run(state, true, [this](const glm::vec3 &) {
+		return voxelutil::mirrorAxis(_volume, math::Axis::Y);
+	});
+}
+
+BENCHMARK_DEFINE_F(VolumeRotatorBenchmark, MirrorParallel)(benchmark::State &state) {
+	run(state, true, [this](const glm::vec3 &) {
+		return voxelutil::mirrorAxis(_volume, math::Axis::Y, &app::App::getInstance()->threadPool());
+	});
+}
+
+BENCHMARK_REGISTER_F(VolumeRotatorBenchmark, RotateGeneric)->RangeMultiplier(4)->Range(64, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VolumeRotatorBenchmark, Rotate)->RangeMultiplier(4)->Range(64, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VolumeRotatorBenchmark, RotateParallel)->RangeMultiplier(4)->Range(64, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VolumeRotatorBenchmark, MirrorGeneric)->RangeMultiplier(4)->Range(64, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VolumeRotatorBenchmark, Mirror)->RangeMultiplier(4)->Range(64, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(VolumeRotatorBenchmark, MirrorParallel)->RangeMultiplier(4)->Range(64, 256)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
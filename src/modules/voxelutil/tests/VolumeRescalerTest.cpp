@@ -0,0 +1,103 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/RawVolume.h"
+#include "voxel/tests/TestHelper.h"
+#include "voxelutil/VolumeRescaler.h"
+
+namespace voxelutil {
+
+class VolumeRescalerTest : public app::AbstractTest {
+protected:
+	bool onInitApp() override {
+		return voxel::initDefaultPalette();
+	}
+
+	/**
+	 * @brief A sphere with a noisy surface and a few thin colored layers
+	 */
+	static void fill(voxel::RawVolume &volume) {
+		const voxel::Region &region = volume.region();
+		const glm::ivec3 &center = region.getCenter();
+		const int radius = region.getWidthInVoxels() / 2 - 2;
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					const glm::ivec3 d = glm::ivec3(x, y, z) - center;
+					const int distSquared = d.x * d.x + d.y * d.y + d.z * d.z;
+					if (distSquared > radius * radius || (x * 13 + y * 7 + z * 3) % 11 == 0) {
+						continue;
+					}
+					const uint8_t color = (uint8_t)(y % 4 == 0 ? 37 : ((x / 3 + z / 5) % 16) + 1);
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, color));
+				}
+			}
+		}
+	}
+
+	static void expectSameVolume(const voxel::RawVolume &expected, const voxel::RawVolume &actual) {
+		ASSERT_EQ(expected.region(), actual.region());
+		const voxel::Region &region = expected.region();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					ASSERT_TRUE(expected.voxel(x, y, z).isSame(actual.voxel(x, y, z)))
+						<< "Voxel at " << x << ":" << y << ":" << z;
+				}
+			}
+		}
+	}
+};
+
+TEST_F(VolumeRescalerTest, testMatchesGeneric) {
+	core::ThreadPool threadPool(2, "Rescaler");
+	threadPool.init();
+	const voxel::Region regions[] = {voxel::Region(glm::ivec3(-3, 5, 0), glm::ivec3(36, 40, 50)), voxel::Region(0, 1), voxel::Region(0, 0)};
+	for (const voxel::Region &region : regions) {
+		voxel::RawVolume volume(region);
+		fill(volume);
+		const voxel::Region &destRegion = downscaledRegion(region);
+		if (!destRegion.isValid()) {
+			EXPECT_EQ(voxel::Region(0, 0), region);
+			continue;
+		}
+		voxel::RawVolume expected(destRegion);
+		rescaleVolume<voxel::RawVolume, voxel::RawVolume>(volume, region, expected, destRegion);
+		voxel::RawVolume single(destRegion);
+		rescaleVolume(volume, region, single, destRegion, nullptr);
+		expectSameVolume(expected, single);
+		voxel::RawVolume parallel(destRegion);
+		rescaleVolume(volume, region, parallel, destRegion, &threadPool);
+		expectSameVolume(expected, parallel);
+	}
+	threadPool.shutdown();
+}
+
+TEST_F(VolumeRescalerTest, testMipChain) {
+	core::ThreadPool threadPool(2, "Rescaler");
+	threadPool.init();
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(39, 31, 47));
+	voxel::RawVolume volume(region);
+	fill(volume);
+	const core::DynamicArray<voxel::RawVolume *> &mips = rescaleMipChain(volume, 10, &threadPool);
+	ASSERT_EQ(5u, mips.size());
+	EXPECT_EQ(glm::ivec3(20, 16, 24), mips[0]->region().getDimensionsInVoxels());
+	EXPECT_EQ(glm::ivec3(1, 1, 1), mips[4]->region().getDimensionsInVoxels());
+	const voxel::RawVolume *source = &volume;
+	for (voxel::RawVolume *mip : mips) {
+		voxel::RawVolume expected(mip->region());
+		rescaleVolume<voxel::RawVolume, voxel::RawVolume>(*source, expected);
+		expectSameVolume(expected, *mip);
+		source = mip;
+	}
+	for (voxel::RawVolume *mip : mips) {
+		delete mip;
+	}
+	threadPool.shutdown();
+}
+
+} // namespace voxelutil
@@ -3,6 +3,8 @@
  */
 
 #include "app/tests/AbstractTest.h"
+#include "core/StringUtil.h"
+#include "core/concurrent/ThreadPool.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/tests/TestHelper.h"
 #include "voxelutil/VolumeRotator.h"
@@ -14,6 +16,41 @@ protected:
 	inline core::String str(const voxel::Region& region) const {
 		return region.toString();
 	}
+
+	static void fill(voxel::RawVolume& volume) {
+		const voxel::Region& region = volume.region();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if ((x * 7 + y * 3 + z) % 5 != 0) {
+						volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, (uint8_t)(x + y * 11 + z * 23)));
+					}
+				}
+			}
+		}
+	}
+
+	static void expectSameVolume(const voxel::RawVolume& expected, const voxel::RawVolume& actual) {
+		ASSERT_EQ(expected.region(), actual.region());
+		const voxel::Region& region = expected.region();
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					ASSERT_TRUE(expected.voxel(x, y, z).isSame(actual.voxel(x, y, z))) << "Voxel at " << x << ":" << y << ":" << z;
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Odd, even and non-cubic sizes with and without negative lower corners
+	 */
+	const voxel::Region _regions[4] {
+		voxel::Region(-1, 1),
+		voxel::Region(glm::ivec3(0), glm::ivec3(3, 4, 5)),
+		voxel::Region(glm::ivec3(-7, 2, -20), glm::ivec3(12, 9, 0)),
+		voxel::Region(glm::ivec3(-16, -3, 5), glm::ivec3(23, 30, 41))
+	};
 };
 
 TEST_F(VolumeRotatorTest, testRotateAxisZ) {
@@ -74,4 +111,61 @@ TEST_F(VolumeRotatorTest, testRotate45Y) {
 	delete rotated;
 }
 
+TEST_F(VolumeRotatorTest, testRotateAxisAlignedMatchesGeneric) {
+	const glm::vec3 angles[] = {
+		glm::vec3(90.0f, 0.0f, 0.0f), glm::vec3(0.0f, 90.0f, 0.0f), glm::vec3(0.0f, 0.0f, 90.0f),
+		glm::vec3(180.0f, 0.0f, 0.0f), glm::vec3(0.0f, 270.0f, 0.0f), glm::vec3(90.0f, 180.0f, 0.0f),
+		glm::vec3(-90.0f, 90.0f, 270.0f), glm::vec3(0.0f)
+	};
+	for (const voxel::Region& region : _regions) {
+		voxel::RawVolume volume(region);
+		fill(volume);
+		for (const glm::vec3& angle : angles) {
+			SCOPED_TRACE(str(region) + " " + core::string::toString(angle.x) + ":" + core::string::toString(angle.y) + ":" + core::string::toString(angle.z));
+			voxel::RawVolume* expected = voxelutil::rotateVolumeGeneric(&volume, angle, region.getPivot());
+			voxel::RawVolume* rotated = voxelutil::rotateVolume(&volume, angle, region.getPivot());
+			expectSameVolume(*expected, *rotated);
+			delete rotated;
+			delete expected;
+		}
+	}
+}
+
+TEST_F(VolumeRotatorTest, testMirrorMatchesGeneric) {
+	const math::Axis axes[] = {math::Axis::X, math::Axis::Y, math::Axis::Z};
+	for (const voxel::Region& region : _regions) {
+		voxel::RawVolume volume(region);
+		fill(volume);
+		for (math::Axis axis : axes) {
+			SCOPED_TRACE(str(region) + " " + core::string::toString(math::getIndexForAxis(axis)));
+			voxel::RawVolume* expected = voxelutil::mirrorAxisGeneric(&volume, axis);
+			voxel::RawVolume* mirrored = voxelutil::mirrorAxis(&volume, axis);
+			expectSameVolume(*expected, *mirrored);
+			delete mirrored;
+			delete expected;
+		}
+	}
+}
+
+TEST_F(VolumeRotatorTest, testParallelMatchesGeneric) {
+	core::ThreadPool threadPool(2, "Rotator");
+	threadPool.init();
+	const voxel::Region region(glm::ivec3(-60, 0, -3), glm::ivec3(69, 140, 130));
+	voxel::RawVolume volume(region);
+	fill(volume);
+
+	voxel::RawVolume* expected = voxelutil::rotateVolumeGeneric(&volume, glm::vec3(90.0f, 0.0f, 90.0f), region.getPivot());
+	voxel::RawVolume* rotated = voxelutil::rotateVolume(&volume, glm::vec3(90.0f, 0.0f, 90.0f), region.getPivot(), &threadPool);
+	expectSameVolume(*expected, *rotated);
+	delete rotated;
+	delete expected;
+
+	expected = voxelutil::mirrorAxisGeneric(&volume, math::Axis::Z);
+	voxel::RawVolume* mirrored = voxelutil::mirrorAxis(&volume, math::Axis::Z, &threadPool);
+	expectSameVolume(*expected, *mirrored);
+	delete mirrored;
+	delete expected;
+	threadPool.shutdown();
+}
+
 }
@@ -4,12 +4,15 @@
 
 #include "voxelutil/VoxelUtil.h"
 #include "app/tests/AbstractTest.h"
+#include "core/ArrayLength.h"
+#include "core/collection/DynamicArray.h"
 #include "voxel/Face.h"
 #include "voxel/Palette.h"
 #include "voxel/PaletteLookup.h"
 #include "voxel/RawVolume.h"
 #include "voxel/RawVolumeWrapper.h"
 #include "voxel/Region.h"
+#include "voxel/SparseVolume.h"
 #include "voxel/Voxel.h"
 #include "voxel/tests/TestHelper.h"
 #include "voxelutil/VolumeVisitor.h"
@@ -177,4 +180,93 @@ TEST_F(VoxelUtilTest, testFillPlaneWithImage) {
 	}
 }
 
+TEST_F(VoxelUtilTest, testVisitSparseVolume) {
+	const voxel::Region region(glm::ivec3(-5, 0, 0), glm::ivec3(60, 10, 20));
+	voxel::RawVolume v(region);
+	for (int x = -5; x <= 60; x += 7) {
+		v.setVoxel(x, x & 7, 3, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		v.setVoxel(x, 10, 20, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	}
+	const voxel::SparseVolume sparse(v);
+	const voxel::Region visitRegion(glm::ivec3(-8, 0, 0), glm::ivec3(58, 12, 20));
+	for (VisitorOrder order : {VisitorOrder::ZYX, VisitorOrder::YZX, VisitorOrder::XYZ}) {
+		core::DynamicArray<glm::ivec3> expected;
+		core::DynamicArray<glm::ivec3> visited;
+		const int expectedCnt = visitVolume(
+			v, visitRegion, 1, 1, 1, [&](int x, int y, int z, const voxel::Voxel &) { expected.push_back(glm::ivec3(x, y, z)); },
+			SkipEmpty(), order);
+		const int cnt = visitVolume(
+			sparse, visitRegion, 1, 1, 1, [&](int x, int y, int z, const voxel::Voxel &) { visited.push_back(glm::ivec3(x, y, z)); },
+			SkipEmpty(), order);
+		ASSERT_EQ(expectedCnt, cnt);
+		ASSERT_EQ(expected.size(), visited.size());
+		for (size_t i = 0; i < expected.size(); ++i) {
+			EXPECT_EQ(expected[i], visited[i]);
+		}
+	}
+	auto noop = [](int, int, int, const voxel::Voxel &) {};
+	EXPECT_EQ(visitVolume(v, visitRegion, 3, 2, 1, noop), visitVolume(sparse, visitRegion, 3, 2, 1, noop));
+}
+
+TEST_F(VoxelUtilTest, testVisitSurfaceVolume) {
+	voxel::RawVolume v(voxel::Region(glm::ivec3(-3, 0, 0), glm::ivec3(70, 20, 10)));
+	v.fill(voxel::Region(glm::ivec3(0, 2, 1), glm::ivec3(66, 10, 9)), voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	v.fill(voxel::Region(glm::ivec3(-3, 0, 0), glm::ivec3(-3, 20, 10)), voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	v.setVoxel(30, 5, 5, voxel::Voxel());
+
+	core::DynamicArray<glm::ivec3> expected;
+	const int cnt = visitSurfaceVolume(v, [&](int x, int y, int z, const voxel::Voxel &) { expected.emplace_back(x, y, z); });
+	EXPECT_EQ((int)expected.size(), cnt);
+	EXPECT_GT(cnt, 0);
+
+	v.enableOccupancy();
+	size_t i = 0;
+	EXPECT_EQ(cnt, visitSurfaceVolume(v, [&](int x, int y, int z, const voxel::Voxel &voxel) {
+		ASSERT_LT(i, expected.size());
+		EXPECT_EQ(expected[i], glm::ivec3(x, y, z));
+		EXPECT_FALSE(voxel::isAir(voxel.getMaterial()));
+		++i;
+	}));
+}
+
+TEST_F(VoxelUtilTest, testIsEmptyOccupancy) {
+	voxel::RawVolume v(voxel::Region(0, 99));
+	v.setVoxel(70, 3, 80, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	const voxel::Region regions[] = {voxel::Region(0, 69), voxel::Region(60, 80), voxel::Region(glm::ivec3(70, 3, 80), glm::ivec3(70, 3, 80)),
+									 voxel::Region(90, 120)};
+	bool expected[lengthof(regions)];
+	for (int i = 0; i < lengthof(regions); ++i) {
+		expected[i] = isEmpty(v, regions[i]);
+	}
+	v.enableOccupancy();
+	for (int i = 0; i < lengthof(regions); ++i) {
+		EXPECT_EQ(expected[i], isEmpty(v, regions[i])) << regions[i].toString();
+	}
+	EXPECT_FALSE(expected[2]);
+}
+
+TEST_F(VoxelUtilTest, testCalculateTightRegion) {
+	voxel::RawVolume v(voxel::Region(glm::ivec3(-3, 1, -7), glm::ivec3(35, 17, 9)));
+	EXPECT_FALSE(calculateTightRegion(v).isValid());
+	const glm::ivec3 positions[] = {glm::ivec3(5, 9, -2), glm::ivec3(-3, 10, 0), glm::ivec3(35, 4, 3),
+									glm::ivec3(20, 1, 9), glm::ivec3(0, 17, -7), glm::ivec3(33, 2, -6)};
+	voxel::Region expected = voxel::Region::InvalidRegion;
+	for (const glm::ivec3 &pos : positions) {
+		v.setVoxel(pos, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		if (expected.isValid()) {
+			expected.accumulate(pos);
+		} else {
+			expected = voxel::Region(pos, pos);
+		}
+		EXPECT_EQ(expected, calculateTightRegion(v));
+	}
+	// the bounds of the volume don't shrink - but the tight region does
+	v.setVoxel(positions[2], voxel::Voxel());
+	v.setVoxel(positions[1], voxel::Voxel());
+	const voxel::Region shrunk(glm::ivec3(0, 1, -7), glm::ivec3(33, 17, 9));
+	EXPECT_EQ(shrunk, calculateTightRegion(v));
+	v.enableOccupancy();
+	EXPECT_EQ(shrunk, calculateTightRegion(v));
+}
+
 } // namespace voxelutil
@@ -9,15 +9,23 @@
 #include "core/Enum.h"
 #include "core/Trace.h"
 #include "core/Log.h"
+#include "core/collection/DynamicArray.h"
 
 namespace voxelworld {
 
 #define WORLD_FILE_VERSION 2
 
-bool ChunkPersister::saveCompressed(const voxel::PagedVolume::ChunkPtr& chunk, io::BufferedReadWriteStream& outStream) const {
+bool ChunkPersister::saveCompressed(const voxel::PagedVolume::Chunk* chunk, io::BufferedReadWriteStream& outStream) const {
 	// save the stuff
 	const voxel::Voxel* voxelBuf = chunk->data();
 	const int voxelSize = chunk->dataSizeInBytes();
+	core::DynamicArray<voxel::Voxel> decoded;
+	if (voxelBuf == nullptr) {
+		// the chunk is still shared and was thus not decompressed for the page out
+		decoded.resize(chunk->voxels());
+		chunk->copyData(decoded.data());
+		voxelBuf = decoded.data();
+	}
 	uint32_t neededVoxelBufLen = core::zip::compressBound(voxelSize);
 	uint8_t* compressedVoxelBuf = new uint8_t[neededVoxelBufLen];
 	std::unique_ptr<uint8_t[]> smartBuf(compressedVoxelBuf);
@@ -21,11 +21,22 @@ public:
 	virtual void shutdown() override { };
 
 	virtual bool load(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) { return false; }
-	virtual bool save(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) { return false; }
+	/**
+	 * @note Takes the raw chunk pointer as this is also called from @c voxel::PagedVolume::Pager::pageOut()
+	 */
+	virtual bool save(const voxel::PagedVolume::Chunk* chunk, unsigned int seed) { return false; }
 	virtual void erase(const voxel::Region& region, unsigned int seed) { }
+	/**
+	 * @return @c false if @c save() doesn't persist anything - modified chunks don't need to get queued for saving then
+	 */
+	virtual bool isPersistent() const { return false; }
+
+	inline bool save(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) {
+		return save(chunk.get(), seed);
+	}
 
 	bool loadCompressed(const voxel::PagedVolume::ChunkPtr& chunk, const uint8_t *fileBuf, size_t fileLen) const;
-	bool saveCompressed(const voxel::PagedVolume::ChunkPtr& chunk, io::BufferedReadWriteStream& outStream) const;
+	bool saveCompressed(const voxel::PagedVolume::Chunk* chunk, io::BufferedReadWriteStream& outStream) const;
 };
 
 typedef std::shared_ptr<ChunkPersister> ChunkPersisterPtr;
@@ -47,7 +47,7 @@ bool FilePersister::load(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int
 	return success;
 }
 
-bool FilePersister::save(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) {
+bool FilePersister::save(const voxel::PagedVolume::Chunk* chunk, unsigned int seed) {
 	core_trace_scoped(WorldPersisterLoad);
 	io::BufferedReadWriteStream final;
 	if (!saveCompressed(chunk, final)) {
@@ -16,9 +16,14 @@ class FilePersister : public ChunkPersister {
 public:
 	virtual ~FilePersister() {}
 
+	using ChunkPersister::save;
+
 	bool load(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) override;
-	bool save(const voxel::PagedVolume::ChunkPtr& chunk, unsigned int seed) override;
+	bool save(const voxel::PagedVolume::Chunk* chunk, unsigned int seed) override;
 	void erase(const voxel::Region& region, unsigned int seed) override;
+	bool isPersistent() const override {
+		return true;
+	}
 };
 
 }
@@ -51,12 +51,20 @@ voxel::PagedVolume::Sampler WorldMgr::sampler() {
 	return voxel::PagedVolume::Sampler(_volumeData);
 }
 
-bool WorldMgr::init(uint32_t volumeMemoryMegaBytes, uint16_t chunkSideLength) {
-	_volumeData = new voxel::PagedVolume(_pager.get(), volumeMemoryMegaBytes * 1024 * 1024, chunkSideLength);
+bool WorldMgr::init(uint32_t volumeMemoryMegaBytes, uint16_t chunkSideLength, bool compressChunks, int pagingThreads) {
+	_volumeData = new voxel::PagedVolume(_pager.get(), volumeMemoryMegaBytes * 1024 * 1024, chunkSideLength, compressChunks);
+	if (pagingThreads > 0) {
+		_volumeData->startPagingThreads(pagingThreads);
+	}
 	return true;
 }
 
 void WorldMgr::shutdown() {
+	if (_volumeData != nullptr) {
+		_volumeData->shutdownPagingThreads();
+		// the pager must not access the volume anymore once it's released
+		_pager->shutdownWriteBack();
+	}
 	delete _volumeData;
 	_volumeData = nullptr;
 }
@@ -47,7 +47,12 @@ public:
 	 */
 	voxelutil::FloorTraceResult findWalkableFloor(const glm::ivec3& position, int maxDistanceUpwards = voxel::MAX_HEIGHT) const;
 
-	bool init(uint32_t volumeMemoryMegaBytes = 1024, uint16_t chunkSideLength = 256);
+	/**
+	 * @param compressChunks Compress chunks that were not used recently to be able to keep more of the world in memory
+	 * @param pagingThreads The amount of threads that page in the chunks requested via @c voxel::PagedVolume::requestChunks()
+	 * in the background - @c 0 disables the asynchronous paging
+	 */
+	bool init(uint32_t volumeMemoryMegaBytes = 1024, uint16_t chunkSideLength = 256, bool compressChunks = false, int pagingThreads = 2);
 	void shutdown();
 	void reset();
 
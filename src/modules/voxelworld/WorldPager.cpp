@@ -10,11 +10,21 @@
 #include "core/Common.h"
 #include "core/StringUtil.h"
 #include "core/collection/Array.h"
+#include "core/TimeProvider.h"
+#include "core/collection/DynamicArray.h"
 
 namespace voxelworld {
 
 WorldPager::WorldPager(const voxelformat::VolumeCachePtr& volumeCache, const ChunkPersisterPtr& chunkPersister) :
-		_volumeCache(volumeCache), _chunkPersister(chunkPersister) {
+		_volumeCache(volumeCache), _chunkPersister(chunkPersister), _writeBackThread(1, "WriteBack") {
+}
+
+WorldPager::~WorldPager() {
+	// the volume might already be gone - shutdownWriteBack() must have been called before
+	core_assert_msg(_writeBack.empty() && _modified.empty(), "The write-back queue was not flushed");
+	_cancelWriteBack = true;
+	_writeBackCondition.notify_all();
+	_writeBackThread.shutdown();
 }
 
 void WorldPager::erase(const voxel::Region& region) {
@@ -26,6 +36,9 @@ bool WorldPager::pageIn(voxel::PagedVolume::PagerContext& pctx) {
 	if (pctx.region.getLowerY() < 0) {
 		return false;
 	}
+	if (loadFromWriteBack(pctx.chunk)) {
+		return true;
+	}
 	if (_chunkPersister->load(pctx.chunk, _seed)) {
 		return false;
 	}
@@ -35,13 +48,131 @@ bool WorldPager::pageIn(voxel::PagedVolume::PagerContext& pctx) {
 	math::Random random(_seed);
 	createWorld(wrapper);
 	placeTrees(pctx);
-	_chunkPersister->save(pctx.chunk, _seed);
+	markDirty(pctx.chunk);
 	//}
 	return true;
 }
 
 void WorldPager::pageOut(voxel::PagedVolume::Chunk* chunk) {
-	// currently chunks are not modifiable and are saved directly after creating the chunk
+	// only called for modified chunks - chunks in the write-back queue are still referenced and thus not paged out
+	core_trace_scoped(WorldPagerPageOut);
+	_chunkPersister->save(chunk, _seed);
+}
+
+/**
+ * The chunk might have been evicted from the volume before the write-back thread persisted it. The chunk
+ * persister doesn't know about it yet - so take the data from the queued chunk.
+ */
+bool WorldPager::loadFromWriteBack(const voxel::PagedVolume::ChunkPtr& chunk) {
+	core::ScopedLock lock(_writeBackLock);
+	auto i = _writeBack.find(chunk->chunkPos());
+	if (i == _writeBack.end()) {
+		return false;
+	}
+	const voxel::PagedVolume::ChunkPtr& pending = i->second;
+	if (pending->data() == nullptr || !chunk->setData(pending->data(), pending->dataSizeInBytes())) {
+		return false;
+	}
+	// the queued chunk is outdated now
+	pending->resetModified();
+	i->second = chunk;
+	return true;
+}
+
+void WorldPager::markDirty(const voxel::PagedVolume::ChunkPtr& chunk) {
+	if (!_chunkPersister->isPersistent()) {
+		return;
+	}
+	core::ScopedLock lock(_writeBackLock);
+	_writeBack[chunk->chunkPos()] = chunk;
+}
+
+void WorldPager::modified(voxel::PagedVolume::Chunk* chunk) {
+	if (!_chunkPersister->isPersistent()) {
+		return;
+	}
+	core::ScopedLock lock(_writeBackLock);
+	// the chunk is persisted once it's paged out
+	if (_volumeData == nullptr) {
+		return;
+	}
+	_modified.insert(chunk->chunkPos());
+}
+
+int WorldPager::flush() {
+	core::DynamicArray<voxel::PagedVolume::ChunkPtr> chunks;
+	std::unordered_set<glm::ivec3, glm::hash<glm::ivec3>> modified;
+	{
+		core::ScopedLock lock(_writeBackLock);
+		if (_writeBack.empty() && _modified.empty()) {
+			return 0;
+		}
+		chunks.reserve(_writeBack.size() + _modified.size());
+		for (const auto& e : _writeBack) {
+			chunks.push_back(e.second);
+		}
+		modified.swap(_modified);
+	}
+	if (_volumeData != nullptr) {
+		// chunks that are no longer resident were already handed over to pageOut() - compressed chunks are
+		// not decompressed just to persist them
+		for (const glm::ivec3& pos : modified) {
+			voxel::PagedVolume::ChunkPtr chunk;
+			if (_volumeData->residentChunkSnapshot(pos, chunk)) {
+				chunks.push_back(chunk);
+			}
+		}
+	}
+	core_trace_scoped(WorldPagerFlush);
+	const uint64_t start = core::TimeProvider::systemMillis();
+	int written = 0;
+	for (const voxel::PagedVolume::ChunkPtr& chunk : chunks) {
+		// the chunk is persisted now - it doesn't need to get paged out anymore unless it's modified again
+		if (!chunk->resetModified()) {
+			continue;
+		}
+		if (!_chunkPersister->save(chunk, _seed)) {
+			const glm::ivec3& pos = chunk->chunkPos();
+			Log::warn("Failed to persist chunk at %i:%i:%i", pos.x, pos.y, pos.z);
+			continue;
+		}
+		++written;
+	}
+	{
+		// the chunks are only removed after they were written - they might be needed by loadFromWriteBack() until then
+		core::ScopedLock lock(_writeBackLock);
+		for (const voxel::PagedVolume::ChunkPtr& chunk : chunks) {
+			auto i = _writeBack.find(chunk->chunkPos());
+			if (i != _writeBack.end() && i->second == chunk) {
+				_writeBack.erase(i);
+			}
+		}
+	}
+	const int millis = (int)(core::TimeProvider::systemMillis() - start);
+	_lastFlushMillis = millis;
+	if (millis > _maxFlushMillis) {
+		_maxFlushMillis = millis;
+	}
+	_flushedChunks.increment(written);
+	core_trace_plot("WorldPagerFlushMillis", (int64_t)millis);
+	Log::debug("Flushed %i chunks in %ims", written, millis);
+	return written;
+}
+
+void WorldPager::setWriteBackInterval(uint32_t millis) {
+	_writeBackIntervalMillis = (int)millis;
+	_writeBackCondition.notify_all();
+}
+
+size_t WorldPager::pendingWriteBacks() const {
+	core::ScopedLock lock(_writeBackLock);
+	size_t pending = _writeBack.size();
+	for (const glm::ivec3& pos : _modified) {
+		if (_writeBack.find(pos) == _writeBack.end()) {
+			++pending;
+		}
+	}
+	return pending;
 }
 
 void WorldPager::setSeed(unsigned int seed) {
@@ -67,16 +198,48 @@ bool WorldPager::init(voxel::PagedVolume *volumeData, const core::String& worldP
 		return false;
 	}
 	_volumeData = volumeData;
-	return _volumeData != nullptr;
+	if (_volumeData == nullptr) {
+		return false;
+	}
+	_cancelWriteBack = false;
+	_writeBackThread.init();
+	_writeBackThread.enqueue([this] () {
+		while (!_cancelWriteBack) {
+			{
+				core::ScopedLock lock(_writeBackLock);
+				_writeBackCondition.waitTimeout(_writeBackLock, (uint32_t)(int)_writeBackIntervalMillis);
+			}
+			if (_cancelWriteBack) {
+				break;
+			}
+			flush();
+		}
+	});
+	return true;
+}
+
+void WorldPager::shutdownWriteBack() {
+	{
+		core::ScopedLock lock(_writeBackLock);
+		_cancelWriteBack = true;
+	}
+	_writeBackCondition.notify_all();
+	_writeBackThread.shutdown();
+	flush();
+	core::ScopedLock lock(_writeBackLock);
+	_volumeData = nullptr;
+	// positions that were modified after the flush - these chunks are persisted by pageOut()
+	_modified.clear();
 }
 
 void WorldPager::shutdown() {
-	if (_volumeData != nullptr) {
-		_volumeData->flushAll();
+	voxel::PagedVolume* volumeData = _volumeData;
+	shutdownWriteBack();
+	if (volumeData != nullptr) {
+		volumeData->flushAll();
 	}
 	_noise.shutdown();
 	_volumeCache.shutdown();
-	_volumeData = nullptr;
 	_biomeManager.shutdown();
 	_worldCtx = WorldContext();
 }
@@ -97,32 +260,64 @@ void WorldPager::createWorld(voxel::PagedVolumeWrapper& volume) const {
 	const int size = 2;
 	core_assert(depth % size == 0);
 	core_assert(width % size == 0);
+	const int columnsX = width / size;
+	const int columnsZ = depth / size;
+	// the 2d noise is evaluated for the whole chunk footprint at once
+	std::vector<float> noiseValues(columnsX * columnsZ);
+	getNoiseValues(lowerX, lowerZ, columnsX, columnsZ, size, noiseValues.data());
+	const float *n = noiseValues.data();
 	for (int z = lowerZ; z < lowerZ + depth; z += size) {
 		for (int x = lowerX; x < lowerX + width; x += size) {
 			voxel::Voxel voxels[voxel::MAX_TERRAIN_HEIGHT];
-			const int ni = fillVoxels(x, minsY, z, voxels);
+			const int ni = fillVoxels(x, minsY, z, *n++, voxels);
 			volume.setVoxels(x, minsY, z, size, size, voxels, ni);
 		}
 	}
 }
 
+float WorldPager::combineNoise(float landscapeNoise, float mountainNoise) {
+	const float noiseNormalized = noise::norm(landscapeNoise);
+	const float mountainNoiseNormalized = noise::norm(mountainNoise);
+	const float mountainMultiplier = mountainNoiseNormalized * (mountainNoiseNormalized + 0.5f);
+	const float n = glm::clamp(noiseNormalized * mountainMultiplier, 0.0f, 1.0f);
+	return n;
+}
+
 float WorldPager::getNoiseValue(float x, float z) const {
-	core_trace_scoped(NoiseValue);
 	const glm::vec2 noisePos2d(_noiseSeedOffset.x + x, _noiseSeedOffset.y + z);
 	// TODO: move the noise settings into the biome
 	const float landscapeNoise = noise::fBm(noisePos2d * _worldCtx.landscapeNoiseFrequency, _worldCtx.landscapeNoiseOctaves,
 			_worldCtx.landscapeNoiseLacunarity, _worldCtx.landscapeNoiseGain);
-	const float noiseNormalized = noise::norm(landscapeNoise);
 	const float mountainNoise = noise::fBm(noisePos2d * _worldCtx.mountainNoiseFrequency, _worldCtx.mountainNoiseOctaves,
 			_worldCtx.mountainNoiseLacunarity, _worldCtx.mountainNoiseGain);
-	const float mountainNoiseNormalized = noise::norm(mountainNoise);
-	const float mountainMultiplier = mountainNoiseNormalized * (mountainNoiseNormalized + 0.5f);
-	const float n = glm::clamp(noiseNormalized * mountainMultiplier, 0.0f, 1.0f);
-	return n;
+	return combineNoise(landscapeNoise, mountainNoise);
+}
+
+void WorldPager::getNoiseValues(int lowerX, int lowerZ, int columnsX, int columnsZ, int step, float *out) const {
+	const int amount = columnsX * columnsZ;
+	std::vector<glm::vec2> landscapePositions(amount);
+	std::vector<glm::vec2> mountainPositions(amount);
+	int i = 0;
+	for (int cz = 0; cz < columnsZ; ++cz) {
+		const int z = lowerZ + cz * step;
+		for (int cx = 0; cx < columnsX; ++cx, ++i) {
+			const int x = lowerX + cx * step;
+			const glm::vec2 noisePos2d(_noiseSeedOffset.x + (float)x, _noiseSeedOffset.y + (float)z);
+			landscapePositions[i] = noisePos2d * _worldCtx.landscapeNoiseFrequency;
+			mountainPositions[i] = noisePos2d * _worldCtx.mountainNoiseFrequency;
+		}
+	}
+	std::vector<float> mountainNoise(amount);
+	noise::fBm(landscapePositions.data(), out, amount, _worldCtx.landscapeNoiseOctaves,
+			_worldCtx.landscapeNoiseLacunarity, _worldCtx.landscapeNoiseGain);
+	noise::fBm(mountainPositions.data(), mountainNoise.data(), amount, _worldCtx.mountainNoiseOctaves,
+			_worldCtx.mountainNoiseLacunarity, _worldCtx.mountainNoiseGain);
+	for (i = 0; i < amount; ++i) {
+		out[i] = combineNoise(out[i], mountainNoise[i]);
+	}
 }
 
 float WorldPager::getDensity(float x, float y, float z, float n) const {
-	core_trace_scoped(DensityValue);
 	const glm::vec3 noisePos3d(_noiseSeedOffset.x + x, y, _noiseSeedOffset.y + z);
 	// TODO: move the noise settings into the biome
 	const float noiseVal = noise::norm(
@@ -131,24 +326,38 @@ float WorldPager::getDensity(float x, float y, float z, float n) const {
 	return finalDensity;
 }
 
+void WorldPager::getDensities(int x, int lowerY, int z, float n, int amount, float *out) const {
+	glm::vec3 positions[voxel::MAX_TERRAIN_HEIGHT];
+	core_assert(amount <= voxel::MAX_TERRAIN_HEIGHT);
+	for (int i = 0; i < amount; ++i) {
+		const glm::vec3 noisePos3d(_noiseSeedOffset.x + (float)x, (float)(lowerY + i), _noiseSeedOffset.y + (float)z);
+		positions[i] = noisePos3d * _worldCtx.caveNoiseFrequency;
+	}
+	noise::fBm(positions, out, amount, _worldCtx.caveNoiseOctaves, _worldCtx.caveNoiseLacunarity, _worldCtx.caveNoiseGain);
+	for (int i = 0; i < amount; ++i) {
+		out[i] = n + noise::norm(out[i]);
+	}
+}
+
 int WorldPager::terrainHeight(int x, int y, int z) const {
 	const float n = getNoiseValue(x, z);
 	return terrainHeight(x, y, z, n);
 }
 
-int WorldPager::terrainHeight(int x, int minsY, int z, float n) const {
-	core_trace_scoped(TerrainHeight);
+int WorldPager::surfaceHeight(int x, int z, float n) const {
 	const int maxHeight = voxel::MAX_TERRAIN_HEIGHT - 1;
 	int centerHeight;
 	// the center of a city should make the terrain more even
 	const float cityMultiplier = _biomeManager.getCityMultiplier(glm::ivec2(x, z), &centerHeight);
-	int ni;
 	if (cityMultiplier < 1.0f) {
 		const float revn = (1.0f - cityMultiplier);
-		ni = revn * centerHeight + (cityMultiplier * n * maxHeight);
-	} else {
-		ni = n * maxHeight;
+		return revn * centerHeight + (cityMultiplier * n * maxHeight);
 	}
+	return n * maxHeight;
+}
+
+int WorldPager::terrainHeight(int x, int minsY, int z, float n) const {
+	int ni = surfaceHeight(x, z, n);
 	for (int y = ni - 1; y >= minsY + 1; --y) {
 		const float density = getDensity(x, y, z, n);
 		if (density > _worldCtx.caveDensityThreshold) {
@@ -159,10 +368,21 @@ int WorldPager::terrainHeight(int x, int minsY, int z, float n) const {
 	return ni;
 }
 
-int WorldPager::fillVoxels(int x, int minsY, int z, voxel::Voxel* voxels) const {
-	core_trace_scoped(FillVoxels);
-	const float n = getNoiseValue(x, z);
-	const int ni = terrainHeight(x, minsY, z, n);
+int WorldPager::fillVoxels(int x, int minsY, int z, float n, voxel::Voxel* voxels) const {
+	const int surface = surfaceHeight(x, z, n);
+	// the densities of the whole column are needed - evaluate them in one batch
+	const int lowerY = minsY + 1;
+	float densities[voxel::MAX_TERRAIN_HEIGHT];
+	if (surface > lowerY) {
+		getDensities(x, lowerY, z, n, surface - lowerY, densities);
+	}
+	int ni = surface;
+	for (int y = ni - 1; y >= lowerY; --y) {
+		if (densities[y - lowerY] > _worldCtx.caveDensityThreshold) {
+			break;
+		}
+		--ni;
+	}
 	if (ni < minsY) {
 		return 0;
 	}
@@ -173,8 +393,8 @@ int WorldPager::fillVoxels(int x, int minsY, int z, voxel::Voxel* voxels) const
 
 	voxels[0] = dirt;
 	glm::ivec3 pos(x, 0, z);
-	for (int y = ni - 1; y >= minsY + 1; --y) {
-		const float density = getDensity(x, y, z, n);
+	for (int y = ni - 1; y >= lowerY; --y) {
+		const float density = densities[y - lowerY];
 		if (density > _worldCtx.caveDensityThreshold) {
 			const bool cave = y < ni - 1;
 			pos.y = y;
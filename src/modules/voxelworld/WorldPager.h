@@ -12,9 +12,15 @@
 #include "noise/Noise.h"
 #include "BiomeManager.h"
 #include "core/SharedPtr.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
 #include "ChunkPersister.h"
 #include "TreeVolumeCache.h"
 #include "voxelutil/RawVolumeRotateWrapper.h"
+#include <unordered_map>
+#include <unordered_set>
 
 namespace voxel {
 class PagedVolumeWrapper;
@@ -28,8 +34,13 @@ namespace voxelworld {
  *
  * This class is responsible for generating the voxel world.
  * The pager is the streaming interface for the voxel::PagedVolume.
+ *
+ * Generated chunks are not persisted while they are paged in. They are put into a write-back queue that
+ * is flushed by a background thread in a configurable interval and on @c shutdown(). Chunks that are
+ * modified later on are queued, too - or persisted once they are paged out before the next flush.
  */
 class WorldPager: public voxel::PagedVolume::Pager {
+	friend class WorldPagerTest;
 private:
 	unsigned int _seed = 0l;
 	glm::vec2 _noiseSeedOffset;
@@ -41,22 +52,52 @@ private:
 	TreeVolumeCache _volumeCache;
 	ChunkPersisterPtr _chunkPersister;
 
+	// Chunks that must be persisted - keyed by the chunk position to coalesce several modifications of the
+	// same chunk until the next flush.
+	mutable core_trace_mutex(core::Lock, _writeBackLock, "WorldPagerWriteBack");
+	core::ConditionVariable _writeBackCondition;
+	std::unordered_map<glm::ivec3, voxel::PagedVolume::ChunkPtr, glm::hash<glm::ivec3>> _writeBack;
+	// positions of the resident chunks that were modified after they were paged in or persisted the last time
+	std::unordered_set<glm::ivec3, glm::hash<glm::ivec3>> _modified;
+	core::ThreadPool _writeBackThread;
+	core::AtomicBool _cancelWriteBack { false };
+	core::AtomicInt _writeBackIntervalMillis { 5000 };
+	core::AtomicInt _lastFlushMillis { 0 };
+	core::AtomicInt _maxFlushMillis { 0 };
+	core::AtomicInt _flushedChunks { 0 };
+
+	bool loadFromWriteBack(const voxel::PagedVolume::ChunkPtr& chunk);
+
 	void createWorld(voxel::PagedVolumeWrapper& volume) const;
 	void placeTrees(voxel::PagedVolume::PagerContext& pagerCtx);
 	void addVolumeToPosition(voxel::PagedVolumeWrapper& target, const voxelutil::RawVolumeRotateWrapper& source, const glm::ivec3& pos);
 
 	int terrainHeight(int x, int minsY, int z) const;
 	int terrainHeight(int x, int minsY, int z, float n) const;
-	int fillVoxels(int x, int minsY, int z, voxel::Voxel* voxels) const;
+	/**
+	 * @return The terrain height without the caves
+	 */
+	int surfaceHeight(int x, int z, float n) const;
+	int fillVoxels(int x, int minsY, int z, float n, voxel::Voxel* voxels) const;
 
+	static float combineNoise(float landscapeNoise, float mountainNoise);
 	/**
 	 * @return A float value between [0.0-1.0]
 	 */
 	float getNoiseValue(float x, float z) const;
+	/**
+	 * @brief Batched version of @c getNoiseValue() for a grid of columns with the given step size
+	 */
+	void getNoiseValues(int lowerX, int lowerZ, int columnsX, int columnsZ, int step, float *out) const;
 	float getDensity(float x, float y, float z, float n) const;
+	/**
+	 * @brief Batched version of @c getDensity() for @c amount voxels of the column starting at @c lowerY
+	 */
+	void getDensities(int x, int lowerY, int z, float n, int amount, float *out) const;
 
 public:
 	WorldPager(const voxelformat::VolumeCachePtr& volumeCache, const ChunkPersisterPtr& chunkPersister);
+	~WorldPager();
 	/**
 	 * @brief Initializes the pager
 	 * @param volumeData The volume data to operate on
@@ -69,6 +110,36 @@ public:
 	 * @sa init()
 	 */
 	void shutdown();
+
+	/**
+	 * @brief Queue the chunk to get persisted by the next flush
+	 */
+	void markDirty(const voxel::PagedVolume::ChunkPtr& chunk);
+	/**
+	 * @brief Persist all queued chunks
+	 * @return The amount of chunks that were written
+	 */
+	int flush();
+	/**
+	 * @brief The interval in which the write-back thread flushes the modified chunks
+	 */
+	void setWriteBackInterval(uint32_t millis);
+	/**
+	 * @return The amount of chunks that are waiting for the next flush
+	 */
+	size_t pendingWriteBacks() const;
+	/**
+	 * @return The duration of the last flush in milliseconds
+	 */
+	uint32_t lastFlushMillis() const;
+	/**
+	 * @return The longest flush duration in milliseconds
+	 */
+	uint32_t maxFlushMillis() const;
+	/**
+	 * @return The amount of chunks that were written by all flushes
+	 */
+	uint32_t flushedChunks() const;
 	void construct();
 
 	const ChunkPersisterPtr& chunkPersister() const;
@@ -86,12 +157,33 @@ public:
 	 */
 	bool pageIn(voxel::PagedVolume::PagerContext& ctx) override;
 	void pageOut(voxel::PagedVolume::Chunk* chunk) override;
+	/**
+	 * @brief Queues the modified chunk for the next flush
+	 */
+	void modified(voxel::PagedVolume::Chunk* chunk) override;
+	/**
+	 * @brief Stops the write-back thread and persists the remaining queued chunks. The volume is not accessed anymore
+	 * afterwards - modified chunks are only persisted once they are paged out.
+	 */
+	void shutdownWriteBack() override;
 };
 
 inline const ChunkPersisterPtr& WorldPager::chunkPersister() const {
 	return _chunkPersister;
 }
 
+inline uint32_t WorldPager::lastFlushMillis() const {
+	return (uint32_t)(int)_lastFlushMillis;
+}
+
+inline uint32_t WorldPager::maxFlushMillis() const {
+	return (uint32_t)(int)_maxFlushMillis;
+}
+
+inline uint32_t WorldPager::flushedChunks() const {
+	return (uint32_t)(int)_flushedChunks;
+}
+
 typedef core::SharedPtr<WorldPager> WorldPagerPtr;
 
 }
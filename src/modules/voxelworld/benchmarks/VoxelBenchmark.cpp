@@ -8,6 +8,7 @@
 #include "voxelworld/BiomeManager.h"
 #include "voxel/Constants.h"
 #include "voxelformat/VolumeCache.h"
+#include "core/concurrent/ThreadPool.h"
 
 class PagedVolumeBenchmark: public app::AbstractBenchmark {
 protected:
@@ -45,4 +46,77 @@ BENCHMARK_DEFINE_F(PagedVolumeBenchmark, pageIn) (benchmark::State& state) {
 
 BENCHMARK_REGISTER_F(PagedVolumeBenchmark, pageIn);
 
+class SolidPager : public voxel::PagedVolume::Pager {
+public:
+	bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+		const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Grass, 0);
+		const voxel::Region& region = ctx.region;
+		for (int y = 0; y < region.getHeightInVoxels() / 2; ++y) {
+			for (int z = 0; z < region.getDepthInVoxels(); ++z) {
+				for (int x = 0; x < region.getWidthInVoxels(); ++x) {
+					ctx.chunk->setVoxel(x, y, z, voxel);
+				}
+			}
+		}
+		return false;
+	}
+
+	void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+	}
+};
+
+/**
+ * Sample the same already paged in area of the volume from several threads - the sampler is moved
+ * along the x axis to cross a lot of chunk borders.
+ */
+BENCHMARK_DEFINE_F(PagedVolumeBenchmark, samplerThreaded) (benchmark::State& state) {
+	const int threads = (int)state.range(0);
+	const int chunkSize = 32;
+	const int chunks = 8;
+	SolidPager pager;
+	voxel::PagedVolume volumeData(&pager, 512 * 1024 * 1024, chunkSize);
+	for (int z = 0; z < chunks; ++z) {
+		for (int y = 0; y < chunks; ++y) {
+			for (int x = 0; x < chunks; ++x) {
+				volumeData.chunk(glm::ivec3(x, y, z) * chunkSize);
+			}
+		}
+	}
+	core::ThreadPool threadPool(threads, "Sampler");
+	threadPool.init();
+	const int extent = chunkSize * chunks;
+	const int rowsPerThread = 64;
+	for (auto _ : state) {
+		std::vector<std::future<int>> futures;
+		futures.reserve(threads);
+		for (int t = 0; t < threads; ++t) {
+			futures.emplace_back(threadPool.enqueue([&volumeData, t, extent, rowsPerThread] () {
+				voxel::PagedVolume::Sampler sampler(volumeData);
+				int solid = 0;
+				for (int row = 0; row < rowsPerThread; ++row) {
+					const int y = (t * 7 + row * 13) % extent;
+					const int z = (t * 31 + row * 17) % extent;
+					sampler.setPosition(0, y, z);
+					for (int x = 0; x < extent; ++x) {
+						if (voxel::isBlocked(sampler.voxel().getMaterial())) {
+							++solid;
+						}
+						// crossing chunk borders to look up the neighbours - e.g. like the mesh extraction
+						solid += (int)voxel::isBlocked(sampler.peekVoxel0px1py0pz().getMaterial());
+						sampler.movePositiveX();
+					}
+				}
+				return solid;
+			}));
+		}
+		for (auto& f : futures) {
+			benchmark::DoNotOptimize(f.get());
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * threads * rowsPerThread * extent);
+	threadPool.shutdown();
+}
+
+BENCHMARK_REGISTER_F(PagedVolumeBenchmark, samplerThreaded)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Arg(16)->UseRealTime();
+
 BENCHMARK_MAIN();
@@ -0,0 +1,197 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelWorldTest.h"
+#include "voxelworld/WorldPager.h"
+#include "voxelformat/VolumeCache.h"
+#include "core/concurrent/Atomic.h"
+#include "io/Filesystem.h"
+
+namespace voxelworld {
+
+class WorldPagerTest: public AbstractVoxelWorldTest {
+protected:
+	class CountingPersister : public ChunkPersister {
+	public:
+		core::AtomicInt _saves { 0 };
+
+		bool save(const voxel::PagedVolume::Chunk* chunk, unsigned int seed) override {
+			++_saves;
+			return true;
+		}
+
+		bool isPersistent() const override {
+			return true;
+		}
+	};
+
+	class EmptyPager : public voxel::PagedVolume::Pager {
+	public:
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			return false;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+	/**
+	 * @brief Generates the column the way the scalar code path did - one noise evaluation per voxel
+	 */
+	int fillVoxelsScalar(const WorldPager& pager, int x, int minsY, int z, voxel::Voxel* voxels) const {
+		const float n = pager.getNoiseValue(x, z);
+		const int ni = pager.terrainHeight(x, minsY, z, n);
+		if (ni < minsY) {
+			return 0;
+		}
+		const voxel::Voxel water = voxel::createColorVoxel(voxel::VoxelType::Water, pager._seed);
+		const voxel::Voxel dirt = voxel::createColorVoxel(voxel::VoxelType::Dirt, pager._seed);
+		const voxel::Voxel air;
+		voxels[0] = dirt;
+		for (int y = ni - 1; y >= minsY + 1; --y) {
+			const float density = pager.getDensity(x, y, z, n);
+			if (density > pager._worldCtx.caveDensityThreshold) {
+				voxels[y] = pager._biomeManager.getVoxel(glm::ivec3(x, y, z), y < ni - 1);
+			} else if (y < voxel::MAX_WATER_HEIGHT) {
+				voxels[y] = water;
+			} else {
+				voxels[y] = air;
+			}
+		}
+		for (int i = minsY; i < voxel::MAX_WATER_HEIGHT; ++i) {
+			if (voxels[i] == air) {
+				voxels[i] = water;
+			}
+		}
+		return core_max(ni - minsY, voxel::MAX_WATER_HEIGHT - minsY);
+	}
+
+	void createWorld(const WorldPager& pager, voxel::PagedVolumeWrapper& wrapper) const {
+		pager.createWorld(wrapper);
+	}
+};
+
+TEST_F(WorldPagerTest, testCreateWorldMatchesScalar) {
+	voxelformat::VolumeCachePtr volumeCache = std::make_shared<voxelformat::VolumeCache>();
+	ASSERT_TRUE(volumeCache->init());
+	WorldPager pager(volumeCache, std::make_shared<ChunkPersister>());
+	pager.setSeed(0);
+	voxel::PagedVolume pagerVolume(&pager, 512 * 1024 * 1024, 256);
+	const io::FilesystemPtr& filesystem = io::filesystem();
+	ASSERT_TRUE(pager.init(&pagerVolume, filesystem->load("worldparams.lua"), filesystem->load("biomes.lua")));
+
+	// negative coordinates are included to cover the floor handling of the batched noise
+	EmptyPager emptyPager;
+	voxel::PagedVolume volume(&emptyPager, 128 * 1024 * 1024, 64);
+	const voxel::Region region(-64, 0, -64, -1, 63, -1);
+	voxel::PagedVolumeWrapper wrapper(&volume, volume.chunk(region.getLowerCorner()), region);
+	createWorld(pager, wrapper);
+
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+			// the world generation fills 2x2 columns with the voxels of the even column
+			voxel::Voxel voxels[voxel::MAX_TERRAIN_HEIGHT];
+			const int ni = fillVoxelsScalar(pager, x & ~1, 0, z & ~1, voxels);
+			for (int y = 0; y < voxel::MAX_TERRAIN_HEIGHT; ++y) {
+				const voxel::Voxel expected = y < ni ? voxels[y] : voxel::Voxel();
+				const voxel::Voxel actual = volume.voxel(x, y, z);
+				ASSERT_EQ((int)expected.getMaterial(), (int)actual.getMaterial()) << "Material mismatch at " << x << ":" << y << ":" << z;
+				ASSERT_EQ(expected.getColor(), actual.getColor()) << "Color mismatch at " << x << ":" << y << ":" << z;
+			}
+		}
+	}
+
+	pager.shutdown();
+	volumeCache->shutdown();
+}
+
+TEST_F(WorldPagerTest, testWriteBack) {
+	voxelformat::VolumeCachePtr volumeCache = std::make_shared<voxelformat::VolumeCache>();
+	ASSERT_TRUE(volumeCache->init());
+	std::shared_ptr<CountingPersister> persister = std::make_shared<CountingPersister>();
+	WorldPager pager(volumeCache, persister);
+	// the background thread should not flush while the test is running
+	pager.setWriteBackInterval(60 * 1000);
+	pager.setSeed(0);
+	// the world generation needs chunks that cover the whole height of the world
+	voxel::PagedVolume volume(&pager, 512 * 1024 * 1024, 256);
+	const io::FilesystemPtr& filesystem = io::filesystem();
+	ASSERT_TRUE(pager.init(&volume, filesystem->load("worldparams.lua"), filesystem->load("biomes.lua")));
+
+	volume.chunk(glm::ivec3(0));
+	EXPECT_EQ(0, (int)persister->_saves) << "Chunks should not be persisted while they are paged in";
+	const int pending = (int)pager.pendingWriteBacks();
+	ASSERT_GE(pending, 1);
+
+	EXPECT_EQ(pending, pager.flush());
+	EXPECT_EQ(0u, pager.pendingWriteBacks());
+	EXPECT_EQ(pending, (int)persister->_saves);
+	EXPECT_EQ((uint32_t)pending, pager.flushedChunks());
+	EXPECT_EQ(0, pager.flush());
+
+	// only the modified chunk must be paged out
+	volume.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Rock, 0));
+	volume.flushAll();
+	EXPECT_EQ(pending + 1, (int)persister->_saves);
+
+	// modifications of resident chunks are written by the next flush - not only once they are paged out
+	volume.chunk(glm::ivec3(0));
+	EXPECT_EQ(pending, pager.flush());
+	volume.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Grass, 0));
+	EXPECT_EQ(1u, pager.pendingWriteBacks());
+	EXPECT_EQ(1, pager.flush());
+	EXPECT_EQ(2 * pending + 2, (int)persister->_saves);
+
+	pager.shutdown();
+	volumeCache->shutdown();
+}
+
+TEST_F(WorldPagerTest, testShutdownWriteBack) {
+	voxelformat::VolumeCachePtr volumeCache = std::make_shared<voxelformat::VolumeCache>();
+	ASSERT_TRUE(volumeCache->init());
+	std::shared_ptr<CountingPersister> persister = std::make_shared<CountingPersister>();
+	WorldPager pager(volumeCache, persister);
+	pager.setWriteBackInterval(60 * 1000);
+	pager.setSeed(0);
+	voxel::PagedVolume volume(&pager, 512 * 1024 * 1024, 256);
+	const io::FilesystemPtr& filesystem = io::filesystem();
+	ASSERT_TRUE(pager.init(&volume, filesystem->load("worldparams.lua"), filesystem->load("biomes.lua")));
+
+	volume.chunk(glm::ivec3(0));
+	const int pending = (int)pager.pendingWriteBacks();
+	ASSERT_GE(pending, 1);
+	pager.shutdownWriteBack();
+	EXPECT_EQ(0u, pager.pendingWriteBacks());
+	EXPECT_EQ(pending, (int)persister->_saves);
+
+	// the volume isn't accessed by the pager anymore - the modified chunk is persisted once it's paged out
+	volume.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Rock, 0));
+	EXPECT_EQ(0u, pager.pendingWriteBacks());
+	volume.flushAll();
+	EXPECT_EQ(pending + 1, (int)persister->_saves);
+
+	pager.shutdown();
+	volumeCache->shutdown();
+}
+
+TEST_F(WorldPagerTest, testWriteBackNotPersistent) {
+	voxelformat::VolumeCachePtr volumeCache = std::make_shared<voxelformat::VolumeCache>();
+	ASSERT_TRUE(volumeCache->init());
+	WorldPager pager(volumeCache, std::make_shared<ChunkPersister>());
+	pager.setWriteBackInterval(60 * 1000);
+	pager.setSeed(0);
+	voxel::PagedVolume volume(&pager, 512 * 1024 * 1024, 256);
+	const io::FilesystemPtr& filesystem = io::filesystem();
+	ASSERT_TRUE(pager.init(&volume, filesystem->load("worldparams.lua"), filesystem->load("biomes.lua")));
+
+	volume.chunk(glm::ivec3(0));
+	volume.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Rock, 0));
+	EXPECT_EQ(0u, pager.pendingWriteBacks());
+	EXPECT_EQ(0, pager.flush());
+
+	pager.shutdown();
+	volumeCache->shutdown();
+}
+
+}
@@ -13,6 +13,7 @@
 #include "core/Var.h"
 #include "video/Trace.h"
 #include "core/GLM.h"
+#include "voxel/CubicSurfaceExtractor.h"
 #include "voxel/Constants.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Palette.h"
@@ -438,7 +439,12 @@ bool WorldRenderer::init(voxel::PagedVolume* volume, const glm::ivec2& position,
 
 	_worldChunkMgr.init(&_worldShader, volume);
 	_worldChunkMgr.updateViewDistance(_viewDistance);
-	_threadPool.enqueue([this] () {while (!_cancelThreads) { _worldChunkMgr.extractScheduledMesh(); } });
+	_threadPool.enqueue([this] () {
+		voxel::SurfaceExtractionContext ctx;
+		while (!_cancelThreads) {
+			_worldChunkMgr.extractScheduledMesh(ctx);
+		}
+	});
 
 	if (!initFrameBuffers(dimension)) {
 		return false;
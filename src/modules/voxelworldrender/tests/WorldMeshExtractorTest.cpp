@@ -0,0 +1,159 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxelworldrender/worldrenderer/WorldMeshExtractor.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/MaterialColor.h"
+#include "core/GameConfig.h"
+
+namespace voxelworldrender {
+
+class WorldMeshExtractorTest : public app::AbstractTest {
+private:
+	using Super = app::AbstractTest;
+
+protected:
+	class TerrainPager : public voxel::PagedVolume::Pager {
+	public:
+		bool pageIn(voxel::PagedVolume::PagerContext& ctx) override {
+			const voxel::Region& region = ctx.region;
+			for (int z = 0; z < region.getDepthInVoxels(); ++z) {
+				for (int x = 0; x < region.getWidthInVoxels(); ++x) {
+					const int wx = region.getLowerX() + x;
+					const int wz = region.getLowerZ() + z;
+					const int height = 8 + (wx / 3 + wz / 5) % 6;
+					for (int y = 0; y < region.getHeightInVoxels(); ++y) {
+						const int wy = region.getLowerY() + y;
+						if (wy > height) {
+							break;
+						}
+						ctx.chunk->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Grass, 1));
+					}
+				}
+			}
+			return true;
+		}
+
+		void pageOut(voxel::PagedVolume::Chunk* chunk) override {
+		}
+	};
+
+	void SetUp() override {
+		Super::SetUp();
+		core::Var::get(cfg::VoxelMeshSize, "16", core::CV_READONLY);
+	}
+
+	static bool extract(WorldMeshExtractor& extractor, const glm::ivec3& pos, int lod, ChunkMesh& chunkMesh) {
+		if (!extractor.scheduleMeshExtraction(pos, lod)) {
+			return false;
+		}
+		voxel::SurfaceExtractionContext ctx;
+		extractor.extractScheduledMesh(ctx);
+		return extractor.pop(chunkMesh);
+	}
+};
+
+TEST_F(WorldMeshExtractorTest, testLevelOfDetail) {
+	TerrainPager pager;
+	voxel::PagedVolume volume(&pager, 64 * 1024 * 1024, 32);
+	WorldMeshExtractor extractor;
+	ASSERT_TRUE(extractor.init(&volume));
+	const glm::ivec3 pos(32, 0, 16);
+	const glm::ivec3& mins = extractor.meshPos(pos);
+	const glm::ivec3& size = extractor.meshSize();
+
+	ChunkMesh full;
+	ASSERT_TRUE(extract(extractor, pos, 0, full));
+	EXPECT_EQ(0, full.lod);
+	ASSERT_FALSE(full.mesh.isEmpty());
+	EXPECT_FALSE(extractor.scheduleMeshExtraction(pos, 0)) << "Same level of detail should not be scheduled twice";
+
+	for (int lod = 1; lod <= WorldMeshExtractor::MaxLOD; ++lod) {
+		const int scale = 1 << lod;
+		ChunkMesh reduced;
+		ASSERT_TRUE(extract(extractor, pos, lod, reduced)) << "Crossing the lod band must re-extract the mesh";
+		EXPECT_EQ(lod, reduced.lod);
+		ASSERT_FALSE(reduced.mesh.isEmpty());
+		EXPECT_LT(reduced.mesh.getNoOfVertices(), full.mesh.getNoOfVertices());
+		EXPECT_EQ(mins, reduced.mesh.getOffset());
+		for (const voxel::VoxelVertex& vertex : reduced.mesh.getVertexVector()) {
+			const glm::ivec3 local = glm::ivec3(vertex.position) - mins;
+			EXPECT_EQ(0, local.x % scale);
+			EXPECT_EQ(0, local.y % scale);
+			EXPECT_EQ(0, local.z % scale);
+			EXPECT_GE(local.x, 0);
+			EXPECT_GE(local.z, 0);
+			EXPECT_LE(local.x, size.x);
+			EXPECT_LE(local.z, size.z);
+		}
+	}
+	extractor.shutdown();
+}
+
+TEST_F(WorldMeshExtractorTest, testLevelOfDetailSkirt) {
+	TerrainPager pager;
+	voxel::PagedVolume volume(&pager, 64 * 1024 * 1024, 32);
+	WorldMeshExtractor extractor;
+	ASSERT_TRUE(extractor.init(&volume));
+	const glm::ivec3 pos(32, 0, 16);
+	const glm::ivec3& mins = extractor.meshPos(pos);
+	const glm::ivec3& size = extractor.meshSize();
+
+	ChunkMesh reduced;
+	ASSERT_TRUE(extract(extractor, pos, 2, reduced));
+	const voxel::Mesh& mesh = reduced.mesh;
+	ASSERT_FALSE(mesh.isEmpty());
+	// the border faces of each side reach down to the bottom - even though the terrain of the neighbours is solid there
+	bool skirt[4] = {false, false, false, false};
+	for (size_t i = 0; i < mesh.getNoOfIndices(); i += 3) {
+		glm::ivec3 corners[3];
+		for (int c = 0; c < 3; ++c) {
+			corners[c] = glm::ivec3(mesh.getVertex(mesh.getIndex(i + c)).position) - mins;
+		}
+		const int lowestY = glm::min(corners[0].y, glm::min(corners[1].y, corners[2].y));
+		if (lowestY != 0) {
+			continue;
+		}
+		const int sides[4] = {0, size.x, 0, size.z};
+		for (int side = 0; side < 4; ++side) {
+			const int axis = side < 2 ? 0 : 2;
+			if (corners[0][axis] == sides[side] && corners[1][axis] == sides[side] && corners[2][axis] == sides[side]) {
+				skirt[side] = true;
+			}
+		}
+	}
+	EXPECT_TRUE(skirt[0]) << "No skirt on the negative x side";
+	EXPECT_TRUE(skirt[1]) << "No skirt on the positive x side";
+	EXPECT_TRUE(skirt[2]) << "No skirt on the negative z side";
+	EXPECT_TRUE(skirt[3]) << "No skirt on the positive z side";
+	extractor.shutdown();
+}
+
+TEST_F(WorldMeshExtractorTest, testDropOutdatedLevelOfDetail) {
+	TerrainPager pager;
+	voxel::PagedVolume volume(&pager, 64 * 1024 * 1024, 32);
+	WorldMeshExtractor extractor;
+	ASSERT_TRUE(extractor.init(&volume));
+	const glm::ivec3 pos(32, 0, 16);
+
+	// the lod band is crossed again before the first request was extracted
+	ASSERT_TRUE(extractor.scheduleMeshExtraction(pos, 0));
+	ASSERT_TRUE(extractor.scheduleMeshExtraction(pos, 2));
+	EXPECT_FALSE(extractor.isScheduled(pos, 0));
+	EXPECT_TRUE(extractor.isScheduled(pos, 2));
+	voxel::SurfaceExtractionContext ctx;
+	extractor.extractScheduledMesh(ctx);
+	extractor.extractScheduledMesh(ctx);
+	ChunkMesh chunkMesh;
+	ASSERT_TRUE(extractor.pop(chunkMesh));
+	EXPECT_EQ(2, chunkMesh.lod);
+	EXPECT_FALSE(extractor.pop(chunkMesh)) << "The request for the outdated level of detail must be dropped";
+
+	EXPECT_TRUE(extractor.allowReExtraction(pos));
+	EXPECT_FALSE(extractor.isScheduled(pos, 2));
+	extractor.shutdown();
+}
+
+}
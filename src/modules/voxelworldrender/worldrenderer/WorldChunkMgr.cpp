@@ -5,6 +5,7 @@
 #include "WorldChunkMgr.h"
 #include "core/Trace.h"
 #include "video/Trace.h"
+#include "core/GameConfig.h"
 #include "voxel/Constants.h"
 #include "voxelrender/ShaderAttribute.h"
 #include "WorldShader.h"
@@ -30,6 +31,7 @@ void WorldChunkMgr::updateViewDistance(float viewDistance) {
 
 bool WorldChunkMgr::init(shader::WorldShader* worldShader, voxel::PagedVolume* volume) {
 	_worldShader = worldShader;
+	_lodDistance = core::Var::get(cfg::ClientLODDistance, "256", -1, "Distance of the first level of detail band for the world meshes - 0 disables the level of detail");
 	if (!_meshExtractor.init(volume)) {
 		Log::error("Failed to initialize the mesh extractor");
 		return false;
@@ -43,31 +45,42 @@ void WorldChunkMgr::shutdown() {
 
 void WorldChunkMgr::reset() {
 	for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
-		chunkBuffer.inuse = false;
+		chunkBuffer.reset();
 	}
+	_chunkBufferLookup.clear();
 	_visibleBuffers.size = 0;
 	_meshExtractor.reset();
 	_octree.clear();
 }
 
 void WorldChunkMgr::handleMeshQueue() {
-	voxel::Mesh mesh;
-	if (!_meshExtractor.pop(mesh)) {
+	ChunkMesh chunkMesh;
+	if (!_meshExtractor.pop(chunkMesh)) {
+		return;
+	}
+	const voxel::Mesh& mesh = chunkMesh.mesh;
+	if (!_meshExtractor.isScheduled(mesh.getOffset(), chunkMesh.lod)) {
+		// the level of detail changed while the mesh was extracted - or the chunk is out of range already
 		return;
 	}
 
 	// Now add the mesh to the list of meshes to render.
 	core_trace_scoped(WorldRendererHandleMeshQueue);
 
+	const glm::ivec3& pos = _meshExtractor.meshPos(mesh.getOffset());
 	ChunkBuffer* freeChunkBuffer = nullptr;
-	for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
-		if (freeChunkBuffer == nullptr && !chunkBuffer.inuse) {
-			freeChunkBuffer = &chunkBuffer;
-		}
-		// check whether we update an existing one
-		if (chunkBuffer.aabb().mins() == mesh.getOffset()) {
-			freeChunkBuffer = &chunkBuffer;
-			break;
+	// a new level of detail (or a re-extraction) for a tile replaces the existing mesh
+	auto existing = _chunkBufferLookup.find(pos);
+	const bool lodChange = existing != _chunkBufferLookup.end();
+	if (lodChange) {
+		freeChunkBuffer = existing->second;
+		releaseChunkBuffer(*freeChunkBuffer);
+	} else {
+		for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
+			if (!chunkBuffer.inuse) {
+				freeChunkBuffer = &chunkBuffer;
+				break;
+			}
 		}
 	}
 
@@ -114,34 +127,52 @@ void WorldChunkMgr::handleMeshQueue() {
 		Log::warn("Failed to insert into octree");
 	}
 	freeChunkBuffer->inuse = true;
-	freeChunkBuffer->scaleSeconds = ScaleDuration;
+	freeChunkBuffer->pos = pos;
+	freeChunkBuffer->lod = chunkMesh.lod;
+	_chunkBufferLookup[pos] = freeChunkBuffer;
+	// only animate new chunks - not the ones that just changed their level of detail
+	if (!lodChange) {
+		freeChunkBuffer->scaleSeconds = ScaleDuration;
+	}
+}
+
+void WorldChunkMgr::releaseChunkBuffer(ChunkBuffer& chunkBuffer) {
+	// the octree finds the buffer by its aabb - so remove it before the aabb is reset
+	_octree.remove(&chunkBuffer);
+	_chunkBufferLookup.erase(chunkBuffer.pos);
+	chunkBuffer.reset();
 }
 
 void WorldChunkMgr::update(double deltaFrameSeconds, const video::Camera &camera, const glm::vec3& focusPos) {
 	handleMeshQueue();
 
+	_focusPos = focusPos;
 	_meshExtractor.updateExtractionOrder(focusPos);
 	for (ChunkBuffer& chunkBuffer : _chunkBuffers) {
 		if (!chunkBuffer.inuse) {
 			continue;
 		}
 		chunkBuffer.scaleSeconds -= deltaFrameSeconds;
-		const glm::ivec3& pos = chunkBuffer.aabb().mins();
+		const glm::ivec3 pos = chunkBuffer.pos;
 		const int distance = distance2(pos, focusPos);
 		if (distance < _maxAllowedDistance) {
+			const int lod = lodForDistance(distance);
+			if (lod != chunkBuffer.lod) {
+				// the old mesh is rendered until the new one replaces it
+				_meshExtractor.scheduleMeshExtraction(pos, lod);
+			}
 			continue;
 		}
 		core_assert_always(_meshExtractor.allowReExtraction(pos));
-		chunkBuffer.reset();
-		_octree.remove(&chunkBuffer);
+		releaseChunkBuffer(chunkBuffer);
 		Log::trace("Remove mesh from %i:%i", pos.x, pos.z);
 	}
 
 	cull(camera);
 }
 
-void WorldChunkMgr::extractScheduledMesh() {
-	_meshExtractor.extractScheduledMesh();
+void WorldChunkMgr::extractScheduledMesh(voxel::SurfaceExtractionContext& ctx) {
+	_meshExtractor.extractScheduledMesh(ctx);
 }
 
 // TODO: put into background task with two states - computing and
@@ -170,6 +201,22 @@ int WorldChunkMgr::distance2(const glm::ivec3& pos, const glm::ivec3& pos2) cons
 	return distance;
 }
 
+int WorldChunkMgr::lodForDistance(int distance2) const {
+	if (!_lodDistance) {
+		return 0;
+	}
+	int bandDistance = _lodDistance->intVal();
+	if (bandDistance <= 0) {
+		return 0;
+	}
+	int lod = 0;
+	while (lod < WorldMeshExtractor::MaxLOD && distance2 >= bandDistance * bandDistance) {
+		bandDistance *= 2;
+		++lod;
+	}
+	return lod;
+}
+
 void WorldChunkMgr::extractMeshes(const video::Camera& camera) {
 	core_trace_scoped(WorldRendererExtractMeshes);
 
@@ -186,12 +233,12 @@ void WorldChunkMgr::extractMeshes(const video::Camera& camera) {
 	maxs.z += farplane;
 
 	_octree.visit(mins, maxs, [&] (const glm::ivec3& mins, const glm::ivec3& maxs) {
-		return !_meshExtractor.scheduleMeshExtraction(mins);
+		return !_meshExtractor.scheduleMeshExtraction(mins, lodForDistance(distance2(mins, _focusPos)));
 	}, glm::vec3(_meshExtractor.meshSize()));
 }
 
 void WorldChunkMgr::extractMesh(const glm::ivec3& pos) {
-	_meshExtractor.scheduleMeshExtraction(pos);
+	_meshExtractor.scheduleMeshExtraction(pos, lodForDistance(distance2(pos, _focusPos)));
 }
 
 int WorldChunkMgr::renderTerrain() {
@@ -22,6 +22,10 @@ protected:
 	struct ChunkBuffer {
 		bool inuse = false;
 		double scaleSeconds = 0.0;
+		/** the mesh tile position the buffer is rendered for */
+		glm::ivec3 pos { 0 };
+		/** the level of detail the mesh was extracted with */
+		int lod = 0;
 		math::AABB<int> _aabb = {glm::ivec3(0), glm::ivec3(0)};
 		size_t _compressedIndexSize = 0;
 
@@ -38,6 +42,10 @@ protected:
 			_vbo = -1;
 			_ibo = -1;
 			inuse = false;
+			pos = glm::ivec3(0);
+			lod = 0;
+			_aabb = {glm::ivec3(0), glm::ivec3(0)};
+			_compressedIndexSize = 0;
 		}
 
 		/**
@@ -54,7 +62,11 @@ protected:
 	Tree _octree;
 	static constexpr int MAX_CHUNKBUFFERS = 2048;
 	ChunkBuffer _chunkBuffers[MAX_CHUNKBUFFERS];
+	/** the buffers that are in use by their mesh tile position - there is only one level of detail per tile */
+	std::unordered_map<glm::ivec3, ChunkBuffer*, std::hash<glm::ivec3> > _chunkBufferLookup;
 	int _maxAllowedDistance = -1;
+	core::VarPtr _lodDistance;
+	glm::ivec3 _focusPos { 0 };
 
 	struct VisibleBuffers {
 		int size = 0;
@@ -68,7 +80,15 @@ protected:
 	core::ThreadPool &_threadPool;
 
 	int distance2(const glm::ivec3 &pos, const glm::ivec3 &pos2) const;
-
+	/**
+	 * @brief Picks the level of detail for a chunk by its squared distance to the focus position
+	 */
+	int lodForDistance(int distance2) const;
+
+	/**
+	 * @brief Removes the buffer from the octree and the lookup and frees the gpu memory
+	 */
+	void releaseChunkBuffer(ChunkBuffer& chunkBuffer);
 	void cull(const video::Camera &camera);
 	void handleMeshQueue();
 public:
@@ -78,7 +98,7 @@ public:
 
 	void extractMesh(const glm::ivec3 &pos);
 	void extractMeshes(const video::Camera &camera);
-	void extractScheduledMesh();
+	void extractScheduledMesh(voxel::SurfaceExtractionContext& ctx);
 
 	void update(double deltaFrameSeconds, const video::Camera &camera, const glm::vec3& focusPos);
 
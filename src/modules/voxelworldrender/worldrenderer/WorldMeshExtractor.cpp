@@ -7,6 +7,9 @@
 #include "voxel/CubicSurfaceExtractor.h"
 #include "voxel/IsQuadNeeded.h"
 #include "voxel/Constants.h"
+#include "voxel/RawVolume.h"
+#include <vector>
+#include <algorithm>
 
 namespace voxelworldrender {
 
@@ -16,6 +19,7 @@ WorldMeshExtractor::WorldMeshExtractor() {
 bool WorldMeshExtractor::init(voxel::PagedVolume *volume) {
 	_volume = volume;
 	_meshSize = core::Var::getSafe(cfg::VoxelMeshSize);
+	_binaryGreedy = core::Var::get(cfg::VoxelMeshBinaryGreedy, "true", "Use the binary greedy mesher for the extraction", core::Var::boolValidator);
 	return true;
 }
 
@@ -24,7 +28,10 @@ void WorldMeshExtractor::shutdown() {
 	_pendingExtraction.abortWait();
 	_extracted.clear();
 	_extracted.abortWait();
-	_positionsExtracted.clear();
+	{
+		core::ScopedLock lock(_positionsExtractedLock);
+		_positionsExtracted.clear();
+	}
 	_extracted.clear();
 	_volume = nullptr;
 }
@@ -34,11 +41,14 @@ void WorldMeshExtractor::reset() {
 		_volume->flushAll();
 	}
 	_extracted.clear();
-	_positionsExtracted.clear();
+	{
+		core::ScopedLock lock(_positionsExtractedLock);
+		_positionsExtracted.clear();
+	}
 	_pendingExtraction.clear();
 }
 
-bool WorldMeshExtractor::pop(voxel::Mesh& item) {
+bool WorldMeshExtractor::pop(ChunkMesh& item) {
 	core_trace_value_scoped(QueryNewMesh, _positionsExtracted.size());
 	return _extracted.pop(item);
 }
@@ -69,42 +79,212 @@ void WorldMeshExtractor::updateExtractionOrder(const glm::ivec3& sortPos) {
 
 bool WorldMeshExtractor::allowReExtraction(const glm::ivec3& pos) {
 	const glm::ivec3& gridPos = meshPos(pos);
+	core::ScopedLock lock(_positionsExtractedLock);
 	return _positionsExtracted.erase(gridPos) != 0;
 }
 
+bool WorldMeshExtractor::isScheduled(const glm::ivec3& pos, int lod) const {
+	const glm::ivec3& gridPos = meshPos(pos);
+	core::ScopedLock lock(_positionsExtractedLock);
+	auto i = _positionsExtracted.find(gridPos);
+	return i != _positionsExtracted.end() && i->second == lod;
+}
+
 // Extract the surface for the specified region of the volume.
 // The surface extractor outputs the mesh in an efficient compressed format which
 // is not directly suitable for rendering.
-bool WorldMeshExtractor::scheduleMeshExtraction(const glm::ivec3& p) {
+bool WorldMeshExtractor::scheduleMeshExtraction(const glm::ivec3& p, int lod) {
 	const glm::ivec3& pos = meshPos(p);
-	auto i = _positionsExtracted.insert(pos);
-	if (!i.second) {
-		return false;
+	lod = glm::clamp(lod, 0, MaxLOD);
+	{
+		core::ScopedLock lock(_positionsExtractedLock);
+		auto i = _positionsExtracted.insert(std::make_pair(pos, lod));
+		if (!i.second) {
+			if (i.first->second == lod) {
+				return false;
+			}
+			// the level of detail band was crossed - the request for the old one is dropped by the extraction
+			i.first->second = lod;
+		}
+	}
+	Log::trace("mesh extraction for %i:%i:%i (%i:%i:%i) with lod %i",
+			p.x, p.y, p.z, pos.x, pos.y, pos.z, lod);
+	if (_volume != nullptr) {
+		// let the paging threads of the volume load the chunks (including the border) before the extraction needs them
+		const glm::ivec3& size = meshSize();
+		const voxel::Region region(glm::ivec3(pos.x - 1, pos.y, pos.z - 1), pos + size);
+		const CloseToPoint closeToPoint(_pendingExtractionSortPosition);
+		_volume->requestChunks(region, -closeToPoint.distanceToSortPos(pos));
 	}
-	Log::trace("mesh extraction for %i:%i:%i (%i:%i:%i)",
-			p.x, p.y, p.z, pos.x, pos.y, pos.z);
-	_pendingExtraction.push(pos);
+	_pendingExtraction.push(MeshRequest{pos, lod});
 	return true;
 }
 
-void WorldMeshExtractor::extractScheduledMesh() {
-	decltype(_pendingExtraction)::Key pos;
-	if (!_pendingExtraction.waitAndPop(pos)) {
+/**
+ * @brief Downsamples the world region into the given volume - one cell of the volume covers @c scale^3 voxels.
+ *
+ * The downsampling preserves the surface: a cell is solid if any of its voxels is solid and takes the highest solid
+ * voxel - the one that is most likely visible from above. Cells without solid voxels keep a transparent voxel if
+ * there is one. The volume must cover the downsampled region plus a border of one cell for the face culling and the
+ * ambient occlusion.
+ */
+static void downsample(voxel::PagedVolume* volume, const glm::ivec3& mins, int scale, voxel::RawVolume& cells) {
+	core_trace_scoped(DownsampleLOD);
+	const voxel::Region& region = cells.region();
+	const int height = region.getHeightInVoxels();
+	std::vector<voxel::Voxel> column(height);
+	std::vector<int> columnHeights(height);
+	voxel::PagedVolume::Sampler sampler(volume);
+	const int lowerY = mins.y + region.getLowerY() * scale;
+	const int voxelsY = height * scale;
+
+	for (int cz = region.getLowerZ(); cz <= region.getUpperZ(); ++cz) {
+		for (int cx = region.getLowerX(); cx <= region.getUpperX(); ++cx) {
+			std::fill(column.begin(), column.end(), voxel::Voxel());
+			std::fill(columnHeights.begin(), columnHeights.end(), -1);
+			for (int dz = 0; dz < scale; ++dz) {
+				for (int dx = 0; dx < scale; ++dx) {
+					sampler.setPosition(mins.x + cx * scale + dx, lowerY, mins.z + cz * scale + dz);
+					for (int y = 0; y < voxelsY; ++y) {
+						const voxel::Voxel& voxel = sampler.voxel();
+						const voxel::VoxelType material = voxel.getMaterial();
+						if (!voxel::isAir(material)) {
+							const int cy = y / scale;
+							if (!voxel::isTransparent(material)) {
+								if (y > columnHeights[cy]) {
+									column[cy] = voxel;
+									columnHeights[cy] = y;
+								}
+							} else if (voxel::isAir(column[cy].getMaterial())) {
+								column[cy] = voxel;
+							}
+						}
+						if (y != voxelsY - 1) {
+							sampler.movePositiveY();
+						}
+					}
+				}
+			}
+			for (int cy = 0; cy < height; ++cy) {
+				cells.setVoxel(cx, region.getLowerY() + cy, cz, column[cy]);
+			}
+		}
+	}
+}
+
+static void addSkirtQuad(voxel::Mesh& mesh, const voxel::Voxel& voxel, const glm::ivec3& v0, const glm::ivec3& v1, const glm::ivec3& v2, const glm::ivec3& v3) {
+	voxel::VoxelVertex vertex;
+	vertex.info = 0;
+	vertex.ambientOcclusion = 3;
+	vertex.flags = voxel.getFlags();
+	vertex.colorIndex = voxel.getColor();
+	const glm::ivec3 corners[] = {v0, v1, v2, v3};
+	voxel::IndexType indices[4];
+	for (int i = 0; i < 4; ++i) {
+		vertex.position = corners[i];
+		indices[i] = mesh.addVertex(vertex);
+	}
+	mesh.addTriangle(indices[0], indices[1], indices[2]);
+	mesh.addTriangle(indices[0], indices[2], indices[3]);
+}
+
+/**
+ * @brief Adds a skirt to the four sides of a downsampled tile to hide the seams to neighbours with another level of detail
+ *
+ * The downsampled cells are at least as high as the voxels they cover - but the faces at the tile border are culled
+ * against the downsampled border cells, while a neighbour with a finer level of detail might be lower there. Each
+ * border column gets a quad on the outer side of the tile that reaches from the top of the column down to the bottom
+ * of the tile. The positions are in cell coordinates - just like the extracted mesh before it's scaled.
+ */
+static void addSkirts(const voxel::RawVolume& cells, const voxel::Region& cellRegion, voxel::Mesh& mesh) {
+	core_trace_scoped(LODSkirts);
+	const glm::ivec3& lower = cellRegion.getLowerCorner();
+	const glm::ivec3& upper = cellRegion.getUpperCorner();
+	// finds the highest opaque cell of the column - returns the height of its top face or -1
+	auto columnTop = [&] (int x, int z, voxel::Voxel& top) {
+		for (int y = upper.y; y >= lower.y; --y) {
+			const voxel::Voxel& voxel = cells.voxel(x, y, z);
+			const voxel::VoxelType material = voxel.getMaterial();
+			if (!voxel::isAir(material) && !voxel::isTransparent(material)) {
+				top = voxel;
+				return y + 1;
+			}
+		}
+		return -1;
+	};
+	voxel::Voxel top;
+	for (int z = lower.z; z <= upper.z; ++z) {
+		int y1 = columnTop(lower.x, z, top);
+		if (y1 != -1) {
+			const int x = lower.x;
+			addSkirtQuad(mesh, top, glm::ivec3(x, lower.y, z), glm::ivec3(x, lower.y, z + 1), glm::ivec3(x, y1, z + 1), glm::ivec3(x, y1, z));
+		}
+		y1 = columnTop(upper.x, z, top);
+		if (y1 != -1) {
+			const int x = upper.x + 1;
+			addSkirtQuad(mesh, top, glm::ivec3(x, lower.y, z), glm::ivec3(x, y1, z), glm::ivec3(x, y1, z + 1), glm::ivec3(x, lower.y, z + 1));
+		}
+	}
+	for (int x = lower.x; x <= upper.x; ++x) {
+		int y1 = columnTop(x, lower.z, top);
+		if (y1 != -1) {
+			const int z = lower.z;
+			addSkirtQuad(mesh, top, glm::ivec3(x, lower.y, z), glm::ivec3(x, y1, z), glm::ivec3(x + 1, y1, z), glm::ivec3(x + 1, lower.y, z));
+		}
+		y1 = columnTop(x, upper.z, top);
+		if (y1 != -1) {
+			const int z = upper.z + 1;
+			addSkirtQuad(mesh, top, glm::ivec3(x, lower.y, z), glm::ivec3(x + 1, lower.y, z), glm::ivec3(x + 1, y1, z), glm::ivec3(x, y1, z));
+		}
+	}
+}
+
+void WorldMeshExtractor::extractScheduledMesh(voxel::SurfaceExtractionContext& ctx) {
+	MeshRequest request;
+	if (!_pendingExtraction.waitAndPop(request)) {
+		return;
+	}
+	if (!isScheduled(request.pos, request.lod)) {
+		// the tile was released or scheduled again with a different level of detail
 		return;
 	}
 	core_trace_scoped(MeshExtraction);
 	const glm::ivec3& size = meshSize();
-	const glm::ivec3 mins(pos);
-	const glm::ivec3 maxs(pos.x + size.x - 1, pos.y + size.y - 2, pos.z + size.z - 1);
+	const glm::ivec3 mins(request.pos);
+	const glm::ivec3 maxs(mins.x + size.x - 1, mins.y + size.y - 2, mins.z + size.z - 1);
 	const voxel::Region region(mins, maxs);
 	// these numbers are made up mostly by try-and-error - we need to revisit them from time to time to prevent extra mem allocs
 	// they also heavily depend on the size of the mesh region we extract
 	const int factor = 64;
-	const int vertices = region.getWidthInVoxels() * region.getDepthInVoxels() * factor;
-	voxel::Mesh mesh(vertices, vertices);
-	voxel::extractCubicMesh(_volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner());
+	const int scale = 1 << request.lod;
+	const int vertices = region.getWidthInVoxels() * region.getDepthInVoxels() * factor / (scale * scale);
+	voxel::Mesh mesh(vertices, vertices, request.lod > 0);
+	const bool binaryGreedy = _binaryGreedy->boolVal();
+	if (request.lod <= 0) {
+		if (binaryGreedy) {
+			voxel::extractBinaryGreedyMesh(_volume, region, &mesh, region.getLowerCorner(), ctx);
+		} else {
+			voxel::extractCubicMesh(_volume, region, &mesh, voxel::IsQuadNeeded(), region.getLowerCorner(), ctx);
+		}
+	} else {
+		const glm::ivec3 cellsSize = (region.getDimensionsInVoxels() + scale - 1) / scale;
+		const voxel::Region cellRegion(glm::ivec3(0), cellsSize - 1);
+		voxel::RawVolume cells(voxel::Region(cellRegion.getLowerCorner() - 1, cellRegion.getUpperCorner() + 1));
+		downsample(_volume, mins, scale, cells);
+		if (binaryGreedy) {
+			voxel::extractBinaryGreedyMesh(&cells, cellRegion, &mesh, glm::ivec3(0), ctx);
+		} else {
+			voxel::extractCubicMesh(&cells, cellRegion, &mesh, voxel::IsQuadNeeded(), glm::ivec3(0), ctx);
+		}
+		addSkirts(cells, cellRegion, mesh);
+		// scale the cells back into world coordinates
+		for (voxel::VoxelVertex& vertex : mesh.getVertexVector()) {
+			vertex.position = glm::ivec3(vertex.position) * scale + mins;
+		}
+		mesh.setOffset(mins);
+	}
 	if (!mesh.isEmpty()) {
-		_extracted.push(std::move(mesh));
+		_extracted.push(ChunkMesh(core::move(mesh), request.lod));
 	}
 }
 
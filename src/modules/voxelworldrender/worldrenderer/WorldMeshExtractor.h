@@ -10,19 +10,57 @@
 #include "core/collection/ConcurrentPriorityQueue.h"
 #include "voxel/PagedVolume.h"
 #include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
 
-#include <unordered_set>
+#include <unordered_map>
 #include <glm/vec3.hpp>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 
+namespace voxel {
+struct SurfaceExtractionContext;
+}
+
 namespace voxelworldrender {
 
-typedef std::unordered_set<glm::ivec3, std::hash<glm::ivec3> > PositionSet;
+/**
+ * @brief Maps the mesh tile position to the level of detail it was scheduled for
+ */
+typedef std::unordered_map<glm::ivec3, int, std::hash<glm::ivec3> > PositionLODMap;
+
+/**
+ * @brief An extracted mesh together with the level of detail it was extracted with
+ */
+struct ChunkMesh {
+	voxel::Mesh mesh;
+	int lod = 0;
+
+	ChunkMesh() {
+	}
+
+	ChunkMesh(voxel::Mesh&& _mesh, int _lod) :
+			mesh(core::move(_mesh)), lod(_lod) {
+	}
+
+	inline bool operator<(const ChunkMesh& rhs) const {
+		return mesh < rhs.mesh;
+	}
+};
 
 class WorldMeshExtractor {
+public:
+	/**
+	 * @brief The highest level of detail - the volume is downsampled by @c 1 << lod before it's meshed
+	 */
+	static constexpr int MaxLOD = 3;
+
 private:
-	core::ConcurrentPriorityQueue<voxel::Mesh> _extracted;
+	struct MeshRequest {
+		glm::ivec3 pos { 0 };
+		int lod = 0;
+	};
+
+	core::ConcurrentPriorityQueue<ChunkMesh> _extracted;
 	glm::ivec3 _pendingExtractionSortPosition { 0, 0, 0 };
 	struct CloseToPoint {
 		glm::ivec2 _refPoint;
@@ -32,27 +70,32 @@ private:
 			const glm::ivec2 d(_refPoint.x - pos.x, _refPoint.y - pos.z);
 			return d.x * d.x + d.y * d.y;
 		}
-		inline bool operator()(const glm::ivec3& lhs, const glm::ivec3& rhs) const {
-			return distanceToSortPos(lhs) > distanceToSortPos(rhs);
+		inline bool operator()(const MeshRequest& lhs, const MeshRequest& rhs) const {
+			return distanceToSortPos(lhs.pos) > distanceToSortPos(rhs.pos);
 		}
 	};
 
-	core::ConcurrentPriorityQueue<glm::ivec3, CloseToPoint> _pendingExtraction { CloseToPoint(_pendingExtractionSortPosition) };
-	// fast lookup for positions that are already extracted
-	PositionSet _positionsExtracted;
+	core::ConcurrentPriorityQueue<MeshRequest, CloseToPoint> _pendingExtraction { CloseToPoint(_pendingExtractionSortPosition) };
+	// fast lookup for positions that are already extracted - also read by the extraction threads
+	PositionLODMap _positionsExtracted;
+	mutable core_trace_mutex(core::Lock, _positionsExtractedLock, "WorldMeshExtractorPositions");
 	core::VarPtr _meshSize;
+	core::VarPtr _binaryGreedy;
 	voxel::PagedVolume *_volume = nullptr;
 
 public:
 	WorldMeshExtractor();
 
-	void extractScheduledMesh();
+	/**
+	 * @param ctx The memory for the extraction - should be kept alive by the calling thread to avoid allocations
+	 */
+	void extractScheduledMesh(voxel::SurfaceExtractionContext& ctx);
 
 	/**
 	 * @brief We need to pop the mesh extractor queue to find out if there are new and ready to use meshes for us
 	 * @return @c false if this isn't the case, @c true if the given reference was filled with valid data.
 	 */
-	bool pop(voxel::Mesh& item);
+	bool pop(ChunkMesh& item);
 
 	/**
 	 * @brief If you don't need an extracted mesh anymore, make sure to allow the reextraction at a later time.
@@ -61,6 +104,14 @@ public:
 	 */
 	bool allowReExtraction(const glm::ivec3& pos);
 
+	/**
+	 * @brief Checks whether an extraction for the given mesh tile and level of detail is still wanted.
+	 * Requests and meshes for a level of detail that was replaced by another one - or for tiles that were
+	 * released by @c allowReExtraction - are outdated.
+	 * @param[in] pos A world position vector that is automatically converted into a mesh tile vector
+	 */
+	bool isScheduled(const glm::ivec3& pos, int lod) const;
+
 	/**
 	 * @brief Reorder the scheduled extraction commands that the closest chunks to the given position are handled first
 	 */
@@ -70,9 +121,11 @@ public:
 	 * @brief Performs async mesh extraction. You need to call @c pop in order to see if some extraction is ready.
 	 *
 	 * @param[in] pos A world vector that is automatically converted into a mesh tile vector
-	 * @note This will not allow to reschedule an extraction for the same area until @c allowReExtraction was called.
+	 * @param[in] lod The level of detail in the range @c [0, MaxLOD] - the volume is downsampled by @c 1 << lod
+	 * @note This will not allow to reschedule an extraction for the same area and level of detail until
+	 * @c allowReExtraction was called. Scheduling the same area with a different level of detail re-extracts it.
 	 */
-	bool scheduleMeshExtraction(const glm::ivec3& pos);
+	bool scheduleMeshExtraction(const glm::ivec3& pos, int lod = 0);
 
 	void reset();
 
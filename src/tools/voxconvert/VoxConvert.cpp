@@ -578,7 +578,8 @@ void VoxConvert::dump(const voxelformat::SceneGraph& sceneGraph) {
 void VoxConvert::crop(voxelformat::SceneGraph& sceneGraph) {
 	Log::info("Crop volumes");
 	for (voxelformat::SceneGraphNode& node : sceneGraph) {
-		node.setVolume(voxelutil::cropVolume(node.volume()), true);
+		const voxel::Region &region = node.tightRegion();
+		node.setVolume(voxelutil::cropVolume(node.volume(), region.getLowerCorner(), region.getUpperCorner()), true);
 	}
 }
 
@@ -624,11 +625,10 @@ void VoxConvert::scale(voxelformat::SceneGraph& sceneGraph) {
 	Log::info("Scale layers");
 	for (voxelformat::SceneGraphNode& node : sceneGraph) {
 		const voxel::Region srcRegion = node.region();
-		const glm::ivec3& targetDimensionsHalf = (srcRegion.getDimensionsInVoxels() / 2) - 1;
-		const voxel::Region destRegion(srcRegion.getLowerCorner(), srcRegion.getLowerCorner() + targetDimensionsHalf);
+		const voxel::Region destRegion = voxelutil::downscaledRegion(srcRegion);
 		if (destRegion.isValid()) {
 			voxel::RawVolume* destVolume = new voxel::RawVolume(destRegion);
-			voxelutil::rescaleVolume(*node.volume(), *destVolume);
+			voxelutil::rescaleVolume(*node.volume(), srcRegion, *destVolume, destRegion, &threadPool());
 			node.setVolume(destVolume, true);
 		}
 	}
@@ -681,7 +681,7 @@ void VoxConvert::mirror(const core::String& axisStr, voxelformat::SceneGraph& sc
 	}
 	Log::info("Mirror on axis %c", axisStr[0]);
 	for (voxelformat::SceneGraphNode &node : sceneGraph) {
-		node.setVolume(voxelutil::mirrorAxis(node.volume(), axis), true);
+		node.setVolume(voxelutil::mirrorAxis(node.volume(), axis, &threadPool()), true);
 	}
 }
 
@@ -692,7 +692,7 @@ void VoxConvert::rotate(const core::String& axisStr, voxelformat::SceneGraph& sc
 	}
 	Log::info("Rotate on axis %c", axisStr[0]);
 	for (voxelformat::SceneGraphNode &node : sceneGraph) {
-		node.setVolume(voxelutil::rotateAxis(node.volume(), axis), true);
+		node.setVolume(voxelutil::rotateAxis(node.volume(), axis, &threadPool()), true);
 	}
 }
 
@@ -422,14 +422,13 @@ void SceneManager::scale(int nodeId) {
 		return;
 	}
 	const voxel::Region srcRegion = srcVolume->region();
-	const glm::ivec3& targetDimensionsHalf = (srcRegion.getDimensionsInVoxels() / 2) - 1;
-	if (targetDimensionsHalf.x < 0 || targetDimensionsHalf.y < 0 || targetDimensionsHalf.z < 0) {
+	const voxel::Region destRegion = voxelutil::downscaledRegion(srcRegion);
+	if (!destRegion.isValid()) {
 		Log::debug("Can't scale anymore");
 		return;
 	}
-	const voxel::Region destRegion(srcRegion.getLowerCorner(), srcRegion.getLowerCorner() + targetDimensionsHalf);
 	voxel::RawVolume* destVolume = new voxel::RawVolume(destRegion);
-	voxelutil::rescaleVolume(*srcVolume, *destVolume);
+	voxelutil::rescaleVolume(*srcVolume, srcRegion, *destVolume, destRegion, &app::App::getInstance()->threadPool());
 	if (!setNewVolume(nodeId, destVolume, true)) {
 		delete destVolume;
 		return;
@@ -447,7 +446,8 @@ void SceneManager::crop() {
 		Log::info("Empty volumes can't be cropped");
 		return;
 	}
-	voxel::RawVolume* newVolume = voxelutil::cropVolume(node->volume());
+	const voxel::Region& region = node->tightRegion();
+	voxel::RawVolume* newVolume = voxelutil::cropVolume(node->volume(), region.getLowerCorner(), region.getUpperCorner());
 	if (newVolume == nullptr) {
 		return;
 	}
@@ -1004,7 +1004,7 @@ void SceneManager::rotate(int angleX, int angleY, int angleZ) {
 		}
 		const voxel::RawVolume *model = node->volume();
 		const glm::vec3 pivot = node->transform(_currentFrameIdx).pivot();
-		voxel::RawVolume *newVolume = voxelutil::rotateVolume(model, angle, pivot);
+		voxel::RawVolume *newVolume = voxelutil::rotateVolume(model, angle, pivot, &app::App::getInstance()->threadPool());
 		voxel::Region r = newVolume->region();
 		r.accumulate(model->region());
 		setSceneGraphNodeVolume(*node, newVolume);
@@ -1742,7 +1742,7 @@ void SceneManager::flip(math::Axis axis) {
 		if (v == nullptr) {
 			return;
 		}
-		voxel::RawVolume* newVolume = voxelutil::mirrorAxis(v, axis);
+		voxel::RawVolume* newVolume = voxelutil::mirrorAxis(v, axis, &app::App::getInstance()->threadPool());
 		voxel::Region r = newVolume->region();
 		r.accumulate(v->region());
 		if (!setNewVolume(nodeId, newVolume)) {